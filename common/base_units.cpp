@@ -38,6 +38,7 @@
 #include <base_struct.h>
 #include <title_block.h>
 #include <common.h>
+#include <kicad_string.h>
 #include <base_units.h>
 #include "libeval/numeric_evaluator.h"
 
@@ -53,7 +54,7 @@
 
 
 // Helper function to print a float number without using scientific notation
-// and no trailing 0
+// and no trailing 0, in the C locale format whatever the current locale
 // So we cannot always just use the %g or the %f format to print a fp number
 // this helper function uses the %f format when needed, or %g when %f is
 // not well working and then removes trailing 0
@@ -67,7 +68,7 @@ std::string Double2Str( double aValue )
     {
         // For these small values, %f works fine,
         // and %g gives an exponent
-        len = sprintf( buf,  "%.16f", aValue );
+        len = FormatDouble( buf, sizeof( buf ), "%.16f", aValue );
 
         while( --len > 0 && buf[len] == '0' )
             buf[len] = '\0';
@@ -81,7 +82,7 @@ std::string Double2Str( double aValue )
     {
         // For these values, %g works fine, and sometimes %f
         // gives a bad value (try aValue = 1.222222222222, with %.16f format!)
-        len = sprintf( buf, "%.16g", aValue );
+        len = FormatDouble( buf, sizeof( buf ), "%.16g", aValue );
     }
 
     return std::string( buf, len );
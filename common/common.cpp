@@ -67,10 +67,14 @@ COLOR4D        g_GhostColor;
  */
 
 std::atomic<unsigned int> LOCALE_IO::m_c_count(0);
+std::string               LOCALE_IO::m_user_locale;
+std::mutex                LOCALE_IO::m_lock;
 
 LOCALE_IO::LOCALE_IO()
 {
-    // use thread safe, atomic operation
+    // The lock makes the other threads wait until the C locale is really set
+    std::lock_guard<std::mutex> lock( m_lock );
+
     if( m_c_count++ == 0 )
     {
         // Store the user locale name, to restore this locale later, in dtor
@@ -82,7 +86,8 @@ LOCALE_IO::LOCALE_IO()
 
 LOCALE_IO::~LOCALE_IO()
 {
-    // use thread safe, atomic operation
+    std::lock_guard<std::mutex> lock( m_lock );
+
     if( --m_c_count == 0 )
     {
         // revert to the user locale
@@ -406,6 +406,57 @@ void DSNLEXER::NeedRIGHT()
 }
 
 
+void DSNLEXER::ReadSectionText( std::string& aText )
+{
+    const char* cur   = next;
+    int         depth = 1;
+    bool        quoted = false;
+
+    while( depth > 0 )
+    {
+        if( cur >= limit )
+        {
+            if( readLine() == 0 )
+            {
+                wxString errtxt( _( "Unexpected end of file" ) );
+                THROW_PARSE_ERROR( errtxt, CurSource(), CurLine(), CurLineNumber(), CurOffset() );
+            }
+
+            cur = start;
+        }
+
+        const char* head = cur;
+
+        while( cur < limit && depth > 0 )
+        {
+            char cc = *cur++;
+
+            if( quoted )
+            {
+                if( cc == '\\' && cur < limit )
+                    ++cur;
+                else if( cc == stringDelimiter )
+                    quoted = false;
+            }
+            else if( cc == stringDelimiter )
+                quoted = true;
+            else if( cc == '(' )
+                ++depth;
+            else if( cc == ')' )
+                --depth;
+        }
+
+        aText.append( head, cur );
+    }
+
+    prevTok   = curTok;
+    curTok    = DSN_RIGHT;
+    curText   = ')';
+    curOffset = cur - 1 - start;
+    next      = cur;
+}
+
+
 int DSNLEXER::NeedSYMBOL()
 {
     int tok = NextTok();
@@ -776,14 +827,15 @@ L_read:
         }
     }           // specctraMode
 
-    // non-quoted token, read it into curText.
-    curText.clear();
-
+    // non-quoted token, read it into curText in one block.  curText keeps its
+    // capacity, so this is not an allocation once the longest token is seen.
     head = cur;
     while( head<limit && !isSep( *head ) )
-        curText += *head++;
+        ++head;
+
+    curText.assign( cur, head );
 
-    if( isNumber( curText.c_str(), curText.c_str() + curText.size() ) )
+    if( isNumber( cur, head ) )
     {
         curTok = DSN_NUMBER;
         goto exit;
@@ -42,16 +42,17 @@ using namespace KIGFX;
 CACHED_CONTAINER_RAM::CACHED_CONTAINER_RAM( unsigned int aSize ) :
     CACHED_CONTAINER( aSize ), m_verticesBuffer( 0 )
 {
-    glGenBuffers( 1, &m_verticesBuffer );
-    checkGlError( "generating vertices buffer" );
-
+    // The vertex buffer is generated by the first upload, so the container can be
+    // filled without an OpenGL context
     m_vertices = static_cast<VERTEX*>( malloc( aSize * VERTEX_SIZE ) );
 }
 
 
 CACHED_CONTAINER_RAM::~CACHED_CONTAINER_RAM()
 {
-    glDeleteBuffers( 1, &m_verticesBuffer );
+    if( m_verticesBuffer )
+        glDeleteBuffers( 1, &m_verticesBuffer );
+
     free( m_vertices );
 }
 
@@ -61,6 +62,12 @@ void CACHED_CONTAINER_RAM::Unmap()
     if( !m_dirty )
         return;
 
+    if( !m_verticesBuffer )
+    {
+        glGenBuffers( 1, &m_verticesBuffer );
+        checkGlError( "generating vertices buffer" );
+    }
+
     // Upload vertices coordinates and shader types to GPU memory
     glBindBuffer( GL_ARRAY_BUFFER, m_verticesBuffer );
     checkGlError( "binding vertices buffer" );
@@ -38,7 +38,10 @@ NONCACHED_CONTAINER::NONCACHED_CONTAINER( unsigned int aSize ) :
     VERTEX_CONTAINER( aSize ), m_freePtr( 0 )
 {
     m_vertices = static_cast<VERTEX*>( malloc( aSize * sizeof( VERTEX ) ) );
-    memset( m_vertices, 0x00, aSize * sizeof( VERTEX ) );
+
+    // A failed allocation leaves GetAllVertices() returning NULL
+    if( m_vertices )
+        memset( m_vertices, 0x00, aSize * sizeof( VERTEX ) );
 }
 
 
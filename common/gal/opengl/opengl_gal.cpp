@@ -32,6 +32,7 @@
 #include <gl_context_mgr.h>
 #include <geometry/shape_poly_set.h>
 #include <text_utils.h>
+#include <work_stealing_pool.h>
 
 #include <macros.h>
 
@@ -94,6 +95,7 @@ OPENGL_GAL::OPENGL_GAL( GAL_DISPLAY_OPTIONS& aDisplayOptions, wxWindow* aParent,
     isBitmapFontInitialized  = false;
     isInitialized            = false;
     isGrouping               = false;
+    isStaging               = false;
     groupCounter             = 0;
 
     // Connecting the event handlers
@@ -385,6 +387,9 @@ void OPENGL_GAL::BeginUpdate()
 
     GL_CONTEXT_MANAGER::Get().LockCtx( glPrivContext, this );
     cachedManager->Map();
+
+    // There is no point in staging the vertices without workers to tessellate them
+    isStaging = GetThreadPool().GetThreadCount() > 1;
 }
 
 
@@ -393,6 +398,9 @@ void OPENGL_GAL::EndUpdate()
     if( !isInitialized )
         return;
 
+    staging.Flush( *cachedManager );
+    isStaging = false;
+
     cachedManager->Unmap();
     GL_CONTEXT_MANAGER::Get().UnlockCtx( glPrivContext );
 }
@@ -1258,6 +1266,7 @@ int OPENGL_GAL::BeginGroup()
     std::shared_ptr<VERTEX_ITEM> newItem = std::make_shared<VERTEX_ITEM>( *cachedManager );
     int groupNumber = getNewGroupNumber();
     groups.insert( std::make_pair( groupNumber, newItem ) );
+    currentGroup = newItem;
 
     return groupNumber;
 }
@@ -1266,6 +1275,7 @@ int OPENGL_GAL::BeginGroup()
 void OPENGL_GAL::EndGroup()
 {
     cachedManager->FinishItem();
+    currentGroup.reset();
     isGrouping = false;
 }
 
@@ -1278,12 +1288,15 @@ void OPENGL_GAL::DrawGroup( int aGroupNumber )
 
 void OPENGL_GAL::ChangeGroupColor( int aGroupNumber, const COLOR4D& aNewColor )
 {
+    // The staged vertices have to be in the group to be modified
+    staging.Flush( *cachedManager );
     cachedManager->ChangeItemColor( *groups[aGroupNumber], aNewColor );
 }
 
 
 void OPENGL_GAL::ChangeGroupDepth( int aGroupNumber, int aDepth )
 {
+    staging.Flush( *cachedManager );
     cachedManager->ChangeItemDepth( *groups[aGroupNumber], aDepth );
 }
 
@@ -1297,6 +1310,7 @@ void OPENGL_GAL::DeleteGroup( int aGroupNumber )
 
 void OPENGL_GAL::ClearCache()
 {
+    staging.Clear();
     groups.clear();
 
     if( isInitialized )
@@ -1386,53 +1400,7 @@ void OPENGL_GAL::DrawCursor( const VECTOR2D& aCursorPosition )
 
 void OPENGL_GAL::drawLineQuad( const VECTOR2D& aStartPoint, const VECTOR2D& aEndPoint )
 {
-    /* Helper drawing:                   ____--- v3       ^
-     *                           ____---- ...   \          \
-     *                   ____----      ...       \   end    \
-     *     v1    ____----           ...    ____----          \ width
-     *       ----                ...___----        \          \
-     *       \             ___...--                 \          v
-     *        \    ____----...                ____---- v2
-     *         ----     ...           ____----
-     *  start   \    ...      ____----
-     *           \... ____----
-     *            ----
-     *            v0
-     * dots mark triangles' hypotenuses
-     */
-
-    VECTOR2D startEndVector = aEndPoint - aStartPoint;
-    double   lineLength     = startEndVector.EuclideanNorm();
-
-    if( lineLength <= 0.0 )
-        return;
-
-    double   scale          = 0.5 * lineWidth / lineLength;
-
-    // The perpendicular vector also needs transformations
-    glm::vec4 vector = currentManager->GetTransformation() *
-                       glm::vec4( -startEndVector.y * scale, startEndVector.x * scale, 0.0, 0.0 );
-
-    currentManager->Reserve( 6 );
-
-    // Line width is maintained by the vertex shader
-    currentManager->Shader( SHADER_LINE, vector.x, vector.y, lineWidth );
-    currentManager->Vertex( aStartPoint.x, aStartPoint.y, layerDepth );    // v0
-
-    currentManager->Shader( SHADER_LINE, -vector.x, -vector.y, lineWidth );
-    currentManager->Vertex( aStartPoint.x, aStartPoint.y, layerDepth );    // v1
-
-    currentManager->Shader( SHADER_LINE, -vector.x, -vector.y, lineWidth );
-    currentManager->Vertex( aEndPoint.x, aEndPoint.y, layerDepth );        // v3
-
-    currentManager->Shader( SHADER_LINE, vector.x, vector.y, lineWidth );
-    currentManager->Vertex( aStartPoint.x, aStartPoint.y, layerDepth );    // v0
-
-    currentManager->Shader( SHADER_LINE, -vector.x, -vector.y, lineWidth );
-    currentManager->Vertex( aEndPoint.x, aEndPoint.y, layerDepth );        // v3
-
-    currentManager->Shader( SHADER_LINE, vector.x, vector.y, lineWidth );
-    currentManager->Vertex( aEndPoint.x, aEndPoint.y, layerDepth );        // v2
+    VERTEX_STAGING::DrawLineQuad( *currentManager, aStartPoint, aEndPoint, lineWidth, layerDepth );
 }
 
 
@@ -1455,31 +1423,8 @@ void OPENGL_GAL::drawSemiCircle( const VECTOR2D& aCenterPoint, double aRadius, d
 void OPENGL_GAL::drawFilledSemiCircle( const VECTOR2D& aCenterPoint, double aRadius,
                                        double aAngle )
 {
-    Save();
-
-    currentManager->Reserve( 3 );
-    currentManager->Translate( aCenterPoint.x, aCenterPoint.y, 0.0f );
-    currentManager->Rotate( aAngle, 0.0f, 0.0f, 1.0f );
-
-    /* Draw a triangle that contains the semicircle, then shade it to leave only
-     * the semicircle. Parameters given to Shader() are indices of the triangle's vertices
-     * (if you want to understand more, check the vertex shader source [shader.vert]).
-     * Shader uses these coordinates to determine if fragments are inside the semicircle or not.
-     *       v2
-     *       /\
-     *      /__\
-     *  v0 //__\\ v1
-     */
-    currentManager->Shader( SHADER_FILLED_CIRCLE, 4.0f );
-    currentManager->Vertex( -aRadius * 3.0f / sqrt( 3.0f ), 0.0f, layerDepth );     // v0
-
-    currentManager->Shader( SHADER_FILLED_CIRCLE, 5.0f );
-    currentManager->Vertex( aRadius * 3.0f / sqrt( 3.0f ), 0.0f, layerDepth );      // v1
-
-    currentManager->Shader( SHADER_FILLED_CIRCLE, 6.0f );
-    currentManager->Vertex( 0.0f, aRadius * 2.0f, layerDepth );                     // v2
-
-    Restore();
+    VERTEX_STAGING::DrawFilledSemiCircle( *currentManager, aCenterPoint, aRadius, aAngle,
+                                          layerDepth );
 }
 
 
@@ -1558,28 +1503,26 @@ void OPENGL_GAL::drawPolyline( const std::function<VECTOR2D (int)>& aPointGetter
     if( aPointCount < 2 )
         return;
 
-    currentManager->Color( strokeColor.r, strokeColor.g, strokeColor.b, strokeColor.a );
-    int i;
-
-    for( i = 1; i < aPointCount; ++i )
+    // Long polylines of the cached groups (e.g. zone outlines) are tessellated in parallel
+    // when the update ends
+    if( isStaging && isGrouping && currentManager == cachedManager
+            && aPointCount >= MIN_STAGED_POLYLINE_POINTS
+            && currentManager->GetTransformation() == glm::mat4( 1.0f ) )
     {
-        auto start = aPointGetter( i - 1 );
-        auto end = aPointGetter( i );
-        const VECTOR2D startEndVector = ( end - start );
-        double lineAngle = startEndVector.Angle();
+        std::vector<VECTOR2D> points( aPointCount );
 
-        drawLineQuad( start, end );
+        for( int i = 0; i < aPointCount; ++i )
+            points[i] = aPointGetter( i );
 
-        // There is no need to draw line caps on both ends of polyline's segments
-        drawFilledSemiCircle( start, lineWidth / 2, lineAngle + M_PI / 2 );
+        staging.AddPolyline( *currentManager, currentGroup, std::move( points ), strokeColor,
+                             lineWidth, layerDepth );
+        return;
     }
 
-    // ..and now - draw the ending cap
-    auto start = aPointGetter( i - 2 );
-    auto end = aPointGetter( i - 1 );
-    const VECTOR2D startEndVector = ( end - start );
-    double lineAngle = startEndVector.Angle();
-    drawFilledSemiCircle( end, lineWidth / 2, lineAngle - M_PI / 2 );
+    currentManager->Color( strokeColor.r, strokeColor.g, strokeColor.b, strokeColor.a );
+
+    VERTEX_STAGING::DrawPolyline( *currentManager, aPointGetter, aPointCount, lineWidth,
+                                  layerDepth );
 }
 
 
@@ -35,6 +35,8 @@
 #include <gal/opengl/vertex_item.h>
 #include <confirm.h>
 
+#include <cstring>
+
 using namespace KIGFX;
 
 VERTEX_MANAGER::VERTEX_MANAGER( bool aCached ) :
@@ -49,6 +51,18 @@ VERTEX_MANAGER::VERTEX_MANAGER( bool aCached ) :
 }
 
 
+VERTEX_MANAGER::VERTEX_MANAGER( VERTEX_CONTAINER* aContainer ) :
+    m_noTransform( true ), m_transform( 1.0f ), m_reserved( NULL ), m_reservedSpace( 0 )
+{
+    m_container.reset( aContainer );
+    m_gpu.reset( GPU_MANAGER::MakeManager( m_container.get() ) );
+
+    // There is no shader used by default
+    for( unsigned int i = 0; i < SHADER_STRIDE; ++i )
+        m_shader[i] = 0.0f;
+}
+
+
 void VERTEX_MANAGER::Map()
 {
     m_container->Map();
@@ -154,6 +168,32 @@ bool VERTEX_MANAGER::Vertices( const VERTEX aVertices[], unsigned int aSize )
 }
 
 
+bool VERTEX_MANAGER::BlankVertices( unsigned int aSize )
+{
+    assert( m_reservedSpace == 0 );
+
+    // flag to avoid hanging by calling DisplayError too many times:
+    static bool show_err = true;
+
+    VERTEX* newVertex = m_container->Allocate( aSize );
+
+    if( newVertex == NULL )
+    {
+        if( show_err )
+        {
+            DisplayError( NULL, wxT( "VERTEX_MANAGER::BlankVertices: Vertex allocation error" ) );
+            show_err = false;
+        }
+
+        return false;
+    }
+
+    memset( newVertex, 0, aSize * VERTEX_SIZE );
+
+    return true;
+}
+
+
 void VERTEX_MANAGER::SetItem( VERTEX_ITEM& aItem ) const
 {
     m_container->SetItem( &aItem );
@@ -209,6 +249,19 @@ void VERTEX_MANAGER::ChangeItemDepth( const VERTEX_ITEM& aItem, GLfloat aDepth )
 }
 
 
+void VERTEX_MANAGER::SetItemVertices( const VERTEX_ITEM& aItem, unsigned int aOffset,
+                                      const VERTEX aVertices[], unsigned int aSize ) const
+{
+    assert( aOffset + aSize <= aItem.GetSize() );
+
+    VERTEX* vertex = m_container->GetVertices( aItem.GetOffset() + aOffset );
+
+    memcpy( vertex, aVertices, aSize * VERTEX_SIZE );
+
+    m_container->SetDirty();
+}
+
+
 VERTEX* VERTEX_MANAGER::GetVertices( const VERTEX_ITEM& aItem ) const
 {
     if( aItem.GetSize() == 0 )
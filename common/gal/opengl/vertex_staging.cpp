@@ -0,0 +1,342 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file vertex_staging.cpp
+ * @brief Class to tessellate the polylines of cached items on worker threads.
+ */
+
+#include <gal/opengl/vertex_staging.h>
+#include <gal/opengl/vertex_manager.h>
+#include <gal/opengl/vertex_item.h>
+#include <gal/opengl/noncached_container.h>
+#include <work_stealing_pool.h>
+#include <confirm.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+using namespace KIGFX;
+
+///> Below this number of points per worker, the polylines are tessellated by the caller
+static const size_t MIN_POINTS_PER_BUFFER = 4096;
+
+
+VERTEX_STAGING::VERTEX_STAGING() :
+    m_pointCount( 0 )
+{
+}
+
+
+void VERTEX_STAGING::AddPolyline( VERTEX_MANAGER& aManager,
+                                  const std::shared_ptr<VERTEX_ITEM>& aItem,
+                                  std::vector<VECTOR2D>&& aPoints, const COLOR4D& aColor,
+                                  double aWidth, double aDepth )
+{
+    unsigned int size = PolylineVertexCount( aPoints );
+
+    if( size == 0 )
+        return;
+
+    POLYLINE polyline;
+
+    polyline.m_item       = aItem;
+    polyline.m_color      = aColor;
+    polyline.m_width      = aWidth;
+    polyline.m_depth      = aDepth;
+    polyline.m_itemOffset = aItem->GetSize();
+    polyline.m_size       = size;
+    polyline.m_buffer     = 0;
+    polyline.m_offset     = 0;
+    polyline.m_done       = false;
+
+    // The vertices take the place reserved here, between the vertices drawn before and after
+    if( !aManager.BlankVertices( size ) )
+        return;
+
+    polyline.m_points = std::move( aPoints );
+    m_pointCount += polyline.m_points.size();
+    m_polylines.push_back( std::move( polyline ) );
+}
+
+
+void VERTEX_STAGING::Clear()
+{
+    m_polylines.clear();
+    m_pointCount = 0;
+}
+
+
+void VERTEX_STAGING::Flush( VERTEX_MANAGER& aManager )
+{
+    if( m_polylines.empty() )
+        return;
+
+    // Split the queue in consecutive ranges having about the same number of points, each
+    // one is tessellated by a worker into its own staging buffer
+    WORK_STEALING_POOL& pool = GetThreadPool();
+    size_t bufferCount = std::min( pool.GetThreadCount(), m_pointCount / MIN_POINTS_PER_BUFFER );
+    size_t pointsPerBuffer = m_pointCount / std::max<size_t>( bufferCount, 1 ) + 1;
+
+    std::vector<size_t> starts;
+    size_t points = pointsPerBuffer;
+
+    for( size_t i = 0; i < m_polylines.size(); ++i )
+    {
+        if( points >= pointsPerBuffer )
+        {
+            starts.push_back( i );
+            points = 0;
+        }
+
+        points += m_polylines[i].m_points.size();
+    }
+
+    starts.push_back( m_polylines.size() );
+    bufferCount = starts.size() - 1;
+
+    std::vector<NONCACHED_CONTAINER*> containers( bufferCount );
+    std::vector<std::unique_ptr<VERTEX_MANAGER>> managers( bufferCount );
+
+    // Runs on the workers: an allocation failure is returned, to be reported by this thread
+    auto tessellate = [&]( size_t aBuffer ) -> bool
+    {
+        unsigned int size = 0;
+
+        for( size_t i = starts[aBuffer]; i < starts[aBuffer + 1]; ++i )
+            size += m_polylines[i].m_size;
+
+        // The manager owns the container
+        containers[aBuffer] = new NONCACHED_CONTAINER( std::max( size, 1u ) );
+        managers[aBuffer].reset( new VERTEX_MANAGER( containers[aBuffer] ) );
+
+        if( !containers[aBuffer]->GetAllVertices() )
+            return false;
+
+        // The buffer has room for all the vertices: the manager never allocates, so it
+        // never reports an error from this thread
+        VERTEX_MANAGER& manager = *managers[aBuffer];
+
+        for( size_t i = starts[aBuffer]; i < starts[aBuffer + 1]; ++i )
+        {
+            POLYLINE& polyline = m_polylines[i];
+            const std::vector<VECTOR2D>& pts = polyline.m_points;
+
+            // The item was deleted in the meantime
+            if( polyline.m_item.expired() )
+                continue;
+
+            polyline.m_buffer = aBuffer;
+            polyline.m_offset = containers[aBuffer]->GetSize();
+
+            manager.Color( polyline.m_color );
+            DrawPolyline( manager, [&pts]( int aIdx ) { return pts[aIdx]; }, pts.size(),
+                          polyline.m_width, polyline.m_depth );
+
+            assert( containers[aBuffer]->GetSize() - polyline.m_offset == polyline.m_size );
+            polyline.m_done = true;
+        }
+
+        return true;
+    };
+
+    std::vector<char> succeeded( bufferCount, false );
+
+    if( bufferCount < 2 )
+    {
+        succeeded[0] = tessellate( 0 );
+    }
+    else
+    {
+        std::vector<WORK_STEALING_POOL::TASK> tasks;
+
+        for( size_t i = 0; i < bufferCount; ++i )
+            tasks.push_back( [&tessellate, &succeeded, i]() { succeeded[i] = tessellate( i ); } );
+
+        pool.Run( tasks );
+    }
+
+    if( std::find( succeeded.begin(), succeeded.end(), false ) != succeeded.end() )
+    {
+        // flag to avoid hanging by calling DisplayError too many times:
+        static bool show_err = true;
+
+        if( show_err )
+        {
+            DisplayError( NULL, wxT( "VERTEX_STAGING::Flush: Vertex allocation error" ) );
+            show_err = false;
+        }
+    }
+
+    // Copy the vertices to the place reserved in their items. The polylines which could
+    // not be tessellated leave blank vertices, which draw nothing.
+    for( const POLYLINE& polyline : m_polylines )
+    {
+        std::shared_ptr<VERTEX_ITEM> item = polyline.m_item.lock();
+
+        if( item && polyline.m_done )
+        {
+            aManager.SetItemVertices( *item, polyline.m_itemOffset,
+                                      containers[polyline.m_buffer]->GetAllVertices()
+                                              + polyline.m_offset,
+                                      polyline.m_size );
+        }
+    }
+
+    Clear();
+}
+
+
+void VERTEX_STAGING::DrawLineQuad( VERTEX_MANAGER& aManager, const VECTOR2D& aStartPoint,
+                                   const VECTOR2D& aEndPoint, double aWidth, double aDepth )
+{
+    /* Helper drawing:                   ____--- v3       ^
+     *                           ____---- ...   \          \
+     *                   ____----      ...       \   end    \
+     *     v1    ____----           ...    ____----          \ width
+     *       ----                ...___----        \          \
+     *       \             ___...--                 \          v
+     *        \    ____----...                ____---- v2
+     *         ----     ...           ____----
+     *  start   \    ...      ____----
+     *           \... ____----
+     *            ----
+     *            v0
+     * dots mark triangles' hypotenuses
+     */
+
+    VECTOR2D startEndVector = aEndPoint - aStartPoint;
+    double   lineLength     = startEndVector.EuclideanNorm();
+
+    if( lineLength <= 0.0 )
+        return;
+
+    double   scale          = 0.5 * aWidth / lineLength;
+
+    // The perpendicular vector also needs transformations
+    glm::vec4 vector = aManager.GetTransformation() *
+                       glm::vec4( -startEndVector.y * scale, startEndVector.x * scale, 0.0, 0.0 );
+
+    aManager.Reserve( 6 );
+
+    // Line width is maintained by the vertex shader
+    aManager.Shader( SHADER_LINE, vector.x, vector.y, aWidth );
+    aManager.Vertex( aStartPoint.x, aStartPoint.y, aDepth );    // v0
+
+    aManager.Shader( SHADER_LINE, -vector.x, -vector.y, aWidth );
+    aManager.Vertex( aStartPoint.x, aStartPoint.y, aDepth );    // v1
+
+    aManager.Shader( SHADER_LINE, -vector.x, -vector.y, aWidth );
+    aManager.Vertex( aEndPoint.x, aEndPoint.y, aDepth );        // v3
+
+    aManager.Shader( SHADER_LINE, vector.x, vector.y, aWidth );
+    aManager.Vertex( aStartPoint.x, aStartPoint.y, aDepth );    // v0
+
+    aManager.Shader( SHADER_LINE, -vector.x, -vector.y, aWidth );
+    aManager.Vertex( aEndPoint.x, aEndPoint.y, aDepth );        // v3
+
+    aManager.Shader( SHADER_LINE, vector.x, vector.y, aWidth );
+    aManager.Vertex( aEndPoint.x, aEndPoint.y, aDepth );        // v2
+}
+
+
+void VERTEX_STAGING::DrawFilledSemiCircle( VERTEX_MANAGER& aManager, const VECTOR2D& aCenterPoint,
+                                           double aRadius, double aAngle, double aDepth )
+{
+    aManager.PushMatrix();
+
+    aManager.Reserve( 3 );
+    aManager.Translate( aCenterPoint.x, aCenterPoint.y, 0.0f );
+    aManager.Rotate( aAngle, 0.0f, 0.0f, 1.0f );
+
+    /* Draw a triangle that contains the semicircle, then shade it to leave only
+     * the semicircle. Parameters given to Shader() are indices of the triangle's vertices
+     * (if you want to understand more, check the vertex shader source [shader.vert]).
+     * Shader uses these coordinates to determine if fragments are inside the semicircle or not.
+     *       v2
+     *       /\
+     *      /__\
+     *  v0 //__\\ v1
+     */
+    aManager.Shader( SHADER_FILLED_CIRCLE, 4.0f );
+    aManager.Vertex( -aRadius * 3.0f / sqrt( 3.0f ), 0.0f, aDepth );     // v0
+
+    aManager.Shader( SHADER_FILLED_CIRCLE, 5.0f );
+    aManager.Vertex( aRadius * 3.0f / sqrt( 3.0f ), 0.0f, aDepth );      // v1
+
+    aManager.Shader( SHADER_FILLED_CIRCLE, 6.0f );
+    aManager.Vertex( 0.0f, aRadius * 2.0f, aDepth );                     // v2
+
+    aManager.PopMatrix();
+}
+
+
+void VERTEX_STAGING::DrawPolyline( VERTEX_MANAGER& aManager,
+                                   const std::function<VECTOR2D (int)>& aPointGetter,
+                                   int aPointCount, double aWidth, double aDepth )
+{
+    if( aPointCount < 2 )
+        return;
+
+    int i;
+
+    for( i = 1; i < aPointCount; ++i )
+    {
+        auto start = aPointGetter( i - 1 );
+        auto end = aPointGetter( i );
+        const VECTOR2D startEndVector = ( end - start );
+        double lineAngle = startEndVector.Angle();
+
+        DrawLineQuad( aManager, start, end, aWidth, aDepth );
+
+        // There is no need to draw line caps on both ends of polyline's segments
+        DrawFilledSemiCircle( aManager, start, aWidth / 2, lineAngle + M_PI / 2, aDepth );
+    }
+
+    // ..and now - draw the ending cap
+    auto start = aPointGetter( i - 2 );
+    auto end = aPointGetter( i - 1 );
+    const VECTOR2D startEndVector = ( end - start );
+    double lineAngle = startEndVector.Angle();
+    DrawFilledSemiCircle( aManager, end, aWidth / 2, lineAngle - M_PI / 2, aDepth );
+}
+
+
+unsigned int VERTEX_STAGING::PolylineVertexCount( const std::vector<VECTOR2D>& aPoints )
+{
+    if( aPoints.size() < 2 )
+        return 0;
+
+    // A cap for each segment, and the ending cap
+    unsigned int count = aPoints.size() * 3;
+
+    // A quad for each segment, unless DrawLineQuad() skips it
+    for( size_t i = 1; i < aPoints.size(); ++i )
+    {
+        if( ( aPoints[i] - aPoints[i - 1] ).EuclideanNorm() > 0.0 )
+            count += 6;
+    }
+
+    return count;
+}
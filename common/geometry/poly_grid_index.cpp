@@ -0,0 +1,338 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <geometry/poly_grid_index.h>
+
+// Average number of edges by grid cell
+static const int EDGES_PER_CELL = 2;
+
+// Maximum number of rows or columns of the grid
+static const int MAX_GRID_SIZE = 512;
+
+
+POLY_GRID_INDEX::POLY_GRID_INDEX( const SHAPE_LINE_CHAIN& aPath ) :
+    m_path( aPath )
+{
+    m_bbox = m_path.BBox();
+
+    int cnt = m_path.PointCount();
+    int segCount = m_path.SegmentCount();
+
+    // Pick a grid of square cells holding a few edges each
+    double width = m_bbox.GetWidth() + 1.0;
+    double height = m_bbox.GetHeight() + 1.0;
+    double cells = std::max( 1, segCount / EDGES_PER_CELL );
+    double cellSize = std::sqrt( width * height / cells );
+
+    m_cols = std::min( MAX_GRID_SIZE, std::max( 1, (int) ( width / cellSize ) ) );
+    m_rows = std::min( MAX_GRID_SIZE, std::max( 1, (int) ( height / cellSize ) ) );
+
+    // The rows hold the edges used by the point in polygon test: the polygon is always
+    // closed there, whatever the state of the line chain.
+    m_rowStart.assign( m_rows + 1, 0 );
+
+    for( int pass = 0; pass < 2; pass++ )
+    {
+        for( int i = 0; i < cnt; i++ )
+        {
+            const VECTOR2I& a = m_path.CPoint( i );
+            const VECTOR2I& b = m_path.CPoint( i + 1 == cnt ? 0 : i + 1 );
+            int             r1 = cellY( std::max( a.y, b.y ) );
+
+            for( int r = cellY( std::min( a.y, b.y ) ); r <= r1; r++ )
+            {
+                if( pass == 0 )
+                    m_rowStart[r + 1]++;
+                else
+                    m_rowEdges[m_rowStart[r]++] = i;
+            }
+        }
+
+        if( pass == 0 )
+        {
+            for( int r = 0; r < m_rows; r++ )
+                m_rowStart[r + 1] += m_rowStart[r];
+
+            m_rowEdges.resize( m_rowStart[m_rows] );
+        }
+        else
+        {
+            // The fill pass has moved each start to the start of the next row
+            std::rotate( m_rowStart.begin(), m_rowStart.end() - 1, m_rowStart.end() );
+            m_rowStart[0] = 0;
+        }
+    }
+
+    // The cells hold the segments of the line chain, in every cell they cross
+    m_cellStart.assign( m_rows * m_cols + 1, 0 );
+
+    for( int pass = 0; pass < 2; pass++ )
+    {
+        for( int i = 0; i < segCount; i++ )
+        {
+            const SEG seg = m_path.CSegment( i );
+            int       minX = std::min( seg.A.x, seg.B.x );
+            int       maxX = std::max( seg.A.x, seg.B.x );
+            int       minY = std::min( seg.A.y, seg.B.y );
+            int       maxY = std::max( seg.A.y, seg.B.y );
+            int       c1 = cellX( maxX );
+
+            for( int c = cellX( minX ); c <= c1; c++ )
+            {
+                // The part of the segment inside the column, rounded outwards
+                double colX0 = m_bbox.GetX() + c * width / m_cols;
+                double colX1 = m_bbox.GetX() + ( c + 1 ) * width / m_cols;
+                int    y0 = minY;
+                int    y1 = maxY;
+
+                if( seg.A.x != seg.B.x )
+                {
+                    double x0 = std::max<double>( minX, colX0 );
+                    double x1 = std::min<double>( maxX, colX1 );
+                    double slope = double( seg.B.y - seg.A.y ) / ( seg.B.x - seg.A.x );
+                    double ya = seg.A.y + ( x0 - seg.A.x ) * slope;
+                    double yb = seg.A.y + ( x1 - seg.A.x ) * slope;
+
+                    y0 = std::max<double>( minY, std::floor( std::min( ya, yb ) ) - 1 );
+                    y1 = std::min<double>( maxY, std::ceil( std::max( ya, yb ) ) + 1 );
+                }
+
+                int r1 = cellY( y1 );
+
+                for( int r = cellY( y0 ); r <= r1; r++ )
+                {
+                    int cell = r * m_cols + c;
+
+                    if( pass == 0 )
+                        m_cellStart[cell + 1]++;
+                    else
+                        m_cellEdges[m_cellStart[cell]++] = i;
+                }
+            }
+        }
+
+        if( pass == 0 )
+        {
+            for( int cell = 0; cell < m_rows * m_cols; cell++ )
+                m_cellStart[cell + 1] += m_cellStart[cell];
+
+            m_cellEdges.resize( m_cellStart.back() );
+        }
+        else
+        {
+            std::rotate( m_cellStart.begin(), m_cellStart.end() - 1, m_cellStart.end() );
+            m_cellStart[0] = 0;
+        }
+    }
+}
+
+
+int POLY_GRID_INDEX::cellX( int64_t aX ) const
+{
+    int64_t c = ( aX - m_bbox.GetX() ) * m_cols / ( (int64_t) m_bbox.GetWidth() + 1 );
+
+    return std::min<int64_t>( m_cols - 1, std::max<int64_t>( 0, c ) );
+}
+
+
+int POLY_GRID_INDEX::cellY( int64_t aY ) const
+{
+    int64_t r = ( aY - m_bbox.GetY() ) * m_rows / ( (int64_t) m_bbox.GetHeight() + 1 );
+
+    return std::min<int64_t>( m_rows - 1, std::max<int64_t>( 0, r ) );
+}
+
+
+template <class FUNC>
+bool POLY_GRID_INDEX::visitEdges( const VECTOR2I& aMin, const VECTOR2I& aMax, int64_t aMargin,
+                                  FUNC aFunc ) const
+{
+    if( aMax.x + aMargin < m_bbox.GetX() || aMin.x - aMargin > m_bbox.GetRight()
+            || aMax.y + aMargin < m_bbox.GetY() || aMin.y - aMargin > m_bbox.GetBottom() )
+        return false;
+
+    int c0 = cellX( aMin.x - aMargin );
+    int c1 = cellX( aMax.x + aMargin );
+    int r0 = cellY( aMin.y - aMargin );
+    int r1 = cellY( aMax.y + aMargin );
+
+    for( int r = r0; r <= r1; r++ )
+    {
+        for( int c = c0; c <= c1; c++ )
+        {
+            int cell = r * m_cols + c;
+
+            for( int i = m_cellStart[cell]; i < m_cellStart[cell + 1]; i++ )
+            {
+                if( aFunc( m_cellEdges[i] ) )
+                    return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+
+bool POLY_GRID_INDEX::PointInside( const VECTOR2I& aP ) const
+{
+    int result = 0;
+    int cnt = m_path.PointCount();
+
+    if( !m_bbox.Contains( aP ) )
+        return false;
+
+    if( cnt < 3 )
+        return false;
+
+    int row = cellY( aP.y );
+
+    // Same test as SHAPE_POLY_SET::pointInPolygon(), on the edges spanning the row of aP
+    for( int i = m_rowStart[row]; i < m_rowStart[row + 1]; i++ )
+    {
+        int             edge = m_rowEdges[i];
+        const VECTOR2I& ip = m_path.CPoint( edge );
+        const VECTOR2I& ipNext = m_path.CPoint( edge + 1 == cnt ? 0 : edge + 1 );
+
+        if( ipNext.y == aP.y )
+        {
+            if( ( ipNext.x == aP.x ) || ( ip.y == aP.y
+                                          && ( ( ipNext.x > aP.x ) == ( ip.x < aP.x ) ) ) )
+                return true;
+        }
+
+        if( ( ip.y < aP.y ) != ( ipNext.y < aP.y ) )
+        {
+            if( ip.x >= aP.x && ipNext.x > aP.x )
+            {
+                result = 1 - result;
+            }
+            else if( ip.x >= aP.x || ipNext.x > aP.x )
+            {
+                int64_t d = (int64_t) ( ip.x - aP.x ) * (int64_t) ( ipNext.y - aP.y ) -
+                            (int64_t) ( ipNext.x - aP.x ) * (int64_t) ( ip.y - aP.y );
+
+                if( !d )
+                    return true;
+
+                if( ( d > 0 ) == ( ipNext.y > ip.y ) )
+                    result = 1 - result;
+            }
+        }
+    }
+
+    return result > 0;
+}
+
+
+bool POLY_GRID_INDEX::PointOnEdge( const VECTOR2I& aP ) const
+{
+    if( m_path.PointCount() == 1 )
+        return m_path.CPoint( 0 ) == aP;
+
+    return visitEdges( aP, aP, 1, [&]( int aEdge )
+            {
+                const SEG s = m_path.CSegment( aEdge );
+
+                return s.A == aP || s.B == aP || s.Distance( aP ) <= 1;
+            } );
+}
+
+
+template <class FUNC>
+int POLY_GRID_INDEX::minDistance( const VECTOR2I& aMin, const VECTOR2I& aMax,
+                                  FUNC aDistance ) const
+{
+    int best = std::numeric_limits<int>::max();
+
+    if( m_cellEdges.empty() )
+        return best;
+
+    // Look in a box around the query, enlarged until it holds an edge closer than its
+    // margin: the edges outside of the box can only be farther.  The first box reaches one
+    // cell into the grid, however far the query is from it, and the last one covers the
+    // whole grid.
+    int64_t cellSize = std::max( m_bbox.GetWidth() / m_cols, m_bbox.GetHeight() / m_rows ) + 1;
+    int64_t gap = std::max( { (int64_t) 0,
+                              (int64_t) m_bbox.GetX() - aMax.x,
+                              (int64_t) aMin.x - m_bbox.GetRight(),
+                              (int64_t) m_bbox.GetY() - aMax.y,
+                              (int64_t) aMin.y - m_bbox.GetBottom() } );
+    int64_t maxMargin = std::max( { (int64_t) 0,
+                                    (int64_t) aMin.x - m_bbox.GetX(),
+                                    (int64_t) m_bbox.GetRight() - aMax.x,
+                                    (int64_t) aMin.y - m_bbox.GetY(),
+                                    (int64_t) m_bbox.GetBottom() - aMax.y } ) + 1;
+    int64_t margin = gap + cellSize;
+
+    while( true )
+    {
+        visitEdges( aMin, aMax, std::min( margin, maxMargin ), [&]( int aEdge )
+                {
+                    best = std::min( best, aDistance( m_path.CSegment( aEdge ) ) );
+                    return best == 0;
+                } );
+
+        if( best <= margin || margin >= maxMargin )
+            return best;
+
+        margin *= 2;
+    }
+}
+
+
+int POLY_GRID_INDEX::Distance( const VECTOR2I& aP ) const
+{
+    return minDistance( aP, aP, [&]( const SEG& aEdge )
+            {
+                return aEdge.Distance( aP );
+            } );
+}
+
+
+int POLY_GRID_INDEX::Distance( const SEG& aSeg ) const
+{
+    VECTOR2I segMin( std::min( aSeg.A.x, aSeg.B.x ), std::min( aSeg.A.y, aSeg.B.y ) );
+    VECTOR2I segMax( std::max( aSeg.A.x, aSeg.B.x ), std::max( aSeg.A.y, aSeg.B.y ) );
+
+    return minDistance( segMin, segMax, [&]( const SEG& aEdge )
+            {
+                return aEdge.Distance( aSeg );
+            } );
+}
+
+
+bool POLY_GRID_INDEX::Collide( const SEG& aSeg, int aClearance ) const
+{
+    VECTOR2I segMin( std::min( aSeg.A.x, aSeg.B.x ), std::min( aSeg.A.y, aSeg.B.y ) );
+    VECTOR2I segMax( std::max( aSeg.A.x, aSeg.B.x ), std::max( aSeg.A.y, aSeg.B.y ) );
+
+    return visitEdges( segMin, segMax, std::max( 0, aClearance ), [&]( int aEdge )
+            {
+                return m_path.CSegment( aEdge ).Collide( aSeg, aClearance );
+            } );
+}
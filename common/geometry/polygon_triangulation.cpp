@@ -0,0 +1,746 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include <geometry/polygon_triangulation.h>
+
+/*
+ * The ear clipping follows the algorithm of the mapbox "earcut" library.  The
+ * coordinates are kept as integers: all the orientation tests are exact.
+ */
+
+// Below this vertex count, the Z-order index costs more than it saves
+static const int minZOrderVertexCount = 80;
+
+
+static int64_t area( const int64_t ax, const int64_t ay, const int64_t bx, const int64_t by,
+                     const int64_t cx, const int64_t cy )
+{
+    return ( by - ay ) * ( cx - bx ) - ( bx - ax ) * ( cy - by );
+}
+
+
+template <class V>
+static int64_t area( const V* p, const V* q, const V* r )
+{
+    return area( p->x, p->y, q->x, q->y, r->x, r->y );
+}
+
+
+template <class V>
+static bool equals( const V* a, const V* b )
+{
+    return a->x == b->x && a->y == b->y;
+}
+
+
+static bool pointInTriangle( int64_t ax, int64_t ay, int64_t bx, int64_t by,
+                             int64_t cx, int64_t cy, int64_t px, int64_t py )
+{
+    return ( cx - px ) * ( ay - py ) - ( ax - px ) * ( cy - py ) >= 0
+        && ( ax - px ) * ( by - py ) - ( bx - px ) * ( ay - py ) >= 0
+        && ( bx - px ) * ( cy - py ) - ( cx - px ) * ( by - py ) >= 0;
+}
+
+
+static int sign( int64_t aValue )
+{
+    return ( aValue > 0 ) - ( aValue < 0 );
+}
+
+
+template <class V>
+static bool onSegment( const V* p, const V* q, const V* r )
+{
+    return q->x <= std::max( p->x, r->x ) && q->x >= std::min( p->x, r->x )
+        && q->y <= std::max( p->y, r->y ) && q->y >= std::min( p->y, r->y );
+}
+
+
+template <class V>
+static bool intersects( const V* p1, const V* q1, const V* p2, const V* q2 )
+{
+    int o1 = sign( area( p1, q1, p2 ) );
+    int o2 = sign( area( p1, q1, q2 ) );
+    int o3 = sign( area( p2, q2, p1 ) );
+    int o4 = sign( area( p2, q2, q1 ) );
+
+    if( o1 != o2 && o3 != o4 )
+        return true;
+
+    return ( o1 == 0 && onSegment( p1, p2, q1 ) ) || ( o2 == 0 && onSegment( p1, q2, q1 ) )
+        || ( o3 == 0 && onSegment( p2, p1, q2 ) ) || ( o4 == 0 && onSegment( p2, q1, q2 ) );
+}
+
+
+bool POLYGON_TRIANGULATION::TesselatePolygon( const SHAPE_POLY_SET::POLYGON& aPoly )
+{
+    m_vertices.clear();
+    m_triangles.clear();
+
+    int vertexCount = 0;
+
+    for( const SHAPE_LINE_CHAIN& path : aPoly )
+        vertexCount += path.PointCount();
+
+    m_result.AllocateVertices( vertexCount );
+
+    for( const SHAPE_LINE_CHAIN& path : aPoly )
+    {
+        for( int i = 0; i < path.PointCount(); i++ )
+            m_result.AddVertex( path.CPoint( i ) );
+    }
+
+    if( aPoly.empty() )
+    {
+        m_result.AllocateTriangles( 0 );
+        return true;
+    }
+
+    VERTEX* outline = createList( aPoly[0], 0, true );
+
+    if( !outline || outline->next == outline->prev )
+    {
+        m_result.AllocateTriangles( 0 );
+        return std::abs( aPoly[0].Area() ) == 0.0;
+    }
+
+    m_bbox = aPoly[0].BBox();
+
+    if( aPoly.size() > 1 )
+        outline = eliminateHoles( aPoly, outline );
+
+    if( vertexCount > minZOrderVertexCount )
+    {
+        int size = std::max( m_bbox.GetWidth(), m_bbox.GetHeight() );
+        m_zScale = size > 0 ? 32767.0 / size : 0.0;
+    }
+
+    earcutList( outline );
+
+    m_result.AllocateTriangles( m_triangles.size() );
+
+    for( size_t i = 0; i < m_triangles.size(); i++ )
+        m_result.SetTriangle( i, m_triangles[i] );
+
+    // The triangles of a correct triangulation cover the polygon exactly.  On degenerate
+    // input, some parts are skipped or covered twice.
+    double polygonArea = std::abs( aPoly[0].Area() );
+
+    for( size_t i = 1; i < aPoly.size(); i++ )
+        polygonArea -= std::abs( aPoly[i].Area() );
+
+    double trianglesArea = 0.0;
+
+    for( size_t i = 0; i < m_triangles.size(); i++ )
+    {
+        VECTOR2I a, b, c;
+
+        m_result.GetTriangle( i, a, b, c );
+        trianglesArea += std::abs( (double) area( a.x, a.y, b.x, b.y, c.x, c.y ) ) / 2.0;
+    }
+
+    return std::abs( trianglesArea - polygonArea ) <= 1e-9 * std::abs( polygonArea ) + 1.0;
+}
+
+
+POLYGON_TRIANGULATION::VERTEX* POLYGON_TRIANGULATION::insertVertex( int aIndex,
+        const VECTOR2I& aPt, VERTEX* aLast )
+{
+    m_vertices.emplace_back( aIndex, aPt.x, aPt.y );
+
+    VERTEX* p = &m_vertices.back();
+
+    if( !aLast )
+    {
+        p->prev = p;
+        p->next = p;
+    }
+    else
+    {
+        p->next = aLast->next;
+        p->prev = aLast;
+        aLast->next->prev = p;
+        aLast->next = p;
+    }
+
+    return p;
+}
+
+
+void POLYGON_TRIANGULATION::removeVertex( VERTEX* aVertex )
+{
+    aVertex->next->prev = aVertex->prev;
+    aVertex->prev->next = aVertex->next;
+
+    if( aVertex->prevZ )
+        aVertex->prevZ->nextZ = aVertex->nextZ;
+
+    if( aVertex->nextZ )
+        aVertex->nextZ->prevZ = aVertex->prevZ;
+}
+
+
+POLYGON_TRIANGULATION::VERTEX* POLYGON_TRIANGULATION::createList(
+        const SHAPE_LINE_CHAIN& aPoints, int aFirstIndex, bool aOutline )
+{
+    VERTEX* last = nullptr;
+    int     count = aPoints.PointCount();
+
+    // The outlines are linked in the order of a positive Area(), the holes in the
+    // opposite order
+    if( aOutline == ( aPoints.Area() > 0.0 ) )
+    {
+        for( int i = 0; i < count; i++ )
+            last = insertVertex( aFirstIndex + i, aPoints.CPoint( i ), last );
+    }
+    else
+    {
+        for( int i = count - 1; i >= 0; i-- )
+            last = insertVertex( aFirstIndex + i, aPoints.CPoint( i ), last );
+    }
+
+    if( last && equals( last, last->next ) )
+    {
+        removeVertex( last );
+        last = last->next;
+    }
+
+    return last;
+}
+
+
+POLYGON_TRIANGULATION::VERTEX* POLYGON_TRIANGULATION::removeNullTriangles( VERTEX* aStart,
+        VERTEX* aEnd )
+{
+    if( !aStart )
+        return aStart;
+
+    if( !aEnd )
+        aEnd = aStart;
+
+    VERTEX* p = aStart;
+    bool    again;
+
+    do
+    {
+        again = false;
+
+        if( !p->steiner && ( equals( p, p->next ) || area( p->prev, p, p->next ) == 0 ) )
+        {
+            removeVertex( p );
+            p = aEnd = p->prev;
+
+            if( p == p->next )
+                break;
+
+            again = true;
+        }
+        else
+        {
+            p = p->next;
+        }
+    } while( again || p != aEnd );
+
+    return aEnd;
+}
+
+
+POLYGON_TRIANGULATION::VERTEX* POLYGON_TRIANGULATION::eliminateHoles(
+        const SHAPE_POLY_SET::POLYGON& aPoly, VERTEX* aOutline )
+{
+    std::vector<VERTEX*> holes;
+    int                  firstIndex = aPoly[0].PointCount();
+
+    for( size_t ii = 1; ii < aPoly.size(); ii++ )
+    {
+        VERTEX* list = createList( aPoly[ii], firstIndex, false );
+
+        firstIndex += aPoly[ii].PointCount();
+
+        if( !list )
+            continue;
+
+        if( list == list->next )
+            list->steiner = true;
+
+        // Bridge the holes from their leftmost vertex
+        VERTEX* leftmost = list;
+        VERTEX* p = list;
+
+        do
+        {
+            if( p->x < leftmost->x || ( p->x == leftmost->x && p->y < leftmost->y ) )
+                leftmost = p;
+
+            p = p->next;
+        } while( p != list );
+
+        holes.push_back( leftmost );
+    }
+
+    std::sort( holes.begin(), holes.end(),
+               []( const VERTEX* a, const VERTEX* b ) { return a->x < b->x; } );
+
+    for( VERTEX* hole : holes )
+    {
+        VERTEX* bridge = findHoleBridge( hole, aOutline );
+
+        if( bridge )
+        {
+            VERTEX* b = splitAt( bridge, hole );
+
+            removeNullTriangles( b, b->next );
+        }
+
+        aOutline = removeNullTriangles( aOutline, aOutline->next );
+    }
+
+    return aOutline;
+}
+
+
+POLYGON_TRIANGULATION::VERTEX* POLYGON_TRIANGULATION::findHoleBridge( VERTEX* aHole,
+        VERTEX* aOutline ) const
+{
+    VERTEX* p = aOutline;
+    int64_t hx = aHole->x;
+    int64_t hy = aHole->y;
+    double  qx = -INFINITY;
+    VERTEX* m = nullptr;
+
+    // Find the segment of the outline which is left of the hole point and intersects
+    // the horizontal ray going left from it
+    do
+    {
+        if( hy <= p->y && hy >= p->next->y && p->next->y != p->y )
+        {
+            double x = p->x + (double) ( hy - p->y ) * ( p->next->x - p->x )
+                              / ( p->next->y - p->y );
+
+            if( x <= hx && x > qx )
+            {
+                qx = x;
+
+                if( x == hx )
+                {
+                    if( hy == p->y )
+                        return p;
+
+                    if( hy == p->next->y )
+                        return p->next;
+                }
+
+                m = p->x < p->next->x ? p : p->next;
+            }
+        }
+
+        p = p->next;
+    } while( p != aOutline );
+
+    if( !m )
+        return nullptr;
+
+    if( hx == qx )
+        return m;
+
+    // Look for the points inside the triangle of the hole point, the segment intersection
+    // and its endpoint: if there are none, the endpoint is the bridge, otherwise the
+    // bridge is the point with the minimum angle with the ray
+    VERTEX* stop = m;
+    int64_t mx = m->x;
+    int64_t my = m->y;
+    int64_t iqx = (int64_t) std::floor( qx );
+    double  tanMin = INFINITY;
+
+    p = m;
+
+    do
+    {
+        if( hx >= p->x && p->x >= mx && hx != p->x
+                && pointInTriangle( hy < my ? hx : iqx, hy, mx, my, hy < my ? iqx : hx, hy,
+                                    p->x, p->y ) )
+        {
+            double tan = std::abs( (double) ( hy - p->y ) ) / ( hx - p->x );
+
+            if( locallyInside( p, aHole )
+                    && ( tan < tanMin || ( tan == tanMin && p->x > m->x ) ) )
+            {
+                m = p;
+                tanMin = tan;
+            }
+        }
+
+        p = p->next;
+    } while( p != stop );
+
+    return m;
+}
+
+
+void POLYGON_TRIANGULATION::earcutList( VERTEX* aEar, int aPass )
+{
+    if( !aEar )
+        return;
+
+    if( !aPass && m_zScale > 0.0 )
+        zOrderSort( aEar );
+
+    VERTEX* stop = aEar;
+
+    while( aEar->prev != aEar->next )
+    {
+        VERTEX* prev = aEar->prev;
+        VERTEX* next = aEar->next;
+
+        if( isEar( aEar ) )
+        {
+            addTriangle( prev, aEar, next );
+            removeVertex( aEar );
+
+            // Skipping the next vertex leads to less sliver triangles
+            aEar = next->next;
+            stop = next->next;
+            continue;
+        }
+
+        aEar = next;
+
+        // No ear found in a whole loop
+        if( aEar == stop )
+        {
+            if( aPass == 0 )
+            {
+                // Remove the degenerate vertices and try again
+                earcutList( removeNullTriangles( aEar ), 1 );
+            }
+            else if( aPass == 1 )
+            {
+                // Clip the small self-intersections and try again
+                aEar = cureLocalIntersections( removeNullTriangles( aEar ) );
+                earcutList( aEar, 2 );
+            }
+            else
+            {
+                // Split the polygon in two along a diagonal, and handle each half
+                splitPolygon( aEar );
+            }
+
+            break;
+        }
+    }
+}
+
+
+bool POLYGON_TRIANGULATION::isEar( VERTEX* aEar ) const
+{
+    const VERTEX* a = aEar->prev;
+    const VERTEX* b = aEar;
+    const VERTEX* c = aEar->next;
+
+    // A reflex vertex is not an ear
+    if( area( a, b, c ) >= 0 )
+        return false;
+
+    auto blocks = [&]( const VERTEX* p )
+    {
+        return p != a && p != c
+            && pointInTriangle( a->x, a->y, b->x, b->y, c->x, c->y, p->x, p->y )
+            && area( p->prev, p, p->next ) >= 0;
+    };
+
+    if( m_zScale == 0.0 )
+    {
+        for( const VERTEX* p = c->next; p != a; p = p->next )
+        {
+            if( blocks( p ) )
+                return false;
+        }
+
+        return true;
+    }
+
+    // Only the vertices in the Z-order range of the triangle box can be inside it
+    uint32_t minZ = zOrder( std::min( { a->x, b->x, c->x } ), std::min( { a->y, b->y, c->y } ) );
+    uint32_t maxZ = zOrder( std::max( { a->x, b->x, c->x } ), std::max( { a->y, b->y, c->y } ) );
+
+    const VERTEX* p = aEar->prevZ;
+    const VERTEX* n = aEar->nextZ;
+
+    while( p && p->z >= minZ && n && n->z <= maxZ )
+    {
+        if( blocks( p ) || blocks( n ) )
+            return false;
+
+        p = p->prevZ;
+        n = n->nextZ;
+    }
+
+    for( ; p && p->z >= minZ; p = p->prevZ )
+    {
+        if( blocks( p ) )
+            return false;
+    }
+
+    for( ; n && n->z <= maxZ; n = n->nextZ )
+    {
+        if( blocks( n ) )
+            return false;
+    }
+
+    return true;
+}
+
+
+POLYGON_TRIANGULATION::VERTEX* POLYGON_TRIANGULATION::cureLocalIntersections( VERTEX* aStart )
+{
+    VERTEX* p = aStart;
+
+    do
+    {
+        VERTEX* a = p->prev;
+        VERTEX* b = p->next->next;
+
+        if( !equals( a, b ) && intersects( a, p, p->next, b ) && locallyInside( a, b )
+                && locallyInside( b, a ) )
+        {
+            addTriangle( a, p, b );
+            removeVertex( p );
+            removeVertex( p->next );
+
+            p = aStart = b;
+        }
+
+        p = p->next;
+    } while( p != aStart );
+
+    return removeNullTriangles( p );
+}
+
+
+void POLYGON_TRIANGULATION::splitPolygon( VERTEX* aStart )
+{
+    VERTEX* a = aStart;
+
+    do
+    {
+        for( VERTEX* b = a->next->next; b != a->prev; b = b->next )
+        {
+            if( a->i != b->i && goodSplit( a, b ) )
+            {
+                VERTEX* c = splitAt( a, b );
+
+                a = removeNullTriangles( a, a->next );
+                c = removeNullTriangles( c, c->next );
+
+                earcutList( a );
+                earcutList( c );
+                return;
+            }
+        }
+
+        a = a->next;
+    } while( a != aStart );
+}
+
+
+POLYGON_TRIANGULATION::VERTEX* POLYGON_TRIANGULATION::splitAt( VERTEX* a, VERTEX* b )
+{
+    // Duplicate a and b, and link them so a -> b and b2 -> a2 become two polygons
+    m_vertices.emplace_back( a->i, a->x, a->y );
+    VERTEX* a2 = &m_vertices.back();
+
+    m_vertices.emplace_back( b->i, b->x, b->y );
+    VERTEX* b2 = &m_vertices.back();
+
+    VERTEX* an = a->next;
+    VERTEX* bp = b->prev;
+
+    a->next = b;
+    b->prev = a;
+
+    a2->next = an;
+    an->prev = a2;
+
+    b2->next = a2;
+    a2->prev = b2;
+
+    bp->next = b2;
+    b2->prev = bp;
+
+    return b2;
+}
+
+
+bool POLYGON_TRIANGULATION::goodSplit( const VERTEX* a, const VERTEX* b ) const
+{
+    return a->next->i != b->i && a->prev->i != b->i && !intersectsPolygon( a, b )
+        && locallyInside( a, b ) && locallyInside( b, a ) && middleInside( a, b );
+}
+
+
+bool POLYGON_TRIANGULATION::intersectsPolygon( const VERTEX* a, const VERTEX* b ) const
+{
+    const VERTEX* p = a;
+
+    do
+    {
+        if( p->i != a->i && p->next->i != a->i && p->i != b->i && p->next->i != b->i
+                && intersects( p, p->next, a, b ) )
+            return true;
+
+        p = p->next;
+    } while( p != a );
+
+    return false;
+}
+
+
+bool POLYGON_TRIANGULATION::locallyInside( const VERTEX* a, const VERTEX* b ) const
+{
+    if( area( a->prev, a, a->next ) < 0 )
+        return area( a, b, a->next ) >= 0 && area( a, a->prev, b ) >= 0;
+    else
+        return area( a, b, a->prev ) < 0 || area( a, a->next, b ) < 0;
+}
+
+
+bool POLYGON_TRIANGULATION::middleInside( const VERTEX* a, const VERTEX* b ) const
+{
+    const VERTEX* p = a;
+    bool          inside = false;
+    double        px = ( a->x + b->x ) / 2.0;
+    double        py = ( a->y + b->y ) / 2.0;
+
+    do
+    {
+        if( ( ( p->y > py ) != ( p->next->y > py ) ) && p->next->y != p->y
+                && px < (double) ( p->next->x - p->x ) * ( py - p->y ) / ( p->next->y - p->y )
+                        + p->x )
+            inside = !inside;
+
+        p = p->next;
+    } while( p != a );
+
+    return inside;
+}
+
+
+uint32_t POLYGON_TRIANGULATION::zOrder( int64_t aX, int64_t aY ) const
+{
+    uint32_t x = (uint32_t) ( ( aX - m_bbox.GetX() ) * m_zScale );
+    uint32_t y = (uint32_t) ( ( aY - m_bbox.GetY() ) * m_zScale );
+
+    x = ( x | ( x << 8 ) ) & 0x00FF00FF;
+    x = ( x | ( x << 4 ) ) & 0x0F0F0F0F;
+    x = ( x | ( x << 2 ) ) & 0x33333333;
+    x = ( x | ( x << 1 ) ) & 0x55555555;
+
+    y = ( y | ( y << 8 ) ) & 0x00FF00FF;
+    y = ( y | ( y << 4 ) ) & 0x0F0F0F0F;
+    y = ( y | ( y << 2 ) ) & 0x33333333;
+    y = ( y | ( y << 1 ) ) & 0x55555555;
+
+    return x | ( y << 1 );
+}
+
+
+void POLYGON_TRIANGULATION::zOrderSort( VERTEX* aStart )
+{
+    VERTEX* p = aStart;
+
+    do
+    {
+        p->z = zOrder( p->x, p->y );
+        p->prevZ = p->prev;
+        p->nextZ = p->next;
+        p = p->next;
+    } while( p != aStart );
+
+    p->prevZ->nextZ = nullptr;
+    p->prevZ = nullptr;
+
+    // Bottom-up merge sort of the Z list
+    VERTEX* list = p;
+    int     inSize = 1;
+    int     merges;
+
+    do
+    {
+        p = list;
+        list = nullptr;
+
+        VERTEX* tail = nullptr;
+
+        merges = 0;
+
+        while( p )
+        {
+            merges++;
+
+            VERTEX* q = p;
+            int     pSize = 0;
+
+            for( int i = 0; i < inSize && q; i++ )
+            {
+                pSize++;
+                q = q->nextZ;
+            }
+
+            int qSize = inSize;
+
+            while( pSize > 0 || ( qSize > 0 && q ) )
+            {
+                VERTEX* e;
+
+                if( pSize != 0 && ( qSize == 0 || !q || p->z <= q->z ) )
+                {
+                    e = p;
+                    p = p->nextZ;
+                    pSize--;
+                }
+                else
+                {
+                    e = q;
+                    q = q->nextZ;
+                    qSize--;
+                }
+
+                if( tail )
+                    tail->nextZ = e;
+                else
+                    list = e;
+
+                e->prevZ = tail;
+                tail = e;
+            }
+
+            p = q;
+        }
+
+        tail->nextZ = nullptr;
+        inSize *= 2;
+    } while( merges > 1 );
+}
@@ -48,9 +48,12 @@ bool SEG::PointCloserThan( const VECTOR2I& aP, int aDist ) const
 
     if( ( dxdy >= -1 && dxdy <= 1 ) || abs( d.x ) <= 1 || abs( d.y ) <= 1 )
     {
-        int ca = -sgn( d.y );
-        int cb = sgn( d.x );
-        int cc = -ca * A.x - cb * A.y;
+        // Diagonal, vertical or horizontal line: a nearly vertical segment must not be
+        // taken for a diagonal one because its d.x is 1
+        bool   diagonal = ( dxdy >= -1 && dxdy <= 1 );
+        int    ca = ( diagonal || abs( d.x ) <= 1 ) ? -sgn( d.y ) : 0;
+        int    cb = ( diagonal || abs( d.y ) <= 1 ) ? sgn( d.x ) : 0;
+        ecoord cc = -(ecoord) ca * A.x - (ecoord) cb * A.y;
 
         ecoord num = (ecoord) ca * aP.x + (ecoord) cb * aP.y + cc;
         num *= num;
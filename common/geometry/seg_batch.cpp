@@ -0,0 +1,465 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include <geometry/seg_batch.h>
+#include <geometry/shape_line_chain.h>
+
+#if defined( __SSE2__ ) || defined( _M_X64 )
+#include <emmintrin.h>
+#define SEG_BATCH_SSE2
+#endif
+
+#if ( defined( __GNUC__ ) || defined( __clang__ ) ) && ( defined( __x86_64__ ) || defined( __i386__ ) )
+#include <immintrin.h>
+#define SEG_BATCH_AVX2
+#endif
+
+
+// Margin between the estimated distances and the distances computed by SEG, which round
+// the nearest points to integer coordinates and take a few shortcuts
+static const double ESTIMATE_MARGIN = 16.0;
+
+// Number of segments estimated at once by the early exit tests
+static const int BLOCK_SIZE = 256;
+
+
+/**
+ * The segment tested against the batch: start point, direction and inverse squared length
+ */
+struct QUERY
+{
+    QUERY( const SEG& aSeg )
+    {
+        double len = (double) ( aSeg.B - aSeg.A ).SquaredEuclideanNorm();
+
+        px = aSeg.A.x;
+        py = aSeg.A.y;
+        ex = (double) aSeg.B.x - aSeg.A.x;
+        ey = (double) aSeg.B.y - aSeg.A.y;
+        invLen = len > 0.0 ? 1.0 / len : 0.0;
+    }
+
+    double px, py, ex, ey, invLen;
+};
+
+
+typedef void (*ESTIMATE_KERNEL)( const double* aAx, const double* aAy, const double* aDx,
+                                 const double* aDy, const double* aInvLen, int aCount,
+                                 const QUERY& aQuery, double* aResult );
+
+
+static inline double pointSegmentDistance( double aPx, double aPy, double aAx, double aAy,
+                                           double aDx, double aDy, double aInvLen )
+{
+    double t = ( ( aPx - aAx ) * aDx + ( aPy - aAy ) * aDy ) * aInvLen;
+
+    t = std::min( 1.0, std::max( 0.0, t ) );
+
+    double ex = aAx + t * aDx - aPx;
+    double ey = aAy + t * aDy - aPy;
+
+    return ex * ex + ey * ey;
+}
+
+
+/**
+ * Estimates the squared distances between the query and the segments: zero if they cross,
+ * the smallest distance between an end point and the other segment otherwise.
+ */
+static void estimateScalar( const double* aAx, const double* aAy, const double* aDx,
+                            const double* aDy, const double* aInvLen, int aCount,
+                            const QUERY& q, double* aResult )
+{
+    double qx = q.px + q.ex;
+    double qy = q.py + q.ey;
+
+    for( int i = 0; i < aCount; i++ )
+    {
+        double ax = aAx[i], ay = aAy[i], dx = aDx[i], dy = aDy[i];
+        double bx = ax + dx, by = ay + dy;
+
+        double o1 = q.ex * ( ay - q.py ) - q.ey * ( ax - q.px );
+        double o2 = q.ex * ( by - q.py ) - q.ey * ( bx - q.px );
+        double o3 = dx * ( q.py - ay ) - dy * ( q.px - ax );
+        double o4 = dx * ( qy - ay ) - dy * ( qx - ax );
+
+        if( o1 * o2 <= 0.0 && o3 * o4 <= 0.0 )
+        {
+            aResult[i] = 0.0;
+            continue;
+        }
+
+        double d = pointSegmentDistance( q.px, q.py, ax, ay, dx, dy, aInvLen[i] );
+
+        d = std::min( d, pointSegmentDistance( qx, qy, ax, ay, dx, dy, aInvLen[i] ) );
+        d = std::min( d, pointSegmentDistance( ax, ay, q.px, q.py, q.ex, q.ey, q.invLen ) );
+        d = std::min( d, pointSegmentDistance( bx, by, q.px, q.py, q.ex, q.ey, q.invLen ) );
+
+        aResult[i] = d;
+    }
+}
+
+
+#ifdef SEG_BATCH_SSE2
+
+static inline __m128d pointSegmentDistanceSSE2( __m128d aPx, __m128d aPy, __m128d aAx,
+                                                __m128d aAy, __m128d aDx, __m128d aDy,
+                                                __m128d aInvLen )
+{
+    __m128d t = _mm_mul_pd( _mm_add_pd( _mm_mul_pd( _mm_sub_pd( aPx, aAx ), aDx ),
+                                        _mm_mul_pd( _mm_sub_pd( aPy, aAy ), aDy ) ), aInvLen );
+
+    t = _mm_min_pd( _mm_set1_pd( 1.0 ), _mm_max_pd( _mm_setzero_pd(), t ) );
+
+    __m128d ex = _mm_sub_pd( _mm_add_pd( aAx, _mm_mul_pd( t, aDx ) ), aPx );
+    __m128d ey = _mm_sub_pd( _mm_add_pd( aAy, _mm_mul_pd( t, aDy ) ), aPy );
+
+    return _mm_add_pd( _mm_mul_pd( ex, ex ), _mm_mul_pd( ey, ey ) );
+}
+
+
+static void estimateSSE2( const double* aAx, const double* aAy, const double* aDx,
+                          const double* aDy, const double* aInvLen, int aCount,
+                          const QUERY& q, double* aResult )
+{
+    const __m128d px = _mm_set1_pd( q.px ), py = _mm_set1_pd( q.py );
+    const __m128d ex = _mm_set1_pd( q.ex ), ey = _mm_set1_pd( q.ey );
+    const __m128d qx = _mm_set1_pd( q.px + q.ex ), qy = _mm_set1_pd( q.py + q.ey );
+    const __m128d qInvLen = _mm_set1_pd( q.invLen );
+    const __m128d zero = _mm_setzero_pd();
+
+    int i = 0;
+
+    for( ; i + 2 <= aCount; i += 2 )
+    {
+        __m128d ax = _mm_loadu_pd( aAx + i ), ay = _mm_loadu_pd( aAy + i );
+        __m128d dx = _mm_loadu_pd( aDx + i ), dy = _mm_loadu_pd( aDy + i );
+        __m128d invLen = _mm_loadu_pd( aInvLen + i );
+        __m128d bx = _mm_add_pd( ax, dx ), by = _mm_add_pd( ay, dy );
+
+        __m128d o1 = _mm_sub_pd( _mm_mul_pd( ex, _mm_sub_pd( ay, py ) ),
+                                 _mm_mul_pd( ey, _mm_sub_pd( ax, px ) ) );
+        __m128d o2 = _mm_sub_pd( _mm_mul_pd( ex, _mm_sub_pd( by, py ) ),
+                                 _mm_mul_pd( ey, _mm_sub_pd( bx, px ) ) );
+        __m128d o3 = _mm_sub_pd( _mm_mul_pd( dx, _mm_sub_pd( py, ay ) ),
+                                 _mm_mul_pd( dy, _mm_sub_pd( px, ax ) ) );
+        __m128d o4 = _mm_sub_pd( _mm_mul_pd( dx, _mm_sub_pd( qy, ay ) ),
+                                 _mm_mul_pd( dy, _mm_sub_pd( qx, ax ) ) );
+        __m128d cross = _mm_and_pd( _mm_cmple_pd( _mm_mul_pd( o1, o2 ), zero ),
+                                    _mm_cmple_pd( _mm_mul_pd( o3, o4 ), zero ) );
+
+        __m128d d = pointSegmentDistanceSSE2( px, py, ax, ay, dx, dy, invLen );
+
+        d = _mm_min_pd( d, pointSegmentDistanceSSE2( qx, qy, ax, ay, dx, dy, invLen ) );
+        d = _mm_min_pd( d, pointSegmentDistanceSSE2( ax, ay, px, py, ex, ey, qInvLen ) );
+        d = _mm_min_pd( d, pointSegmentDistanceSSE2( bx, by, px, py, ex, ey, qInvLen ) );
+
+        _mm_storeu_pd( aResult + i, _mm_andnot_pd( cross, d ) );
+    }
+
+    if( i < aCount )
+        estimateScalar( aAx + i, aAy + i, aDx + i, aDy + i, aInvLen + i, aCount - i, q,
+                        aResult + i );
+}
+
+#endif
+
+
+#ifdef SEG_BATCH_AVX2
+
+__attribute__(( target( "avx2" ) ))
+static inline __m256d pointSegmentDistanceAVX2( __m256d aPx, __m256d aPy, __m256d aAx,
+                                                __m256d aAy, __m256d aDx, __m256d aDy,
+                                                __m256d aInvLen )
+{
+    __m256d t = _mm256_mul_pd( _mm256_add_pd( _mm256_mul_pd( _mm256_sub_pd( aPx, aAx ), aDx ),
+                                              _mm256_mul_pd( _mm256_sub_pd( aPy, aAy ), aDy ) ),
+                               aInvLen );
+
+    t = _mm256_min_pd( _mm256_set1_pd( 1.0 ), _mm256_max_pd( _mm256_setzero_pd(), t ) );
+
+    __m256d ex = _mm256_sub_pd( _mm256_add_pd( aAx, _mm256_mul_pd( t, aDx ) ), aPx );
+    __m256d ey = _mm256_sub_pd( _mm256_add_pd( aAy, _mm256_mul_pd( t, aDy ) ), aPy );
+
+    return _mm256_add_pd( _mm256_mul_pd( ex, ex ), _mm256_mul_pd( ey, ey ) );
+}
+
+
+__attribute__(( target( "avx2" ) ))
+static void estimateAVX2( const double* aAx, const double* aAy, const double* aDx,
+                          const double* aDy, const double* aInvLen, int aCount,
+                          const QUERY& q, double* aResult )
+{
+    const __m256d px = _mm256_set1_pd( q.px ), py = _mm256_set1_pd( q.py );
+    const __m256d ex = _mm256_set1_pd( q.ex ), ey = _mm256_set1_pd( q.ey );
+    const __m256d qx = _mm256_set1_pd( q.px + q.ex ), qy = _mm256_set1_pd( q.py + q.ey );
+    const __m256d qInvLen = _mm256_set1_pd( q.invLen );
+    const __m256d zero = _mm256_setzero_pd();
+
+    int i = 0;
+
+    for( ; i + 4 <= aCount; i += 4 )
+    {
+        __m256d ax = _mm256_loadu_pd( aAx + i ), ay = _mm256_loadu_pd( aAy + i );
+        __m256d dx = _mm256_loadu_pd( aDx + i ), dy = _mm256_loadu_pd( aDy + i );
+        __m256d invLen = _mm256_loadu_pd( aInvLen + i );
+        __m256d bx = _mm256_add_pd( ax, dx ), by = _mm256_add_pd( ay, dy );
+
+        __m256d o1 = _mm256_sub_pd( _mm256_mul_pd( ex, _mm256_sub_pd( ay, py ) ),
+                                    _mm256_mul_pd( ey, _mm256_sub_pd( ax, px ) ) );
+        __m256d o2 = _mm256_sub_pd( _mm256_mul_pd( ex, _mm256_sub_pd( by, py ) ),
+                                    _mm256_mul_pd( ey, _mm256_sub_pd( bx, px ) ) );
+        __m256d o3 = _mm256_sub_pd( _mm256_mul_pd( dx, _mm256_sub_pd( py, ay ) ),
+                                    _mm256_mul_pd( dy, _mm256_sub_pd( px, ax ) ) );
+        __m256d o4 = _mm256_sub_pd( _mm256_mul_pd( dx, _mm256_sub_pd( qy, ay ) ),
+                                    _mm256_mul_pd( dy, _mm256_sub_pd( qx, ax ) ) );
+        __m256d cross = _mm256_and_pd(
+                _mm256_cmp_pd( _mm256_mul_pd( o1, o2 ), zero, _CMP_LE_OQ ),
+                _mm256_cmp_pd( _mm256_mul_pd( o3, o4 ), zero, _CMP_LE_OQ ) );
+
+        __m256d d = pointSegmentDistanceAVX2( px, py, ax, ay, dx, dy, invLen );
+
+        d = _mm256_min_pd( d, pointSegmentDistanceAVX2( qx, qy, ax, ay, dx, dy, invLen ) );
+        d = _mm256_min_pd( d, pointSegmentDistanceAVX2( ax, ay, px, py, ex, ey, qInvLen ) );
+        d = _mm256_min_pd( d, pointSegmentDistanceAVX2( bx, by, px, py, ex, ey, qInvLen ) );
+
+        _mm256_storeu_pd( aResult + i, _mm256_andnot_pd( cross, d ) );
+    }
+
+    if( i < aCount )
+        estimateScalar( aAx + i, aAy + i, aDx + i, aDy + i, aInvLen + i, aCount - i, q,
+                        aResult + i );
+}
+
+#endif
+
+
+struct KERNEL_INFO
+{
+    ESTIMATE_KERNEL m_func;
+    const char*     m_name;
+};
+
+
+static const KERNEL_INFO& estimateKernel()
+{
+    static const KERNEL_INFO kernel = []() -> KERNEL_INFO
+    {
+#ifdef SEG_BATCH_AVX2
+        if( __builtin_cpu_supports( "avx2" ) )
+            return { estimateAVX2, "AVX2" };
+#endif
+
+#ifdef SEG_BATCH_SSE2
+        return { estimateSSE2, "SSE2" };
+#else
+        return { estimateScalar, "scalar" };
+#endif
+    }();
+
+    return kernel;
+}
+
+
+const char* SEG_BATCH::KernelName()
+{
+    return estimateKernel().m_name;
+}
+
+
+SEG_BATCH::SEG_BATCH( const SHAPE_LINE_CHAIN& aChain )
+{
+    for( int i = 0; i < aChain.SegmentCount(); i++ )
+        Add( aChain.CSegment( i ) );
+}
+
+
+void SEG_BATCH::Add( const SEG& aSeg )
+{
+    double len = (double) ( aSeg.B - aSeg.A ).SquaredEuclideanNorm();
+
+    m_segs.push_back( aSeg );
+    m_ax.push_back( aSeg.A.x );
+    m_ay.push_back( aSeg.A.y );
+    m_dx.push_back( (double) aSeg.B.x - aSeg.A.x );
+    m_dy.push_back( (double) aSeg.B.y - aSeg.A.y );
+    m_invLen.push_back( len > 0.0 ? 1.0 / len : 0.0 );
+}
+
+
+void SEG_BATCH::Clear()
+{
+    m_segs.clear();
+    m_ax.clear();
+    m_ay.clear();
+    m_dx.clear();
+    m_dy.clear();
+    m_invLen.clear();
+}
+
+
+void SEG_BATCH::estimate( const SEG& aSeg, int aFirst, int aCount, double* aResult ) const
+{
+    estimateKernel().m_func( &m_ax[aFirst], &m_ay[aFirst], &m_dx[aFirst], &m_dy[aFirst],
+                             &m_invLen[aFirst], aCount, QUERY( aSeg ), aResult );
+}
+
+
+bool SEG_BATCH::Collide( const SEG& aSeg, int aClearance, std::vector<uint8_t>* aHitMask ) const
+{
+    double limit = std::max( 0, aClearance ) + ESTIMATE_MARGIN;
+    double estimates[BLOCK_SIZE];
+    bool   collision = false;
+
+    if( aHitMask )
+        aHitMask->assign( m_segs.size(), 0 );
+
+    for( int first = 0; first < Size(); first += BLOCK_SIZE )
+    {
+        int count = std::min( BLOCK_SIZE, Size() - first );
+
+        estimate( aSeg, first, count, estimates );
+
+        for( int i = 0; i < count; i++ )
+        {
+            if( estimates[i] > limit * limit || !m_segs[first + i].Collide( aSeg, aClearance ) )
+                continue;
+
+            if( !aHitMask )
+                return true;
+
+            ( *aHitMask )[first + i] = 1;
+            collision = true;
+        }
+    }
+
+    return collision;
+}
+
+
+void SEG_BATCH::Candidates( const SEG& aSeg, int aDistance, std::vector<int>& aIndices ) const
+{
+    double limit = std::max( 0, aDistance ) + ESTIMATE_MARGIN;
+    double estimates[BLOCK_SIZE];
+
+    aIndices.clear();
+
+    for( int first = 0; first < Size(); first += BLOCK_SIZE )
+    {
+        int count = std::min( BLOCK_SIZE, Size() - first );
+
+        estimate( aSeg, first, count, estimates );
+
+        for( int i = 0; i < count; i++ )
+        {
+            if( estimates[i] <= limit * limit )
+                aIndices.push_back( first + i );
+        }
+    }
+}
+
+
+/**
+ * Returns the smallest of aExact( i ), evaluated only on the segments whose estimated
+ * distance is close enough to the smallest one
+ */
+template <class EXACT>
+static SEG_BATCH::ecoord minSquaredDistance( const std::vector<double>& aEstimates, EXACT aExact,
+                                       int* aIndex )
+{
+    SEG_BATCH::ecoord best = VECTOR2I::ECOORD_MAX;
+    int         bestIndex = -1;
+
+    if( !aEstimates.empty() )
+    {
+        double minEstimate = *std::min_element( aEstimates.begin(), aEstimates.end() );
+        double tested = -1.0;
+        double limit = std::sqrt( minEstimate ) + ESTIMATE_MARGIN;
+
+        while( true )
+        {
+            double low = tested < 0.0 ? -1.0 : tested * tested;
+
+            for( size_t i = 0; i < aEstimates.size(); i++ )
+            {
+                if( aEstimates[i] <= low || aEstimates[i] > limit * limit )
+                    continue;
+
+                SEG_BATCH::ecoord d = aExact( i );
+
+                if( d < best || ( d == best && (int) i < bestIndex ) )
+                {
+                    best = d;
+                    bestIndex = i;
+                }
+            }
+
+            // The segments left are estimated farther than limit: farther than best
+            if( std::sqrt( (double) best ) + ESTIMATE_MARGIN <= limit )
+                break;
+
+            tested = limit;
+            limit = std::sqrt( (double) best ) + ESTIMATE_MARGIN;
+        }
+    }
+
+    if( aIndex )
+        *aIndex = bestIndex;
+
+    return best;
+}
+
+
+SEG_BATCH::ecoord SEG_BATCH::SquaredDistance( const SEG& aSeg, int* aIndex ) const
+{
+    thread_local std::vector<double> estimates;
+
+    estimates.resize( m_segs.size() );
+
+    if( !m_segs.empty() )
+        estimate( aSeg, 0, Size(), &estimates[0] );
+
+    return minSquaredDistance( estimates, [&]( int i )
+            {
+                return m_segs[i].SquaredDistance( aSeg );
+            }, aIndex );
+}
+
+
+SEG_BATCH::ecoord SEG_BATCH::SquaredDistance( const VECTOR2I& aP, int* aIndex ) const
+{
+    thread_local std::vector<double> estimates;
+
+    estimates.resize( m_segs.size() );
+
+    if( !m_segs.empty() )
+        estimate( SEG( aP, aP ), 0, Size(), &estimates[0] );
+
+    return minSquaredDistance( estimates, [&]( int i )
+            {
+                return m_segs[i].SquaredDistance( aP );
+            }, aIndex );
+}
@@ -25,6 +25,7 @@
 #include <math/vector2d.h>
 #include <math.h>
 
+#include <geometry/seg_batch.h>
 #include <geometry/shape.h>
 #include <geometry/shape_line_chain.h>
 #include <geometry/shape_circle.h>
@@ -220,6 +221,35 @@ static inline bool Collide( const SHAPE_CIRCLE& aA, const SHAPE_SEGMENT& aSeg, i
 static inline bool Collide( const SHAPE_LINE_CHAIN& aA, const SHAPE_LINE_CHAIN& aB, int aClearance,
                             bool aNeedMTV, VECTOR2I& aMTV )
 {
+    // Long chains: run the same test as SHAPE_LINE_CHAIN::Collide() on the segments of aA
+    // the batch finds near each segment of aB.  Without clearance nothing ever collides.
+    if( aClearance > 0 && aA.SegmentCount() >= 16
+            && (int64_t) aA.SegmentCount() * aB.SegmentCount() >= 4096 )
+    {
+        SEG_BATCH           batch( aA );
+        std::vector<int>    candidates;
+        BOX2I::ecoord_type  dist_sq = (BOX2I::ecoord_type) aClearance * aClearance;
+
+        for( int i = 0; i < aB.SegmentCount(); i++ )
+        {
+            const SEG seg = aB.CSegment( i );
+            BOX2I     box_a( seg.A, seg.B - seg.A );
+
+            batch.Candidates( seg, aClearance, candidates );
+
+            for( int j : candidates )
+            {
+                const SEG& s = batch.Segment( j );
+                BOX2I      box_b( s.A, s.B - s.A );
+
+                if( box_a.SquaredDistance( box_b ) < dist_sq && s.Collide( seg, aClearance ) )
+                    return true;
+            }
+        }
+
+        return false;
+    }
+
     for( int i = 0; i < aB.SegmentCount(); i++ )
         if( aA.Collide( aB.CSegment( i ), aClearance ) )
             return true;
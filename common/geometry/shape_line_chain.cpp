@@ -43,6 +43,8 @@ void SHAPE_LINE_CHAIN::Rotate( double aAngle, const VECTOR2I& aCenter )
         (*i) = (*i).Rotate( aAngle );
         (*i) += aCenter;
     }
+
+    m_segmentCache.reset();
 }
 
 
@@ -51,10 +53,15 @@ bool SHAPE_LINE_CHAIN::Collide( const SEG& aSeg, int aClearance ) const
     BOX2I box_a( aSeg.A, aSeg.B - aSeg.A );
     BOX2I::ecoord_type dist_sq = (BOX2I::ecoord_type) aClearance * aClearance;
 
+    // The segments lie in the bounding box of the chain: none of them is closer than it
+    if( m_segmentCache && box_a.SquaredDistance( m_segmentCache->bbox ) >= dist_sq )
+        return false;
+
     for( int i = 0; i < SegmentCount(); i++ )
     {
         const SEG& s = CSegment( i );
-        BOX2I box_b( s.A, s.B - s.A );
+        BOX2I box_b = m_segmentCache ? m_segmentCache->segmentBoxes[i]
+                                     : BOX2I( s.A, s.B - s.A );
 
         BOX2I::ecoord_type d = box_a.SquaredDistance( box_b );
 
@@ -75,6 +82,7 @@ const SHAPE_LINE_CHAIN SHAPE_LINE_CHAIN::Reverse() const
 
     reverse( a.m_points.begin(), a.m_points.end() );
     a.m_closed = m_closed;
+    a.m_segmentCache.reset();
 
     return a;
 }
@@ -82,6 +90,9 @@ const SHAPE_LINE_CHAIN SHAPE_LINE_CHAIN::Reverse() const
 
 int SHAPE_LINE_CHAIN::Length() const
 {
+    if( m_segmentCache )
+        return m_segmentCache->pathLength.back();
+
     int l = 0;
 
     for( int i = 0; i < SegmentCount(); i++ )
@@ -99,6 +110,8 @@ void SHAPE_LINE_CHAIN::Replace( int aStartIndex, int aEndIndex, const VECTOR2I&
     if( aStartIndex < 0 )
         aStartIndex += PointCount();
 
+    m_segmentCache.reset();
+
     if( aStartIndex == aEndIndex )
         m_points[aStartIndex] = aP;
     else
@@ -117,6 +130,7 @@ void SHAPE_LINE_CHAIN::Replace( int aStartIndex, int aEndIndex, const SHAPE_LINE
     if( aStartIndex < 0 )
         aStartIndex += PointCount();
 
+    m_segmentCache.reset();
     m_points.erase( m_points.begin() + aStartIndex, m_points.begin() + aEndIndex + 1 );
     m_points.insert( m_points.begin() + aStartIndex, aLine.m_points.begin(), aLine.m_points.end() );
 }
@@ -130,6 +144,7 @@ void SHAPE_LINE_CHAIN::Remove( int aStartIndex, int aEndIndex )
     if( aStartIndex < 0 )
         aStartIndex += PointCount();
 
+    m_segmentCache.reset();
     m_points.erase( m_points.begin() + aStartIndex, m_points.begin() + aEndIndex + 1 );
 }
 
@@ -142,7 +157,12 @@ int SHAPE_LINE_CHAIN::Distance( const VECTOR2I& aP, bool aOutlineOnly ) const
         return 0;
 
     for( int s = 0; s < SegmentCount(); s++ )
+    {
+        if( m_segmentCache && segmentFartherThan( s, aP, d ) )
+            continue;
+
         d = std::min( d, CSegment( s ).Distance( aP ) );
+    }
 
     return d;
 }
@@ -178,6 +198,7 @@ int SHAPE_LINE_CHAIN::Split( const VECTOR2I& aP )
     if( ii >= 0 )
     {
         m_points.insert( m_points.begin() + ii + 1, aP );
+        m_segmentCache.reset();
 
         return ii + 1;
     }
@@ -199,8 +220,13 @@ int SHAPE_LINE_CHAIN::Find( const VECTOR2I& aP ) const
 int SHAPE_LINE_CHAIN::FindSegment( const VECTOR2I& aP ) const
 {
     for( int s = 0; s < SegmentCount(); s++ )
+    {
+        if( m_segmentCache && segmentFartherThan( s, aP, 2 ) )
+            continue;
+
         if( CSegment( s ).Distance( aP ) <= 1 )
             return s;
+    }
 
     return -1;
 }
@@ -313,6 +339,14 @@ int SHAPE_LINE_CHAIN::PathLength( const VECTOR2I& aP ) const
 
     for( int i = 0; i < SegmentCount(); i++ )
     {
+        if( m_segmentCache )
+        {
+            if( segmentFartherThan( i, aP, 2 ) )
+                continue;
+
+            sum = m_segmentCache->pathLength[i];
+        }
+
         const SEG seg = CSegment( i );
         int d = seg.Distance( aP );
 
@@ -364,6 +398,9 @@ bool SHAPE_LINE_CHAIN::PointOnEdge( const VECTOR2I& aP ) const
 
     for( int i = 0; i < SegmentCount(); i++ )
     {
+        if( m_segmentCache && segmentFartherThan( i, aP, 2 ) )
+            continue;
+
         const SEG s = CSegment( i );
 
         if( s.A == aP || s.B == aP )
@@ -383,6 +420,11 @@ const OPT<SHAPE_LINE_CHAIN::INTERSECTION> SHAPE_LINE_CHAIN::SelfIntersecting() c
     {
         for( int s2 = s1 + 1; s2 < SegmentCount(); s2++ )
         {
+            // Contains() and Intersect() need the segments to be at most 1 unit apart
+            if( m_segmentCache && m_segmentCache->segmentBoxes[s1].SquaredDistance(
+                        m_segmentCache->segmentBoxes[s2] ) > 1 )
+                continue;
+
             const VECTOR2I s2a = CSegment( s2 ).A, s2b = CSegment( s2 ).B;
 
             if( s1 + 1 != s2 && CSegment( s1 ).Contains( s2a ) )
@@ -429,6 +471,8 @@ SHAPE_LINE_CHAIN& SHAPE_LINE_CHAIN::Simplify()
 {
     std::vector<VECTOR2I> pts_unique;
 
+    m_segmentCache.reset();
+
     if( PointCount() < 2 )
     {
         return *this;
@@ -501,6 +545,9 @@ const VECTOR2I SHAPE_LINE_CHAIN::NearestPoint( const VECTOR2I& aP ) const
 
     for( int i = 0; i < SegmentCount(); i++ )
     {
+        if( m_segmentCache && segmentFartherThan( i, aP, min_d ) )
+            continue;
+
         int d = CSegment( i ).Distance( aP );
 
         if( d < min_d )
@@ -580,6 +627,7 @@ bool SHAPE_LINE_CHAIN::Parse( std::stringstream& aStream )
     int n_pts;
 
     m_points.clear();
+    m_segmentCache.reset();
     aStream >> n_pts;
 
     // Rough sanity check, just make sure the loop bounds aren't absolutely outlandish
@@ -607,7 +655,19 @@ const VECTOR2I SHAPE_LINE_CHAIN::PointAlong( int aPathLength ) const
     if( aPathLength == 0 )
         return CPoint( 0 );
 
-    for( int i = 0; i < SegmentCount(); i++ )
+    int first = 0;
+
+    // Skip to the first segment ending beyond aPathLength
+    if( m_segmentCache )
+    {
+        const std::vector<int>& pathLength = m_segmentCache->pathLength;
+
+        first = std::lower_bound( pathLength.begin() + 1, pathLength.end(), aPathLength )
+                - pathLength.begin() - 1;
+        total = pathLength[first];
+    }
+
+    for( int i = first; i < SegmentCount(); i++ )
     {
         const SEG& s = CSegment( i );
         int l = s.Length();
@@ -642,3 +702,40 @@ double SHAPE_LINE_CHAIN::Area() const
 
     return -area * 0.5;
 }
+
+
+void SHAPE_LINE_CHAIN::CacheSegments()
+{
+    if( m_segmentCache )
+        return;
+
+    auto cache = std::make_shared<SEGMENT_CACHE>();
+    int  segCount = SegmentCount();
+    int  length = 0;
+
+    cache->bbox.Compute( m_points );
+    cache->segmentBoxes.reserve( segCount );
+    cache->pathLength.reserve( segCount + 1 );
+    cache->pathLength.push_back( 0 );
+
+    for( int i = 0; i < segCount; i++ )
+    {
+        const SEG s = CSegment( i );
+
+        // Same sums as Length(), to give exactly the same results
+        length += s.Length();
+        cache->segmentBoxes.emplace_back( s.A, s.B - s.A );
+        cache->pathLength.push_back( length );
+    }
+
+    m_segmentCache = cache;
+}
+
+
+bool SHAPE_LINE_CHAIN::segmentFartherThan( int aSegment, const VECTOR2I& aP, int aDist ) const
+{
+    // One more unit for the rounding of the square root in SEG::Distance()
+    BOX2I::ecoord_type d = (BOX2I::ecoord_type) aDist + 1;
+
+    return m_segmentCache->segmentBoxes[aSegment].SquaredDistance( aP ) >= d * d;
+}
@@ -33,6 +33,8 @@
 #include <list>
 #include <algorithm>
 #include <unordered_set>
+#include <cstdint>
+#include <limits>
 
 #include <common.h>
 #include <md5_hash.h>
@@ -42,6 +44,8 @@
 #include <geometry/shape.h>
 #include <geometry/shape_line_chain.h>
 #include <geometry/shape_poly_set.h>
+#include <geometry/polygon_triangulation.h>
+#include <work_stealing_pool.h>
 
 #include "poly2tri/poly2tri.h"
 
@@ -155,6 +159,8 @@ bool SHAPE_POLY_SET::GetGlobalIndex( SHAPE_POLY_SET::VERTEX_INDEX aRelativeIndic
 
 int SHAPE_POLY_SET::NewOutline()
 {
+    invalidateIndex();
+
     SHAPE_LINE_CHAIN empty_path;
     POLYGON poly;
 
@@ -167,6 +173,8 @@ int SHAPE_POLY_SET::NewOutline()
 
 int SHAPE_POLY_SET::NewHole( int aOutline )
 {
+    invalidateIndex();
+
     SHAPE_LINE_CHAIN empty_path;
 
     empty_path.SetClosed( true );
@@ -184,6 +192,8 @@ int SHAPE_POLY_SET::NewHole( int aOutline )
 
 int SHAPE_POLY_SET::Append( int x, int y, int aOutline, int aHole, bool aAllowDuplication )
 {
+    invalidateIndex();
+
     if( aOutline < 0 )
         aOutline += m_polys.size();
 
@@ -205,6 +215,8 @@ int SHAPE_POLY_SET::Append( int x, int y, int aOutline, int aHole, bool aAllowDu
 
 void SHAPE_POLY_SET::InsertVertex( int aGlobalIndex, VECTOR2I aNewVertex )
 {
+    invalidateIndex();
+
     VERTEX_INDEX index;
 
     if( aGlobalIndex < 0 )
@@ -258,7 +270,7 @@ SHAPE_POLY_SET SHAPE_POLY_SET::Subset( int aFirstPolygon, int aLastPolygon )
 
     for( int index = aFirstPolygon; index < aLastPolygon; index++ )
     {
-        newPolySet.m_polys.push_back( Polygon( index ) );
+        newPolySet.m_polys.push_back( CPolygon( index ) );
     }
 
     return newPolySet;
@@ -267,6 +279,8 @@ SHAPE_POLY_SET SHAPE_POLY_SET::Subset( int aFirstPolygon, int aLastPolygon )
 
 VECTOR2I& SHAPE_POLY_SET::Vertex( int aIndex, int aOutline, int aHole )
 {
+    invalidateIndex();
+
     if( aOutline < 0 )
         aOutline += m_polys.size();
 
@@ -305,6 +319,8 @@ const VECTOR2I& SHAPE_POLY_SET::CVertex( int aIndex, int aOutline, int aHole ) c
 
 VECTOR2I& SHAPE_POLY_SET::Vertex( int aGlobalIndex )
 {
+    invalidateIndex();
+
     SHAPE_POLY_SET::VERTEX_INDEX index;
 
     // Assure the passed index references a legal position; abort otherwise
@@ -427,6 +443,8 @@ bool SHAPE_POLY_SET::IsSelfIntersecting()
 
 int SHAPE_POLY_SET::AddOutline( const SHAPE_LINE_CHAIN& aOutline )
 {
+    invalidateIndex();
+
     assert( aOutline.IsClosed() );
 
     POLYGON poly;
@@ -441,6 +459,8 @@ int SHAPE_POLY_SET::AddOutline( const SHAPE_LINE_CHAIN& aOutline )
 
 int SHAPE_POLY_SET::AddHole( const SHAPE_LINE_CHAIN& aHole, int aOutline )
 {
+    invalidateIndex();
+
     assert( m_polys.size() );
 
     if( aOutline < 0 )
@@ -587,7 +607,7 @@ void SHAPE_POLY_SET::BooleanIntersection( const SHAPE_POLY_SET& a,
 }
 
 
-void SHAPE_POLY_SET::Inflate( int aFactor, int aCircleSegmentsCount )
+double SHAPE_POLY_SET::inflateArcTolerance( int aFactor, int aCircleSegmentsCount )
 {
     // A static table to avoid repetitive calculations of the coefficient
     // 1.0 - cos( M_PI/aCircleSegmentsCount)
@@ -595,17 +615,6 @@ void SHAPE_POLY_SET::Inflate( int aFactor, int aCircleSegmentsCount )
     #define SEG_CNT_MAX 64
     static double arc_tolerance_factor[SEG_CNT_MAX + 1];
 
-    ClipperOffset c;
-
-    for( const POLYGON& poly : m_polys )
-    {
-        for( unsigned int i = 0; i < poly.size(); i++ )
-            c.AddPath( convertToClipper( poly[i], i > 0 ? false : true ), jtRound,
-                    etClosedPolygon );
-    }
-
-    PolyTree solution;
-
     // Calculate the arc tolerance (arc error) from the seg count by circle.
     // the seg count is nn = M_PI / acos(1.0 - c.ArcTolerance / abs(aFactor))
     // see:
@@ -626,7 +635,24 @@ void SHAPE_POLY_SET::Inflate( int aFactor, int aCircleSegmentsCount )
     else
         coeff = arc_tolerance_factor[aCircleSegmentsCount];
 
-    c.ArcTolerance = std::abs( aFactor ) * coeff;
+    return std::abs( aFactor ) * coeff;
+}
+
+
+void SHAPE_POLY_SET::Inflate( int aFactor, int aCircleSegmentsCount )
+{
+    ClipperOffset c;
+
+    for( const POLYGON& poly : m_polys )
+    {
+        for( unsigned int i = 0; i < poly.size(); i++ )
+            c.AddPath( convertToClipper( poly[i], i > 0 ? false : true ), jtRound,
+                    etClosedPolygon );
+    }
+
+    PolyTree solution;
+
+    c.ArcTolerance = inflateArcTolerance( aFactor, aCircleSegmentsCount );
 
     c.Execute( solution, aFactor );
 
@@ -634,8 +660,101 @@ void SHAPE_POLY_SET::Inflate( int aFactor, int aCircleSegmentsCount )
 }
 
 
+SHAPE_POLY_SET::BATCH::BATCH( const SHAPE_POLY_SET& aPolySet )
+{
+    for( const POLYGON& poly : aPolySet.m_polys )
+    {
+        for( unsigned int i = 0; i < poly.size(); i++ )
+            m_paths.push_back( convertToClipper( poly[i], i > 0 ? false : true ) );
+    }
+}
+
+
+void SHAPE_POLY_SET::BATCH::booleanOp( ClipperLib::ClipType aType, const BATCH* aOther,
+        POLYGON_MODE aFastMode )
+{
+    Clipper c;
+
+    if( aFastMode == PM_STRICTLY_SIMPLE )
+        c.StrictlySimple( true );
+
+    // The paths of a PolyTree have the orientations required by Clipper
+    forEachPath( [&c]( const Path& aPath ) { c.AddPath( aPath, ptSubject, true ); } );
+
+    if( aOther )
+        aOther->forEachPath( [&c]( const Path& aPath ) { c.AddPath( aPath, ptClip, true ); } );
+
+    std::unique_ptr<PolyTree> solution( new PolyTree );
+
+    c.Execute( aType, *solution, pftNonZero, pftNonZero );
+
+    m_tree = std::move( solution );
+    m_paths.clear();
+}
+
+
+void SHAPE_POLY_SET::BATCH::BooleanAdd( const BATCH& aOther, POLYGON_MODE aFastMode )
+{
+    booleanOp( ctUnion, &aOther, aFastMode );
+}
+
+
+void SHAPE_POLY_SET::BATCH::BooleanSubtract( const BATCH& aOther, POLYGON_MODE aFastMode )
+{
+    booleanOp( ctDifference, &aOther, aFastMode );
+}
+
+
+void SHAPE_POLY_SET::BATCH::BooleanIntersection( const BATCH& aOther, POLYGON_MODE aFastMode )
+{
+    booleanOp( ctIntersection, &aOther, aFastMode );
+}
+
+
+void SHAPE_POLY_SET::BATCH::Simplify( POLYGON_MODE aFastMode )
+{
+    booleanOp( ctUnion, nullptr, aFastMode );
+}
+
+
+void SHAPE_POLY_SET::BATCH::Inflate( int aFactor, int aCircleSegmentsCount )
+{
+    ClipperOffset c;
+
+    forEachPath( [&c]( const Path& aPath ) { c.AddPath( aPath, jtRound, etClosedPolygon ); } );
+
+    std::unique_ptr<PolyTree> solution( new PolyTree );
+
+    c.ArcTolerance = inflateArcTolerance( aFactor, aCircleSegmentsCount );
+    c.Execute( *solution, aFactor );
+
+    m_tree = std::move( solution );
+    m_paths.clear();
+}
+
+
+void SHAPE_POLY_SET::BATCH::GetResult( SHAPE_POLY_SET& aResult ) const
+{
+    if( m_tree )
+    {
+        aResult.importTree( m_tree.get() );
+        return;
+    }
+
+    Clipper  c;
+    PolyTree solution;
+
+    c.AddPaths( m_paths, ptSubject, true );
+    c.Execute( ctUnion, solution, pftNonZero, pftNonZero );
+
+    aResult.importTree( &solution );
+}
+
+
 void SHAPE_POLY_SET::importTree( PolyTree* tree )
 {
+    invalidateIndex();
+
     m_polys.clear();
 
     for( PolyNode* n = tree->GetFirst(); n; n = n->GetNext() )
@@ -874,6 +993,8 @@ void SHAPE_POLY_SET::fractureSingle( POLYGON& paths )
 
 void SHAPE_POLY_SET::Fracture( POLYGON_MODE aFastMode )
 {
+    invalidateIndex();
+
     Simplify( aFastMode );    // remove overlapping holes/degeneracy
 
     for( POLYGON& paths : m_polys )
@@ -1061,6 +1182,8 @@ bool SHAPE_POLY_SET::HasHoles() const
 
 void SHAPE_POLY_SET::Unfracture( POLYGON_MODE aFastMode )
 {
+    invalidateIndex();
+
     for( POLYGON& path : m_polys )
     {
         unfractureSingle( path );
@@ -1078,8 +1201,175 @@ void SHAPE_POLY_SET::Simplify( POLYGON_MODE aFastMode )
 }
 
 
+/**
+ * Interleaves the bits of aX and aY, so sorting on the result keeps neighbouring
+ * points together.
+ */
+static uint32_t mortonCode( uint32_t aX, uint32_t aY )
+{
+    auto spread = []( uint32_t v )
+    {
+        v &= 0xFFFF;
+        v = ( v | ( v << 8 ) ) & 0x00FF00FF;
+        v = ( v | ( v << 4 ) ) & 0x0F0F0F0F;
+        v = ( v | ( v << 2 ) ) & 0x33333333;
+        v = ( v | ( v << 1 ) ) & 0x55555555;
+        return v;
+    };
+
+    return spread( aX ) | ( spread( aY ) << 1 );
+}
+
+
+void SHAPE_POLY_SET::UnionMany( const std::vector<SHAPE_POLY_SET>& aPolySets,
+                                POLYGON_MODE aFastMode )
+{
+    // Number of polygons merged by each task.  The grouping, and so the rounding of the
+    // partial unions, only depends on the input: it must not depend on the thread count,
+    // or the result would differ between machines.
+    const size_t groupSize = 256;
+
+    struct ITEM
+    {
+        const POLYGON*  m_poly;
+        VECTOR2I        m_center;
+        uint32_t        m_key;
+    };
+
+    std::vector<ITEM> items;
+    BOX2I             extents;
+
+    auto addItems = [&]( const SHAPE_POLY_SET& aPolySet )
+    {
+        for( const POLYGON& poly : aPolySet.m_polys )
+        {
+            BOX2I bbox = poly[0].BBox();
+
+            items.push_back( { &poly, bbox.Centre(), 0 } );
+
+            if( items.size() == 1 )
+                extents = bbox;
+            else
+                extents.Merge( bbox );
+        }
+    };
+
+    addItems( *this );
+
+    for( const SHAPE_POLY_SET& polySet : aPolySets )
+        addItems( polySet );
+
+    WORK_STEALING_POOL& pool = GetThreadPool();
+    size_t groupCount = ( items.size() + groupSize - 1 ) / groupSize;
+
+    if( groupCount < 2 )
+    {
+        Clipper c;
+
+        if( aFastMode == PM_STRICTLY_SIMPLE )
+            c.StrictlySimple( true );
+
+        for( const ITEM& item : items )
+        {
+            for( unsigned int i = 0; i < item.m_poly->size(); i++ )
+                c.AddPath( convertToClipper( (*item.m_poly)[i], i == 0 ), ptSubject, true );
+        }
+
+        PolyTree solution;
+
+        c.Execute( ctUnion, solution, pftNonZero, pftNonZero );
+        importTree( &solution );
+        return;
+    }
+
+    // Sort the polygons along a Z-order curve, so each group holds neighbouring polygons
+    // which are likely to merge, and the partial results do not overlap much
+    double scaleX = extents.GetWidth() > 0 ? 65535.0 / extents.GetWidth() : 0.0;
+    double scaleY = extents.GetHeight() > 0 ? 65535.0 / extents.GetHeight() : 0.0;
+
+    for( ITEM& item : items )
+    {
+        uint32_t x = (uint32_t) ( ( item.m_center.x - extents.GetX() ) * scaleX );
+        uint32_t y = (uint32_t) ( ( item.m_center.y - extents.GetY() ) * scaleY );
+
+        item.m_key = mortonCode( x, y );
+    }
+
+    std::sort( items.begin(), items.end(),
+               []( const ITEM& a, const ITEM& b ) { return a.m_key < b.m_key; } );
+
+    std::vector<Paths>                      results( groupCount );
+    std::vector<WORK_STEALING_POOL::TASK>   tasks;
+
+    for( size_t g = 0; g < groupCount; g++ )
+    {
+        tasks.push_back( [&, g]()
+        {
+            Clipper c;
+
+            for( size_t ii = g * items.size() / groupCount;
+                 ii < ( g + 1 ) * items.size() / groupCount; ii++ )
+            {
+                const POLYGON& poly = *items[ii].m_poly;
+
+                for( unsigned int i = 0; i < poly.size(); i++ )
+                    c.AddPath( convertToClipper( poly[i], i == 0 ), ptSubject, true );
+            }
+
+            c.Execute( ctUnion, results[g], pftNonZero, pftNonZero );
+        } );
+    }
+
+    pool.Run( tasks );
+
+    // Merge the neighbouring results two by two, until two of them are left
+    while( results.size() > 2 )
+    {
+        std::vector<Paths> merged( ( results.size() + 1 ) / 2 );
+
+        tasks.clear();
+
+        for( size_t g = 0; g < merged.size(); g++ )
+        {
+            tasks.push_back( [&, g]()
+            {
+                if( 2 * g + 1 == results.size() )
+                {
+                    merged[g].swap( results[2 * g] );
+                    return;
+                }
+
+                Clipper c;
+
+                c.AddPaths( results[2 * g], ptSubject, true );
+                c.AddPaths( results[2 * g + 1], ptSubject, true );
+                c.Execute( ctUnion, merged[g], pftNonZero, pftNonZero );
+            } );
+        }
+
+        pool.Run( tasks );
+        results.swap( merged );
+    }
+
+    Clipper c;
+
+    if( aFastMode == PM_STRICTLY_SIMPLE )
+        c.StrictlySimple( true );
+
+    for( const Paths& paths : results )
+        c.AddPaths( paths, ptSubject, true );
+
+    PolyTree solution;
+
+    c.Execute( ctUnion, solution, pftNonZero, pftNonZero );
+    importTree( &solution );
+}
+
+
 int SHAPE_POLY_SET::NormalizeAreaOutlines()
 {
+    invalidateIndex();
+
     // We are expecting only one main outline, but this main outline can have holes
     // if holes: combine holes and remove them from the main outline.
     // Note also we are using SHAPE_POLY_SET::PM_STRICTLY_SIMPLE in polygon
@@ -1138,6 +1428,8 @@ const std::string SHAPE_POLY_SET::Format() const
 
 bool SHAPE_POLY_SET::Parse( std::stringstream& aStream )
 {
+    invalidateIndex();
+
     std::string tmp;
 
     aStream >> tmp;
@@ -1215,12 +1507,22 @@ const BOX2I SHAPE_POLY_SET::BBox( int aClearance ) const
 bool SHAPE_POLY_SET::PointOnEdge( const VECTOR2I& aP ) const
 {
     // Iterate through all the polygons in the set
-    for( const POLYGON& polygon : m_polys )
+    for( unsigned int polygonIdx = 0; polygonIdx < m_polys.size(); polygonIdx++ )
     {
+        const POLYGON&       polygon = m_polys[polygonIdx];
+        POLYGON_INDEX_PTR index = polygonIndex( polygonIdx );
+
         // Iterate through all the line chains in the polygon
-        for( const SHAPE_LINE_CHAIN& lineChain : polygon )
+        for( unsigned int contourIdx = 0; contourIdx < polygon.size(); contourIdx++ )
         {
-            if( lineChain.PointOnEdge( aP ) )
+            if( index )
+            {
+                const POLY_GRID_INDEX* grid = ( *index )[contourIdx].get();
+
+                if( grid && grid->PointOnEdge( aP ) )
+                    return true;
+            }
+            else if( polygon[contourIdx].PointOnEdge( aP ) )
                 return true;
         }
     }
@@ -1231,28 +1533,58 @@ bool SHAPE_POLY_SET::PointOnEdge( const VECTOR2I& aP ) const
 
 bool SHAPE_POLY_SET::Collide( const VECTOR2I& aP, int aClearance ) const
 {
-    SHAPE_POLY_SET polySet = SHAPE_POLY_SET( *this );
+    // There is a collision if the point is inside of a polygon or closer than aClearance
+    // to one of its edges.
+    return Collide( SEG( aP, aP ), aClearance );
+}
+
 
-    // Inflate the polygon if necessary.
-    if( aClearance > 0 )
+bool SHAPE_POLY_SET::Collide( const SEG& aSeg, int aClearance ) const
+{
+    for( unsigned int polygonIdx = 0; polygonIdx < m_polys.size(); polygonIdx++ )
     {
-        // fixme: the number of arc segments should not be hardcoded
-        polySet.Inflate( aClearance, 8 );
+        const POLYGON&       polygon = m_polys[polygonIdx];
+        POLYGON_INDEX_PTR index = polygonIndex( polygonIdx );
+
+        for( unsigned int contourIdx = 0; contourIdx < polygon.size(); contourIdx++ )
+        {
+            const SHAPE_LINE_CHAIN& path = polygon[contourIdx];
+
+            if( index )
+            {
+                const POLY_GRID_INDEX* grid = ( *index )[contourIdx].get();
+
+                if( grid && grid->Collide( aSeg, aClearance ) )
+                    return true;
+
+                continue;
+            }
+
+            for( int i = 0; i < path.SegmentCount(); i++ )
+            {
+                if( path.CSegment( i ).Collide( aSeg, aClearance ) )
+                    return true;
+            }
+        }
     }
 
-    // There is a collision if and only if the point is inside of the polygon.
-    return polySet.Contains( aP );
+    // The segment does not touch any edge: it collides only if it is inside a polygon
+    return Contains( aSeg.A );
 }
 
 
 void SHAPE_POLY_SET::RemoveAllContours()
 {
+    invalidateIndex();
+
     m_polys.clear();
 }
 
 
 void SHAPE_POLY_SET::RemoveContour( int aContourIdx, int aPolygonIdx )
 {
+    invalidateIndex();
+
     // Default polygon is the last one
     if( aPolygonIdx < 0 )
         aPolygonIdx += m_polys.size();
@@ -1263,6 +1595,8 @@ void SHAPE_POLY_SET::RemoveContour( int aContourIdx, int aPolygonIdx )
 
 int SHAPE_POLY_SET::RemoveNullSegments()
 {
+    invalidateIndex();
+
     int removed = 0;
 
     ITERATOR iterator = IterateWithHoles();
@@ -1316,12 +1650,16 @@ int SHAPE_POLY_SET::RemoveNullSegments()
 
 void SHAPE_POLY_SET::DeletePolygon( int aIdx )
 {
+    invalidateIndex();
+
     m_polys.erase( m_polys.begin() + aIdx );
 }
 
 
 void SHAPE_POLY_SET::Append( const SHAPE_POLY_SET& aSet )
 {
+    invalidateIndex();
+
     m_polys.insert( m_polys.end(), aSet.m_polys.begin(), aSet.m_polys.end() );
 }
 
@@ -1345,7 +1683,7 @@ bool SHAPE_POLY_SET::CollideVertex( const VECTOR2I& aPoint,
     // Convert clearance to double for precission when comparing distances
     clearance = aClearance;
 
-    for( ITERATOR iterator = IterateWithHoles(); iterator; iterator++ )
+    for( CONST_ITERATOR iterator = CIterateWithHoles(); iterator; iterator++ )
     {
         // Get the difference vector between current vertex and aPoint
         delta = *iterator - aPoint;
@@ -1376,9 +1714,9 @@ bool SHAPE_POLY_SET::CollideEdge( const VECTOR2I& aPoint,
     // Shows whether there was a collision
     bool collision = false;
 
-    SEGMENT_ITERATOR iterator;
+    CONST_SEGMENT_ITERATOR iterator;
 
-    for( iterator = IterateSegmentsWithHoles(); iterator; iterator++ )
+    for( iterator = CIterateSegmentsWithHoles(); iterator; iterator++ )
     {
         SEG currentSegment = *iterator;
         int distance = currentSegment.Distance( aPoint );
@@ -1434,12 +1772,36 @@ void SHAPE_POLY_SET::RemoveVertex( int aGlobalIndex )
 
 void SHAPE_POLY_SET::RemoveVertex( VERTEX_INDEX aIndex )
 {
+    invalidateIndex();
+
     m_polys[aIndex.m_polygon][aIndex.m_contour].Remove( aIndex.m_vertex );
 }
 
 
 bool SHAPE_POLY_SET::containsSingle( const VECTOR2I& aP, int aSubpolyIndex, bool aIgnoreHoles ) const
 {
+    if( POLYGON_INDEX_PTR index = polygonIndex( aSubpolyIndex ) )
+    {
+        // Same tests as below, on the edges found in the grids
+        const POLY_GRID_INDEX* outline = ( *index )[0].get();
+
+        if( !outline || !outline->PointInside( aP ) )
+            return false;
+
+        if( !aIgnoreHoles )
+        {
+            for( unsigned int holeIdx = 1; holeIdx < index->size(); holeIdx++ )
+            {
+                const POLY_GRID_INDEX* hole = ( *index )[holeIdx].get();
+
+                if( hole && hole->PointInside( aP ) && !hole->PointOnEdge( aP ) )
+                    return false;
+            }
+        }
+
+        return true;
+    }
+
     // Check that the point is inside the outline
     if( pointInPolygon( aP, m_polys[aSubpolyIndex][0] ) )
     {
@@ -1448,7 +1810,7 @@ bool SHAPE_POLY_SET::containsSingle( const VECTOR2I& aP, int aSubpolyIndex, bool
             // Check that the point is not in any of the holes
             for( int holeIdx = 0; holeIdx < HoleCount( aSubpolyIndex ); holeIdx++ )
             {
-                const SHAPE_LINE_CHAIN hole = CHole( aSubpolyIndex, holeIdx );
+                const SHAPE_LINE_CHAIN& hole = CHole( aSubpolyIndex, holeIdx );
 
                 // If the point is inside a hole (and not on its edge),
                 // it is outside of the polygon
@@ -1531,6 +1893,8 @@ bool SHAPE_POLY_SET::pointInPolygon( const VECTOR2I& aP, const SHAPE_LINE_CHAIN&
 
 void SHAPE_POLY_SET::Move( const VECTOR2I& aVector )
 {
+    invalidateIndex();
+
     for( POLYGON& poly : m_polys )
     {
         for( SHAPE_LINE_CHAIN& path : poly )
@@ -1543,6 +1907,8 @@ void SHAPE_POLY_SET::Move( const VECTOR2I& aVector )
 
 void SHAPE_POLY_SET::Rotate( double aAngle, const VECTOR2I& aCenter )
 {
+    invalidateIndex();
+
     for( POLYGON& poly : m_polys )
     {
         for( SHAPE_LINE_CHAIN& path : poly )
@@ -1583,7 +1949,7 @@ SHAPE_POLY_SET::POLYGON SHAPE_POLY_SET::FilletPolygon( unsigned int aRadius,
 }
 
 
-int SHAPE_POLY_SET::DistanceToPolygon( VECTOR2I aPoint, int aPolygonIndex )
+int SHAPE_POLY_SET::DistanceToPolygon( VECTOR2I aPoint, int aPolygonIndex ) const
 {
     // We calculate the min dist between the segment and each outline segment
     // However, if the segment to test is inside the outline, and does not cross
@@ -1592,7 +1958,20 @@ int SHAPE_POLY_SET::DistanceToPolygon( VECTOR2I aPoint, int aPolygonIndex )
     if( containsSingle( aPoint, aPolygonIndex ) )
         return 0;
 
-    SEGMENT_ITERATOR iterator = IterateSegmentsWithHoles( aPolygonIndex );
+    if( POLYGON_INDEX_PTR index = polygonIndex( aPolygonIndex ) )
+    {
+        int minDistance = std::numeric_limits<int>::max();
+
+        for( const std::unique_ptr<POLY_GRID_INDEX>& grid : *index )
+        {
+            if( grid )
+                minDistance = std::min( minDistance, grid->Distance( aPoint ) );
+        }
+
+        return minDistance;
+    }
+
+    CONST_SEGMENT_ITERATOR iterator = CIterateSegmentsWithHoles( aPolygonIndex );
 
     SEG polygonEdge = *iterator;
     int minDistance = polygonEdge.Distance( aPoint );
@@ -1611,7 +1990,7 @@ int SHAPE_POLY_SET::DistanceToPolygon( VECTOR2I aPoint, int aPolygonIndex )
 }
 
 
-int SHAPE_POLY_SET::DistanceToPolygon( SEG aSegment, int aPolygonIndex, int aSegmentWidth )
+int SHAPE_POLY_SET::DistanceToPolygon( SEG aSegment, int aPolygonIndex, int aSegmentWidth ) const
 {
     // We calculate the min dist between the segment and each outline segment
     // However, if the segment to test is inside the outline, and does not cross
@@ -1620,19 +1999,32 @@ int SHAPE_POLY_SET::DistanceToPolygon( SEG aSegment, int aPolygonIndex, int aSeg
     if( containsSingle( aSegment.A, aPolygonIndex ) )
         return 0;
 
-    SEGMENT_ITERATOR iterator = IterateSegmentsWithHoles( aPolygonIndex );
-
-    SEG polygonEdge = *iterator;
-    int minDistance = polygonEdge.Distance( aSegment );
+    int minDistance = std::numeric_limits<int>::max();
 
-    for( iterator++; iterator && minDistance > 0; iterator++ )
+    if( POLYGON_INDEX_PTR index = polygonIndex( aPolygonIndex ) )
     {
-        polygonEdge = *iterator;
+        for( const std::unique_ptr<POLY_GRID_INDEX>& grid : *index )
+        {
+            if( grid )
+                minDistance = std::min( minDistance, grid->Distance( aSegment ) );
+        }
+    }
+    else
+    {
+        CONST_SEGMENT_ITERATOR iterator = CIterateSegmentsWithHoles( aPolygonIndex );
 
-        int currentDistance = polygonEdge.Distance( aSegment );
+        SEG polygonEdge = *iterator;
+        minDistance = polygonEdge.Distance( aSegment );
 
-        if( currentDistance < minDistance )
-            minDistance = currentDistance;
+        for( iterator++; iterator && minDistance > 0; iterator++ )
+        {
+            polygonEdge = *iterator;
+
+            int currentDistance = polygonEdge.Distance( aSegment );
+
+            if( currentDistance < minDistance )
+                minDistance = currentDistance;
+        }
     }
 
     // Take into account the width of the segment
@@ -1644,7 +2036,7 @@ int SHAPE_POLY_SET::DistanceToPolygon( SEG aSegment, int aPolygonIndex, int aSeg
 }
 
 
-int SHAPE_POLY_SET::Distance( VECTOR2I aPoint )
+int SHAPE_POLY_SET::Distance( VECTOR2I aPoint ) const
 {
     int currentDistance;
     int minDistance = DistanceToPolygon( aPoint, 0 );
@@ -1662,7 +2054,7 @@ int SHAPE_POLY_SET::Distance( VECTOR2I aPoint )
 }
 
 
-int SHAPE_POLY_SET::Distance( const SEG& aSegment, int aSegmentWidth )
+int SHAPE_POLY_SET::Distance( const SEG& aSegment, int aSegmentWidth ) const
 {
     int currentDistance;
     int minDistance = DistanceToPolygon( aSegment, 0 );
@@ -1878,8 +2270,72 @@ SHAPE_POLY_SET::POLYGON SHAPE_POLY_SET::chamferFilletPolygon( CORNER_MODE aMode,
 }
 
 
+SHAPE_POLY_SET::POLYGON_INDEX_PTR SHAPE_POLY_SET::polygonIndex( int aIndex ) const
+{
+    // Below this number of vertices, the linear tests are fast enough
+    const int minVertices = 64;
+
+    // Number of queries after a change before building the indices, so a single test on a
+    // temporary polygon does not pay for a grid
+    const int minQueries = 4;
+
+    int vertexCount = 0;
+
+    for( const SHAPE_LINE_CHAIN& path : m_polys[aIndex] )
+        vertexCount += path.PointCount();
+
+    if( vertexCount < minVertices )
+        return nullptr;
+
+    if( m_indexQueries < minQueries && m_indexQueries++ < minQueries )
+        return nullptr;
+
+    std::lock_guard<std::mutex> lock( m_indexLock );
+
+    if( m_polygonIndices.size() != m_polys.size() )
+        m_polygonIndices.resize( m_polys.size() );
+
+    POLYGON_INDEX_PTR& index = m_polygonIndices[aIndex];
+    const POLYGON&     polygon = m_polys[aIndex];
+
+    // A contour modified through a reference kept since the last invalidateIndex() is not
+    // seen by the index: rebuild it at least when the size of a contour changed.
+    if( index )
+    {
+        bool stale = index->size() != polygon.size();
+
+        for( size_t i = 0; i < polygon.size() && !stale; i++ )
+        {
+            const POLY_GRID_INDEX* grid = ( *index )[i].get();
+
+            stale = ( grid ? grid->PointCount() : 0 ) != polygon[i].PointCount();
+        }
+
+        assert( !stale );
+
+        if( stale )
+            index.reset();
+    }
+
+    if( !index )
+    {
+        auto newIndex = std::make_shared<POLYGON_INDEX>();
+
+        for( const SHAPE_LINE_CHAIN& path : polygon )
+            newIndex->emplace_back( path.PointCount() ? new POLY_GRID_INDEX( path ) : nullptr );
+
+        index = std::move( newIndex );
+    }
+
+    // Returned by value: the caller keeps the index alive even if the set is invalidated
+    return index;
+}
+
+
 SHAPE_POLY_SET &SHAPE_POLY_SET::operator=( const SHAPE_POLY_SET& aOther )
 {
+    invalidateIndex();
+
     static_cast<SHAPE&>(*this) = aOther;
     m_polys = aOther.m_polys;
 
@@ -2087,24 +2543,44 @@ void SHAPE_POLY_SET::CacheTriangulation()
     if( !recalculate )
         return;
 
-    SHAPE_POLY_SET tmpSet = *this;
-
-    if( !tmpSet.HasHoles() )
-        tmpSet.Unfracture( PM_FAST );
-
     m_triangulatedPolys.clear();
 
-    if( tmpSet.HasTouchingHoles() )
+    for( const POLYGON& poly : m_polys )
     {
-        // temporary workaround for overlapping hole vertices that poly2tri doesn't handle
-        m_triangulationValid = false;
-        return;
-    }
+        // The ear clipping handles the fractured polygons as they are
+        auto triPoly = std::make_unique<TRIANGULATED_POLYGON>();
+        POLYGON_TRIANGULATION tess( *triPoly );
 
-    for( int i = 0; i < tmpSet.OutlineCount(); i++ )
-    {
-        m_triangulatedPolys.push_back( std::make_unique<TRIANGULATED_POLYGON>() );
-        triangulateSingle( tmpSet.Polygon( i ), *m_triangulatedPolys.back() );
+        if( tess.TesselatePolygon( poly ) )
+        {
+            m_triangulatedPolys.push_back( std::move( triPoly ) );
+            continue;
+        }
+
+        // Degenerate polygon: use poly2tri, which needs the holes to be restored
+        SHAPE_POLY_SET tmpSet;
+
+        tmpSet.AddOutline( poly[0] );
+
+        for( unsigned i = 1; i < poly.size(); i++ )
+            tmpSet.AddHole( poly[i] );
+
+        if( !tmpSet.HasHoles() )
+            tmpSet.Unfracture( PM_FAST );
+
+        if( tmpSet.HasTouchingHoles() )
+        {
+            // temporary workaround for overlapping hole vertices that poly2tri doesn't handle
+            m_triangulatedPolys.clear();
+            m_triangulationValid = false;
+            return;
+        }
+
+        for( int i = 0; i < tmpSet.OutlineCount(); i++ )
+        {
+            m_triangulatedPolys.push_back( std::make_unique<TRIANGULATED_POLYGON>() );
+            triangulateSingle( tmpSet.Polygon( i ), *m_triangulatedPolys.back() );
+        }
     }
 
     m_triangulationValid = true;
@@ -28,6 +28,9 @@
 #include <class_text_mod.h>
 #include <class_edge_mod.h>
 #include <class_pad.h>
+#include <class_track.h>
+#include <class_drawsegment.h>
+#include <class_pcb_text.h>
 
 #include <functional>
 
@@ -39,7 +42,7 @@ static inline size_t hash_board_item( const BOARD_ITEM* aItem, int aFlags )
     size_t ret = 0;
 
     if( aFlags & LAYER )
-        ret ^= hash<unsigned long long>{}( aItem->GetLayerSet().to_ullong() );
+        hash_combine( ret, hash<unsigned long long>{}( aItem->GetLayerSet().to_ullong() ) );
 
     return ret;
 }
@@ -55,57 +58,57 @@ size_t hash_eda( const EDA_ITEM* aItem, int aFlags )
         {
             const MODULE* module = static_cast<const MODULE*>( aItem );
 
-            ret ^= hash_board_item( module, aFlags );
+            hash_combine( ret, hash_board_item( module, aFlags ) );
 
             if( aFlags & POSITION )
             {
-                ret ^= hash<int>{}( module->GetPosition().x );
-                ret ^= hash<int>{}( module->GetPosition().y );
+                hash_combine( ret, hash<int>{}( module->GetPosition().x ) );
+                hash_combine( ret, hash<int>{}( module->GetPosition().y ) );
             }
 
             if( aFlags & ROTATION )
-                ret ^= hash<double>{}( module->GetOrientation() );
+                hash_combine( ret, hash<double>{}( module->GetOrientation() ) );
 
             for( const BOARD_ITEM* i = module->GraphicalItemsList(); i; i = i->Next() )
-                ret ^= hash_eda( i, aFlags );
+                hash_combine( ret, hash_eda( i, aFlags ) );
 
             for( const D_PAD* i = module->PadsList(); i; i = i->Next() )
-                ret ^= hash_eda( i, aFlags );
+                hash_combine( ret, hash_eda( i, aFlags ) );
         }
         break;
 
     case PCB_PAD_T:
         {
             const D_PAD* pad = static_cast<const D_PAD*>( aItem );
-            ret ^= hash_board_item( pad, aFlags );
-            ret ^= hash<int>{}( pad->GetShape() << 16 );
-            ret ^= hash<int>{}( pad->GetDrillShape() << 18 );
-            ret ^= hash<int>{}( pad->GetSize().x << 8 );
-            ret ^= hash<int>{}( pad->GetSize().y << 9 );
-            ret ^= hash<int>{}( pad->GetOffset().x << 6 );
-            ret ^= hash<int>{}( pad->GetOffset().y << 7 );
-            ret ^= hash<int>{}( pad->GetDelta().x << 4 );
-            ret ^= hash<int>{}( pad->GetDelta().y << 5 );
+            hash_combine( ret, hash_board_item( pad, aFlags ) );
+            hash_combine( ret, hash<int>{}( pad->GetShape() ) );
+            hash_combine( ret, hash<int>{}( pad->GetDrillShape() ) );
+            hash_combine( ret, hash<int>{}( pad->GetSize().x ) );
+            hash_combine( ret, hash<int>{}( pad->GetSize().y ) );
+            hash_combine( ret, hash<int>{}( pad->GetOffset().x ) );
+            hash_combine( ret, hash<int>{}( pad->GetOffset().y ) );
+            hash_combine( ret, hash<int>{}( pad->GetDelta().x ) );
+            hash_combine( ret, hash<int>{}( pad->GetDelta().y ) );
 
             if( aFlags & POSITION )
             {
                 if( aFlags & REL_COORD )
                 {
-                    ret ^= hash<int>{}( pad->GetPos0().x );
-                    ret ^= hash<int>{}( pad->GetPos0().y );
+                    hash_combine( ret, hash<int>{}( pad->GetPos0().x ) );
+                    hash_combine( ret, hash<int>{}( pad->GetPos0().y ) );
                 }
                 else
                 {
-                    ret ^= hash<int>{}( pad->GetPosition().x );
-                    ret ^= hash<int>{}( pad->GetPosition().y );
+                    hash_combine( ret, hash<int>{}( pad->GetPosition().x ) );
+                    hash_combine( ret, hash<int>{}( pad->GetPosition().y ) );
                 }
             }
 
             if( aFlags & ROTATION )
-                ret ^= hash<double>{}( pad->GetOrientation() );
+                hash_combine( ret, hash<double>{}( pad->GetOrientation() ) );
 
             if( aFlags & NET )
-                ret ^= hash<int>{}( pad->GetNetCode() << 6 );
+                hash_combine( ret, hash<int>{}( pad->GetNetCode() ) );
         }
         break;
 
@@ -119,64 +122,141 @@ size_t hash_eda( const EDA_ITEM* aItem, int aFlags )
             if( !( aFlags & VALUE ) && text->GetType() == TEXTE_MODULE::TEXT_is_VALUE )
                 break;
 
-            ret ^= hash_board_item( text, aFlags );
-            ret ^= hash<string>{}( text->GetText().ToStdString() );
-            ret ^= hash<bool>{}( text->IsItalic() );
-            ret ^= hash<bool>{}( text->IsBold() );
-            ret ^= hash<bool>{}( text->IsMirrored() );
-            ret ^= hash<int>{}( text->GetTextWidth() );
-            ret ^= hash<int>{}( text->GetTextHeight() );
-            ret ^= hash<int>{}( text->GetHorizJustify() );
-            ret ^= hash<int>{}( text->GetVertJustify() );
+            hash_combine( ret, hash_board_item( text, aFlags ) );
+            hash_combine( ret, hash<string>{}( text->GetText().ToStdString() ) );
+            hash_combine( ret, hash<bool>{}( text->IsItalic() ) );
+            hash_combine( ret, hash<bool>{}( text->IsBold() ) );
+            hash_combine( ret, hash<bool>{}( text->IsMirrored() ) );
+            hash_combine( ret, hash<int>{}( text->GetTextWidth() ) );
+            hash_combine( ret, hash<int>{}( text->GetTextHeight() ) );
+            hash_combine( ret, hash<int>{}( text->GetHorizJustify() ) );
+            hash_combine( ret, hash<int>{}( text->GetVertJustify() ) );
 
             if( aFlags & POSITION )
             {
                 if( aFlags & REL_COORD )
                 {
-                    ret ^= hash<int>{}( text->GetPos0().x );
-                    ret ^= hash<int>{}( text->GetPos0().y );
+                    hash_combine( ret, hash<int>{}( text->GetPos0().x ) );
+                    hash_combine( ret, hash<int>{}( text->GetPos0().y ) );
                 }
                 else
                 {
-                    ret ^= hash<int>{}( text->GetPosition().x );
-                    ret ^= hash<int>{}( text->GetPosition().y );
+                    hash_combine( ret, hash<int>{}( text->GetPosition().x ) );
+                    hash_combine( ret, hash<int>{}( text->GetPosition().y ) );
                 }
             }
 
             if( aFlags & ROTATION )
-                ret ^= hash<double>{}( text->GetTextAngle() );
+                hash_combine( ret, hash<double>{}( text->GetTextAngle() ) );
         }
         break;
 
     case PCB_MODULE_EDGE_T:
         {
             const EDGE_MODULE* segment = static_cast<const EDGE_MODULE*>( aItem );
-            ret ^= hash_board_item( segment, aFlags );
-            ret ^= hash<int>{}( segment->GetType() );
-            ret ^= hash<int>{}( segment->GetShape() );
-            ret ^= hash<int>{}( segment->GetWidth() );
-            ret ^= hash<int>{}( segment->GetRadius() );
+            hash_combine( ret, hash_board_item( segment, aFlags ) );
+            hash_combine( ret, hash<int>{}( segment->GetType() ) );
+            hash_combine( ret, hash<int>{}( segment->GetShape() ) );
+            hash_combine( ret, hash<int>{}( segment->GetWidth() ) );
+            hash_combine( ret, hash<int>{}( segment->GetRadius() ) );
 
             if( aFlags & POSITION )
             {
                 if( aFlags & REL_COORD )
                 {
-                    ret ^= hash<int>{}( segment->GetStart0().x );
-                    ret ^= hash<int>{}( segment->GetStart0().y );
-                    ret ^= hash<int>{}( segment->GetEnd0().x );
-                    ret ^= hash<int>{}( segment->GetEnd0().y );
+                    hash_combine( ret, hash<int>{}( segment->GetStart0().x ) );
+                    hash_combine( ret, hash<int>{}( segment->GetStart0().y ) );
+                    hash_combine( ret, hash<int>{}( segment->GetEnd0().x ) );
+                    hash_combine( ret, hash<int>{}( segment->GetEnd0().y ) );
                 }
                 else
                 {
-                    ret ^= hash<int>{}( segment->GetStart().x );
-                    ret ^= hash<int>{}( segment->GetStart().y );
-                    ret ^= hash<int>{}( segment->GetEnd().x );
-                    ret ^= hash<int>{}( segment->GetEnd().y );
+                    hash_combine( ret, hash<int>{}( segment->GetStart().x ) );
+                    hash_combine( ret, hash<int>{}( segment->GetStart().y ) );
+                    hash_combine( ret, hash<int>{}( segment->GetEnd().x ) );
+                    hash_combine( ret, hash<int>{}( segment->GetEnd().y ) );
                 }
             }
 
             if( aFlags & ROTATION )
-                ret ^= hash<double>{}( segment->GetAngle() );
+                hash_combine( ret, hash<double>{}( segment->GetAngle() ) );
+        }
+        break;
+
+    case PCB_TRACE_T:
+    case PCB_VIA_T:
+        {
+            const TRACK* track = static_cast<const TRACK*>( aItem );
+            hash_combine( ret, hash_board_item( track, aFlags ) );
+            hash_combine( ret, hash<int>{}( track->Type() ) );
+            hash_combine( ret, hash<int>{}( track->GetWidth() ) );
+
+            if( track->Type() == PCB_VIA_T )
+            {
+                const VIA* via = static_cast<const VIA*>( track );
+                hash_combine( ret, hash<int>{}( via->GetViaType() ) );
+                hash_combine( ret, hash<int>{}( via->GetDrill() ) );
+            }
+
+            if( aFlags & POSITION )
+            {
+                hash_combine( ret, hash<int>{}( track->GetStart().x ) );
+                hash_combine( ret, hash<int>{}( track->GetStart().y ) );
+                hash_combine( ret, hash<int>{}( track->GetEnd().x ) );
+                hash_combine( ret, hash<int>{}( track->GetEnd().y ) );
+            }
+
+            if( aFlags & NET )
+                hash_combine( ret, hash<int>{}( track->GetNetCode() ) );
+        }
+        break;
+
+    case PCB_LINE_T:
+        {
+            const DRAWSEGMENT* segment = static_cast<const DRAWSEGMENT*>( aItem );
+            hash_combine( ret, hash_board_item( segment, aFlags ) );
+            hash_combine( ret, hash<int>{}( segment->GetShape() ) );
+            hash_combine( ret, hash<int>{}( segment->GetWidth() ) );
+
+            if( aFlags & POSITION )
+            {
+                hash_combine( ret, hash<int>{}( segment->GetStart().x ) );
+                hash_combine( ret, hash<int>{}( segment->GetStart().y ) );
+                hash_combine( ret, hash<int>{}( segment->GetEnd().x ) );
+                hash_combine( ret, hash<int>{}( segment->GetEnd().y ) );
+                hash_combine( ret, hash<int>{}( segment->GetBezControl1().x ) );
+                hash_combine( ret, hash<int>{}( segment->GetBezControl1().y ) );
+                hash_combine( ret, hash<int>{}( segment->GetBezControl2().x ) );
+                hash_combine( ret, hash<int>{}( segment->GetBezControl2().y ) );
+            }
+
+            if( aFlags & ROTATION )
+                hash_combine( ret, hash<double>{}( segment->GetAngle() ) );
+        }
+        break;
+
+    case PCB_TEXT_T:
+        {
+            const TEXTE_PCB* text = static_cast<const TEXTE_PCB*>( aItem );
+            hash_combine( ret, hash_board_item( text, aFlags ) );
+            hash_combine( ret, hash<string>{}( text->GetText().ToStdString() ) );
+            hash_combine( ret, hash<bool>{}( text->IsItalic() ) );
+            hash_combine( ret, hash<bool>{}( text->IsBold() ) );
+            hash_combine( ret, hash<bool>{}( text->IsMirrored() ) );
+            hash_combine( ret, hash<int>{}( text->GetTextWidth() ) );
+            hash_combine( ret, hash<int>{}( text->GetTextHeight() ) );
+            hash_combine( ret, hash<int>{}( text->GetThickness() ) );
+            hash_combine( ret, hash<int>{}( text->GetHorizJustify() ) );
+            hash_combine( ret, hash<int>{}( text->GetVertJustify() ) );
+
+            if( aFlags & POSITION )
+            {
+                hash_combine( ret, hash<int>{}( text->GetTextPos().x ) );
+                hash_combine( ret, hash<int>{}( text->GetTextPos().y ) );
+            }
+
+            if( aFlags & ROTATION )
+                hash_combine( ret, hash<double>{}( text->GetTextAngle() ) );
         }
         break;
 
@@ -28,6 +28,17 @@
 
 #include <richio.h>
 
+#if defined( _WIN32 )
+#define WIN32_LEAN_AND_MEAN 1
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 
 // Fall back to getc() when getc_unlocked() is not available on the target platform.
 #if !defined( HAVE_FGETC_NOLOCK )
@@ -225,13 +236,15 @@ char* FILE_LINE_READER::ReadLine()
 }
 
 
-STRING_LINE_READER::STRING_LINE_READER( const std::string& aString, const wxString& aSource ):
+STRING_LINE_READER::STRING_LINE_READER( const std::string& aString, const wxString& aSource,
+                                        unsigned aStartingLineNumber ):
     LINE_READER( LINE_READER_LINE_DEFAULT_MAX ),
     m_lines( aString ), m_ndx( 0 )
 {
     // Clipboard text should be nice and _use multiple lines_ so that
     // we can report _line number_ oriented error messages when parsing.
-    m_source = aSource;
+    m_source  = aSource;
+    m_lineNum = aStartingLineNumber;
 }
 
 
@@ -278,6 +291,181 @@ char* STRING_LINE_READER::ReadLine()
 }
 
 
+MMAP_LINE_READER::MMAP_LINE_READER( const wxString& aFileName,
+            unsigned aStartingLineNumber, unsigned aMaxLineLength ) :
+    LINE_READER( aMaxLineLength ),
+    m_data( NULL ), m_size( 0 ), m_ndx( 0 ), m_mapped( false ), m_mapping( NULL )
+{
+    m_source  = aFileName;
+    m_lineNum = aStartingLineNumber;
+
+    if( !mapFile( aFileName ) )
+    {
+        FILE* fp = wxFopen( aFileName, wxT( "rb" ) );
+
+        if( !fp )
+        {
+            wxString msg = wxString::Format(
+                _( "Unable to open filename \"%s\" for reading" ), aFileName.GetData() );
+            THROW_IO_ERROR( msg );
+        }
+
+        char   chunk[65536];
+        size_t count;
+
+        while( ( count = fread( chunk, 1, sizeof( chunk ), fp ) ) > 0 )
+            m_fileBuffer.insert( m_fileBuffer.end(), chunk, chunk + count );
+
+        fclose( fp );
+
+        m_size = m_fileBuffer.size();
+        m_data = m_fileBuffer.data();
+    }
+}
+
+
+MMAP_LINE_READER::~MMAP_LINE_READER()
+{
+    unmapFile();
+}
+
+
+#if defined( _WIN32 )
+
+bool MMAP_LINE_READER::mapFile( const wxString& aFileName )
+{
+    HANDLE file = CreateFileW( aFileName.wc_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                               OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL );
+
+    if( file == INVALID_HANDLE_VALUE )
+        return false;
+
+    LARGE_INTEGER size;
+
+    // An empty file cannot be mapped
+    if( !GetFileSizeEx( file, &size ) || size.QuadPart == 0
+            || (unsigned long long) size.QuadPart > (size_t) -1 )
+    {
+        CloseHandle( file );
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingW( file, NULL, PAGE_READONLY, 0, 0, NULL );
+
+    // The mapping keeps the file open
+    CloseHandle( file );
+
+    if( !mapping )
+        return false;
+
+    void* data = MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 );
+
+    if( !data )
+    {
+        CloseHandle( mapping );
+        return false;
+    }
+
+    m_data    = (const char*) data;
+    m_size    = (size_t) size.QuadPart;
+    m_mapping = mapping;
+    m_mapped  = true;
+
+    return true;
+}
+
+
+void MMAP_LINE_READER::unmapFile()
+{
+    if( m_mapped )
+    {
+        UnmapViewOfFile( (void*) m_data );
+        CloseHandle( (HANDLE) m_mapping );
+        m_mapped = false;
+    }
+}
+
+#else
+
+bool MMAP_LINE_READER::mapFile( const wxString& aFileName )
+{
+    int fd = open( aFileName.fn_str(), O_RDONLY );
+
+    if( fd < 0 )
+        return false;
+
+    struct stat st;
+
+    // An empty file cannot be mapped, and a pipe or a device should not be
+    if( fstat( fd, &st ) != 0 || !S_ISREG( st.st_mode ) || st.st_size == 0 )
+    {
+        close( fd );
+        return false;
+    }
+
+    void* data = mmap( NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+
+    // The mapping keeps the file open
+    close( fd );
+
+    if( data == MAP_FAILED )
+        return false;
+
+    madvise( data, st.st_size, MADV_SEQUENTIAL );
+
+    m_data   = (const char*) data;
+    m_size   = st.st_size;
+    m_mapped = true;
+
+    return true;
+}
+
+
+void MMAP_LINE_READER::unmapFile()
+{
+    if( m_mapped )
+    {
+        munmap( (void*) m_data, m_size );
+        m_mapped = false;
+    }
+}
+
+#endif
+
+
+char* MMAP_LINE_READER::ReadLine()
+{
+    // m_lineNum is incremented even if there was no line read, because this
+    // leads to better error reporting when we hit an end of file.
+    ++m_lineNum;
+
+    m_length = 0;
+
+    if( m_ndx >= m_size )
+    {
+        m_line[0] = 0;
+        return NULL;
+    }
+
+    const char* lineStart = m_data + m_ndx;
+    const char* newline = (const char*) memchr( lineStart, '\n', m_size - m_ndx );
+    size_t      length = newline ? newline - lineStart + 1 : m_size - m_ndx;
+
+    if( length >= m_maxLineLength )
+        THROW_IO_ERROR( _( "Maximum line length exceeded" ) );
+
+    if( length + 1 > m_capacity )
+        expandCapacity( length + 1 );
+
+    memcpy( m_line, lineStart, length );
+    m_line[length] = 0;
+    m_length = length;
+    m_ndx += length;
+
+    return m_line;
+}
+
+
 INPUTSTREAM_LINE_READER::INPUTSTREAM_LINE_READER( wxInputStream* aStream, const wxString& aSource ) :
     LINE_READER( LINE_READER_LINE_DEFAULT_MAX ),
     m_stream( aStream )
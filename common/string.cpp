@@ -31,6 +31,17 @@
 #include <richio.h>                        // StrPrintf
 #include <kicad_string.h>
 
+#include <clocale>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <locale>
+#include <sstream>
+
+#if defined( __APPLE__ )
+#include <xlocale.h>
+#endif
+
 
 /**
  * Illegal file name characters used to insure file names will be valid on all supported
@@ -226,6 +237,168 @@ char* GetLine( FILE* File, char* Line, int* LineNum, int SizeLine )
 }
 
 
+const char* ParseDouble( const char* aStart, const char* aEnd, double& aValue )
+{
+    // The powers of ten which are exactly represented by a double
+    static const double powersOfTen[] =
+    {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    const char* cp = aStart;
+    bool        negative = false;
+    bool        sawDigit = false;
+    bool        exact = true;       // false when non zero digits did not fit in the mantissa
+    uint64_t    mantissa = 0;
+    int         digits = 0;         // significant digits in the mantissa
+    int         exponent = 0;
+
+    if( cp < aEnd && ( *cp == '-' || *cp == '+' ) )
+        negative = *cp++ == '-';
+
+    for( ; cp < aEnd && *cp >= '0' && *cp <= '9'; ++cp )
+    {
+        sawDigit = true;
+
+        if( digits < 19 )
+        {
+            mantissa = mantissa * 10 + ( *cp - '0' );
+
+            if( mantissa )
+                ++digits;
+        }
+        else
+        {
+            ++exponent;
+            exact = exact && *cp == '0';
+        }
+    }
+
+    if( cp < aEnd && *cp == '.' )
+    {
+        for( ++cp; cp < aEnd && *cp >= '0' && *cp <= '9'; ++cp )
+        {
+            sawDigit = true;
+
+            if( digits < 19 )
+            {
+                mantissa = mantissa * 10 + ( *cp - '0' );
+                --exponent;
+
+                if( mantissa )
+                    ++digits;
+            }
+            else
+            {
+                exact = exact && *cp == '0';
+            }
+        }
+    }
+
+    if( !sawDigit )
+    {
+        aValue = 0.0;
+        return aStart;
+    }
+
+    // An exponent without digits is not a part of the number
+    if( cp < aEnd && ( *cp == 'e' || *cp == 'E' ) )
+    {
+        const char* ep = cp + 1;
+        bool        negativeExp = false;
+
+        if( ep < aEnd && ( *ep == '-' || *ep == '+' ) )
+            negativeExp = *ep++ == '-';
+
+        if( ep < aEnd && *ep >= '0' && *ep <= '9' )
+        {
+            int value = 0;
+
+            for( ; ep < aEnd && *ep >= '0' && *ep <= '9'; ++ep )
+            {
+                if( value < 100000 )
+                    value = value * 10 + ( *ep - '0' );
+            }
+
+            exponent += negativeExp ? -value : value;
+            cp = ep;
+        }
+    }
+
+    if( mantissa == 0 )
+    {
+        aValue = negative ? -0.0 : 0.0;
+    }
+    else if( exact && mantissa <= ( UINT64_C( 1 ) << 53 ) && exponent >= -22 && exponent <= 22 )
+    {
+        // Both operands are exact, so the result is correctly rounded
+        aValue = (double) mantissa;
+
+        if( exponent < 0 )
+            aValue /= powersOfTen[-exponent];
+        else
+            aValue *= powersOfTen[exponent];
+
+        if( negative )
+            aValue = -aValue;
+    }
+    else
+    {
+        // Too many digits or a large exponent: rare enough to use the slow conversion
+        std::istringstream text( std::string( aStart, cp ) );
+
+        text.imbue( std::locale::classic() );
+        text >> aValue;
+
+        if( text.fail() )
+            aValue = negative ? -HUGE_VAL : HUGE_VAL;
+    }
+
+    return cp;
+}
+
+
+const char* ParseDoubleToken( const char* aLine, double& aValue )
+{
+    while( *aLine && isspace( *aLine ) )
+        aLine++;
+
+    const char* next = ParseDouble( aLine, aLine + strlen( aLine ), aValue );
+
+    while( *next && isspace( *next ) )
+        next++;
+
+    return next;
+}
+
+
+int FormatDouble( char* aBuffer, size_t aSize, const char* aFormat, double aValue )
+{
+    // Print with a C locale object rather than the global locale, which another thread
+    // may be switching with LOCALE_IO.  The locale is created once and never freed.
+#if defined( _WIN32 )
+    static _locale_t cLocale = _create_locale( LC_NUMERIC, "C" );
+
+    int len = _snprintf_s_l( aBuffer, aSize, _TRUNCATE, aFormat, cLocale, aValue );
+
+    // Return the length of the whole text on truncation, as snprintf()
+    if( len < 0 )
+        len = _scprintf_l( aFormat, cLocale, aValue );
+#else
+    // uselocale() only changes the locale of the calling thread
+    static locale_t cLocale = newlocale( LC_ALL_MASK, "C", (locale_t) 0 );
+
+    locale_t previous = uselocale( cLocale );
+    int      len = snprintf( aBuffer, aSize, aFormat, aValue );
+
+    uselocale( previous );
+#endif
+
+    return len;
+}
+
+
 wxString DateAndTime()
 {
     wxDateTime datetime = wxDateTime::Now();
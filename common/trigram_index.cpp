@@ -0,0 +1,167 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <trigram_index.h>
+
+#include <algorithm>
+#include <iterator>
+
+
+// The characters are unicode code points, which fit in 21 bits.  The code point 0 pads
+// the last trigram of a text, so that every substring of two characters is the prefix of
+// a trigram.
+static const int      codeBits = 21;
+static const uint32_t codeMask = ( 1 << codeBits ) - 1;
+
+
+static void toCodes( const wxString& aText, std::vector<uint32_t>& aCodes )
+{
+    aCodes.clear();
+
+    for( wxString::const_iterator it = aText.begin(); it != aText.end(); ++it )
+        aCodes.push_back( (uint32_t) ( *it ).GetValue() & codeMask );
+}
+
+
+TRIGRAM_INDEX::TRIGRAM_INDEX() :
+    m_lastItem( 0 )
+{
+}
+
+
+uint64_t TRIGRAM_INDEX::trigramKey( uint32_t aFirst, uint32_t aSecond, uint32_t aThird )
+{
+    return ( (uint64_t) aFirst << ( 2 * codeBits ) ) | ( (uint64_t) aSecond << codeBits ) | aThird;
+}
+
+
+void TRIGRAM_INDEX::Clear()
+{
+    m_postings.clear();
+    m_keys.clear();
+    m_lastItem = 0;
+}
+
+
+void TRIGRAM_INDEX::Add( unsigned aItem, const wxString& aText )
+{
+    wxASSERT( aItem >= m_lastItem );
+    m_lastItem = aItem;
+
+    std::vector<uint32_t> codes;
+
+    toCodes( aText, codes );
+
+    if( codes.size() < 2 )
+        return;
+
+    codes.push_back( 0 );
+
+    for( size_t i = 0; i + 2 < codes.size(); ++i )
+    {
+        POSTING_LIST& items = m_postings[ trigramKey( codes[i], codes[i + 1], codes[i + 2] ) ];
+
+        // The items come in increasing order, so a repeated trigram is at the end
+        if( items.empty() || items.back() != aItem )
+            items.push_back( aItem );
+    }
+}
+
+
+void TRIGRAM_INDEX::Build()
+{
+    m_keys.clear();
+    m_keys.reserve( m_postings.size() );
+
+    for( const auto& posting : m_postings )
+        m_keys.push_back( posting.first );
+
+    std::sort( m_keys.begin(), m_keys.end() );
+}
+
+
+bool TRIGRAM_INDEX::Find( const wxString& aTerm, std::vector<unsigned>& aItems ) const
+{
+    std::vector<uint32_t> codes;
+
+    toCodes( aTerm, codes );
+    aItems.clear();
+
+    if( codes.size() < 2 )
+        return false;
+
+    if( codes.size() == 2 )
+    {
+        // The term is the prefix of the trigrams of the matching texts
+        uint64_t first = trigramKey( codes[0], codes[1], 0 );
+        uint64_t last = trigramKey( codes[0], codes[1], codeMask );
+
+        for( auto it = std::lower_bound( m_keys.begin(), m_keys.end(), first );
+             it != m_keys.end() && *it <= last; ++it )
+        {
+            const POSTING_LIST& items = m_postings.at( *it );
+            aItems.insert( aItems.end(), items.begin(), items.end() );
+        }
+
+        std::sort( aItems.begin(), aItems.end() );
+        aItems.erase( std::unique( aItems.begin(), aItems.end() ), aItems.end() );
+        return true;
+    }
+
+    // A matching text has all the trigrams of the term: intersect their items, starting
+    // with the rarest trigram
+    std::vector<const POSTING_LIST*> lists;
+
+    for( size_t i = 0; i + 2 < codes.size(); ++i )
+    {
+        auto it = m_postings.find( trigramKey( codes[i], codes[i + 1], codes[i + 2] ) );
+
+        if( it == m_postings.end() )
+            return true;
+
+        lists.push_back( &it->second );
+    }
+
+    std::sort( lists.begin(), lists.end(),
+               []( const POSTING_LIST* a, const POSTING_LIST* b )
+               {
+                   return a->size() < b->size();
+               } );
+
+    aItems = *lists[0];
+
+    std::vector<unsigned> intersection;
+
+    for( size_t i = 1; i < lists.size() && !aItems.empty(); ++i )
+    {
+        if( lists[i] == lists[i - 1] )
+            continue;
+
+        intersection.clear();
+        std::set_intersection( aItems.begin(), aItems.end(), lists[i]->begin(), lists[i]->end(),
+                               std::back_inserter( intersection ) );
+        aItems.swap( intersection );
+    }
+
+    return true;
+}
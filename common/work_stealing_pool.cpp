@@ -0,0 +1,323 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+
+#include <wx/log.h>
+#include <wx/utils.h>
+
+#include <widgets/progress_reporter.h>
+#include <work_stealing_pool.h>
+
+
+WORK_STEALING_POOL::WORK_STEALING_POOL( size_t aThreadCount ) :
+    m_nextQueue( 0 ),
+    m_generation( 0 ),
+    m_quit( false )
+{
+    if( aThreadCount == 0 )
+        aThreadCount = std::max( (size_t) std::thread::hardware_concurrency(), (size_t) 2 );
+
+    for( size_t ii = 0; ii < aThreadCount; ++ii )
+        m_queues.emplace_back( new WORKER_QUEUE );
+
+    m_threads.reserve( aThreadCount );
+
+    for( size_t ii = 0; ii < aThreadCount; ++ii )
+        m_threads.push_back( std::thread( &WORK_STEALING_POOL::workerLoop, this, ii ) );
+}
+
+
+WORK_STEALING_POOL::~WORK_STEALING_POOL()
+{
+    {
+        std::lock_guard<std::mutex> lock( m_idleLock );
+        m_quit = true;
+    }
+
+    m_idle.notify_all();
+
+    for( auto& thread : m_threads )
+        thread.join();
+}
+
+
+int WORK_STEALING_POOL::workerIndex() const
+{
+    std::thread::id id = std::this_thread::get_id();
+
+    for( size_t ii = 0; ii < m_threads.size(); ++ii )
+    {
+        if( m_threads[ii].get_id() == id )
+            return (int) ii;
+    }
+
+    return -1;
+}
+
+
+bool WORK_STEALING_POOL::takeTask( int aIndex, TASK& aTask )
+{
+    // The newest task of our own queue first: its data is likely still in the cache
+    {
+        WORKER_QUEUE& own = *m_queues[aIndex];
+        std::lock_guard<std::mutex> lock( own.m_lock );
+
+        if( !own.m_tasks.empty() )
+        {
+            aTask = std::move( own.m_tasks.back() );
+            own.m_tasks.pop_back();
+            return true;
+        }
+    }
+
+    // Then the oldest task of another queue, which is usually the biggest one
+    for( size_t ii = 1; ii < m_queues.size(); ++ii )
+    {
+        WORKER_QUEUE& victim = *m_queues[( aIndex + ii ) % m_queues.size()];
+        std::lock_guard<std::mutex> lock( victim.m_lock );
+
+        if( !victim.m_tasks.empty() )
+        {
+            aTask = std::move( victim.m_tasks.front() );
+            victim.m_tasks.pop_front();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+void WORK_STEALING_POOL::workerLoop( size_t aIndex )
+{
+    TASK task;
+
+    while( !m_quit.load() )
+    {
+        size_t generation = m_generation.load();
+
+        if( takeTask( (int) aIndex, task ) )
+        {
+            task();
+            task = nullptr;
+            continue;
+        }
+
+        // Tasks queued since the queues were checked change the generation, so their
+        // notification cannot be missed
+        std::unique_lock<std::mutex> lock( m_idleLock );
+        m_idle.wait_for( lock, std::chrono::milliseconds( 10 ), [&]()
+                {
+                    return m_quit.load() || m_generation.load() != generation;
+                } );
+    }
+}
+
+
+void WORK_STEALING_POOL::queueTasks( std::vector<TASK>&& aTasks )
+{
+    int self = workerIndex();
+
+    {
+        std::lock_guard<std::mutex> idleLock( m_idleLock );
+
+        for( TASK& task : aTasks )
+        {
+            size_t queue = self >= 0 ? (size_t) self : m_nextQueue.fetch_add( 1 ) % m_queues.size();
+            std::lock_guard<std::mutex> lock( m_queues[queue]->m_lock );
+
+            m_queues[queue]->m_tasks.push_back( std::move( task ) );
+        }
+
+        m_generation.fetch_add( 1 );
+    }
+
+    m_idle.notify_all();
+}
+
+
+/**
+ * The state of a set of tasks started by Run().  It is shared with the queued tasks, which
+ * can be dequeued after Run() has returned when the caller has run them itself.
+ */
+struct RUN_BATCH
+{
+    RUN_BATCH( size_t aCount ) :
+        m_pending( aCount ),
+        m_cancelled( false ),
+        m_claimed( new std::atomic<bool>[aCount] )
+    {
+        for( size_t ii = 0; ii < aCount; ++ii )
+            m_claimed[ii] = false;
+    }
+
+    /// Runs a task, unless it was already claimed by another thread
+    void RunTask( size_t aIndex, WORK_STEALING_POOL::TASK* aTask )
+    {
+        if( m_claimed[aIndex].exchange( true ) )
+            return;
+
+        if( !m_cancelled.load() )
+        {
+            try
+            {
+                ( *aTask )();
+            }
+            catch( ... )
+            {
+                std::lock_guard<std::mutex> lock( m_lock );
+
+                if( !m_error )
+                    m_error = std::current_exception();
+            }
+        }
+
+        if( m_pending.fetch_sub( 1 ) == 1 )
+        {
+            std::lock_guard<std::mutex> lock( m_lock );
+            m_done.notify_all();
+        }
+    }
+
+    std::atomic<size_t>                  m_pending;
+    std::atomic<bool>                    m_cancelled;
+    std::unique_ptr<std::atomic<bool>[]> m_claimed;
+    std::exception_ptr                   m_error;       ///< The first exception thrown
+    std::mutex                           m_lock;
+    std::condition_variable              m_done;
+};
+
+
+bool WORK_STEALING_POOL::Run( std::vector<TASK>& aTasks, PROGRESS_REPORTER* aReporter,
+                              bool aCancellable )
+{
+    if( aTasks.empty() )
+        return true;
+
+    auto                batch = std::make_shared<RUN_BATCH>( aTasks.size() );
+    int                 self = workerIndex();
+    std::vector<TASK>   wrapped;
+
+    for( size_t ii = 0; ii < aTasks.size(); ++ii )
+    {
+        TASK* task = &aTasks[ii];
+
+        // The task itself is only used before its batch is completed
+        wrapped.push_back( [batch, ii, task]()
+                {
+                    batch->RunTask( ii, task );
+                } );
+    }
+
+    queueTasks( std::move( wrapped ) );
+
+    if( self >= 0 )
+    {
+        // A worker waiting for its subtasks helps to run them, or any other task
+        TASK task;
+
+        while( batch->m_pending.load() > 0 )
+        {
+            if( takeTask( self, task ) )
+            {
+                task();
+                task = nullptr;
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+    else if( aReporter )
+    {
+        // The reporter must be refreshed from this thread while the workers run the tasks
+        while( batch->m_pending.load() > 0 )
+        {
+            if( !aReporter->KeepRefreshing() && aCancellable )
+                batch->m_cancelled = true;
+        }
+    }
+    else
+    {
+        // The caller runs the tasks of its own batch which are not started yet, then
+        // waits for the ones run by the workers
+        for( size_t ii = 0; ii < aTasks.size(); ++ii )
+            batch->RunTask( ii, &aTasks[ii] );
+
+        std::unique_lock<std::mutex> lock( batch->m_lock );
+        batch->m_done.wait( lock, [&]() { return batch->m_pending.load() == 0; } );
+    }
+
+    if( batch->m_error )
+        std::rethrow_exception( batch->m_error );
+
+    return !batch->m_cancelled.load();
+}
+
+
+static size_t            s_maxThreads = 0;
+static std::atomic<bool> s_poolStarted( false );
+
+
+bool WORK_STEALING_POOL::SetMaxThreads( size_t aThreadCount )
+{
+    if( s_poolStarted.load() )
+    {
+        wxLogWarning( "The thread pool is already started with %u threads, the limit of %u "
+                      "threads is ignored.",
+                      (unsigned) GetThreadPool().GetThreadCount(), (unsigned) aThreadCount );
+        return false;
+    }
+
+    s_maxThreads = aThreadCount;
+    return true;
+}
+
+
+WORK_STEALING_POOL& GetThreadPool()
+{
+    static WORK_STEALING_POOL* pool = nullptr;
+    static std::once_flag      started;
+
+    std::call_once( started, []()
+            {
+                size_t   threadCount = s_maxThreads;
+                wxString envValue;
+                long     envThreads;
+
+                if( !threadCount && wxGetEnv( "KICAD_MAX_THREADS", &envValue )
+                        && envValue.ToLong( &envThreads ) && envThreads > 0 )
+                    threadCount = (size_t) envThreads;
+
+                // Never deleted: joining the workers from a static destructor can deadlock
+                // when the module is unloaded, and the system stops them at exit anyway.
+                pool = new WORK_STEALING_POOL( threadCount );
+                s_poolStarted = true;
+            } );
+
+    return *pool;
+}
@@ -304,9 +304,122 @@ CMP_TREE_NODE_LIB& CMP_TREE_NODE_ROOT::AddLib( wxString const& aName, wxString c
 }
 
 
+void CMP_TREE_NODE_ROOT::updateIndex()
+{
+    size_t ii = 0;
+    bool   valid = true;
+
+    // Nodes are never updated in place without clearing SearchTextNormalized, and the
+    // index normalizes all of them, so comparing the nodes is enough to detect a change.
+    for( auto& lib: Children )
+    {
+        for( auto& alias: lib->Children )
+        {
+            if( ii >= m_indexed.size() || m_indexed[ii] != alias.get()
+                    || !alias->SearchTextNormalized )
+            {
+                valid = false;
+                break;
+            }
+
+            ++ii;
+        }
+
+        if( !valid )
+            break;
+    }
+
+    if( valid && ii == m_indexed.size() )
+        return;
+
+    m_index.Clear();
+    m_indexed.clear();
+
+    for( auto& lib: Children )
+    {
+        for( auto& alias: lib->Children )
+        {
+            if( !alias->SearchTextNormalized )
+            {
+                alias->SearchText = alias->SearchText.Lower();
+                alias->SearchTextNormalized = true;
+            }
+
+            m_index.Add( m_indexed.size(), alias->MatchName );
+            m_index.Add( m_indexed.size(), alias->SearchText );
+            m_indexed.push_back( alias.get() );
+        }
+    }
+
+    m_index.Build();
+}
+
+
+/**
+ * Returns true if all the matchers of EDA_COMBINED_MATCHER find aTerm as a plain
+ * substring: it is neither a regular expression, nor a wildcard nor a relation.
+ */
+static bool isPlainSubstring( const wxString& aTerm )
+{
+    static const wxString special = wxT( ".*+?^${}()|[]\\<=>" );
+
+    for( wxString::const_iterator it = aTerm.begin(); it != aTerm.end(); ++it )
+    {
+        if( special.Find( *it ) != wxNOT_FOUND )
+            return false;
+    }
+
+    return true;
+}
+
+
 void CMP_TREE_NODE_ROOT::UpdateScore( EDA_COMBINED_MATCHER& aMatcher )
 {
-    for( auto& child: Children )
-        child->UpdateScore( aMatcher );
+    updateIndex();
+
+    std::vector<unsigned> candidates;
+
+    if( !isPlainSubstring( aMatcher.GetPattern() )
+            || !m_index.Find( aMatcher.GetPattern(), candidates ) )
+    {
+        for( auto& child: Children )
+            child->UpdateScore( aMatcher );
+
+        return;
+    }
+
+    // The aliases which are not candidates match neither by name nor by search text, so
+    // the full search would zero their score unless their library name matches.
+    std::vector<bool> isCandidate( m_indexed.size(), false );
+
+    for( unsigned ii : candidates )
+        isCandidate[ii] = true;
+
+    size_t ii = 0;
+
+    for( auto& lib: Children )
+    {
+        int matchers_fired;
+        int found_pos;
+
+        if( aMatcher.Find( lib->MatchName, matchers_fired, found_pos ) )
+        {
+            lib->UpdateScore( aMatcher );
+            ii += lib->Children.size();
+            continue;
+        }
+
+        lib->Score = 0;
+
+        for( auto& alias: lib->Children )
+        {
+            if( isCandidate[ii++] )
+                alias->UpdateScore( aMatcher );
+            else
+                alias->Score = 0;
+
+            lib->Score = std::max( lib->Score, alias->Score );
+        }
+    }
 }
 
@@ -26,6 +26,7 @@
 #include <memory>
 #include <wx/string.h>
 #include <lib_id.h>
+#include <trigram_index.h>
 
 
 class EDA_COMBINED_MATCHER;
@@ -281,7 +282,22 @@ public:
      */
     CMP_TREE_NODE_LIB& AddLib( wxString const& aName, wxString const& aDesc );
 
+    /**
+     * Update the scores of the whole tree.  When the search term is a plain substring,
+     * the aliases which can't contain it are found in a trigram index of their
+     * MatchName and SearchText, and discarded without running the matchers.
+     */
     virtual void UpdateScore( EDA_COMBINED_MATCHER& aMatcher ) override;
+
+private:
+    /**
+     * Rebuild the search index if aliases were added, removed or updated since it was
+     * built.
+     */
+    void updateIndex();
+
+    TRIGRAM_INDEX               m_index;        ///< Trigrams of the aliases
+    std::vector<CMP_TREE_NODE*> m_indexed;      ///< The aliases in m_index, in tree order
 };
 
 
@@ -24,8 +24,17 @@
 #include <eda_pattern_match.h>
 #include <wx/tokenzr.h>
 #include <symbol_lib_table.h>
+#include <sync_queue.h>
+#include <template_fieldnames.h>
+#include <work_stealing_pool.h>
 #include <wx/progdlg.h>
 
+#include <atomic>
+#include <exception>
+#include <future>
+
+#define PROGRESS_INTERVAL_MILLIS 66
+
 CMP_TREE_MODEL_ADAPTER_BASE::PTR CMP_TREE_MODEL_ADAPTER::Create( SYMBOL_LIB_TABLE* aLibs )
 {
     auto adapter = new CMP_TREE_MODEL_ADAPTER( aLibs );
@@ -68,6 +77,148 @@ void CMP_TREE_MODEL_ADAPTER::AddLibrary( wxString const& aLibNickname )
 }
 
 
+void CMP_TREE_MODEL_ADAPTER::AddLibrariesWithProgress(
+        const std::vector<wxString>& aNicknames, wxWindow* aParent )
+{
+    struct LOADED_LIB
+    {
+        wxString                m_nickname;
+        std::vector<LIB_ALIAS*> m_aliases;
+        bool                    m_failed = false;
+        wxString                m_error;
+    };
+
+    bool onlyPowerSymbols = ( GetFilter() == CMP_FILTER_POWER );
+
+    // The library table builds its index and instantiates the plugins lazily: do it here,
+    // so the worker threads only read the table.  Each library has its own plugin, so
+    // the libraries can be loaded concurrently.
+    std::vector<wxString> nicknames;
+
+    for( const auto& nickname : aNicknames )
+    {
+        try
+        {
+            m_libs->FindRow( nickname );
+            nicknames.push_back( nickname );
+        }
+        catch( const IO_ERROR& ioe )
+        {
+            wxLogError( wxString::Format( _( "Error occurred loading symbol library %s."
+                                             "\n\n%s" ), nickname, ioe.What() ) );
+        }
+    }
+
+    // Fetch the translated default field names before the parts are built in parallel
+    TEMPLATE_FIELDNAME::GetDefaultFieldName( 0 );
+
+    SYNC_QUEUE<LOADED_LIB>         loaded;
+    std::atomic<bool>              cancelled( false );
+    std::vector<std::future<void>> loaders;
+
+    for( const auto& nickname : nicknames )
+    {
+        loaders.push_back( GetThreadPool().Submit(
+                [this, nickname, onlyPowerSymbols, &loaded, &cancelled]() {
+                    LOADED_LIB lib;
+
+                    lib.m_nickname = nickname;
+
+                    if( !cancelled )
+                    {
+                        try
+                        {
+                            m_libs->LoadSymbolLib( lib.m_aliases, nickname, onlyPowerSymbols );
+                        }
+                        catch( const IO_ERROR& ioe )
+                        {
+                            lib.m_failed = true;
+                            lib.m_error = ioe.What();
+                        }
+                        catch( const std::exception& e )
+                        {
+                            lib.m_failed = true;
+                            lib.m_error = wxString::FromUTF8( e.what() );
+                        }
+                        catch( ... )
+                        {
+                            // Translated by the GUI thread
+                            lib.m_failed = true;
+                        }
+                    }
+
+                    // Always pushed, even on error: the loop below waits for every library
+                    loaded.move_push( std::move( lib ) );
+                } ) );
+    }
+
+    wxProgressDialog* prg = nullptr;
+    wxLongLong        nextUpdate = wxGetUTCTimeMillis() + (PROGRESS_INTERVAL_MILLIS / 2);
+
+    if( m_show_progress )
+        prg = new wxProgressDialog( _( "Loading Symbol Libraries" ),
+                                    wxEmptyString,
+                                    nicknames.size(),
+                                    aParent,
+                                    wxPD_APP_MODAL | wxPD_AUTO_HIDE | wxPD_CAN_ABORT );
+
+    // The model is only modified from this thread: the libraries are added as they come.
+    size_t finished = 0;
+
+    while( finished < nicknames.size() )
+    {
+        LOADED_LIB lib;
+
+        if( loaded.pop( lib ) )
+        {
+            ++finished;
+
+            if( lib.m_failed )
+            {
+                wxString error = lib.m_error.IsEmpty() ? _( "Unknown error." ) : lib.m_error;
+
+                wxLogError( wxString::Format( _( "Error occurred loading symbol library %s."
+                                                 "\n\n%s" ), lib.m_nickname, error ) );
+            }
+            else if( lib.m_aliases.size() > 0 )
+            {
+                AddAliasList( lib.m_nickname, m_libs->GetDescription( lib.m_nickname ),
+                              lib.m_aliases );
+            }
+
+            if( prg && !cancelled && wxGetUTCTimeMillis() > nextUpdate )
+            {
+                if( !prg->Update( finished, wxString::Format( _( "Loaded library \"%s\"" ),
+                                                              lib.m_nickname ) ) )
+                    cancelled = true;
+
+                nextUpdate = wxGetUTCTimeMillis() + PROGRESS_INTERVAL_MILLIS;
+            }
+        }
+        else
+        {
+            // Keep the dialog responsive, and notice the cancellation, while waiting
+            if( prg && !cancelled && !prg->Update( finished ) )
+                cancelled = true;
+
+            wxMilliSleep( 10 );
+        }
+    }
+
+    for( auto& loader : loaders )
+        loader.wait();
+
+    if( prg )
+    {
+        prg->Destroy();
+
+        // Show the progress again for the libraries which were not loaded
+        if( !cancelled )
+            m_show_progress = false;
+    }
+}
+
+
 void CMP_TREE_MODEL_ADAPTER::AddAliasList(
             wxString const&         aNodeName,
             wxArrayString const&    aAliasNameList )
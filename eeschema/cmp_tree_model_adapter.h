@@ -57,6 +57,17 @@ public:
      */
     void AddLibrary( wxString const& aLibNickname ) override;
 
+    /**
+     * Load the libraries in worker threads, adding each library to the model as soon as
+     * it is loaded.  The progress dialog allows the user to cancel the libraries not
+     * loaded yet, the model then holds the libraries loaded so far.
+     *
+     * @param aNicknames is the list of library nicknames
+     * @param aParent is the parent window to display the progress dialog
+     */
+    void AddLibrariesWithProgress( const std::vector<wxString>& aNicknames,
+            wxWindow* aParent ) override;
+
     /**
      * Add the given list of components, by name. To be called in the setup
      * phase.
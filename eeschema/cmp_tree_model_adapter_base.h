@@ -157,7 +157,7 @@ public:
      * @param aNicknames is the list of library nicknames
      * @param aParent is the parent window to display the progress dialog
      */
-    void AddLibrariesWithProgress( const std::vector<wxString>& aNicknames,
+    virtual void AddLibrariesWithProgress( const std::vector<wxString>& aNicknames,
             wxWindow* aParent );
 
     /**
@@ -336,6 +336,11 @@ protected:
             unsigned int            aCol,
             wxDataViewItemAttr&     aAttr ) const override;
 
+    /**
+     * Flag to only show the symbol library table load progress dialog the first time.
+     */
+    static bool        m_show_progress;
+
 private:
     CMP_FILTER_TYPE     m_filter;
     bool                m_show_units;
@@ -350,11 +355,6 @@ private:
 
     static WIDTH_CACHE m_width_cache;
 
-    /**
-     * Flag to only show the symbol library table load progress dialog the first time.
-     */
-    static bool        m_show_progress;
-
     /**
      * Compute the width required for the given column of a node and its
      * children.
@@ -22,6 +22,8 @@
 
 #include <ctype.h>
 #include <algorithm>
+#include <atomic>
+#include <cmath>
 
 #include <wx/mstream.h>
 #include <wx/filename.h>
@@ -241,25 +243,15 @@ static double parseDouble( FILE_LINE_READER& aReader, const char* aLine,
     if( !*aLine )
         SCH_PARSE_ERROR( _( "unexpected end of line" ), aReader, aLine );
 
-    // Clear errno before calling strtod() in case some other crt call set it.
-    errno = 0;
-
-    double retv = strtod( aLine, (char**) aOutput );
+    // The C locale number format, whatever the current locale
+    double retv;
+    const char* next = ParseDoubleToken( aLine, retv );
 
-    // Make sure no error occurred when calling strtod().
-    if( errno == ERANGE )
+    if( !std::isfinite( retv ) )
         SCH_PARSE_ERROR( "invalid floating point number", aReader, aLine );
 
-    // strtod does not strip off whitespace before the next token.
     if( aOutput )
-    {
-        const char* next = *aOutput;
-
-        while( *next && isspace( *next ) )
-            next++;
-
         *aOutput = next;
-    }
 
     return retv;
 }
@@ -469,7 +461,7 @@ static void parseQuotedString( wxString& aString, FILE_LINE_READER& aReader,
  */
 class SCH_LEGACY_PLUGIN_CACHE
 {
-    static int      m_modHash;      // Keep track of the modification status of the library.
+    static std::atomic<int> m_modHash;  // Keep track of the modification status of the library.
 
     wxString        m_fileName;     // Absolute path and file name.
     wxFileName      m_libFileName;  // Absolute path and file name is required here.
@@ -588,7 +580,6 @@ SCH_SHEET* SCH_LEGACY_PLUGIN::Load( const wxString& aFileName, KIWAY* aKiway,
 {
     wxASSERT( !aFileName || aKiway != NULL );
 
-    LOCALE_IO   toggle;     // toggles on, then off, the C locale.
     SCH_SHEET*  sheet;
 
     wxFileName fn = aFileName;
@@ -1940,7 +1931,10 @@ void SCH_LEGACY_PLUGIN::saveBitmap( SCH_BITMAP* aBitmap )
 
     m_out->Print( 0, "$Bitmap\n" );
     m_out->Print( 0, "Pos %-4d %-4d\n", aBitmap->GetPosition().x, aBitmap->GetPosition().y );
-    m_out->Print( 0, "Scale %f\n", aBitmap->GetImage()->GetScale() );
+    char scale[50];
+
+    FormatDouble( scale, sizeof( scale ), "%f", aBitmap->GetImage()->GetScale() );
+    m_out->Print( 0, "Scale %s\n", scale );
     m_out->Print( 0, "Data\n" );
 
     wxMemoryOutputStream stream;
@@ -2176,7 +2170,7 @@ void SCH_LEGACY_PLUGIN::saveText( SCH_TEXT* aText )
 }
 
 
-int SCH_LEGACY_PLUGIN_CACHE::m_modHash = 1;     // starts at 1 and goes up
+std::atomic<int> SCH_LEGACY_PLUGIN_CACHE::m_modHash( 1 );     // starts at 1 and goes up
 
 
 SCH_LEGACY_PLUGIN_CACHE::SCH_LEGACY_PLUGIN_CACHE( const wxString& aFullPathAndFileName ) :
@@ -3938,7 +3932,11 @@ void SCH_LEGACY_PLUGIN_CACHE::saveText( LIB_TEXT* aText,
         text.Replace( wxT( " " ), wxT( "~" ) );
     }
 
-    aFormatter->Print( 0, "T %g %d %d %d %d %d %d %s", aText->GetTextAngle(),
+    char angle[50];
+
+    FormatDouble( angle, sizeof( angle ), "%g", aText->GetTextAngle() );
+
+    aFormatter->Print( 0, "T %s %d %d %d %d %d %d %s", angle,
                        aText->GetTextPos().x, aText->GetTextPos().y,
                        aText->GetTextWidth(), !aText->IsVisible(),
                        aText->GetUnit(), aText->GetConvert(), TO_UTF8( text ) );
@@ -4102,8 +4100,6 @@ int SCH_LEGACY_PLUGIN::GetModifyHash() const
 size_t SCH_LEGACY_PLUGIN::GetSymbolLibCount( const wxString&   aLibraryPath,
                                              const PROPERTIES* aProperties )
 {
-    LOCALE_IO toggle;
-
     m_props = aProperties;
 
     cacheLib( aLibraryPath );
@@ -4116,8 +4112,6 @@ void SCH_LEGACY_PLUGIN::EnumerateSymbolLib( wxArrayString&    aAliasNameList,
                                             const wxString&   aLibraryPath,
                                             const PROPERTIES* aProperties )
 {
-    LOCALE_IO   toggle;     // toggles on, then off, the C locale.
-
     m_props = aProperties;
 
     bool powerSymbolsOnly = ( aProperties &&
@@ -4138,8 +4132,6 @@ void SCH_LEGACY_PLUGIN::EnumerateSymbolLib( std::vector<LIB_ALIAS*>& aAliasList,
                                             const wxString&   aLibraryPath,
                                             const PROPERTIES* aProperties )
 {
-    LOCALE_IO   toggle;     // toggles on, then off, the C locale.
-
     m_props = aProperties;
 
     bool powerSymbolsOnly = ( aProperties &&
@@ -4159,8 +4151,6 @@ void SCH_LEGACY_PLUGIN::EnumerateSymbolLib( std::vector<LIB_ALIAS*>& aAliasList,
 LIB_ALIAS* SCH_LEGACY_PLUGIN::LoadSymbol( const wxString& aLibraryPath, const wxString& aAliasName,
                                           const PROPERTIES* aProperties )
 {
-    LOCALE_IO toggle;     // toggles on, then off, the C locale.
-
     m_props = aProperties;
 
     cacheLib( aLibraryPath );
@@ -43,6 +43,7 @@
 #include <gal/color4d.h>
 
 #include <atomic>
+#include <mutex>
 
 // C++11 "polyfill" for the C++14 std::make_unique function
 #include "make_unique.h"
@@ -177,7 +178,11 @@ private:
 
     // The locale in use before switching to the "C" locale
     // (the locale can be set by user, and is not always the system locale)
-    std::string m_user_locale;
+    // Shared by the nested instances, which can be destroyed in any order across threads
+    static std::string m_user_locale;
+
+    // Serializes the locale switches of the instances created in different threads
+    static std::mutex m_lock;
 };
 
 
@@ -458,6 +458,17 @@ public:
      */
     void NeedRIGHT();
 
+    /**
+     * Function ReadSectionText
+     * reads the rest of the current section, up to and including the DSN_RIGHT which
+     * closes it, without tokenizing it, and appends its text to @a aText.  The end of
+     * lines are kept, so the text can be handed over to another lexer which reports
+     * the same line numbers.  Quoted strings follow the KiCad quoting rules.
+     * After this, the current token is the closing DSN_RIGHT.
+     * @throw IO_ERROR, if the file ends before the section.
+     */
+    void ReadSectionText( std::string& aText );
+
     /**
      * Function GetTokenText
      * returns the C string representation of a DSN_T value.
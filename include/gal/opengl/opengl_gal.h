@@ -37,6 +37,7 @@
 #include <gal/opengl/vertex_item.h>
 #include <gal/opengl/cached_container.h>
 #include <gal/opengl/noncached_container.h>
+#include <gal/opengl/vertex_staging.h>
 #include <gal/opengl/opengl_compositor.h>
 #include <gal/hidpi_gl_canvas.h>
 
@@ -288,6 +289,7 @@ private:
 
     static const int    CIRCLE_POINTS   = 64;   ///< The number of points for circle approximation
     static const int    CURVE_POINTS    = 32;   ///< The number of points for curve approximation
+    static const int    MIN_STAGED_POLYLINE_POINTS = 32;  ///< Shorter cached polylines are not staged
 
     static wxGLContext*     glMainContext;      ///< Parent OpenGL context
     wxGLContext*            glPrivContext;      ///< Canvas-specific OpenGL context
@@ -305,6 +307,8 @@ private:
     VERTEX_MANAGER*         cachedManager;          ///< Container for storing cached VERTEX_ITEMs
     VERTEX_MANAGER*         nonCachedManager;       ///< Container for storing non-cached VERTEX_ITEMs
     VERTEX_MANAGER*         overlayManager;         ///< Container for storing overlaid VERTEX_ITEMs
+    std::shared_ptr<VERTEX_ITEM> currentGroup;      ///< Group being drawn, if any
+    VERTEX_STAGING          staging;                ///< Polylines of the groups tessellated at EndUpdate()
 
     // Framebuffer & compositing
     OPENGL_COMPOSITOR*      compositor;             ///< Handles multiple rendering targets
@@ -322,6 +326,7 @@ private:
     bool                    isInitialized;              ///< Basic initialization flag, has to be done
                                                         ///< when the window is visible
     bool                    isGrouping;                 ///< Was a group started?
+    bool                    isStaging;                  ///< Are long polylines of the groups staged?
 
     ///< Update handler for OpenGL settings
     bool updatedGalDisplayOptions( const GAL_DISPLAY_OPTIONS& aOptions ) override;
@@ -58,6 +58,15 @@ public:
      */
     VERTEX_MANAGER( bool aCached );
 
+    /**
+     * @brief Constructor of a manager using the given container.
+     *
+     * @param aContainer is the container storing the vertices, it becomes owned by the manager.
+     * A manager using a NONCACHED_CONTAINER does not need an OpenGL context to store vertices,
+     * so it can serve as a staging buffer in a worker thread.
+     */
+    VERTEX_MANAGER( VERTEX_CONTAINER* aContainer );
+
     /**
      * Function Map()
      * maps vertex buffer.
@@ -120,6 +129,16 @@ public:
      */
     bool Vertices( const VERTEX aVertices[], unsigned int aSize );
 
+    /**
+     * Function BlankVertices()
+     * adds vertices set to zero to the currently set item. They draw nothing, and serve to
+     * reserve the place of vertices which are written later with SetItemVertices().
+     *
+     * @param aSize is the number of vertices to be added.
+     * @return True if successful, false otherwise.
+     */
+    bool BlankVertices( unsigned int aSize );
+
     /**
      * Function Color()
      * changes currently used color that will be applied to newly added vertices.
@@ -288,6 +307,20 @@ public:
      */
     void ChangeItemDepth( const VERTEX_ITEM& aItem, GLfloat aDepth ) const;
 
+    /**
+     * Function SetItemVertices()
+     * overwrites vertices of an item with already processed vertices. The coordinates, color
+     * & shader parameters stored in aVertices are kept, so it serves to copy the vertices
+     * prepared by another manager.
+     *
+     * @param aItem is the item whose vertices are overwritten.
+     * @param aOffset is the index of the first overwritten vertex in the item.
+     * @param aVertices contains the vertices to be copied.
+     * @param aSize is the number of vertices to be copied.
+     */
+    void SetItemVertices( const VERTEX_ITEM& aItem, unsigned int aOffset,
+                          const VERTEX aVertices[], unsigned int aSize ) const;
+
     /**
      * Function GetVertices()
      * returns a pointer to the vertices owned by an item.
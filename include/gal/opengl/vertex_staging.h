@@ -0,0 +1,151 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file vertex_staging.h
+ * @brief Class to tessellate the polylines of cached items on worker threads.
+ */
+
+#ifndef VERTEX_STAGING_H_
+#define VERTEX_STAGING_H_
+
+#include <gal/color4d.h>
+#include <math/vector2d.h>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace KIGFX
+{
+class VERTEX_ITEM;
+class VERTEX_MANAGER;
+
+/**
+ * @brief Class to tessellate the polylines of cached items in parallel.
+ *
+ * The polylines are queued with the item owning them while the items are drawn, and the
+ * place of their vertices is reserved in the item. Flush() tessellates them on the thread
+ * pool, each worker into its own staging buffer, then copies the vertices to their place
+ * from the calling thread, which is the only one accessing the cached container. The items
+ * end up with the same vertices, in the same order, as if the polylines were drawn
+ * immediately.
+ *
+ * The static functions are the tessellation routines shared with OPENGL_GAL.
+ */
+class VERTEX_STAGING
+{
+public:
+    VERTEX_STAGING();
+
+    /**
+     * Function AddPolyline()
+     * queues a polyline to be tessellated for an item, and reserves the place of its vertices
+     * in the item.
+     *
+     * @param aManager is the manager of the item, aItem being the item under modification.
+     * @param aItem is the item which receives the vertices. The polyline is dropped if the
+     * item is destroyed before Flush().
+     * @param aPoints are the points of the polyline, with identity transformation.
+     * @param aColor is the color of the polyline.
+     * @param aWidth is the line width.
+     * @param aDepth is the layer depth.
+     */
+    void AddPolyline( VERTEX_MANAGER& aManager, const std::shared_ptr<VERTEX_ITEM>& aItem,
+                      std::vector<VECTOR2D>&& aPoints, const COLOR4D& aColor, double aWidth,
+                      double aDepth );
+
+    /**
+     * Function Flush()
+     * tessellates the queued polylines, adds their vertices to their items using aManager
+     * and empties the queue. No item of aManager may be under modification.
+     *
+     * @param aManager is the manager of the items.
+     */
+    void Flush( VERTEX_MANAGER& aManager );
+
+    ///> Removes the queued polylines
+    void Clear();
+
+    ///> Returns true if there is no queued polyline
+    bool Empty() const
+    {
+        return m_polylines.empty();
+    }
+
+    /**
+     * Function DrawLineQuad()
+     * adds the quad of a line, whose width is maintained by the vertex shader.
+     */
+    static void DrawLineQuad( VERTEX_MANAGER& aManager, const VECTOR2D& aStartPoint,
+                              const VECTOR2D& aEndPoint, double aWidth, double aDepth );
+
+    /**
+     * Function DrawFilledSemiCircle()
+     * adds the triangle containing a filled semicircle, which is shaded by the vertex shader.
+     */
+    static void DrawFilledSemiCircle( VERTEX_MANAGER& aManager, const VECTOR2D& aCenterPoint,
+                                      double aRadius, double aAngle, double aDepth );
+
+    /**
+     * Function DrawPolyline()
+     * adds the line quads and the caps of a polyline, with the current color of aManager.
+     *
+     * @param aPointGetter is a function to obtain coordinates of n-th vertex.
+     * @param aPointCount is the number of points to be drawn.
+     */
+    static void DrawPolyline( VERTEX_MANAGER& aManager,
+                              const std::function<VECTOR2D (int)>& aPointGetter,
+                              int aPointCount, double aWidth, double aDepth );
+
+    ///> Returns the number of vertices added by DrawPolyline() for aPoints
+    static unsigned int PolylineVertexCount( const std::vector<VECTOR2D>& aPoints );
+
+private:
+    struct POLYLINE
+    {
+        std::weak_ptr<VERTEX_ITEM>  m_item;
+        std::vector<VECTOR2D>       m_points;
+        COLOR4D                     m_color;
+        double                      m_width;
+        double                      m_depth;
+
+        ///> Place reserved for the vertices in the item
+        unsigned int                m_itemOffset;
+        unsigned int                m_size;
+
+        ///> Location of the vertices in the staging buffers, set by Flush()
+        unsigned int                m_buffer;
+        unsigned int                m_offset;
+        bool                        m_done;
+    };
+
+    ///> Queued polylines, in the drawing order
+    std::vector<POLYLINE>   m_polylines;
+
+    ///> Number of points of the queued polylines
+    size_t                  m_pointCount;
+};
+} // namespace KIGFX
+
+#endif /* VERTEX_STAGING_H_ */
@@ -0,0 +1,104 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef __POLY_GRID_INDEX_H
+#define __POLY_GRID_INDEX_H
+
+#include <geometry/seg.h>
+#include <geometry/shape_line_chain.h>
+
+#include <vector>
+
+/**
+ * Class POLY_GRID_INDEX
+ *
+ * Splits the edges of a closed line chain into a rectangular grid, like
+ * POLY_GRID_PARTITION, to answer the point and segment queries of SHAPE_POLY_SET
+ * without looking at every edge.  Each query runs the same test as the linear version
+ * on the edges of the grid cells it covers, so the results are exactly the same.
+ *
+ * The index holds its own copy of the line chain, so it stays valid whatever happens
+ * to the original chain, but it must be rebuilt to see the changes of that chain.
+ */
+class POLY_GRID_INDEX
+{
+public:
+    POLY_GRID_INDEX( const SHAPE_LINE_CHAIN& aPath );
+
+    const BOX2I& BBox() const
+    {
+        return m_bbox;
+    }
+
+    int PointCount() const
+    {
+        return m_path.PointCount();
+    }
+
+    ///> Returns true if aP is inside the line chain or on its edge, with the same rules as
+    ///> SHAPE_POLY_SET::pointInPolygon()
+    bool PointInside( const VECTOR2I& aP ) const;
+
+    ///> Returns true if aP lies on an edge, like SHAPE_LINE_CHAIN::PointOnEdge()
+    bool PointOnEdge( const VECTOR2I& aP ) const;
+
+    ///> Returns the minimum distance between aP and the edges of the line chain
+    int Distance( const VECTOR2I& aP ) const;
+
+    ///> Returns the minimum distance between aSeg and the edges of the line chain
+    int Distance( const SEG& aSeg ) const;
+
+    ///> Returns true if an edge is closer than aClearance to aSeg (see SEG::Collide())
+    bool Collide( const SEG& aSeg, int aClearance ) const;
+
+private:
+    int cellX( int64_t aX ) const;
+    int cellY( int64_t aY ) const;
+
+    ///> Calls aFunc( edgeIndex ) for the edges of the cells covering the box aMin..aMax
+    ///> (enlarged by aMargin), until it returns true.  Edges spanning several cells may be
+    ///> visited more than once.
+    template <class FUNC>
+    bool visitEdges( const VECTOR2I& aMin, const VECTOR2I& aMax, int64_t aMargin,
+                     FUNC aFunc ) const;
+
+    ///> Returns the minimum of aDistance( edge ) for the edges near the box aMin..aMax,
+    ///> with aDistance an exact distance to the contents of the box
+    template <class FUNC>
+    int minDistance( const VECTOR2I& aMin, const VECTOR2I& aMax, FUNC aDistance ) const;
+
+    const SHAPE_LINE_CHAIN  m_path;
+    BOX2I                   m_bbox;
+    int                     m_cols = 1;
+    int                     m_rows = 1;
+
+    ///> Edges crossing each row of the grid, for the point in polygon test
+    std::vector<int>        m_rowStart;
+    std::vector<int>        m_rowEdges;
+
+    ///> Edges crossing each cell of the grid, row by row
+    std::vector<int>        m_cellStart;
+    std::vector<int>        m_cellEdges;
+};
+
+#endif // __POLY_GRID_INDEX_H
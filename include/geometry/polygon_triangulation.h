@@ -0,0 +1,123 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef __POLYGON_TRIANGULATION_H
+#define __POLYGON_TRIANGULATION_H
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include <geometry/shape_poly_set.h>
+
+/**
+ * Class POLYGON_TRIANGULATION
+ *
+ * Triangulates a polygon by ear clipping.  The holes are joined to the outline by
+ * bridges, so fractured polygons are triangulated as they are.  The vertices are linked
+ * in a list sorted along a Z-order curve, so the ear test only looks at the vertices
+ * close to each ear.
+ *
+ * The vertices are stored in a deque of plain structures: there is no heap object per
+ * vertex, and the triangles use the vertex indices of the input polygon.
+ */
+class POLYGON_TRIANGULATION
+{
+public:
+    POLYGON_TRIANGULATION( SHAPE_POLY_SET::TRIANGULATED_POLYGON& aResult ) :
+        m_result( aResult )
+    {
+    }
+
+    /**
+     * Function TesselatePolygon
+     * triangulates aPoly (an outline and its holes) into the result polygon.
+     * @return false if the input is degenerate (self-intersecting for instance) and the
+     * triangles do not cover it exactly: the result must then be discarded.
+     */
+    bool TesselatePolygon( const SHAPE_POLY_SET::POLYGON& aPoly );
+
+private:
+    struct VERTEX
+    {
+        VERTEX( int aIndex, int64_t aX, int64_t aY ) :
+            i( aIndex ), x( aX ), y( aY )
+        {
+        }
+
+        const int       i;              ///< index of the vertex in the result
+        const int64_t   x;
+        const int64_t   y;
+
+        VERTEX*         prev = nullptr; ///< previous and next vertices of the polygon
+        VERTEX*         next = nullptr;
+        VERTEX*         prevZ = nullptr;    ///< previous and next vertices in Z-order
+        VERTEX*         nextZ = nullptr;
+        uint32_t        z = 0;
+        bool            steiner = false;    ///< a hole reduced to a single point
+    };
+
+    VERTEX* insertVertex( int aIndex, const VECTOR2I& aPt, VERTEX* aLast );
+    void removeVertex( VERTEX* aVertex );
+
+    /// Links the points of a closed line chain, in the orientation of the outlines if
+    /// aOutline is true, or in the opposite orientation
+    VERTEX* createList( const SHAPE_LINE_CHAIN& aPoints, int aFirstIndex, bool aOutline );
+
+    VERTEX* removeNullTriangles( VERTEX* aStart, VERTEX* aEnd = nullptr );
+    VERTEX* eliminateHoles( const SHAPE_POLY_SET::POLYGON& aPoly, VERTEX* aOutline );
+    VERTEX* findHoleBridge( VERTEX* aHole, VERTEX* aOutline ) const;
+
+    void earcutList( VERTEX* aEar, int aPass = 0 );
+    bool isEar( VERTEX* aEar ) const;
+    VERTEX* cureLocalIntersections( VERTEX* aStart );
+    void splitPolygon( VERTEX* aStart );
+
+    VERTEX* splitAt( VERTEX* a, VERTEX* b );
+    bool goodSplit( const VERTEX* a, const VERTEX* b ) const;
+    bool intersectsPolygon( const VERTEX* a, const VERTEX* b ) const;
+    bool locallyInside( const VERTEX* a, const VERTEX* b ) const;
+    bool middleInside( const VERTEX* a, const VERTEX* b ) const;
+
+    void zOrderSort( VERTEX* aStart );
+    uint32_t zOrder( int64_t aX, int64_t aY ) const;
+
+    void addTriangle( const VERTEX* a, const VERTEX* b, const VERTEX* c )
+    {
+        SHAPE_POLY_SET::TRIANGULATED_POLYGON::TRI tri;
+
+        tri.a = a->i;
+        tri.b = b->i;
+        tri.c = c->i;
+        m_triangles.push_back( tri );
+    }
+
+    SHAPE_POLY_SET::TRIANGULATED_POLYGON&               m_result;
+    std::deque<VERTEX>                                  m_vertices;
+    std::vector<SHAPE_POLY_SET::TRIANGULATED_POLYGON::TRI> m_triangles;
+
+    BOX2I                                               m_bbox;
+    double                                              m_zScale = 0.0;
+};
+
+#endif // __POLYGON_TRIANGULATION_H
@@ -0,0 +1,113 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef __SEG_BATCH_H
+#define __SEG_BATCH_H
+
+#include <cstdint>
+#include <vector>
+
+#include <geometry/seg.h>
+
+class SHAPE_LINE_CHAIN;
+
+/**
+ * Class SEG_BATCH
+ *
+ * A set of segments stored as structure of arrays, to test one segment or point against
+ * all of them at once.  The distances are first estimated in double precision, several
+ * segments at a time with SSE2 or AVX2 when the processor has them, and the segments
+ * found close enough are then tested with the integer SEG methods: the results are
+ * exactly the ones of the per-pair tests.
+ */
+class SEG_BATCH
+{
+public:
+    typedef VECTOR2I::extended_type ecoord;
+
+    SEG_BATCH()
+    {
+    }
+
+    ///> Builds a batch of the segments of aChain
+    SEG_BATCH( const SHAPE_LINE_CHAIN& aChain );
+
+    void Add( const SEG& aSeg );
+    void Clear();
+
+    int Size() const
+    {
+        return m_segs.size();
+    }
+
+    const SEG& Segment( int aIndex ) const
+    {
+        return m_segs[aIndex];
+    }
+
+    /**
+     * Function Collide
+     * tests aSeg against all the segments of the batch with SEG::Collide().
+     * @param aHitMask if not null, receives for each segment of the batch 1 if it collides
+     *                 and 0 otherwise. If null, the test stops on the first collision.
+     * @return true if any segment collides with aSeg.
+     */
+    bool Collide( const SEG& aSeg, int aClearance, std::vector<uint8_t>* aHitMask = nullptr ) const;
+
+    /**
+     * Function SquaredDistance
+     * returns the minimum of SEG::SquaredDistance( aSeg ) over the segments of the batch,
+     * and the index of the closest segment in aIndex if not null.
+     */
+    ecoord SquaredDistance( const SEG& aSeg, int* aIndex = nullptr ) const;
+
+    ///> Same as above, with SEG::SquaredDistance( aP )
+    ecoord SquaredDistance( const VECTOR2I& aP, int* aIndex = nullptr ) const;
+
+    /**
+     * Function Candidates
+     * fills aIndices with the segments which may lie closer than aDistance to aSeg: all of
+     * them, plus a few slightly farther.  Used to run another exact test on the segments
+     * near aSeg only.
+     */
+    void Candidates( const SEG& aSeg, int aDistance, std::vector<int>& aIndices ) const;
+
+    ///> Name of the instruction set used by the estimates: "AVX2", "SSE2" or "scalar"
+    static const char* KernelName();
+
+private:
+    ///> Writes in aResult the estimated squared distances between aSeg and the segments
+    ///> aFirst to aFirst + aCount - 1
+    void estimate( const SEG& aSeg, int aFirst, int aCount, double* aResult ) const;
+
+    std::vector<SEG>    m_segs;
+
+    ///> Start point, direction and inverse squared length of the segments
+    std::vector<double> m_ax;
+    std::vector<double> m_ay;
+    std::vector<double> m_dx;
+    std::vector<double> m_dy;
+    std::vector<double> m_invLen;
+};
+
+#endif // __SEG_BATCH_H
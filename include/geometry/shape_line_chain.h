@@ -26,6 +26,7 @@
 #ifndef __SHAPE_LINE_CHAIN
 #define __SHAPE_LINE_CHAIN
 
+#include <memory>
 #include <vector>
 #include <sstream>
 
@@ -80,7 +81,10 @@ public:
      * Copy Constructor
      */
     SHAPE_LINE_CHAIN( const SHAPE_LINE_CHAIN& aShape ) :
-        SHAPE( SH_LINE_CHAIN ), m_points( aShape.m_points ), m_closed( aShape.m_closed )
+        SHAPE( SH_LINE_CHAIN ),
+        m_points( aShape.m_points ),
+        m_closed( aShape.m_closed ),
+        m_segmentCache( aShape.m_segmentCache )
     {}
 
     /**
@@ -138,6 +142,7 @@ public:
     {
         m_points.clear();
         m_closed = false;
+        m_segmentCache.reset();
     }
 
     /**
@@ -150,6 +155,7 @@ public:
     void SetClosed( bool aClosed )
     {
         m_closed = aClosed;
+        m_segmentCache.reset();
     }
 
     /**
@@ -240,6 +246,8 @@ public:
         if( aIndex < 0 )
             aIndex += PointCount();
 
+        m_segmentCache.reset();
+
         return m_points[aIndex];
     }
 
@@ -265,6 +273,8 @@ public:
      */
     VECTOR2I& LastPoint()
     {
+        m_segmentCache.reset();
+
         return m_points[PointCount() - 1];
     }
 
@@ -280,7 +290,11 @@ public:
     const BOX2I BBox( int aClearance = 0 ) const override
     {
         BOX2I bbox;
-        bbox.Compute( m_points );
+
+        if( m_segmentCache )
+            bbox = m_segmentCache->bbox;
+        else
+            bbox.Compute( m_points );
 
         if( aClearance != 0 )
             bbox.Inflate( aClearance );
@@ -367,6 +381,7 @@ public:
         {
             m_points.push_back( aP );
             m_bbox.Merge( aP );
+            m_segmentCache.reset();
         }
     }
 
@@ -381,7 +396,9 @@ public:
         if( aOtherLine.PointCount() == 0 )
             return;
 
-        else if( PointCount() == 0 || aOtherLine.CPoint( 0 ) != CPoint( -1 ) )
+        m_segmentCache.reset();
+
+        if( PointCount() == 0 || aOtherLine.CPoint( 0 ) != CPoint( -1 ) )
         {
             const VECTOR2I p = aOtherLine.CPoint( 0 );
             m_points.push_back( p );
@@ -399,6 +416,7 @@ public:
     void Insert( int aVertex, const VECTOR2I& aP )
     {
         m_points.insert( m_points.begin() + aVertex, aP );
+        m_segmentCache.reset();
     }
 
     /**
@@ -609,6 +627,8 @@ public:
     {
         for( std::vector<VECTOR2I>::iterator i = m_points.begin(); i != m_points.end(); ++i )
             (*i) += aVector;
+
+        m_segmentCache.reset();
     }
 
     /**
@@ -628,7 +648,39 @@ public:
 
     double Area() const;
 
+    /**
+     * Function CacheSegments()
+     *
+     * Computes the bounding boxes and the lengths of the segments once, for the length,
+     * bounding box, collision and nearest point queries of long line chains which are not
+     * modified for a while (e.g. the lines being tuned by the meander placers).  The cache
+     * is shared with the copies of the line chain and dropped by any modification.
+     */
+    void CacheSegments();
+
+    bool HasSegmentCache() const
+    {
+        return (bool) m_segmentCache;
+    }
+
 private:
+    /// returns true if the bounding box of segment aSegment shows that its Distance( aP )
+    /// is at least aDist. Needs the segment cache.
+    bool segmentFartherThan( int aSegment, const VECTOR2I& aP, int aDist ) const;
+
+    /// bounding boxes and path lengths kept by CacheSegments()
+    struct SEGMENT_CACHE
+    {
+        /// bounding box of the whole line chain
+        BOX2I bbox;
+
+        /// bounding box of each segment
+        std::vector<BOX2I> segmentBoxes;
+
+        /// length of the chain from its start to each point (SegmentCount() + 1 entries)
+        std::vector<int> pathLength;
+    };
+
     /// array of vertices
     std::vector<VECTOR2I> m_points;
 
@@ -637,6 +689,9 @@ private:
 
     /// cached bounding box
     BOX2I m_bbox;
+
+    /// segment bounding boxes and lengths, valid until the next modification
+    std::shared_ptr<const SEGMENT_CACHE> m_segmentCache;
 };
 
 #endif // __SHAPE_LINE_CHAIN
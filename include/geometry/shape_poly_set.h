@@ -29,8 +29,11 @@
 #include <vector>
 #include <cstdio>
 #include <memory>
+#include <mutex>
+#include <atomic>
 #include <geometry/shape.h>
 #include <geometry/shape_line_chain.h>
+#include <geometry/poly_grid_index.h>
 
 #include "clipper.hpp"
 
@@ -62,6 +65,8 @@ class SHAPE_POLY_SET : public SHAPE
 
         class TRIANGULATION_CONTEXT;
 
+        class BATCH;
+
         class TRIANGULATED_POLYGON
         {
         public:
@@ -224,7 +229,7 @@ class SHAPE_POLY_SET : public SHAPE
 
             T& Get()
             {
-                return m_poly->Polygon( m_currentPolygon )[m_currentContour].Point( m_currentVertex );
+                return m_poly->m_polys[m_currentPolygon][m_currentContour].Point( m_currentVertex );
             }
 
             T& operator*()
@@ -346,7 +351,7 @@ class SHAPE_POLY_SET : public SHAPE
 
             T Get()
             {
-                return m_poly->Polygon( m_currentPolygon )[m_currentContour].Segment( m_currentSegment );
+                return m_poly->m_polys[m_currentPolygon][m_currentContour].Segment( m_currentSegment );
             }
 
             T operator*()
@@ -568,6 +573,8 @@ class SHAPE_POLY_SET : public SHAPE
         ///> Returns the reference to aIndex-th outline in the set
         SHAPE_LINE_CHAIN& Outline( int aIndex )
         {
+            invalidateIndex();
+
             return m_polys[aIndex][0];
         }
 
@@ -590,12 +597,16 @@ class SHAPE_POLY_SET : public SHAPE
         ///> Returns the reference to aHole-th hole in the aIndex-th outline
         SHAPE_LINE_CHAIN& Hole( int aOutline, int aHole )
         {
+            invalidateIndex();
+
             return m_polys[aOutline][aHole + 1];
         }
 
         ///> Returns the aIndex-th subpolygon in the set
         POLYGON& Polygon( int aIndex )
         {
+            invalidateIndex();
+
             return m_polys[aIndex];
         }
 
@@ -637,6 +648,8 @@ class SHAPE_POLY_SET : public SHAPE
          */
         ITERATOR Iterate( int aFirst, int aLast, bool aIterateHoles = false )
         {
+            invalidateIndex();
+
             ITERATOR iter;
 
             iter.m_poly = this;
@@ -749,6 +762,8 @@ class SHAPE_POLY_SET : public SHAPE
         /// without holes (default: without)
         SEGMENT_ITERATOR IterateSegments( int aFirst, int aLast, bool aIterateHoles = false )
         {
+            invalidateIndex();
+
             SEGMENT_ITERATOR iter;
 
             iter.m_poly = this;
@@ -785,6 +800,35 @@ class SHAPE_POLY_SET : public SHAPE
             return IterateSegments( aOutline, aOutline, true );
         }
 
+        ///> Returns a constant iterator object, for iterating between aFirst and aLast outline,
+        ///> with or without holes (default: without)
+        CONST_SEGMENT_ITERATOR CIterateSegments( int aFirst, int aLast,
+                                                 bool aIterateHoles = false ) const
+        {
+            CONST_SEGMENT_ITERATOR iter;
+
+            iter.m_poly = const_cast<SHAPE_POLY_SET*>( this );
+            iter.m_currentPolygon = aFirst;
+            iter.m_lastPolygon = aLast < 0 ? OutlineCount() - 1 : aLast;
+            iter.m_currentContour = 0;
+            iter.m_currentSegment = 0;
+            iter.m_iterateHoles = aIterateHoles;
+
+            return iter;
+        }
+
+        ///> Returns a constant iterator object, for all outlines in the set (with holes)
+        CONST_SEGMENT_ITERATOR CIterateSegmentsWithHoles() const
+        {
+            return CIterateSegments( 0, OutlineCount() - 1, true );
+        }
+
+        ///> Returns a constant iterator object, for the aOutline-th outline in the set (with holes)
+        CONST_SEGMENT_ITERATOR CIterateSegmentsWithHoles( int aOutline ) const
+        {
+            return CIterateSegments( aOutline, aOutline, true );
+        }
+
         /** operations on polygons use a aFastMode param
          * if aFastMode is PM_FAST (true) the result can be a weak polygon
          * if aFastMode is PM_STRICTLY_SIMPLE (false) (default) the result is (theorically) a strictly
@@ -848,6 +892,17 @@ class SHAPE_POLY_SET : public SHAPE
         ///> For aFastMode meaning, see function booleanOp
         void Simplify( POLYGON_MODE aFastMode );
 
+        /**
+         * Function UnionMany
+         * merges this polygon set and all the sets of aPolySets, like appending them and
+         * calling Simplify(), but on all the cores: the polygons are sorted in spatial
+         * groups of fixed size which are merged by parallel tasks, and the partial results
+         * are merged two by two.  The result does not depend on the number of cores.
+         * An empty aPolySets simplifies this polygon set.
+         * For aFastMode meaning, see function booleanOp
+         */
+        void UnionMany( const std::vector<SHAPE_POLY_SET>& aPolySets, POLYGON_MODE aFastMode );
+
         /**
          * Function NormalizeAreaOutlines
          * Convert a self-intersecting polygon to one (or more) non self-intersecting polygon(s)
@@ -904,8 +959,15 @@ class SHAPE_POLY_SET : public SHAPE
          */
         bool Collide( const VECTOR2I& aP, int aClearance = 0 ) const override;
 
-        // fixme: add collision support
-        bool Collide( const SEG& aSeg, int aClearance = 0 ) const override { return false; }
+        /**
+         * Function Collide
+         * Checks whether the segment aSeg collides with the polygon set: if it crosses or
+         * comes closer than aClearance to an edge, or if it lies inside of a polygon.
+         * @param  aSeg       is the segment whose collision with the poly set will be tested.
+         * @param  aClearance is the security distance.
+         * @return bool - true if the segment collides with the polygon set.
+         */
+        bool Collide( const SEG& aSeg, int aClearance = 0 ) const override;
 
         /**
          * Function CollideVertex
@@ -1033,7 +1095,7 @@ class SHAPE_POLY_SET : public SHAPE
          * @return int -  The minimum distance between aPoint and all the segments of the aIndex-th
          *                polygon. If the point is contained in the polygon, the distance is zero.
          */
-        int DistanceToPolygon( VECTOR2I aPoint, int aIndex );
+        int DistanceToPolygon( VECTOR2I aPoint, int aIndex ) const;
 
         /**
          * Function DistanceToPolygon
@@ -1047,7 +1109,7 @@ class SHAPE_POLY_SET : public SHAPE
          *                  aIndex-th polygon. If the point is contained in the polygon, the
          *                  distance is zero.
          */
-        int DistanceToPolygon( SEG aSegment, int aIndex, int aSegmentWidth = 0 );
+        int DistanceToPolygon( SEG aSegment, int aIndex, int aSegmentWidth = 0 ) const;
 
         /**
          * Function DistanceToPolygon
@@ -1056,7 +1118,7 @@ class SHAPE_POLY_SET : public SHAPE
          * @return int -  The minimum distance between aPoint and all the polygons in the set. If
          *                the point is contained in any of the polygons, the distance is zero.
          */
-        int Distance( VECTOR2I aPoint );
+        int Distance( VECTOR2I aPoint ) const;
 
         /**
          * Function DistanceToPolygon
@@ -1066,7 +1128,7 @@ class SHAPE_POLY_SET : public SHAPE
          * @return int -    The minimum distance between aSegment and all the polygons in the set.
          *                  If the point is contained in the polygon, the distance is zero.
          */
-        int Distance( const SEG& aSegment, int aSegmentWidth = 0 );
+        int Distance( const SEG& aSegment, int aSegmentWidth = 0 ) const;
 
         /**
          * Function IsVertexInHole.
@@ -1107,8 +1169,13 @@ class SHAPE_POLY_SET : public SHAPE
 
         bool pointInPolygon( const VECTOR2I& aP, const SHAPE_LINE_CHAIN& aPath ) const;
 
-        const ClipperLib::Path convertToClipper( const SHAPE_LINE_CHAIN& aPath, bool aRequiredOrientation );
-        const SHAPE_LINE_CHAIN convertFromClipper( const ClipperLib::Path& aPath );
+        static const ClipperLib::Path convertToClipper( const SHAPE_LINE_CHAIN& aPath,
+                                                        bool aRequiredOrientation );
+        static const SHAPE_LINE_CHAIN convertFromClipper( const ClipperLib::Path& aPath );
+
+        ///> Returns the ClipperOffset arc tolerance giving aCircleSegmentsCount segments
+        ///> by circle for an inflation of aFactor
+        static double inflateArcTolerance( int aFactor, int aCircleSegmentsCount );
 
         /**
          * containsSingle function
@@ -1177,6 +1244,101 @@ class SHAPE_POLY_SET : public SHAPE
         bool m_triangulationValid = false;
         MD5_HASH m_hash;
 
+        ///> Grid indices of the contours of a polygon (nullptr for the empty contours)
+        typedef std::vector<std::unique_ptr<POLY_GRID_INDEX>> POLYGON_INDEX;
+
+        ///> A built index is never modified and holds copies of the contours: a query keeps
+        ///> the index it uses alive even if invalidateIndex() drops it meanwhile.  The set
+        ///> follows the usual rules of the containers otherwise: concurrent queries are safe,
+        ///> a modification of the set must not run concurrently with any other access.
+        typedef std::shared_ptr<const POLYGON_INDEX> POLYGON_INDEX_PTR;
+
+        /**
+         * Function polygonIndex
+         * returns the grid indices of the contours of the aIndex-th polygon, built on the
+         * first call.  Returns nullptr when the linear tests are cheaper: for small polygons
+         * and for the first queries after a change of the set.
+         */
+        POLYGON_INDEX_PTR polygonIndex( int aIndex ) const;
+
+        ///> Discards the grid indices.  Called by every method able to modify the contours,
+        ///> including the ones returning non-const references or iterators: these must not
+        ///> be used to modify the set after a query, which would be answered from the
+        ///> previous contours (polygonIndex() only catches a change of the point counts).
+        void invalidateIndex()
+        {
+            if( m_indexQueries > 0 )
+            {
+                std::lock_guard<std::mutex> lock( m_indexLock );
+
+                m_polygonIndices.clear();
+                m_indexQueries = 0;
+            }
+        }
+
+        mutable std::mutex                     m_indexLock;
+        mutable std::vector<POLYGON_INDEX_PTR> m_polygonIndices;
+        mutable std::atomic<int>               m_indexQueries { 0 };
+
+};
+
+
+/**
+ * Class SHAPE_POLY_SET::BATCH
+ * chains boolean and offset operations on a polygon set without converting it between
+ * SHAPE_POLY_SET and Clipper for each operation: the result of an operation is kept in
+ * the Clipper format and fed as is to the next one.  The polygon set is converted once
+ * to Clipper when the BATCH is built, and the result once back by GetResult().
+ *
+ * A BATCH can also be the operand of the operations of other BATCHes, for instance when
+ * the same holes are subtracted from many outlines.  An operand is only read, so several
+ * threads can use it at the same time.
+ */
+class SHAPE_POLY_SET::BATCH
+{
+public:
+    BATCH( const SHAPE_POLY_SET& aPolySet );
+
+    BATCH( const BATCH& ) = delete;
+    BATCH& operator=( const BATCH& ) = delete;
+
+    ///> For aFastMode meaning, see function SHAPE_POLY_SET::booleanOp
+    void BooleanAdd( const BATCH& aOther, POLYGON_MODE aFastMode );
+    void BooleanSubtract( const BATCH& aOther, POLYGON_MODE aFastMode );
+    void BooleanIntersection( const BATCH& aOther, POLYGON_MODE aFastMode );
+    void Simplify( POLYGON_MODE aFastMode );
+
+    ///> Performs outline inflation/deflation, using round corners.
+    void Inflate( int aFactor, int aCircleSegmentsCount );
+
+    /**
+     * Function GetResult
+     * converts the current polygon set to aResult.  If no operation was done, the
+     * polygon set is simplified to find which outline owns each hole.
+     */
+    void GetResult( SHAPE_POLY_SET& aResult ) const;
+
+private:
+    void booleanOp( ClipperLib::ClipType aType, const BATCH* aOther, POLYGON_MODE aFastMode );
+
+    ///> Calls aFunc for each path of the current polygon set, outlines and holes
+    template <class FUNC>
+    void forEachPath( FUNC aFunc ) const
+    {
+        if( m_tree )
+        {
+            for( ClipperLib::PolyNode* n = m_tree->GetFirst(); n; n = n->GetNext() )
+                aFunc( n->Contour );
+        }
+        else
+        {
+            for( const ClipperLib::Path& path : m_paths )
+                aFunc( path );
+        }
+    }
+
+    ClipperLib::Paths                       m_paths;    ///< the polygon set before any operation
+    std::unique_ptr<ClipperLib::PolyTree>   m_tree;     ///< the result of the last operation
 };
 
 #endif
@@ -46,6 +46,18 @@ enum HASH_FLAGS
     ALL         = 0xff
 };
 
+/**
+ * Combines the hash of a value into a hash seed, in the same way as boost::hash_combine().
+ * Unlike a XOR of the hashes, the result depends on the order of the values, so that
+ * swapped or offset coordinates do not cancel out.
+ * @param aSeed is the hash to update.
+ * @param aValue is the hash of the value.
+ */
+inline void hash_combine( std::size_t& aSeed, std::size_t aValue )
+{
+    aSeed ^= aValue + 0x9e3779b9 + ( aSeed << 6 ) + ( aSeed >> 2 );
+}
+
 /*
  * Calculates hash of an EDA_ITEM.
  * @param aItem is the item for which the hash will be computed.
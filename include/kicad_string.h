@@ -92,6 +92,46 @@ char* GetLine( FILE* aFile, char* Line, int* LineNum = NULL, int SizeLine = 255
  */
 char* StrPurge( char* text );
 
+/**
+ * Function ParseDouble
+ * reads a floating point number written in the C locale format, whatever the current
+ * locale: an optional sign, digits with an optional '.' and an optional exponent.
+ * The usual numbers are converted without calling the C library.
+ *
+ * @param aStart is the start of the text.
+ * @param aEnd is the end of the text, which does not need to be nul terminated.
+ * @param aValue receives the number.
+ * @return the end of the number in the text, or @a aStart if the text does not start
+ *   with a number.
+ */
+const char* ParseDouble( const char* aStart, const char* aEnd, double& aValue );
+
+/**
+ * Function ParseDoubleToken
+ * reads a number like ParseDouble() from a nul terminated line, skipping the whitespace
+ * before and after it, as the strtod() based token parsers do.
+ *
+ * @param aLine is the text, starting with optional whitespace.
+ * @param aValue receives the number, 0.0 if the text does not start with a number.
+ * @return the start of the next token.
+ */
+const char* ParseDoubleToken( const char* aLine, double& aValue );
+
+/**
+ * Function FormatDouble
+ * prints a floating point number like snprintf(), but in the C locale format whatever
+ * the current locale, so that files can be written without switching the global locale.
+ * The global locale is neither read nor changed, so it is safe to call while another
+ * thread switches it.
+ *
+ * @param aBuffer receives the nul terminated text.
+ * @param aSize is the size of @a aBuffer.
+ * @param aFormat is a printf format holding a single floating point conversion.
+ * @param aValue is the number to print.
+ * @return the length of the text, as snprintf().
+ */
+int FormatDouble( char* aBuffer, size_t aSize, const char* aFormat, double aValue );
+
 /**
  * Function DateAndTime
  * @return a string giving the current date and time.
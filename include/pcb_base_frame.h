@@ -45,6 +45,7 @@
 
 /* Forward declarations of classes. */
 class BOARD;
+class BOARD_ITEM;
 class BOARD_CONNECTED_ITEM;
 class MODULE;
 class TRACK;
@@ -307,6 +308,18 @@ public:
      */
     virtual void OnModify();
 
+    /**
+     * Function OnBoardItemsChanged
+     * Virtual
+     * Called by BOARD_COMMIT::Push() and by undo/redo after a set of board items has been
+     * changed.
+     * @param aDirtyAreas = the bounding boxes of the added and removed items, and of the
+     * modified items before and after the change
+     * @param aChangedItems = the items added, removed or modified
+     */
+    virtual void OnBoardItemsChanged( const std::vector<EDA_RECT>& aDirtyAreas,
+                                      const std::vector<BOARD_ITEM*>& aChangedItems ) { }
+
     // Modules (footprints)
 
     /**
@@ -85,6 +85,7 @@ public:
             return;
 
         m_stoptime = std::chrono::high_resolution_clock::now();
+        m_running = false;
     }
 
     /**
@@ -268,8 +268,12 @@ public:
      *
      * @param aSource describes the source of aString for error reporting purposes
      *  can be anything meaninful, such as wxT( "clipboard" ).
+     *
+     * @param aStartingLineNumber is the initial line number to report on error, when
+     *  aString is a part of a larger source.
      */
-    STRING_LINE_READER( const std::string& aString, const wxString& aSource );
+    STRING_LINE_READER( const std::string& aString, const wxString& aSource,
+                        unsigned aStartingLineNumber = 0 );
 
     /**
      * Constructor STRING_LINE_READER( const STRING_LINE_READER& )
@@ -283,6 +287,71 @@ public:
 };
 
 
+/**
+ * Class MMAP_LINE_READER
+ * is a LINE_READER that reads from a read only memory mapped file.  The mapping is
+ * never written to: each line is copied from it into the LINE_READER buffer, so only
+ * the current line is copied instead of going through the stdio buffers.
+ *
+ * Unlike FILE_LINE_READER, the file is read in binary mode: DOS line ends are
+ * returned as "\r\n".  The whole file is read into memory if it cannot be mapped.
+ */
+class MMAP_LINE_READER : public LINE_READER
+{
+protected:
+    const char*         m_data;         ///< the file contents, mapped or in m_fileBuffer
+    size_t              m_size;         ///< no. bytes in m_data
+    size_t              m_ndx;          ///< offset of the next line in m_data
+    bool                m_mapped;
+    std::vector<char>   m_fileBuffer;   ///< the file contents when not mapped
+    void*               m_mapping;      ///< the system handle of the mapping, if needed
+
+    /// Maps the file, and returns false if this is not possible
+    bool mapFile( const wxString& aFileName );
+
+    void unmapFile();
+
+public:
+
+    /**
+     * Constructor MMAP_LINE_READER
+     * maps @a aFileName, or reads it if it cannot be mapped.
+     *
+     * @param aFileName is the name of the file to open and to use for error reporting purposes.
+     * @param aStartingLineNumber is the initial line number to report on error.
+     * @param aMaxLineLength is the maximum allowed length of a line.
+     *
+     * @throw IO_ERROR if @a aFileName cannot be opened.
+     */
+    MMAP_LINE_READER( const wxString& aFileName,
+            unsigned aStartingLineNumber = 0,
+            unsigned aMaxLineLength = LINE_READER_LINE_DEFAULT_MAX );
+
+    ~MMAP_LINE_READER();
+
+    char* ReadLine() override;
+
+    /**
+     * Function Rewind
+     * goes back to the start of the file and resets the line number back to zero.
+     */
+    void Rewind()
+    {
+        m_ndx = 0;
+        m_lineNum = 0;
+    }
+
+    /**
+     * Function Size
+     * returns the size of the file in bytes.
+     */
+    size_t Size() const
+    {
+        return m_size;
+    }
+};
+
+
 /**
  * Class INPUTSTREAM_LINE_READER
  * is a LINE_READER that reads from a wxInputStream object.
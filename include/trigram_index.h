@@ -0,0 +1,94 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef TRIGRAM_INDEX_H
+#define TRIGRAM_INDEX_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <wx/string.h>
+
+
+/**
+ * Class TRIGRAM_INDEX
+ *
+ * Inverted index of the character trigrams of a set of texts, used to find quickly the
+ * few items whose texts may contain a substring before running slower matchers on them.
+ *
+ * The items are numbered by the caller, and must be added in increasing order.  An item
+ * can have several texts.  The index is case sensitive: the texts and the searched terms
+ * are normalized by the caller.
+ */
+class TRIGRAM_INDEX
+{
+public:
+    TRIGRAM_INDEX();
+
+    ///> Removes all the items
+    void Clear();
+
+    /**
+     * Function Add
+     * indexes a text of item aItem.
+     * @param aItem is the number of the item, not lower than the last added item.
+     * @param aText is the text of the item.
+     */
+    void Add( unsigned aItem, const wxString& aText );
+
+    /**
+     * Function Build
+     * prepares the index for the queries, once all the items are added.
+     */
+    void Build();
+
+    /**
+     * Function Find
+     * returns the items which may have a text containing aTerm: all the items which
+     * contain it are returned, and some others may be.
+     * @param aTerm is the searched substring.
+     * @param aItems receives the sorted numbers of the items.
+     * @return false if the index can't narrow the search: aTerm is a single character.
+     */
+    bool Find( const wxString& aTerm, std::vector<unsigned>& aItems ) const;
+
+    ///> Returns the number of distinct trigrams in the index
+    size_t TrigramCount() const { return m_postings.size(); }
+
+private:
+    typedef std::vector<unsigned> POSTING_LIST;
+
+    ///> Returns the key of a trigram, from its three characters
+    static uint64_t trigramKey( uint32_t aFirst, uint32_t aSecond, uint32_t aThird );
+
+    ///> The items having each trigram, in increasing order
+    std::unordered_map<uint64_t, POSTING_LIST> m_postings;
+
+    ///> The sorted keys of m_postings, for the queries by prefix
+    std::vector<uint64_t>                      m_keys;
+
+    unsigned                                   m_lastItem;
+};
+
+#endif  // TRIGRAM_INDEX_H
@@ -0,0 +1,145 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef __WORK_STEALING_POOL_H
+#define __WORK_STEALING_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class PROGRESS_REPORTER;
+
+/**
+ * A set of worker threads running small tasks.
+ *
+ * Each worker has its own task queue.  A worker runs the tasks of its queue last in,
+ * first out, and steals the oldest tasks of the other queues when its own queue is
+ * empty, so a task can split its work into subtasks which are shared by all the
+ * workers.
+ *
+ * Run() can be called from a task: the worker then runs other tasks until the
+ * subtasks it has queued are completed, instead of blocking.  Another thread calling
+ * Run() without progress reporter runs its own tasks along with the workers.
+ *
+ * The pool shared by all the users of a process is returned by GetThreadPool().
+ */
+class WORK_STEALING_POOL
+{
+public:
+    typedef std::function<void()> TASK;
+
+    /**
+     * Starts the worker threads.
+     * @param aThreadCount is the number of workers, 0 to use all the available cores.
+     */
+    WORK_STEALING_POOL( size_t aThreadCount = 0 );
+    ~WORK_STEALING_POOL();
+
+    WORK_STEALING_POOL( const WORK_STEALING_POOL& ) = delete;
+    WORK_STEALING_POOL& operator=( const WORK_STEALING_POOL& ) = delete;
+
+    /**
+     * Runs a set of tasks and returns when they are all completed.
+     * From a thread which is not a worker of this pool (typically the main thread), the
+     * reporter is refreshed while waiting.  The tasks can call AdvanceProgress() on it.
+     * Without reporter, this thread runs some of the tasks itself.
+     * The first exception thrown by a task is rethrown once all the tasks are completed.
+     * @param aCancellable is true to skip the tasks which are not started yet when the
+     * user cancels the operation from the reporter.
+     * @return false if the operation was cancelled.
+     */
+    bool Run( std::vector<TASK>& aTasks, PROGRESS_REPORTER* aReporter = nullptr,
+              bool aCancellable = false );
+
+    /**
+     * Queues a task and returns immediately.
+     * @return a future holding the result of the task, or the exception it has thrown.
+     * A task must not wait for a future: use Run() for nested tasks.
+     */
+    template<typename FUNC>
+    auto Submit( FUNC aFunc ) -> std::future<decltype( aFunc() )>
+    {
+        typedef decltype( aFunc() ) RESULT;
+
+        auto task = std::make_shared<std::packaged_task<RESULT()>>( std::move( aFunc ) );
+        std::future<RESULT> result = task->get_future();
+
+        queueTasks( std::vector<TASK>( 1, [task]() { ( *task )(); } ) );
+        return result;
+    }
+
+    size_t GetThreadCount() const { return m_threads.size(); }
+
+    /**
+     * Sets the number of workers of the pool returned by GetThreadPool().  The
+     * KICAD_MAX_THREADS environment variable is used when this is not called, and all the
+     * cores are used otherwise.
+     *
+     * The pool is started by the first call to GetThreadPool(), and cannot be resized:
+     * this must be called before.  Each kiface has its own pool.
+     * @return false, and logs a warning, if the pool is already started.
+     */
+    static bool SetMaxThreads( size_t aThreadCount );
+
+private:
+    struct WORKER_QUEUE
+    {
+        std::mutex       m_lock;
+        std::deque<TASK> m_tasks;
+    };
+
+    void workerLoop( size_t aIndex );
+
+    /// Index of the calling thread in m_threads, or -1 if it is not a worker
+    int workerIndex() const;
+
+    /// Pops a task from the queue of worker aIndex, or steals one from another worker
+    bool takeTask( int aIndex, TASK& aTask );
+
+    /// Moves the tasks to the queue of the calling worker, or spreads them on all queues
+    void queueTasks( std::vector<TASK>&& aTasks );
+
+    std::vector<std::thread>                    m_threads;
+    std::vector<std::unique_ptr<WORKER_QUEUE>>  m_queues;
+    std::atomic<size_t>                         m_nextQueue;    // Round robin for outside tasks
+    std::atomic<size_t>                         m_generation;   // Incremented when tasks are queued
+    std::atomic<bool>                           m_quit;
+
+    std::mutex                                  m_idleLock;
+    std::condition_variable                     m_idle;
+};
+
+
+/**
+ * Returns the pool shared by all the users of the process, starting it on first use.
+ */
+WORK_STEALING_POOL& GetThreadPool();
+
+#endif
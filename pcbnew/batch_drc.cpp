@@ -0,0 +1,371 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file batch_drc.cpp
+ * @brief Command line zone filler and DRC, for batch processing of boards.
+ *
+ * Usage: pcbnew_batch_drc [options] board_file.kicad_pcb
+ *
+ * The markers and unconnected items are written in JSON (default) or CSV format,
+ * and the duration of each phase is reported on stderr (and in the JSON output).
+ * The exit code is 0 if no problem was found, 1 if there are DRC errors and 2 if
+ * the board could not be tested.
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include <wx/init.h>
+
+#include <fctsys.h>
+#include <pgm_base.h>
+#include <kiway.h>
+#include <convert_to_biu.h>
+#include <profile.h>
+#include <work_stealing_pool.h>
+
+#include <io_mgr.h>
+#include <kicad_plugin.h>
+#include <class_board.h>
+#include <class_marker_pcb.h>
+#include <drc.h>
+
+
+enum BATCH_DRC_RESULT
+{
+    BATCH_DRC_OK = 0,
+    BATCH_DRC_ERRORS,
+    BATCH_DRC_FAILURE
+};
+
+
+/**
+ * The pcbnew code expects a program object: this one has no user interface.
+ */
+static struct PGM_BATCH_DRC : public PGM_BASE
+{
+    bool OnPgmInit() override { return true; }
+    void OnPgmExit() override { Destroy(); }
+    void MacOpenFile( const wxString& aFileName ) override { }
+} program;
+
+
+typedef std::vector< std::pair<wxString, double> > PHASE_TIMINGS;
+
+
+static void usage( const char* aProgName )
+{
+    printf( "Fill the zones of a board and run the design rules check.\n\n" );
+    printf( "usage: %s [options] board_file.kicad_pcb\n\n", aProgName );
+    printf( "  --refill-zones        refill all the zones before testing\n" );
+    printf( "  --all-track-errors    report all the errors of each track, not only the first\n" );
+    printf( "  --no-unconnected      do not report unconnected items\n" );
+    printf( "  --format=json|csv     output format (default json)\n" );
+    printf( "  --output=FILE         output file (default stdout)\n" );
+    printf( "  --threads=N           number of worker threads (default: KICAD_MAX_THREADS,\n" );
+    printf( "                        or all the cores)\n" );
+}
+
+
+static std::string jsonString( const wxString& aText )
+{
+    std::string utf8 = std::string( aText.ToUTF8() );
+    std::string out = "\"";
+
+    for( char c : utf8 )
+    {
+        switch( c )
+        {
+        case '"':  out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n";  break;
+        case '\r': out += "\\r";  break;
+        case '\t': out += "\\t";  break;
+
+        default:
+            if( (unsigned char) c < 0x20 )
+            {
+                char buf[8];
+                snprintf( buf, sizeof( buf ), "\\u%04x", (unsigned char) c );
+                out += buf;
+            }
+            else
+            {
+                out += c;
+            }
+        }
+    }
+
+    return out + "\"";
+}
+
+
+static std::string csvString( const wxString& aText )
+{
+    std::string utf8 = std::string( aText.ToUTF8() );
+    std::string out = "\"";
+
+    for( char c : utf8 )
+    {
+        if( c == '"' )
+            out += '"';
+
+        out += c;
+    }
+
+    return out + "\"";
+}
+
+
+static double toMM( int aValue )
+{
+    return aValue / IU_PER_MM;
+}
+
+
+static void writeJsonItem( std::ostream& aOut, const char* aKind, const DRC_ITEM& aItem,
+                           bool aLast )
+{
+    aOut << "    { \"kind\": \"" << aKind << "\""
+         << ", \"code\": " << aItem.GetErrorCode()
+         << ", \"description\": " << jsonString( aItem.GetErrorText() )
+         << ", \"item_a\": " << jsonString( aItem.GetTextA() )
+         << ", \"x_a_mm\": " << toMM( aItem.GetPointA().x )
+         << ", \"y_a_mm\": " << toMM( aItem.GetPointA().y );
+
+    if( aItem.HasSecondItem() )
+    {
+        aOut << ", \"item_b\": " << jsonString( aItem.GetTextB() )
+             << ", \"x_b_mm\": " << toMM( aItem.GetPointB().x )
+             << ", \"y_b_mm\": " << toMM( aItem.GetPointB().y );
+    }
+
+    aOut << " }" << ( aLast ? "\n" : ",\n" );
+}
+
+
+static void writeCsvItem( std::ostream& aOut, const char* aKind, const DRC_ITEM& aItem )
+{
+    aOut << aKind << ","
+         << aItem.GetErrorCode() << ","
+         << csvString( aItem.GetErrorText() ) << ","
+         << csvString( aItem.GetTextA() ) << ","
+         << toMM( aItem.GetPointA().x ) << ","
+         << toMM( aItem.GetPointA().y ) << ",";
+
+    if( aItem.HasSecondItem() )
+    {
+        aOut << csvString( aItem.GetTextB() ) << ","
+             << toMM( aItem.GetPointB().x ) << ","
+             << toMM( aItem.GetPointB().y );
+    }
+    else
+    {
+        aOut << ",,";
+    }
+
+    aOut << "\n";
+}
+
+
+static void writeJson( std::ostream& aOut, const wxString& aBoardFile, BOARD* aBoard,
+                       const DRC_LIST& aUnconnected, const PHASE_TIMINGS& aTimings,
+                       const DRC_PAD_TEST_STATS& aPadStats )
+{
+    aOut << "{\n";
+    aOut << "  \"board\": " << jsonString( aBoardFile ) << ",\n";
+
+    aOut << "  \"timings_ms\": {\n";
+
+    for( size_t i = 0; i < aTimings.size(); ++i )
+    {
+        aOut << "    " << jsonString( aTimings[i].first ) << ": " << aTimings[i].second
+             << ( i + 1 < aTimings.size() ? ",\n" : "\n" );
+    }
+
+    aOut << "  },\n";
+
+    aOut << "  \"pad_to_pad\": { \"pads\": " << aPadStats.m_padCount
+         << ", \"candidate_pairs\": " << aPadStats.m_candidatePairs
+         << ", \"narrow_phase_tests\": " << aPadStats.m_narrowPhaseTests << " },\n";
+
+    aOut << "  \"violations\": [\n";
+
+    int markerCount = aBoard->GetMARKERCount();
+
+    for( int i = 0; i < markerCount; ++i )
+        writeJsonItem( aOut, "marker", aBoard->GetMARKER( i )->GetReporter(),
+                       i + 1 == markerCount && aUnconnected.empty() );
+
+    for( size_t i = 0; i < aUnconnected.size(); ++i )
+        writeJsonItem( aOut, "unconnected", *aUnconnected[i], i + 1 == aUnconnected.size() );
+
+    aOut << "  ]\n";
+    aOut << "}\n";
+}
+
+
+static void writeCsv( std::ostream& aOut, BOARD* aBoard, const DRC_LIST& aUnconnected )
+{
+    aOut << "kind,code,description,item_a,x_a_mm,y_a_mm,item_b,x_b_mm,y_b_mm\n";
+
+    for( int i = 0; i < aBoard->GetMARKERCount(); ++i )
+        writeCsvItem( aOut, "marker", aBoard->GetMARKER( i )->GetReporter() );
+
+    for( auto item : aUnconnected )
+        writeCsvItem( aOut, "unconnected", *item );
+}
+
+
+int main( int argc, char* argv[] )
+{
+    wxInitializer initializer( argc, argv );
+
+    if( !initializer.IsOk() )
+    {
+        fprintf( stderr, "Failed to initialize wxWidgets.\n" );
+        return BATCH_DRC_FAILURE;
+    }
+
+    // The pcbnew code reaches the program through Pgm(), which is set by the kiface getter
+    int kifaceVersion = 0;
+    KIFACE_GETTER( &kifaceVersion, KIFACE_VERSION, &program );
+
+    wxString boardFile;
+    wxString outputFile;
+    wxString threads;
+    long     threadCount;
+    bool     refillZones = false;
+    bool     allTrackErrors = false;
+    bool     unconnectedTest = true;
+    bool     csv = false;
+
+    for( int i = 1; i < argc; ++i )
+    {
+        wxString arg = wxString::FromUTF8( argv[i] );
+
+        if( arg == "--refill-zones" )
+            refillZones = true;
+        else if( arg == "--all-track-errors" )
+            allTrackErrors = true;
+        else if( arg == "--no-unconnected" )
+            unconnectedTest = false;
+        else if( arg == "--format=json" )
+            csv = false;
+        else if( arg == "--format=csv" )
+            csv = true;
+        else if( arg.StartsWith( "--output=", &outputFile ) )
+            continue;
+        else if( arg.StartsWith( "--threads=", &threads ) && threads.ToLong( &threadCount )
+                 && threadCount > 0 )
+        {
+            // The pool must not be started yet, or the timings would not use this count
+            if( !WORK_STEALING_POOL::SetMaxThreads( (size_t) threadCount ) )
+                return BATCH_DRC_FAILURE;
+        }
+        else if( !arg.StartsWith( "-" ) && boardFile.IsEmpty() )
+            boardFile = arg;
+        else
+        {
+            usage( argv[0] );
+            return BATCH_DRC_FAILURE;
+        }
+    }
+
+    if( boardFile.IsEmpty() )
+    {
+        usage( argv[0] );
+        return BATCH_DRC_FAILURE;
+    }
+
+    PHASE_TIMINGS          timings;
+    std::unique_ptr<BOARD> board;
+    PROF_COUNTER           loadTimer( "load" );
+
+    try
+    {
+        PLUGIN::RELEASER pi( new PCB_IO );
+        board.reset( pi->Load( boardFile, NULL, NULL ) );
+    }
+    catch( const IO_ERROR& ioe )
+    {
+        fprintf( stderr, "Error loading board %s:\n%s\n",
+                 (const char*) boardFile.ToUTF8(), (const char*) ioe.What().ToUTF8() );
+        return BATCH_DRC_FAILURE;
+    }
+
+    loadTimer.Stop();
+    timings.push_back( std::make_pair( wxString( "load" ), loadTimer.msecs() ) );
+
+    if( !board )
+        return BATCH_DRC_FAILURE;
+
+    DRC drc( board.get() );
+
+    drc.SetSettings( true, unconnectedTest, true, true, refillZones, true, true,
+                     allTrackErrors, wxEmptyString, false );
+    drc.RunBatchTests( &timings );
+
+    std::ofstream      outFile;
+    std::ostringstream output;
+
+    output.imbue( std::locale::classic() );
+
+    if( csv )
+        writeCsv( output, board.get(), drc.GetUnconnectedItems() );
+    else
+        writeJson( output, boardFile, board.get(), drc.GetUnconnectedItems(), timings,
+                   drc.GetPadTestStats() );
+
+    if( outputFile.IsEmpty() )
+    {
+        std::cout << output.str();
+    }
+    else
+    {
+        outFile.open( (const char*) outputFile.ToUTF8() );
+
+        if( !outFile )
+        {
+            fprintf( stderr, "Cannot write %s\n", (const char*) outputFile.ToUTF8() );
+            return BATCH_DRC_FAILURE;
+        }
+
+        outFile << output.str();
+    }
+
+    for( const auto& timing : timings )
+        fprintf( stderr, "%-20s %10.1f ms\n", (const char*) timing.first.ToUTF8(), timing.second );
+
+    const DRC_PAD_TEST_STATS& padStats = drc.GetPadTestStats();
+
+    fprintf( stderr, "pad to pad: %zu pads, %zu candidate pairs, %zu narrow phase tests\n",
+             padStats.m_padCount, padStats.m_candidatePairs, padStats.m_narrowPhaseTests );
+
+    bool hasErrors = board->GetMARKERCount() > 0 || !drc.GetUnconnectedItems().empty();
+
+    return hasErrors ? BATCH_DRC_ERRORS : BATCH_DRC_OK;
+}
@@ -66,6 +66,10 @@ void BOARD_COMMIT::Push( const wxString& aMessage, bool aCreateUndoEntry )
     auto connectivity = board->GetConnectivity();
     std::set<EDA_ITEM*> savedModules;
 
+    // Areas changed by this commit, reported to the frame (e.g. for the online DRC)
+    std::vector<EDA_RECT> dirtyAreas;
+    std::vector<BOARD_ITEM*> changedItems;
+
     if( Empty() )
         return;
 
@@ -75,6 +79,17 @@ void BOARD_COMMIT::Push( const wxString& aMessage, bool aCreateUndoEntry )
         int changeFlags = ent.m_type & CHT_FLAGS;
         BOARD_ITEM* boardItem = static_cast<BOARD_ITEM*>( ent.m_item );
 
+        // Markers are the result of the DRC, not an input
+        if( !m_editModules && boardItem->Type() != PCB_MARKER_T )
+        {
+            dirtyAreas.push_back( boardItem->GetBoundingBox() );
+
+            if( changeType == CHT_MODIFY && ent.m_copy )
+                dirtyAreas.push_back( static_cast<BOARD_ITEM*>( ent.m_copy )->GetBoundingBox() );
+
+            changedItems.push_back( boardItem );
+        }
+
         // Module items need to be saved in the undo buffer before modification
         if( m_editModules )
         {
@@ -281,6 +296,9 @@ void BOARD_COMMIT::Push( const wxString& aMessage, bool aCreateUndoEntry )
         auto panel = static_cast<PCB_DRAW_PANEL_GAL*>( frame->GetGalCanvas() );
         connectivity->RecalculateRatsnest();
         panel->RedrawRatsnest();
+
+        if( !dirtyAreas.empty() )
+            frame->OnBoardItemsChanged( dirtyAreas, changedItems );
     }
 
     frame->OnModify();
@@ -30,6 +30,7 @@
 
 #include <fctsys.h>
 #include <common.h>
+#include <kicad_string.h>
 #include <pcbnew.h>
 #include <wx/debug.h>
 
@@ -97,7 +98,7 @@ std::string BOARD_ITEM::FormatInternalUnits( int aValue )
 
     if( mm != 0.0 && fabs( mm ) <= 0.0001 )
     {
-        len = sprintf( buf, "%.10f", mm );
+        len = FormatDouble( buf, sizeof( buf ), "%.10f", mm );
 
         while( --len > 0 && buf[len] == '0' )
             buf[len] = '\0';
@@ -109,7 +110,7 @@ std::string BOARD_ITEM::FormatInternalUnits( int aValue )
     }
     else
     {
-        len = sprintf( buf, "%.10g", mm );
+        len = FormatDouble( buf, sizeof( buf ), "%.10g", mm );
     }
 
     return std::string( buf, len );
@@ -172,7 +173,7 @@ std::string BOARD_ITEM::FormatAngle( double aAngle )
 {
     char temp[50];
 
-    int len = snprintf( temp, sizeof(temp), "%.10g", aAngle / 10.0 );
+    int len = FormatDouble( temp, sizeof(temp), "%.10g", aAngle / 10.0 );
 
     return std::string( temp, len );
 }
@@ -46,7 +46,8 @@
 
 MARKER_PCB::MARKER_PCB( BOARD_ITEM* aParent ) :
     BOARD_ITEM( aParent, PCB_MARKER_T ),
-    MARKER_BASE(), m_item( NULL )
+    MARKER_BASE(), m_item( NULL ),
+    m_mainItemType( TYPE_NOT_INIT ), m_mainItemNetCode( -1 )
 {
     m_Color = WHITE;
     m_ScalingFactor = SCALING_FACTOR;
@@ -57,7 +58,8 @@ MARKER_PCB::MARKER_PCB( int aErrorCode, const wxPoint& aMarkerPos,
                         const wxString& aText, const wxPoint& aPos,
                         const wxString& bText, const wxPoint& bPos ) :
     BOARD_ITEM( NULL, PCB_MARKER_T ),  // parent set during BOARD::Add()
-    MARKER_BASE( aErrorCode, aMarkerPos, aText, aPos, bText, bPos ), m_item( NULL )
+    MARKER_BASE( aErrorCode, aMarkerPos, aText, aPos, bText, bPos ), m_item( NULL ),
+    m_mainItemType( TYPE_NOT_INIT ), m_mainItemNetCode( -1 )
 {
     m_Color = WHITE;
     m_ScalingFactor = SCALING_FACTOR;
@@ -66,7 +68,8 @@ MARKER_PCB::MARKER_PCB( int aErrorCode, const wxPoint& aMarkerPos,
 MARKER_PCB::MARKER_PCB( int aErrorCode, const wxPoint& aMarkerPos,
                         const wxString& aText, const wxPoint& aPos ) :
     BOARD_ITEM( NULL, PCB_MARKER_T ),  // parent set during BOARD::Add()
-    MARKER_BASE( aErrorCode, aMarkerPos, aText,  aPos ), m_item( NULL )
+    MARKER_BASE( aErrorCode, aMarkerPos, aText,  aPos ), m_item( NULL ),
+    m_mainItemType( TYPE_NOT_INIT ), m_mainItemNetCode( -1 )
 {
     m_Color = WHITE;
     m_ScalingFactor = SCALING_FACTOR;
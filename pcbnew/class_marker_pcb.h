@@ -98,6 +98,28 @@ public:
         return m_item;
     }
 
+    /**
+     * Function SetMainItemId
+     * stores the type and the net code of the main item.  With the main position of the
+     * reporter, they identify the item even after it is modified or deleted, whatever the
+     * language and the units of the item description.
+     */
+    void SetMainItemId( KICAD_T aType, int aNetCode )
+    {
+        m_mainItemType = aType;
+        m_mainItemNetCode = aNetCode;
+    }
+
+    KICAD_T GetMainItemType() const
+    {
+        return m_mainItemType;
+    }
+
+    int GetMainItemNetCode() const
+    {
+        return m_mainItemNetCode;
+    }
+
     bool HitTest( const wxPoint& aPosition ) const override
     {
         return HitTestMarker( aPosition );
@@ -136,6 +158,10 @@ public:
 protected:
     ///> Pointer to BOARD_ITEM that causes DRC error.
     const BOARD_ITEM* m_item;
+
+    ///> Type and net code of the main item, TYPE_NOT_INIT if they are unknown.
+    KICAD_T           m_mainItemType;
+    int               m_mainItemNetCode;
 };
 
 #endif      //  CLASS_MARKER_PCB_H
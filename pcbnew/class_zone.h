@@ -31,6 +31,7 @@
 #define CLASS_ZONE_H_
 
 
+#include <cstdint>
 #include <vector>
 #include <gr_basic.h>
 #include <class_board_item.h>
@@ -189,6 +190,13 @@ public:
     bool IsFilled() const { return m_IsFilled; }
     void SetIsFilled( bool isFilled ) { m_IsFilled = isFilled; }
 
+    /**
+     * The fill hash identifies the zone and board items the current fill was computed
+     * from (see ZONE_FILLER).  It is 0 when unknown.
+     */
+    uint64_t GetFillHash() const { return m_fillHash; }
+    void SetFillHash( uint64_t aHash ) { m_fillHash = aHash; }
+
     int GetZoneClearance() const { return m_ZoneClearance; }
     void SetZoneClearance( int aZoneClearance ) { m_ZoneClearance = aZoneClearance; }
 
@@ -704,6 +712,9 @@ private:
     /** True when a zone was filled, false after deleting the filled areas. */
     bool                  m_IsFilled;
 
+    /** Hash of the items the fill was computed from, 0 if unknown. */
+    uint64_t              m_fillHash;
+
     ///< Width of the gap in thermal reliefs.
     int                   m_ThermalReliefGap;
 
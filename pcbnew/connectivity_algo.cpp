@@ -24,6 +24,7 @@
 
 #include <connectivity_algo.h>
 #include <widgets/progress_reporter.h>
+#include <work_stealing_pool.h>
 
 #include <thread>
 #include <mutex>
@@ -32,10 +33,6 @@
 #include <profile.h>
 #endif
 
-#ifdef USE_OPENMP
-#include <omp.h>
-#endif /* USE_OPENMP */
-
 using namespace std::placeholders;
 
 bool operator<( const CN_ANCHOR_PTR& a, const CN_ANCHOR_PTR& b )
@@ -298,22 +295,10 @@ bool CN_CONNECTIVITY_ALGO::Add( BOARD_ITEM* aItem )
 }
 
 
-void CN_CONNECTIVITY_ALGO::searchConnections( bool aIncludeZones )
+void CN_CONNECTIVITY_ALGO::searchConnections()
 {
     std::mutex cnListLock;
 
-    int totalDirtyCount = 0;
-
-    if( m_lastSearchWithZones != aIncludeZones )
-    {
-        m_padList.MarkAllAsDirty();
-        m_viaList.MarkAllAsDirty();
-        m_trackList.MarkAllAsDirty();
-        m_zoneList.MarkAllAsDirty();
-    }
-
-    m_lastSearchWithZones = aIncludeZones;
-
     auto checkForConnection = [ &cnListLock ] ( const CN_ANCHOR_PTR point, CN_ITEM* aRefItem, int aMaxDist = 0 )
     {
         const auto parent = aRefItem->Parent();
@@ -475,39 +460,125 @@ void CN_CONNECTIVITY_ALGO::searchConnections( bool aIncludeZones )
     PROF_COUNTER search_basic( "search-basic" );
 #endif
 
-    if( m_padList.IsDirty() || m_trackList.IsDirty() || m_viaList.IsDirty() )
+    // The connections between items which did not change are already known: only the dirty
+    // items are searched.  When all the items are dirty (after a build), searching from each
+    // item finds all the connections.  Otherwise the anchors of the dirty items must also be
+    // tested against the clean items around them, which do not search again.
+    bool fullSearch = m_padList.AllDirty() && m_trackList.AllDirty() && m_viaList.AllDirty()
+                      && m_zoneList.AllDirty();
+
+    m_padList.Sort();
+    m_trackList.Sort();
+    m_viaList.Sort();
+
+    for( auto padItem : m_padList )
     {
-        totalDirtyCount++;
+        if( !padItem->Dirty() )
+            continue;
 
-        for( auto padItem : m_padList )
-        {
-            auto pad = static_cast<D_PAD*> ( padItem->Parent() );
-            auto searchPads = std::bind( checkForConnection, _1, padItem );
+        auto pad = static_cast<D_PAD*> ( padItem->Parent() );
+        auto searchPads = std::bind( checkForConnection, _1, padItem );
 
-            m_padList.FindNearby( pad->ShapePos(), pad->GetBoundingRadius(), searchPads );
-            m_trackList.FindNearby( pad->ShapePos(), pad->GetBoundingRadius(), searchPads );
-            m_viaList.FindNearby( pad->ShapePos(), pad->GetBoundingRadius(), searchPads );
-        }
+        m_padList.FindNearby( pad->ShapePos(), pad->GetBoundingRadius(), searchPads );
+        m_trackList.FindNearby( pad->ShapePos(), pad->GetBoundingRadius(), searchPads );
+        m_viaList.FindNearby( pad->ShapePos(), pad->GetBoundingRadius(), searchPads );
+    }
+
+    for( auto& trackItem : m_trackList )
+    {
+        if( !trackItem->Dirty() )
+            continue;
 
-        for( auto& trackItem : m_trackList )
+        auto track = static_cast<TRACK*> ( trackItem->Parent() );
+        int dist_max = track->GetWidth() / 2;
+        auto searchTracks = std::bind( checkForConnection, _1, trackItem, dist_max );
+
+        m_trackList.FindNearby( track->GetStart(), dist_max, searchTracks );
+        m_trackList.FindNearby( track->GetEnd(), dist_max, searchTracks );
+    }
+
+    for( auto& viaItem : m_viaList )
+    {
+        if( !viaItem->Dirty() )
+            continue;
+
+        auto via = static_cast<VIA*> ( viaItem->Parent() );
+        int dist_max = via->GetWidth() / 2;
+        auto searchVias = std::bind( checkForConnection, _1, viaItem, dist_max );
+
+        m_viaList.FindNearby( via->GetStart(), dist_max, searchVias );
+        m_trackList.FindNearby( via->GetStart(), dist_max, searchVias );
+    }
+
+    if( !fullSearch )
+    {
+        // The clean items which could have found a dirty anchor in their own search.  The
+        // lists give the largest search distance of their items, and the items do the
+        // exact tests.
+        auto searchFromAnchor = [&]( const CN_ANCHOR_PTR& aAnchor, bool aTrackAnchor,
+                                     bool aViaAnchor )
         {
-            auto track = static_cast<TRACK*> ( trackItem->Parent() );
-            int dist_max = track->GetWidth() / 2;
-            auto searchTracks = std::bind( checkForConnection, _1, trackItem, dist_max );
+            auto checkRefItem = [&]( const CN_ANCHOR_PTR& aRefAnchor, int aMaxDist )
+            {
+                if( !aRefAnchor->IsDirty() )
+                    checkForConnection( aAnchor, aRefAnchor->Item(), aMaxDist );
+            };
 
-            m_trackList.FindNearby( track->GetStart(), dist_max, searchTracks );
-            m_trackList.FindNearby( track->GetEnd(), dist_max, searchTracks );
+            // Pads search the pad, track and via anchors
+            m_padList.FindNearby( aAnchor->Pos(), m_padList.SearchRadius(),
+                    [&]( const CN_ANCHOR_PTR& aPadAnchor )
+                    {
+                        checkRefItem( aPadAnchor, 0 );
+                    } );
+
+            // Tracks search the track anchors
+            if( aTrackAnchor )
+            {
+                m_trackList.FindNearby( aAnchor->Pos(), m_trackList.SearchRadius(),
+                        [&]( const CN_ANCHOR_PTR& aTrackEnd )
+                        {
+                            auto track = static_cast<TRACK*>( aTrackEnd->Item()->Parent() );
+                            checkRefItem( aTrackEnd, track->GetWidth() / 2 );
+                        } );
+            }
+
+            // Vias search the via and track anchors
+            if( aTrackAnchor || aViaAnchor )
+            {
+                m_viaList.FindNearby( aAnchor->Pos(), m_viaList.SearchRadius(),
+                        [&]( const CN_ANCHOR_PTR& aViaAnchor )
+                        {
+                            auto via = static_cast<VIA*>( aViaAnchor->Item()->Parent() );
+                            checkRefItem( aViaAnchor, via->GetWidth() / 2 );
+                        } );
+            }
+
+            // Zones search the pad, track and via anchors
+            for( auto zoneItem : m_zoneList )
+            {
+                auto zone = static_cast<CN_ZONE*>( zoneItem );
+
+                if( !zone->Dirty() && zone->BBox().Contains( aAnchor->Pos() ) )
+                    checkForConnection( aAnchor, zone );
+            }
+        };
+
+        for( auto& anchor : m_padList.Anchors() )
+        {
+            if( anchor->IsDirty() )
+                searchFromAnchor( anchor, false, false );
         }
 
-        for( auto& viaItem : m_viaList )
+        for( auto& anchor : m_trackList.Anchors() )
         {
-            auto via = static_cast<VIA*> ( viaItem->Parent() );
-            int dist_max = via->GetWidth() / 2;
-            auto searchVias = std::bind( checkForConnection, _1, viaItem, dist_max );
+            if( anchor->IsDirty() )
+                searchFromAnchor( anchor, true, false );
+        }
 
-            totalDirtyCount++;
-            m_viaList.FindNearby( via->GetStart(), dist_max, searchVias );
-            m_trackList.FindNearby( via->GetStart(), dist_max, searchVias );
+        for( auto& anchor : m_viaList.Anchors() )
+        {
+            if( anchor->IsDirty() )
+                searchFromAnchor( anchor, false, true );
         }
     }
 
@@ -515,61 +586,44 @@ void CN_CONNECTIVITY_ALGO::searchConnections( bool aIncludeZones )
     search_basic.Show();
 #endif
 
-    if( aIncludeZones )
+    std::vector<CN_ZONE*> dirtyZones;
+
+    for( auto item : m_zoneList )
     {
-        int cnt = 0;
+        if( item->Dirty() )
+            dirtyZones.push_back( static_cast<CN_ZONE*>( item ) );
+    }
 
+    if( !dirtyZones.empty() )
+    {
         if( m_progressReporter )
         {
-            m_progressReporter->SetMaxProgress( m_zoneList.Size() );
+            m_progressReporter->SetMaxProgress( dirtyZones.size() );
         }
 
-        #ifdef USE_OPENMP
-            // launch at least two threads, one to compute, second to update UI
-            #pragma omp parallel num_threads( std::max( omp_get_num_procs(), 2 ) )
-        #endif
-        {
-            #ifdef USE_OPENMP
-                #pragma omp master
-                if (m_progressReporter)
-                {
-                    m_progressReporter->KeepRefreshing( true );
-                }
-            #endif
+        std::vector<WORK_STEALING_POOL::TASK> tasks;
 
-            #ifdef USE_OPENMP
-                #pragma omp for schedule(dynamic)
-            #endif
-            for(int i = 0; i < m_zoneList.Size(); i++ )
+        // The inter-zone test is symmetric, so searching from the dirty zones is enough
+        for( auto zoneItem : dirtyZones )
+        {
+            tasks.push_back( [&, zoneItem]()
             {
-                auto item = m_zoneList[i];
-                auto zoneItem = static_cast<CN_ZONE *> (item);
                 auto searchZones = std::bind( checkForConnection, _1, zoneItem );
 
-                if( zoneItem->Dirty() || m_padList.IsDirty() || m_trackList.IsDirty() || m_viaList.IsDirty() )
-                {
-                    totalDirtyCount++;
-                    m_viaList.FindNearby( zoneItem->BBox(), searchZones );
-                    m_trackList.FindNearby( zoneItem->BBox(), searchZones );
-                    m_padList.FindNearby( zoneItem->BBox(), searchZones );
-                    m_zoneList.FindNearbyZones( zoneItem->BBox(), std::bind( checkInterZoneConnection, _1, zoneItem ) );
-                }
+                m_viaList.FindNearby( zoneItem->BBox(), searchZones );
+                m_trackList.FindNearby( zoneItem->BBox(), searchZones );
+                m_padList.FindNearby( zoneItem->BBox(), searchZones );
+                m_zoneList.FindNearbyZones( zoneItem->BBox(), std::bind( checkInterZoneConnection, _1, zoneItem ) );
 
-                {
-                    std::lock_guard<std::mutex> lock( cnListLock );
-                    cnt++;
-
-                    if (m_progressReporter)
-                    {
-                        m_progressReporter->AdvanceProgress();
-                    }
-                }
-            }
+                if( m_progressReporter )
+                    m_progressReporter->AdvanceProgress();
+            } );
         }
 
-        m_zoneList.ClearDirtyFlags();
+        GetThreadPool().Run( tasks, m_progressReporter );
     }
 
+    m_zoneList.ClearDirtyFlags();
     m_padList.ClearDirtyFlags();
     m_viaList.ClearDirtyFlags();
     m_trackList.ClearDirtyFlags();
@@ -646,7 +700,7 @@ const CN_CONNECTIVITY_ALGO::CLUSTERS CN_CONNECTIVITY_ALGO::SearchClusters( CLUST
     CLUSTERS clusters;
 
     if( isDirty() )
-        searchConnections( includeZones );
+        searchConnections();
 
     auto addToSearchList = [&head, withinAnyNet, aSingleNet, aTypes] ( CN_ITEM *aItem )
     {
@@ -716,6 +770,10 @@ const CN_CONNECTIVITY_ALGO::CLUSTERS CN_CONNECTIVITY_ALGO::SearchClusters( CLUST
                 if( withinAnyNet && n->Net() != root->Net() )
                     continue;
 
+                // The zone connections are always known, but not always wanted
+                if( !includeZones && n->Parent()->Type() == PCB_ZONE_AREA_T )
+                    continue;
+
                 if( !n->Visited() && n->Valid() )
                 {
                     n->SetVisited( true );
@@ -921,11 +979,91 @@ void CN_CONNECTIVITY_ALGO::FindIsolatedCopperIslands( std::vector<CN_ZONE_ISOLAT
 
 const CN_CONNECTIVITY_ALGO::CLUSTERS& CN_CONNECTIVITY_ALGO::GetClusters()
 {
-    m_ratsnestClusters = SearchClusters( CSM_RATSNEST );
+    if( isDirty() )
+        searchConnections();
+
+    updateRatsnestClusters();
     return m_ratsnestClusters;
 }
 
 
+void CN_CONNECTIVITY_ALGO::updateRatsnestClusters()
+{
+    // The ratsnest clusters never span several nets, so only the clusters of the dirty
+    // nets can have changed.  Removed items always mark their net as dirty, so the other
+    // clusters do not refer to deleted items.
+    CLUSTERS clusters;
+
+    auto netDirty = [this]( int aNet )
+    {
+        return aNet >= 0 && aNet < NetCount() && IsNetDirty( aNet );
+    };
+
+    for( const auto& cluster : m_ratsnestClusters )
+    {
+        if( !netDirty( cluster->OriginNet() ) )
+            clusters.push_back( cluster );
+    }
+
+    // The items of the dirty nets, pads first so they become the cluster origins
+    std::vector<CN_ITEM*> items;
+    std::unordered_map<const CN_ITEM*, int> itemIndex;
+
+    auto addItem = [&]( CN_ITEM* aItem )
+    {
+        int net = aItem->Net();
+
+        if( aItem->Valid() && net > 0 && netDirty( net ) )
+        {
+            itemIndex[aItem] = items.size();
+            items.push_back( aItem );
+        }
+    };
+
+    std::for_each( m_padList.begin(), m_padList.end(), addItem );
+    std::for_each( m_trackList.begin(), m_trackList.end(), addItem );
+    std::for_each( m_viaList.begin(), m_viaList.end(), addItem );
+    std::for_each( m_zoneList.begin(), m_zoneList.end(), addItem );
+
+    CN_UNION_FIND sets( items.size() );
+
+    for( unsigned i = 0; i < items.size(); i++ )
+    {
+        for( auto connected : items[i]->ConnectedItems() )
+        {
+            if( !connected->Valid() || connected->Net() != items[i]->Net() )
+                continue;
+
+            auto it = itemIndex.find( connected );
+
+            if( it != itemIndex.end() )
+                sets.Union( i, it->second );
+        }
+    }
+
+    std::unordered_map<int, CN_CLUSTER_PTR> setClusters;
+
+    for( unsigned i = 0; i < items.size(); i++ )
+    {
+        CN_CLUSTER_PTR& cluster = setClusters[ sets.Find( i ) ];
+
+        if( !cluster )
+        {
+            cluster.reset( new CN_CLUSTER() );
+            clusters.push_back( cluster );
+        }
+
+        cluster->Add( items[i] );
+    }
+
+    std::stable_sort( clusters.begin(), clusters.end(), []( CN_CLUSTER_PTR a, CN_CLUSTER_PTR b ) {
+        return a->OriginNet() < b->OriginNet();
+    } );
+
+    m_ratsnestClusters = std::move( clusters );
+}
+
+
 void CN_CONNECTIVITY_ALGO::MarkNetAsDirty( int aNet )
 {
     if( aNet < 0 )
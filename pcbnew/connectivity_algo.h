@@ -261,6 +261,53 @@ public:
 typedef std::shared_ptr<CN_CLUSTER> CN_CLUSTER_PTR;
 
 
+/**
+ * Disjoint sets of items, to group the connected items into clusters.
+ */
+class CN_UNION_FIND
+{
+public:
+    CN_UNION_FIND( int aSize ) :
+        m_parent( aSize ),
+        m_size( aSize, 1 )
+    {
+        for( int i = 0; i < aSize; i++ )
+            m_parent[i] = i;
+    }
+
+    int Find( int aElem )
+    {
+        // Path halving: every other element on the path is linked to its grandparent
+        while( m_parent[aElem] != aElem )
+        {
+            m_parent[aElem] = m_parent[ m_parent[aElem] ];
+            aElem = m_parent[aElem];
+        }
+
+        return aElem;
+    }
+
+    void Union( int aA, int aB )
+    {
+        aA = Find( aA );
+        aB = Find( aB );
+
+        if( aA == aB )
+            return;
+
+        if( m_size[aA] < m_size[aB] )
+            std::swap( aA, aB );
+
+        m_parent[aB] = aA;
+        m_size[aA] += m_size[aB];
+    }
+
+private:
+    std::vector<int> m_parent;
+    std::vector<int> m_size;
+};
+
+
 // basic connectivity item
 class CN_ITEM : public INTRUSIVE_LIST<CN_ITEM>
 {
@@ -407,32 +454,51 @@ class CN_LIST
 {
 private:
     bool m_dirty;
+    bool m_sorted;
     std::vector<CN_ANCHOR_PTR> m_anchors;
 
 protected:
     std::vector<CN_ITEM*> m_items;
 
+    ///> the largest distance at which an item of the list looks for anchors
+    int m_searchRadius;
+
     void addAnchor( VECTOR2I pos, CN_ITEM* item )
     {
         m_anchors.push_back( item->AddAnchor( pos ) );
+        m_sorted = false;
     }
 
-private:
+    void updateSearchRadius( int aRadius )
+    {
+        m_searchRadius = std::max( m_searchRadius, aRadius );
+    }
 
-    void sort()
+public:
+    CN_LIST()
     {
-        if( m_dirty )
+        m_dirty = false;
+        m_sorted = true;
+        m_searchRadius = 0;
+    }
+
+    /**
+     * Sorts the anchors by position, for the searches.  The searches sort the list when
+     * needed, but this must be done before searching from several threads.
+     */
+    void Sort()
+    {
+        if( !m_sorted )
         {
             std::sort( m_anchors.begin(), m_anchors.end() );
 
-            m_dirty = false;
+            m_sorted = true;
         }
     }
 
-public:
-    CN_LIST()
+    int SearchRadius() const
     {
-        m_dirty = false;
+        return m_searchRadius;
     }
 
     void Clear()
@@ -484,6 +550,18 @@ public:
         SetDirty( false );
     }
 
+    ///> @return true if all the items need to be searched, e.g. after the first build
+    bool AllDirty() const
+    {
+        for( auto item : m_items )
+        {
+            if( !item->Dirty() )
+                return false;
+        }
+
+        return true;
+    }
+
     void MarkAllAsDirty()
     {
         for( auto item : m_items )
@@ -508,6 +586,7 @@ public:
 
         addAnchor( pad->ShapePos(), item );
         m_items.push_back( item );
+        updateSearchRadius( pad->GetBoundingRadius() );
 
         SetDirty();
         return item;
@@ -526,6 +605,7 @@ public:
 
         addAnchor( track->GetStart(), item );
         addAnchor( track->GetEnd(), item );
+        updateSearchRadius( track->GetWidth() / 2 );
         SetDirty();
 
         return item;
@@ -542,6 +622,7 @@ public:
 
         m_items.push_back( item );
         addAnchor( via->GetStart(), item );
+        updateSearchRadius( via->GetWidth() / 2 );
         SetDirty();
         return item;
     }
@@ -630,8 +711,22 @@ public:
 template <class T>
 void CN_LIST::FindNearby( BOX2I aBBox, T aFunc, bool aDirtyOnly )
 {
-    for( auto p : m_anchors )
+    // The anchors are sorted by X: only the ones in the X range of the box are tested
+    Sort();
+
+    int xmin = std::min( aBBox.GetX(), aBBox.GetRight() );
+    int xmax = std::max( aBBox.GetX(), aBBox.GetRight() );
+
+    auto first = std::lower_bound( m_anchors.begin(), m_anchors.end(), xmin,
+            []( const CN_ANCHOR_PTR& aAnchor, int aX )
+            {
+                return aAnchor->Pos().x < aX;
+            } );
+
+    for( auto it = first; it != m_anchors.end() && (*it)->Pos().x <= xmax; ++it )
     {
+        const CN_ANCHOR_PTR& p = *it;
+
         if( p->Valid() && aBBox.Contains( p->Pos() ) )
         {
             if( !aDirtyOnly || p->IsDirty() )
@@ -671,7 +766,7 @@ void CN_LIST::FindNearby( VECTOR2I aPosition, int aDistMax, T aFunc, bool aDirty
      * So from this entry point, a linear search is made to find all candidates
      */
 
-    sort();
+    Sort();
 
     int idxmax = m_anchors.size() - 1;
 
@@ -772,8 +867,6 @@ public:
 
 private:
 
-    bool m_lastSearchWithZones = false;
-
     class ITEM_MAP_ENTRY
     {
 public:
@@ -819,7 +912,8 @@ public:
     std::vector<bool> m_dirtyNets;
     PROGRESS_REPORTER* m_progressReporter = nullptr;
 
-    void    searchConnections( bool aIncludeZones = false );
+    void    searchConnections();
+    void    updateRatsnestClusters();
 
     void    update();
     void    propagateConnections();
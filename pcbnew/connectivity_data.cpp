@@ -29,9 +29,7 @@
 #include <connectivity_algo.h>
 #include <ratsnest_data.h>
 
-#ifdef USE_OPENMP
-#include <omp.h>
-#endif /* USE_OPENMP */
+#include <work_stealing_pool.h>
 
 CONNECTIVITY_DATA::CONNECTIVITY_DATA()
 {
@@ -93,28 +91,20 @@ void CONNECTIVITY_DATA::updateRatsnest()
     PROF_COUNTER rnUpdate( "update-ratsnest" );
     #endif
 
-    int nDirty = 0;
+    std::vector<WORK_STEALING_POOL::TASK> tasks;
 
-    int i;
-
-    #ifdef USE_OPENMP
-        #pragma omp parallel shared(lastNet) private(i)
-    {
-        #pragma omp for schedule(guided, 1)
-    #else /* USE_OPENMP */
+    // Start with net number 1, as 0 stands for not connected
+    for( int i = 1; i < lastNet; ++i )
     {
-    #endif
-
-        // Start with net number 1, as 0 stands for not connected
-        for( i = 1; i < lastNet; ++i )
+        if( m_nets[i]->IsDirty() )
         {
-            if( m_nets[i]->IsDirty() )
-            {
-                m_nets[i]->Update();
-                nDirty++;
-            }
+            RN_NET* net = m_nets[i];
+
+            tasks.push_back( [net]() { net->Update(); } );
         }
-    }          /* end of parallel section */
+    }
+
+    GetThreadPool().Run( tasks );
 
     #ifdef PROFILE
     rnUpdate.Show();
@@ -27,6 +27,12 @@
  * @file drc.cpp
  */
 
+#include <algorithm>
+#include <atomic>
+#include <set>
+#include <tuple>
+#include <unordered_map>
+
 #include <fctsys.h>
 #include <pcb_edit_frame.h>
 #include <trigo.h>
@@ -38,6 +44,7 @@
 #include <class_pad.h>
 #include <class_zone.h>
 #include <class_pcb_text.h>
+#include <class_marker_pcb.h>
 #include <class_draw_panel_gal.h>
 #include <view/view.h>
 #include <geometry/seg.h>
@@ -52,6 +59,11 @@
 #include <pcbnew.h>
 #include <drc.h>
 
+#include <drc_clearance_index.h>
+#include <zone_filler.h>
+#include <work_stealing_pool.h>
+#include <profile.h>
+
 #include <dialog_drc.h>
 #include <wx/progdlg.h>
 #include <board_commit.h>
@@ -97,12 +109,37 @@ void DRC::ShowDRCDialog( wxWindow* aParent )
 
 void DRC::addMarkerToPcb( MARKER_PCB* aMarker )
 {
+    if( !m_pcbEditorFrame )
+    {
+        m_pcb->Add( aMarker );
+        return;
+    }
+
     BOARD_COMMIT commit( m_pcbEditorFrame );
     commit.Add( aMarker );
     commit.Push( wxEmptyString, false );
 }
 
 
+void DRC::addMarkersToPcb( const std::vector<MARKER_PCB*>& aMarkers )
+{
+    if( !m_pcbEditorFrame )
+    {
+        for( auto marker : aMarkers )
+            m_pcb->Add( marker );
+
+        return;
+    }
+
+    BOARD_COMMIT commit( m_pcbEditorFrame );
+
+    for( auto marker : aMarkers )
+        commit.Add( marker );
+
+    commit.Push( wxEmptyString, false );
+}
+
+
 void DRC::DestroyDRCDialog( int aReason )
 {
     if( m_drcDialog )
@@ -119,10 +156,17 @@ void DRC::DestroyDRCDialog( int aReason )
 }
 
 
-DRC::DRC( PCB_EDIT_FRAME* aPcbWindow )
+DRC::DRC( PCB_EDIT_FRAME* aPcbWindow ) :
+    DRC( aPcbWindow->GetBoard() )
 {
     m_pcbEditorFrame = aPcbWindow;
-    m_pcb = aPcbWindow->GetBoard();
+}
+
+
+DRC::DRC( BOARD* aBoard )
+{
+    m_pcbEditorFrame = NULL;
+    m_pcb = aBoard;
     m_drcDialog  = NULL;
 
     // establish initial values for everything:
@@ -141,6 +185,7 @@ DRC::DRC( PCB_EDIT_FRAME* aPcbWindow )
     // m_rptFilename set to empty by its constructor
 
     m_currentMarker = NULL;
+    m_padToPadTests = 0;
 
     m_segmAngle  = 0;
     m_segmLength = 0;
@@ -152,6 +197,23 @@ DRC::DRC( PCB_EDIT_FRAME* aPcbWindow )
 }
 
 
+DRC::DRC( const DRC* aParent ) :
+    DRC( aParent->m_pcb )
+{
+    m_pcbEditorFrame = aParent->m_pcbEditorFrame;
+
+    // The test options of the parent, but not its state
+    m_doPad2PadTest     = aParent->m_doPad2PadTest;
+    m_doUnconnectedTest = aParent->m_doUnconnectedTest;
+    m_doZonesTest = aParent->m_doZonesTest;
+    m_doKeepoutTest = aParent->m_doKeepoutTest;
+    m_doFootprintOverlapping = aParent->m_doFootprintOverlapping;
+    m_doNoCourtyardDefined = aParent->m_doNoCourtyardDefined;
+    m_refillZones = aParent->m_refillZones;
+    m_reportAllTrackErrors = aParent->m_reportAllTrackErrors;
+}
+
+
 DRC::~DRC()
 {
     // maybe someday look at pointainer.h  <- google for "pointainer.h"
@@ -186,8 +248,8 @@ int DRC::Drc( TRACK* aRefSegm, TRACK* aList )
 
 int DRC::TestZoneToZoneOutline( ZONE_CONTAINER* aZone, bool aCreateMarkers )
 {
-    BOARD* board = m_pcbEditorFrame->GetBoard();
-    BOARD_COMMIT commit( m_pcbEditorFrame );
+    BOARD* board = m_pcbEditorFrame ? m_pcbEditorFrame->GetBoard() : m_pcb;
+    std::vector<MARKER_PCB*> markers;
     int nerrors = 0;
 
     // iterate through all areas
@@ -258,7 +320,7 @@ int DRC::TestZoneToZoneOutline( ZONE_CONTAINER* aZone, bool aCreateMarkers )
                         wxString msg2 = zoneToTest->GetSelectMenuText();
                         MARKER_PCB* marker = new MARKER_PCB( COPPERAREA_INSIDE_COPPERAREA,
                                                              pt, msg1, pt, msg2, pt );
-                        commit.Add( marker );
+                        markers.push_back( marker );
                     }
 
                     nerrors++;
@@ -280,7 +342,7 @@ int DRC::TestZoneToZoneOutline( ZONE_CONTAINER* aZone, bool aCreateMarkers )
                         wxString msg2 = zoneRef->GetSelectMenuText();
                         MARKER_PCB* marker = new MARKER_PCB( COPPERAREA_INSIDE_COPPERAREA,
                                                               pt, msg1, pt, msg2, pt );
-                        commit.Add( marker );
+                        markers.push_back( marker );
                     }
 
                     nerrors++;
@@ -328,7 +390,7 @@ int DRC::TestZoneToZoneOutline( ZONE_CONTAINER* aZone, bool aCreateMarkers )
                             wxString msg2 = zoneToTest->GetSelectMenuText();
                             MARKER_PCB* marker = new MARKER_PCB( COPPERAREA_CLOSE_TO_COPPERAREA,
                                                                  pt, msg1, pt, msg2, pt );
-                            commit.Add( marker );
+                            markers.push_back( marker );
                         }
 
                         nerrors++;
@@ -339,7 +401,7 @@ int DRC::TestZoneToZoneOutline( ZONE_CONTAINER* aZone, bool aCreateMarkers )
     }
 
     if( aCreateMarkers )
-        commit.Push( wxEmptyString, false );
+        addMarkersToPcb( markers );
 
     return nerrors;
 }
@@ -366,6 +428,10 @@ void DRC::RunTests( wxTextCtrl* aMessages )
     // ( the board can be reloaded )
     m_pcb = m_pcbEditorFrame->GetBoard();
 
+    // Zone refills and markers are committed during the tests: they must not trigger
+    // TestDirtyAreas()
+    m_drcInProgress = true;
+
     // someone should have cleared the two lists before calling this.
 
     if( !testNetClasses() )
@@ -380,6 +446,7 @@ void DRC::RunTests( wxTextCtrl* aMessages )
         // update the m_drcDialog listboxes
         updatePointers();
 
+        m_drcInProgress = false;
         return;
     }
 
@@ -478,6 +545,8 @@ void DRC::RunTests( wxTextCtrl* aMessages )
     // update the m_drcDialog listboxes
     updatePointers();
 
+    m_drcInProgress = false;
+
     if( aMessages )
     {
         // no newline on this one because it is last, don't want the window
@@ -487,6 +556,76 @@ void DRC::RunTests( wxTextCtrl* aMessages )
 }
 
 
+void DRC::RunBatchTests( std::vector< std::pair<wxString, double> >* aTimings )
+{
+    wxCHECK_RET( !m_pcbEditorFrame, wxT( "RunBatchTests() is only usable without editor frame" ) );
+
+    m_drcInProgress = true;
+
+    auto runPhase = [&]( const wxString& aName, const std::function<void()>& aPhase )
+    {
+        PROF_COUNTER timer( std::string( aName.ToUTF8() ) );
+
+        aPhase();
+        timer.Stop();
+
+        if( aTimings )
+            aTimings->push_back( std::make_pair( aName, timer.msecs() ) );
+    };
+
+    runPhase( wxT( "connectivity" ), [&]()
+    {
+        m_pcb->BuildConnectivity();
+    } );
+
+    // Zones are filled first, so that all the following tests see up to date fills
+    if( m_refillZones )
+    {
+        runPhase( wxT( "zone_fill" ), [&]()
+        {
+            std::vector<ZONE_CONTAINER*> zones( m_pcb->Zones().begin(), m_pcb->Zones().end() );
+            ZONE_FILLER filler( m_pcb );
+
+            filler.Fill( zones );
+        } );
+    }
+
+    bool netclassesOk = true;
+
+    runPhase( wxT( "netclasses" ), [&]()
+    {
+        netclassesOk = testNetClasses();
+    } );
+
+    // See RunTests(): netclass errors would be reported again by every item of the class
+    if( !netclassesOk )
+    {
+        m_drcInProgress = false;
+        return;
+    }
+
+    if( m_doPad2PadTest )
+        runPhase( wxT( "pad_clearances" ), [&]() { testPad2Pad(); } );
+
+    runPhase( wxT( "track_clearances" ), [&]() { testTracks( NULL, false ); } );
+
+    runPhase( wxT( "zones" ), [&]() { testZones(); } );
+
+    if( m_doUnconnectedTest )
+        runPhase( wxT( "unconnected" ), [&]() { testUnconnected(); } );
+
+    if( m_doKeepoutTest )
+        runPhase( wxT( "keepout_areas" ), [&]() { testKeepoutAreas(); } );
+
+    runPhase( wxT( "texts" ), [&]() { testTexts(); } );
+
+    if( m_doFootprintOverlapping || m_doNoCourtyardDefined )
+        runPhase( wxT( "courtyards" ), [&]() { doFootprintOverlappingDrc(); } );
+
+    m_drcInProgress = false;
+}
+
+
 void DRC::ListUnconnectedPads()
 {
     testUnconnected();
@@ -496,10 +635,208 @@ void DRC::ListUnconnectedPads()
 }
 
 
+/**
+ * @return true for the errors reported with a track or via as main item by the track
+ * clearance tests (doTrackDrc()).
+ */
+static bool isTrackClearanceError( int aErrorCode )
+{
+    switch( aErrorCode )
+    {
+    case DRCE_TRACK_NEAR_THROUGH_HOLE:
+    case DRCE_TRACK_NEAR_PAD:
+    case DRCE_TRACK_NEAR_VIA:
+    case DRCE_VIA_NEAR_VIA:
+    case DRCE_VIA_NEAR_TRACK:
+    case DRCE_TRACK_ENDS1:
+    case DRCE_TRACK_ENDS2:
+    case DRCE_TRACK_ENDS3:
+    case DRCE_TRACK_ENDS4:
+    case DRCE_TRACK_SEGMENTS_TOO_CLOSE:
+    case DRCE_TRACKS_CROSSING:
+    case DRCE_ENDS_PROBLEM1:
+    case DRCE_ENDS_PROBLEM2:
+    case DRCE_ENDS_PROBLEM3:
+    case DRCE_ENDS_PROBLEM4:
+    case DRCE_ENDS_PROBLEM5:
+    case DRCE_VIA_HOLE_BIGGER:
+    case DRCE_MICRO_VIA_INCORRECT_LAYER_PAIR:
+    case DRCE_TOO_SMALL_TRACK_WIDTH:
+    case DRCE_TOO_SMALL_VIA:
+    case DRCE_TOO_SMALL_MICROVIA:
+    case DRCE_TOO_SMALL_VIA_DRILL:
+    case DRCE_TOO_SMALL_MICROVIA_DRILL:
+    case DRCE_MICRO_VIA_NOT_ALLOWED:
+    case DRCE_BURIED_VIA_NOT_ALLOWED:
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+
+/**
+ * Identifies the main item of a marker by its type, net code and position, which are
+ * stored in the marker.  Unlike the item address, this stays valid when the item is
+ * deleted, and unlike the item description, it does not depend on the language or units.
+ */
+typedef std::tuple<int, int, int, int> MARKER_ITEM_KEY;
+
+static MARKER_ITEM_KEY markerItemKey( KICAD_T aType, int aNetCode, const wxPoint& aPos )
+{
+    return MARKER_ITEM_KEY( aType, aNetCode, aPos.x, aPos.y );
+}
+
+
+void DRC::TestDirtyAreas( const std::vector<EDA_RECT>& aDirtyAreas,
+                          const std::vector<BOARD_ITEM*>& aChangedItems )
+{
+    // The markers are added through a commit, which must not start a new test
+    if( m_drcInProgress )
+        return;
+
+    m_drcInProgress = true;
+    m_pcb = m_pcbEditorFrame->GetBoard();
+
+    DRC_CLEARANCE_INDEX index;
+    index.Build( m_pcb, aDirtyAreas );
+
+    std::vector< std::vector<MARKER_PCB*> > trackMarkers;
+
+    runTrackTests( index, trackMarkers, m_doKeepoutTest, nullptr );
+
+    std::vector<D_PAD*>      refPads;
+    std::vector<MARKER_PCB*> padMarkers;
+
+    if( m_doPad2PadTest )
+        runPadTests( &aDirtyAreas, refPads, padMarkers );
+
+    // The markers to replace are the ones of the tested items, which are found again if
+    // still valid, and the ones of the changed items in their previous state.  The main item
+    // of a marker is at its main position, so the markers of the changed items are inside
+    // the dirty areas, and any track or pad at this position has just been tested again.
+    std::set<MARKER_ITEM_KEY> testedItems;
+
+    for( int ref : index.References() )
+    {
+        TRACK* track = index.Tracks()[ref];
+
+        testedItems.insert( markerItemKey( track->Type(), track->GetNetCode(),
+                                           track->GetPosition() ) );
+    }
+
+    for( D_PAD* pad : refPads )
+        testedItems.insert( markerItemKey( pad->Type(), pad->GetNetCode(), pad->GetPosition() ) );
+
+    std::vector<EDA_RECT> dirtyAreas = aDirtyAreas;
+
+    for( EDA_RECT& area : dirtyAreas )
+        area.Normalize();
+
+    // The zone tests only depend on the zones, and on the pad count of their nets
+    bool zonesChanged = false;
+    bool padsChanged = false;
+
+    for( BOARD_ITEM* item : aChangedItems )
+    {
+        if( item->Type() == PCB_ZONE_AREA_T )
+            zonesChanged = true;
+        else if( item->Type() == PCB_MODULE_T || item->Type() == PCB_PAD_T )
+            padsChanged = true;
+    }
+
+    auto isReplaced = [&]( const MARKER_PCB* aMarker ) -> bool
+    {
+        const DRC_ITEM& rpt = aMarker->GetReporter();
+        int             code = rpt.GetErrorCode();
+
+        if( code == COPPERAREA_INSIDE_COPPERAREA || code == COPPERAREA_CLOSE_TO_COPPERAREA )
+            return zonesChanged;
+
+        if( code == DRCE_SUSPICIOUS_NET_FOR_ZONE_OUTLINE )
+            return zonesChanged || padsChanged;
+
+        bool tested = isTrackClearanceError( code );
+
+        if( code == DRCE_TRACK_INSIDE_KEEPOUT || code == DRCE_VIA_INSIDE_KEEPOUT )
+            tested = m_doKeepoutTest;
+        else if( code == DRCE_PAD_NEAR_PAD1 || code == DRCE_HOLE_NEAR_PAD )
+            tested = m_doPad2PadTest;
+
+        if( !tested )
+            return false;
+
+        if( testedItems.count( markerItemKey( aMarker->GetMainItemType(),
+                                              aMarker->GetMainItemNetCode(),
+                                              rpt.GetPointA() ) ) )
+            return true;
+
+        for( const EDA_RECT& area : dirtyAreas )
+        {
+            if( area.Contains( rpt.GetPointA() ) )
+                return true;
+        }
+
+        return false;
+    };
+
+    std::vector<MARKER_PCB*> oldMarkers;
+    BOARD_COMMIT             commit( m_pcbEditorFrame );
+
+    for( int ii = 0; ii < m_pcb->GetMARKERCount(); ii++ )
+    {
+        MARKER_PCB* marker = m_pcb->GetMARKER( ii );
+
+        if( isReplaced( marker ) )
+        {
+            commit.Remove( marker );
+            oldMarkers.push_back( marker );
+        }
+    }
+
+    for( const auto& markers : trackMarkers )
+    {
+        for( auto marker : markers )
+            commit.Add( marker );
+    }
+
+    for( auto marker : padMarkers )
+        commit.Add( marker );
+
+    commit.Push( wxEmptyString, false );
+
+    // Without undo entry, the commit does not take the ownership of removed items
+    for( auto marker : oldMarkers )
+        delete marker;
+
+    if( zonesChanged )
+        testZones();
+    else if( padsChanged )
+        testZoneNets();
+
+    if( m_doUnconnectedTest )
+    {
+        // The ratsnest is kept up to date by the commits
+        for( auto item : m_unconnected )
+            delete item;
+
+        m_unconnected.clear();
+        listUnconnectedItems();
+    }
+
+    // update the m_drcDialog listboxes
+    updatePointers();
+
+    m_drcInProgress = false;
+}
+
+
 void DRC::updatePointers()
 {
     // update my pointers, m_pcbEditorFrame is the only unchangeable one
-    m_pcb = m_pcbEditorFrame->GetBoard();
+    if( m_pcbEditorFrame )
+        m_pcb = m_pcbEditorFrame->GetBoard();
 
     if( m_drcDialog )  // Use diag list boxes only in DRC dialog
     {
@@ -627,11 +964,33 @@ bool DRC::testNetClasses()
 
 
 void DRC::testPad2Pad()
+{
+    std::vector<D_PAD*>      refPads;
+    std::vector<MARKER_PCB*> markers;
+
+    runPadTests( nullptr, refPads, markers );
+    addMarkersToPcb( markers );
+}
+
+
+void DRC::runPadTests( const std::vector<EDA_RECT>* aDirtyAreas, std::vector<D_PAD*>& aRefPads,
+                       std::vector<MARKER_PCB*>& aMarkers )
 {
     std::vector<D_PAD*> sortedPads;
 
     m_pcb->GetSortedPadListByXthenYCoord( sortedPads );
 
+    m_padTestStats = DRC_PAD_TEST_STATS();
+    aRefPads.clear();
+    aMarkers.clear();
+
+    if( sortedPads.empty() )
+        return;
+
+    // Building the index also caches the bounding radius of all the pads
+    DRC_CLEARANCE_INDEX index;
+    index.BuildPads( m_pcb );
+
     // find the max size of the pads (used to stop the test)
     int max_size = 0;
 
@@ -646,22 +1005,110 @@ void DRC::testPad2Pad()
             max_size = radius;
     }
 
-    // Test the pads
-    D_PAD** listEnd = &sortedPads[ sortedPads.size() ];
+    // Each pad is tested against the candidates from the index which come after it in the
+    // sorted list, and not beyond the X limit: these are the pads a sweep over the sorted
+    // list would reach, so the same errors are found.
+    std::unordered_map<const D_PAD*, size_t> sortedIndex;
+
+    for( size_t i = 0; i < sortedPads.size(); ++i )
+        sortedIndex[ sortedPads[i] ] = i;
+
+    // The reference pads, as indices in the sorted list
+    std::vector<size_t> references;
 
-    for( unsigned i = 0; i< sortedPads.size(); ++i )
+    if( aDirtyAreas )
     {
-        D_PAD* pad = sortedPads[i];
+        std::vector<D_PAD*> nearPads;
+
+        index.QueryPads( *aDirtyAreas, nearPads );
 
-        int    x_limit = max_size + pad->GetClearance() +
-                         pad->GetBoundingRadius() + pad->GetPosition().x;
+        for( D_PAD* pad : nearPads )
+            references.push_back( sortedIndex.at( pad ) );
 
-        if( !doPadToPadsDrc( pad, &sortedPads[i], listEnd, x_limit ) )
+        std::sort( references.begin(), references.end() );
+    }
+    else
+    {
+        for( size_t i = 0; i < sortedPads.size(); ++i )
+            references.push_back( i );
+    }
+
+    for( size_t i : references )
+        aRefPads.push_back( sortedPads[i] );
+
+    m_padTestStats.m_padCount = references.size();
+
+    if( references.empty() )
+        return;
+
+    std::vector<MARKER_PCB*> markers( references.size(), nullptr );
+    std::atomic<size_t>      next( 0 );
+    std::atomic<size_t>      candidatePairs( 0 );
+    std::atomic<size_t>      narrowPhaseTests( 0 );
+
+    WORK_STEALING_POOL& pool = GetThreadPool();
+    size_t parallelThreadCount = std::min( pool.GetThreadCount(), references.size() );
+
+    std::vector<WORK_STEALING_POOL::TASK> drcWorkers;
+
+    for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+    {
+        drcWorkers.push_back( [ this, &index, &sortedPads, &sortedIndex, &references, &markers,
+                                max_size, &next, &candidatePairs, &narrowPhaseTests ]()
         {
-            wxASSERT( m_currentMarker );
-            addMarkerToPcb ( m_currentMarker );
-            m_currentMarker = nullptr;
-        }
+            DRC worker( this );
+            std::vector<D_PAD*> candidates;
+
+            for( size_t r = next.fetch_add( 1 ); r < references.size(); r = next.fetch_add( 1 ) )
+            {
+                size_t i = references[r];
+                D_PAD* pad = sortedPads[i];
+
+                int    x_limit = max_size + pad->GetClearance() +
+                                 pad->GetBoundingRadius() + pad->GetPosition().x;
+
+                index.QueryPads( pad, candidates );
+
+                candidates.erase( std::remove_if( candidates.begin(), candidates.end(),
+                        [&]( D_PAD* aCandidate )
+                        {
+                            return sortedIndex.at( aCandidate ) < i
+                                   || aCandidate->GetPosition().x > x_limit;
+                        } ), candidates.end() );
+
+                std::sort( candidates.begin(), candidates.end(),
+                        [&]( D_PAD* aFirst, D_PAD* aSecond )
+                        {
+                            return sortedIndex.at( aFirst ) < sortedIndex.at( aSecond );
+                        } );
+
+                candidatePairs.fetch_add( candidates.size() );
+
+                if( candidates.empty() )
+                    continue;
+
+                if( !worker.doPadToPadsDrc( pad, &candidates[0],
+                                            &candidates[0] + candidates.size(), x_limit ) )
+                {
+                    wxASSERT( worker.m_currentMarker );
+                    markers[r] = worker.m_currentMarker;
+                    worker.m_currentMarker = nullptr;
+                }
+            }
+
+            narrowPhaseTests.fetch_add( worker.m_padToPadTests );
+        } );
+    }
+
+    pool.Run( drcWorkers );
+
+    m_padTestStats.m_candidatePairs = candidatePairs.load();
+    m_padTestStats.m_narrowPhaseTests = narrowPhaseTests.load();
+
+    for( MARKER_PCB* marker : markers )
+    {
+        if( marker )
+            aMarkers.push_back( marker );
     }
 }
 
@@ -671,11 +1118,12 @@ void DRC::testTracks( wxWindow *aActiveWindow, bool aShowProgressBar )
     wxProgressDialog * progressDialog = NULL;
     const int delta = 500;  // This is the number of tests between 2 calls to the
                             // progress bar
-    int count = 0;
 
-    for( TRACK* segm = m_pcb->m_Track; segm && segm->Next(); segm = segm->Next() )
-        count++;
+    DRC_CLEARANCE_INDEX index;
+    index.Build( m_pcb );
 
+    const std::vector<TRACK*>& tracks = index.Tracks();
+    int count = tracks.size();
     int deltamax = count/delta;
 
     if( aShowProgressBar && deltamax > 3 )
@@ -688,40 +1136,105 @@ void DRC::testTracks( wxWindow *aActiveWindow, bool aShowProgressBar )
         progressDialog->Update( 0, wxEmptyString );
     }
 
-    int ii = 0;
-    count = 0;
-
-    for( TRACK* segm = m_pcb->m_Track; segm; segm = segm->Next() )
+    auto updateProgress = [&]( size_t aDone ) -> bool
     {
-        if( ii++ > delta )
-        {
-            ii = 0;
-            count++;
+        if( !progressDialog )
+            return true;
 
-            if( progressDialog )
-            {
-                if( !progressDialog->Update( count, wxEmptyString ) )
-                    break;  // Aborted by user
+        int progress = std::min( (int) aDone / delta, deltamax );
+
+        if( !progressDialog->Update( progress, wxEmptyString ) )
+            return false;   // Aborted by user
 #ifdef __WXMAC__
-                // Work around a dialog z-order issue on OS X
-                if( count == deltamax )
-                    aActiveWindow->Raise();
+        // Work around a dialog z-order issue on OS X
+        if( progress == deltamax )
+            aActiveWindow->Raise();
 #endif
-            }
-        }
+        return true;
+    };
+
+    std::vector< std::vector<MARKER_PCB*> > markers;
+
+    runTrackTests( index, markers, false, updateProgress );
+
+    // Markers are added to the board in the track order, so the result does not depend
+    // on the scheduling of the workers.
+    std::vector<MARKER_PCB*> allMarkers;
+
+    for( const auto& trackMarkers : markers )
+        allMarkers.insert( allMarkers.end(), trackMarkers.begin(), trackMarkers.end() );
+
+    addMarkersToPcb( allMarkers );
+
+    if( progressDialog )
+        progressDialog->Destroy();
+}
 
-        if( !doTrackDrc( segm, segm->Next(), true ) )
+
+void DRC::runTrackTests( const DRC_CLEARANCE_INDEX& aIndex,
+                         std::vector< std::vector<MARKER_PCB*> >& aMarkers, bool aTestKeepouts,
+                         const std::function<bool( size_t )>& aProgress )
+{
+    const std::vector<TRACK*>& tracks = aIndex.Tracks();
+    const std::vector<int>&    references = aIndex.References();
+
+    aMarkers.clear();
+    aMarkers.resize( references.size() );
+
+    if( references.empty() )
+        return;
+
+    std::atomic<size_t> next( 0 );
+    std::atomic<size_t> count_done( 0 );
+    std::atomic<bool>   cancelled( false );
+
+    WORK_STEALING_POOL& pool = GetThreadPool();
+    size_t parallelThreadCount = std::min( pool.GetThreadCount(), references.size() );
+
+    std::vector<std::future<void>> drcWorkers;
+
+    for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+    {
+        drcWorkers.push_back( pool.Submit( [ this, &aIndex, &tracks, &references, &aMarkers,
+                                             aTestKeepouts, &next, &count_done, &cancelled ]()
         {
-            if( m_currentMarker )
+            DRC worker( this );
+            std::vector<TRACK*> candidateTracks;
+            std::vector<D_PAD*> candidatePads;
+
+            for( size_t i = next.fetch_add( 1 ); i < references.size(); i = next.fetch_add( 1 ) )
             {
-                addMarkerToPcb ( m_currentMarker );
-                m_currentMarker = nullptr;
+                if( !cancelled.load() )
+                {
+                    TRACK* refSeg = tracks[ references[i] ];
+
+                    aIndex.QueryTracks( references[i], candidateTracks );
+                    aIndex.QueryPads( refSeg, candidatePads );
+
+                    worker.doTrackDrc( refSeg, candidateTracks, candidatePads, aMarkers[i] );
+
+                    if( aTestKeepouts )
+                        worker.doTrackKeepoutDrc( refSeg, aMarkers[i] );
+                }
+
+                count_done.fetch_add( 1 );
             }
+        } ) );
+    }
+
+    if( aProgress )
+    {
+        while( count_done.load() < references.size() )
+        {
+            if( !cancelled.load() && !aProgress( count_done.load() ) )
+                cancelled.store( true );
+
+            wxMilliSleep( 20 );
         }
     }
 
-    if( progressDialog )
-        progressDialog->Destroy();
+    for( auto& worker : drcWorkers )
+        worker.wait();
 }
 
 
@@ -734,6 +1247,14 @@ void DRC::testUnconnected()
     connectivity->Build( m_pcb ); // just in case. This really needs to be reliable.
     connectivity->RecalculateRatsnest();
 
+    listUnconnectedItems();
+}
+
+
+void DRC::listUnconnectedItems()
+{
+    auto connectivity = m_pcb->GetConnectivity();
+
     std::vector<CN_EDGE> edges;
     connectivity->GetUnconnectedEdges( edges );
 
@@ -756,6 +1277,15 @@ void DRC::testUnconnected()
 
 
 void DRC::testZones()
+{
+    testZoneNets();
+
+    // Test copper areas outlines, and create markers when needed
+    TestZoneToZoneOutline( NULL, true );
+}
+
+
+void DRC::testZoneNets()
 {
     // Test copper areas for valid netcodes
     // if a netcode is < 0 the netname was not found when reading a netlist
@@ -787,9 +1317,6 @@ void DRC::testZones()
             m_currentMarker = nullptr;
         }
     }
-
-    // Test copper areas outlines, and create markers when needed
-    TestZoneToZoneOutline( NULL, true );
 }
 
 
@@ -807,39 +1334,12 @@ void DRC::testKeepoutAreas()
 
         for( TRACK* segm = m_pcb->m_Track; segm != NULL; segm = segm->Next() )
         {
-            if( segm->Type() == PCB_TRACE_T )
-            {
-                if( !area->GetDoNotAllowTracks()  )
-                    continue;
+            int errorCode = checkTrackInKeepout( area, segm );
 
-                // Ignore if the keepout zone is not on the same layer
-                if( !area->IsOnLayer( segm->GetLayer() ) )
-                    continue;
-
-                if( area->Outline()->Distance( SEG( segm->GetStart(), segm->GetEnd() ),
-                                               segm->GetWidth() ) == 0 )
-                {
-                    addMarkerToPcb( fillMarker( segm, NULL,
-                                                DRCE_TRACK_INSIDE_KEEPOUT, m_currentMarker ) );
-                    m_currentMarker = nullptr;
-                }
-            }
-            else if( segm->Type() == PCB_VIA_T )
+            if( errorCode )
             {
-                if( ! area->GetDoNotAllowVias()  )
-                    continue;
-
-                auto viaLayers = segm->GetLayerSet();
-
-                if( !area->CommonLayerExists( viaLayers ) )
-                    continue;
-
-                if( area->Outline()->Distance( segm->GetPosition() ) < segm->GetWidth()/2 )
-                {
-                    addMarkerToPcb( fillMarker( segm, NULL,
-                                                DRCE_VIA_INSIDE_KEEPOUT, m_currentMarker ) );
-                    m_currentMarker = nullptr;
-                }
+                addMarkerToPcb( fillMarker( segm, NULL, errorCode, m_currentMarker ) );
+                m_currentMarker = nullptr;
             }
         }
         // Test pads: TODO
@@ -976,47 +1476,64 @@ bool DRC::doTrackKeepoutDrc( TRACK* aRefSeg )
     // Test keepout areas for vias, tracks and pads inside keepout areas
     for( int ii = 0; ii < m_pcb->GetAreaCount(); ii++ )
     {
-        ZONE_CONTAINER* area = m_pcb->GetArea( ii );
-
-        if( !area->GetIsKeepout() )
-            continue;
+        int errorCode = checkTrackInKeepout( m_pcb->GetArea( ii ), aRefSeg );
 
-        if( aRefSeg->Type() == PCB_TRACE_T )
+        if( errorCode )
         {
-            if( !area->GetDoNotAllowTracks()  )
-                continue;
+            m_currentMarker = fillMarker( aRefSeg, NULL, errorCode, m_currentMarker );
+            return false;
+        }
+    }
 
-            if( !area->IsOnLayer( aRefSeg->GetLayer() ) )
-                continue;
+    return true;
+}
 
-            if( area->Outline()->Distance( SEG( aRefSeg->GetStart(), aRefSeg->GetEnd() ),
-                                           aRefSeg->GetWidth() ) == 0 )
-            {
-                m_currentMarker = fillMarker( aRefSeg, NULL,
-                                              DRCE_TRACK_INSIDE_KEEPOUT, m_currentMarker );
-                return false;
-            }
-        }
-        else if( aRefSeg->Type() == PCB_VIA_T )
-        {
-            if( !area->GetDoNotAllowVias() )
-                continue;
 
-            auto viaLayers = aRefSeg->GetLayerSet();
+void DRC::doTrackKeepoutDrc( TRACK* aRefSeg, std::vector<MARKER_PCB*>& aMarkers )
+{
+    for( int ii = 0; ii < m_pcb->GetAreaCount(); ii++ )
+    {
+        int errorCode = checkTrackInKeepout( m_pcb->GetArea( ii ), aRefSeg );
+
+        if( errorCode )
+            aMarkers.push_back( fillMarker( aRefSeg, NULL, errorCode, nullptr ) );
+    }
+}
 
-            if( !area->CommonLayerExists( viaLayers ) )
-                continue;
 
-            if( area->Outline()->Distance( aRefSeg->GetPosition() ) < aRefSeg->GetWidth()/2 )
-            {
-                m_currentMarker = fillMarker( aRefSeg, NULL,
-                                              DRCE_VIA_INSIDE_KEEPOUT, m_currentMarker );
-                return false;
-            }
-        }
+int DRC::checkTrackInKeepout( ZONE_CONTAINER* aArea, TRACK* aRefSeg )
+{
+    if( !aArea->GetIsKeepout() )
+        return 0;
+
+    if( aRefSeg->Type() == PCB_TRACE_T )
+    {
+        if( !aArea->GetDoNotAllowTracks()  )
+            return 0;
+
+        // Ignore if the keepout zone is not on the same layer
+        if( !aArea->IsOnLayer( aRefSeg->GetLayer() ) )
+            return 0;
+
+        if( aArea->Outline()->Distance( SEG( aRefSeg->GetStart(), aRefSeg->GetEnd() ),
+                                        aRefSeg->GetWidth() ) == 0 )
+            return DRCE_TRACK_INSIDE_KEEPOUT;
     }
+    else if( aRefSeg->Type() == PCB_VIA_T )
+    {
+        if( !aArea->GetDoNotAllowVias() )
+            return 0;
 
-    return true;
+        auto viaLayers = aRefSeg->GetLayerSet();
+
+        if( !aArea->CommonLayerExists( viaLayers ) )
+            return 0;
+
+        if( aArea->Outline()->Distance( aRefSeg->GetPosition() ) < aRefSeg->GetWidth()/2 )
+            return DRCE_VIA_INSIDE_KEEPOUT;
+    }
+
+    return 0;
 }
 
 
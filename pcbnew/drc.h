@@ -31,6 +31,7 @@
 
 #include <vector>
 #include <memory>
+#include <functional>
 
 #define OK_DRC  0
 #define BAD_DRC 1
@@ -103,6 +104,8 @@ class TRACK;
 class MARKER_PCB;
 class DRC_ITEM;
 class NETCLASS;
+class EDA_RECT;
+class DRC_CLEARANCE_INDEX;
 
 
 /**
@@ -151,6 +154,18 @@ public:
 typedef std::vector<DRC_ITEM*> DRC_LIST;
 
 
+/**
+ * Counters of the pad to pad clearance test, used to measure the pruning of the
+ * pad pairs by the spatial index.
+ */
+struct DRC_PAD_TEST_STATS
+{
+    size_t m_padCount = 0;          ///< number of pads tested
+    size_t m_candidatePairs = 0;    ///< pad pairs kept by the spatial index
+    size_t m_narrowPhaseTests = 0;  ///< calls to DRC::checkClearancePadToPad()
+};
+
+
 /**
  * Design Rule Checker object that performs all the DRC tests.  The output of
  * the checking goes to the BOARD file in the form of two MARKER lists.  Those
@@ -212,6 +227,9 @@ private:
 
     DRC_LIST            m_unconnected;      ///< list of unconnected pads, as DRC_ITEMs
 
+    DRC_PAD_TEST_STATS  m_padTestStats;     ///< counters of the last pad to pad test
+    size_t              m_padToPadTests;    ///< calls to checkClearancePadToPad()
+
 
     /**
      * Update needed pointers from the one pointer which is known not to change.
@@ -265,10 +283,17 @@ private:
     MARKER_PCB* fillMarker( int aErrorCode, const wxString& aMessage, MARKER_PCB* fillMe );
 
     /**
-     * Adds a DRC marker to the PCB through the COMMIT mechanism.
+     * Adds a DRC marker to the PCB through the COMMIT mechanism, or directly to the
+     * board when there is no editor frame.
      */
     void addMarkerToPcb( MARKER_PCB* aMarker );
 
+    /**
+     * Adds a set of DRC markers to the PCB in one commit, or directly to the board when
+     * there is no editor frame.
+     */
+    void addMarkersToPcb( const std::vector<MARKER_PCB*>& aMarkers );
+
     //-----<categorical group tests>-----------------------------------------
 
     /**
@@ -292,12 +317,49 @@ private:
      */
     void testTracks( wxWindow * aActiveWindow, bool aShowProgressBar );
 
+    /**
+     * Run the clearance tests (and optionally the keepout tests) of the reference tracks
+     * of \a aIndex, spread over worker threads.
+     *
+     * @param aIndex The clearance index to test
+     * @param aMarkers Receives the markers found for each reference, in References() order
+     * @param aTestKeepouts true to also test the references against the keepout areas
+     * @param aProgress Called from this thread while the workers are running, with the
+     *                  number of references done.  Returns false to abort the tests.  Can be
+     *                  empty.
+     */
+    void runTrackTests( const DRC_CLEARANCE_INDEX& aIndex,
+                        std::vector< std::vector<MARKER_PCB*> >& aMarkers, bool aTestKeepouts,
+                        const std::function<bool( size_t )>& aProgress );
+
     void testPad2Pad();
 
+    /**
+     * Run the pad to pad clearance tests, spread over worker threads.
+     *
+     * @param aDirtyAreas When not null, only the pads whose clearance area intersects one
+     *                    of these areas are tested against the other pads
+     * @param aRefPads Receives the tested pads
+     * @param aMarkers Receives the markers found, in the order of the sorted pad list
+     */
+    void runPadTests( const std::vector<EDA_RECT>* aDirtyAreas, std::vector<D_PAD*>& aRefPads,
+                      std::vector<MARKER_PCB*>& aMarkers );
+
     void testUnconnected();
 
+    /**
+     * Fill m_unconnected from the current ratsnest, without rebuilding the connectivity.
+     */
+    void listUnconnectedItems();
+
     void testZones();
 
+    /**
+     * Test the nets of the copper zones, which is the part of testZones() depending on the
+     * pads of the board.
+     */
+    void testZoneNets();
+
     void testKeepoutAreas();
 
     void testTexts();
@@ -329,6 +391,20 @@ private:
      */
     bool doTrackDrc( TRACK* aRefSeg, TRACK* aStart, bool doPads = true );
 
+    /**
+     * Test the current segment against a list of candidate items, without adding the
+     * resulting markers to the board.  This function does not use the board editor and
+     * can be run concurrently by several worker DRC instances.
+     *
+     * @param aRefSeg The segment to test
+     * @param aTracks The tracks to test against, in the order they must be reported
+     * @param aPads The pads to test against, in the order they must be reported
+     * @param aMarkers The list the new markers are appended to
+     * @return bool - true if no problems, else false
+     */
+    bool doTrackDrc( TRACK* aRefSeg, const std::vector<TRACK*>& aTracks,
+                     const std::vector<D_PAD*>& aPads, std::vector<MARKER_PCB*>& aMarkers );
+
     /**
      * Test the current segment or via.
      *
@@ -338,6 +414,18 @@ private:
      */
     bool doTrackKeepoutDrc( TRACK* aRefSeg );
 
+    /**
+     * Test the current segment or via against all the keepout areas, and append a marker
+     * for each area it is not allowed in.
+     */
+    void doTrackKeepoutDrc( TRACK* aRefSeg, std::vector<MARKER_PCB*>& aMarkers );
+
+    /**
+     * @return the DRC error code if aRefSeg is not allowed in the keepout area aArea,
+     *         or 0 if aRefSeg passes this test.
+     */
+    int checkTrackInKeepout( ZONE_CONTAINER* aArea, TRACK* aRefSeg );
+
 
     /**
      * Test a segment in ZONE_CONTAINER * aArea:
@@ -411,9 +499,22 @@ private:
 
     //-----</single tests>---------------------------------------------
 
+    /**
+     * Create a worker instance sharing the board and the test settings of \a aParent.
+     * The single item tests store intermediate results in members, so each thread
+     * running them needs its own DRC instance.
+     */
+    DRC( const DRC* aParent );
+
 public:
     DRC( PCB_EDIT_FRAME* aPcbWindow );
 
+    /**
+     * Create a DRC without user interface, to test \a aBoard with RunBatchTests().
+     * The markers are added directly to the board, without undo entries.
+     */
+    DRC( BOARD* aBoard );
+
     ~DRC();
 
     /**
@@ -532,12 +633,53 @@ public:
      */
     void RunTests( wxTextCtrl* aMessages = NULL );
 
+    /**
+     * Run all the tests specified with a previous call to SetSettings(), without user
+     * interface.  The zones are refilled first if requested.  Only usable by a DRC created
+     * without editor frame.
+     *
+     * @param aTimings = if not NULL, receives the name and the duration (in ms) of
+     * each test phase, in execution order
+     */
+    void RunBatchTests( std::vector< std::pair<wxString, double> >* aTimings = NULL );
+
+    /**
+     * @return the counters of the last pad to pad clearance test.
+     */
+    const DRC_PAD_TEST_STATS& GetPadTestStats() const
+    {
+        return m_padTestStats;
+    }
+
+    /**
+     * @return the unconnected items found by the last run of the tests.
+     */
+    const DRC_LIST& GetUnconnectedItems() const
+    {
+        return m_unconnected;
+    }
+
     /**
      * Gather a list of all the unconnected pads and shows them in the
      * dialog, and optionally prints a report of such.
      */
     void ListUnconnectedPads();
 
+    /**
+     * Re-run the track clearance, pad clearance, keepout and unconnected tests after a
+     * change limited to some areas of the board.  Only the tracks, vias and pads near these
+     * areas are tested again, and the markers of these items and of the changed items are
+     * replaced.  The markers are matched by their main item description and position, so
+     * the markers from RunTests(), from a previous call or from a reloaded board are all
+     * replaced.  The zone tests are run again when a zone, or a pad, was changed.
+     *
+     * @param aDirtyAreas The bounding boxes of the added and removed items, and of the
+     *                    modified items before and after the change
+     * @param aChangedItems The items added, removed or modified by the change
+     */
+    void TestDirtyAreas( const std::vector<EDA_RECT>& aDirtyAreas,
+                         const std::vector<BOARD_ITEM*>& aChangedItems );
+
     /**
      * @return a pointer to the current marker (last created marker
      */
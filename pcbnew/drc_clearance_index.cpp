@@ -0,0 +1,378 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <algorithm>
+
+#include <class_board.h>
+#include <class_track.h>
+#include <class_pad.h>
+
+#include <drc_clearance_index.h>
+
+/*
+ * The clearance tests work on coordinates rotated to the reference segment axis,
+ * and round each rotated coordinate.  Items closer than this margin to the clearance
+ * limit are always returned as candidates and left to the fine tests.
+ */
+static const int s_roundingMargin = 1000;
+
+/*
+ * The pad tests first check the segment against the pad bounding box, in the pad
+ * orientation, grown by the clearance.  The corners of this box are at most sqrt(2) times
+ * (pad bounding radius + clearance) away from the pad centre, so both the pad extent
+ * and the query extent are scaled by 3/2 to stay conservative.
+ */
+static inline int padScale( int aValue )
+{
+    return aValue + ( aValue >> 1 );
+}
+
+
+static EDA_RECT segmentArea( const TRACK* aTrack, int aMargin )
+{
+    EDA_RECT area( aTrack->GetStart(), wxSize( 0, 0 ) );
+
+    area.SetEnd( aTrack->GetEnd() );
+    area.Normalize();
+    area.Inflate( aMargin );
+
+    return area;
+}
+
+
+/*
+ * The area covered by a pad, and the copper layers where it can collide.  Drilled pads
+ * collide on all copper layers, because of their hole.
+ */
+static EDA_RECT padArea( D_PAD* aPad, LSET& aLayers )
+{
+    const LSET allCu = LSET::AllCuMask();
+
+    // GetBoundingRadius() caches its result: compute it now, before the index is
+    // shared between threads.
+    EDA_RECT area( aPad->ShapePos(), wxSize( 0, 0 ) );
+
+    area.Inflate( padScale( aPad->GetBoundingRadius() ) );
+    aLayers = aPad->GetLayerSet() & allCu;
+
+    if( aPad->GetDrillSize().x )
+    {
+        // The hole is tested on all copper layers, even if the pad is not
+        EDA_RECT hole( aPad->GetPosition(), wxSize( 0, 0 ) );
+
+        hole.Inflate( padScale( std::max( aPad->GetDrillSize().x,
+                                          aPad->GetDrillSize().y ) / 2 ) );
+        area.Merge( hole );
+        aLayers = allCu;
+    }
+
+    return area;
+}
+
+
+static void insert( RTree<int, int, 2, double>& aTree, const EDA_RECT& aArea, int aIndex )
+{
+    int min[2] = { aArea.GetX(), aArea.GetY() };
+    int max[2] = { aArea.GetRight(), aArea.GetBottom() };
+
+    aTree.Insert( min, max, aIndex );
+}
+
+
+DRC_CLEARANCE_INDEX::DRC_CLEARANCE_INDEX() :
+    m_maxClearance( 0 )
+{
+}
+
+
+void DRC_CLEARANCE_INDEX::Build( BOARD* aBoard )
+{
+    build( aBoard, nullptr );
+}
+
+
+void DRC_CLEARANCE_INDEX::Build( BOARD* aBoard, const std::vector<EDA_RECT>& aDirtyAreas )
+{
+    build( aBoard, &aDirtyAreas );
+}
+
+
+void DRC_CLEARANCE_INDEX::build( BOARD* aBoard, const std::vector<EDA_RECT>* aDirtyAreas )
+{
+    m_tracks.clear();
+    m_references.clear();
+    m_pads = aBoard->GetPads();
+    m_maxClearance = 0;
+
+    for( int layer = 0; layer < MAX_CU_LAYERS; ++layer )
+    {
+        m_trackTrees[layer].RemoveAll();
+        m_padTrees[layer].RemoveAll();
+    }
+
+    const LSET allCu = LSET::AllCuMask();
+
+    std::vector<EDA_RECT> trackAreas;
+    std::vector<EDA_RECT> padAreas;
+    std::vector<LSET>     padLayers;
+
+    for( TRACK* track = aBoard->m_Track; track; track = track->Next() )
+    {
+        m_tracks.push_back( track );
+        trackAreas.push_back( segmentArea( track, ( track->GetWidth() + 1 ) / 2 ) );
+        m_maxClearance = std::max( m_maxClearance, track->GetClearance( NULL ) );
+    }
+
+    for( D_PAD* pad : m_pads )
+    {
+        LSET layers;
+
+        m_maxClearance = std::max( m_maxClearance, pad->GetClearance( NULL ) );
+        padAreas.push_back( padArea( pad, layers ) );
+        padLayers.push_back( layers );
+    }
+
+    // Without dirty areas, everything is tested and indexed
+    bool     indexAll = ( aDirtyAreas == nullptr );
+    EDA_RECT indexedArea;
+
+    if( !indexAll )
+    {
+        std::vector<EDA_RECT> areas = *aDirtyAreas;
+
+        for( EDA_RECT& area : areas )
+        {
+            area.Normalize();
+            area.Inflate( m_maxClearance + s_roundingMargin );
+        }
+
+        for( unsigned idx = 0; idx < m_tracks.size(); ++idx )
+        {
+            for( const EDA_RECT& area : areas )
+            {
+                if( trackAreas[idx].Intersects( area ) )
+                {
+                    // The pad query area contains the track query area
+                    if( m_references.empty() )
+                        indexedArea = padQueryArea( m_tracks[idx] );
+                    else
+                        indexedArea.Merge( padQueryArea( m_tracks[idx] ) );
+
+                    m_references.push_back( idx );
+                    break;
+                }
+            }
+        }
+    }
+    else
+    {
+        for( unsigned idx = 0; idx < m_tracks.size(); ++idx )
+            m_references.push_back( idx );
+    }
+
+    if( m_references.empty() )
+        return;
+
+    for( unsigned idx = 0; idx < m_tracks.size(); ++idx )
+    {
+        if( !indexAll && !trackAreas[idx].Intersects( indexedArea ) )
+            continue;
+
+        for( PCB_LAYER_ID layer : ( m_tracks[idx]->GetLayerSet() & allCu ).Seq() )
+            insert( m_trackTrees[layer], trackAreas[idx], idx );
+    }
+
+    for( unsigned idx = 0; idx < m_pads.size(); ++idx )
+    {
+        if( !indexAll && !padAreas[idx].Intersects( indexedArea ) )
+            continue;
+
+        for( PCB_LAYER_ID layer : padLayers[idx].Seq() )
+            insert( m_padTrees[layer], padAreas[idx], idx );
+    }
+}
+
+
+void DRC_CLEARANCE_INDEX::BuildPads( BOARD* aBoard )
+{
+    m_tracks.clear();
+    m_references.clear();
+    m_pads = aBoard->GetPads();
+    m_maxClearance = 0;
+
+    for( int layer = 0; layer < MAX_CU_LAYERS; ++layer )
+    {
+        m_trackTrees[layer].RemoveAll();
+        m_padTrees[layer].RemoveAll();
+    }
+
+    for( D_PAD* pad : m_pads )
+        m_maxClearance = std::max( m_maxClearance, pad->GetClearance( NULL ) );
+
+    for( unsigned idx = 0; idx < m_pads.size(); ++idx )
+    {
+        LSET     layers;
+        EDA_RECT area = padArea( m_pads[idx], layers );
+
+        for( PCB_LAYER_ID layer : layers.Seq() )
+            insert( m_padTrees[layer], area, idx );
+    }
+}
+
+
+EDA_RECT DRC_CLEARANCE_INDEX::trackQueryArea( const TRACK* aRefSeg ) const
+{
+    return segmentArea( aRefSeg,
+                        ( aRefSeg->GetWidth() + 1 ) / 2 + m_maxClearance + s_roundingMargin );
+}
+
+
+EDA_RECT DRC_CLEARANCE_INDEX::padQueryArea( const TRACK* aRefSeg ) const
+{
+    return segmentArea( aRefSeg,
+                        padScale( ( aRefSeg->GetWidth() + 1 ) / 2 + m_maxClearance )
+                        + s_roundingMargin );
+}
+
+
+EDA_RECT DRC_CLEARANCE_INDEX::padQueryArea( const D_PAD* aRefPad ) const
+{
+    // The pad extent is already part of the indexed areas: only the area which can
+    // collide with the reference pad, and with its hole, is needed
+    int      margin = m_maxClearance + s_roundingMargin;
+    EDA_RECT area( aRefPad->ShapePos(), wxSize( 0, 0 ) );
+
+    area.Inflate( aRefPad->GetBoundingRadius() + margin );
+
+    if( aRefPad->GetDrillSize().x )
+    {
+        EDA_RECT hole( aRefPad->GetPosition(), wxSize( 0, 0 ) );
+
+        hole.Inflate( std::max( aRefPad->GetDrillSize().x, aRefPad->GetDrillSize().y ) / 2
+                      + margin );
+        area.Merge( hole );
+    }
+
+    return area;
+}
+
+
+void DRC_CLEARANCE_INDEX::query( const ITEM_TREE* aTrees, LSET aLayers, const EDA_RECT& aArea,
+                                 std::vector<int>& aResult ) const
+{
+    int min[2] = { aArea.GetX(), aArea.GetY() };
+    int max[2] = { aArea.GetRight(), aArea.GetBottom() };
+
+    aResult.clear();
+
+    auto visitor = [&aResult]( int aIndex ) -> bool
+    {
+        aResult.push_back( aIndex );
+        return true;
+    };
+
+    // RTree::Search() does not modify the tree, it is only missing the const qualifier
+    for( PCB_LAYER_ID layer : ( aLayers & LSET::AllCuMask() ).Seq() )
+        const_cast<ITEM_TREE&>( aTrees[layer] ).Search( min, max, visitor );
+
+    // Items on several layers are found more than once
+    std::sort( aResult.begin(), aResult.end() );
+    aResult.erase( std::unique( aResult.begin(), aResult.end() ), aResult.end() );
+}
+
+
+void DRC_CLEARANCE_INDEX::QueryTracks( int aRefIndex, std::vector<TRACK*>& aResult ) const
+{
+    const TRACK*     refSeg = m_tracks[aRefIndex];
+    std::vector<int> found;
+
+    query( m_trackTrees, refSeg->GetLayerSet(), trackQueryArea( refSeg ), found );
+
+    aResult.clear();
+
+    // The linear DRC only tests the tracks stored after the reference
+    for( int idx : found )
+    {
+        if( idx > aRefIndex )
+            aResult.push_back( m_tracks[idx] );
+    }
+}
+
+
+void DRC_CLEARANCE_INDEX::QueryPads( const TRACK* aRefSeg, std::vector<D_PAD*>& aResult ) const
+{
+    std::vector<int> found;
+
+    query( m_padTrees, aRefSeg->GetLayerSet(), padQueryArea( aRefSeg ), found );
+
+    aResult.clear();
+
+    for( int idx : found )
+        aResult.push_back( m_pads[idx] );
+}
+
+
+void DRC_CLEARANCE_INDEX::QueryPads( const D_PAD* aRefPad, std::vector<D_PAD*>& aResult ) const
+{
+    std::vector<int> found;
+    LSET             layers = aRefPad->GetLayerSet();
+
+    // A hole can collide on all copper layers
+    if( aRefPad->GetDrillSize().x )
+        layers = LSET::AllCuMask();
+
+    query( m_padTrees, layers, padQueryArea( aRefPad ), found );
+
+    aResult.clear();
+
+    for( int idx : found )
+    {
+        if( m_pads[idx] != aRefPad )
+            aResult.push_back( m_pads[idx] );
+    }
+}
+
+
+void DRC_CLEARANCE_INDEX::QueryPads( const std::vector<EDA_RECT>& aAreas,
+                                     std::vector<D_PAD*>& aResult ) const
+{
+    std::vector<int> found;
+    std::vector<int> all;
+
+    for( EDA_RECT area : aAreas )
+    {
+        area.Normalize();
+        area.Inflate( m_maxClearance + s_roundingMargin );
+
+        query( m_padTrees, LSET::AllCuMask(), area, found );
+        all.insert( all.end(), found.begin(), found.end() );
+    }
+
+    std::sort( all.begin(), all.end() );
+    all.erase( std::unique( all.begin(), all.end() ), all.end() );
+
+    aResult.clear();
+
+    for( int idx : all )
+        aResult.push_back( m_pads[idx] );
+}
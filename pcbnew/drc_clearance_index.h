@@ -0,0 +1,137 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef DRC_CLEARANCE_INDEX_H
+#define DRC_CLEARANCE_INDEX_H
+
+#include <vector>
+
+#include <eda_rect.h>
+#include <layers_id_colors_and_visibility.h>
+#include <geometry/rtree.h>
+
+class BOARD;
+class TRACK;
+class D_PAD;
+
+/**
+ * Spatial index of the copper items tested by the track clearance DRC.
+ *
+ * Tracks, vias and pads are stored in one R-tree per copper layer, and each query
+ * returns a conservative superset of the items which can violate the clearance of
+ * a reference track, via or pad: items outside of the returned set are guaranteed to
+ * pass the single item tests of DRC::doTrackDrc() and DRC::doPadToPadsDrc().
+ *
+ * Query results are sorted in the order used by the linear DRC (the track list order
+ * and the BOARD::GetPads() order), so that the first reported error is the same.
+ *
+ * Once built, the index is read only and can be queried concurrently.
+ */
+class DRC_CLEARANCE_INDEX
+{
+public:
+    DRC_CLEARANCE_INDEX();
+
+    /**
+     * Index all tracks, vias and pads of \a aBoard.  All the tracks and vias are
+     * references.
+     */
+    void Build( BOARD* aBoard );
+
+    /**
+     * Index only the items needed to test the tracks and vias whose clearance area
+     * intersects one of \a aDirtyAreas.  Only these tracks and vias are references.
+     */
+    void Build( BOARD* aBoard, const std::vector<EDA_RECT>& aDirtyAreas );
+
+    /**
+     * Index only the pads of \a aBoard, for the pad to pad clearance tests.
+     */
+    void BuildPads( BOARD* aBoard );
+
+    /**
+     * @return all the tracks and vias of the board, in the BOARD::m_Track order.
+     */
+    const std::vector<TRACK*>& Tracks() const { return m_tracks; }
+
+    /**
+     * @return the indices in Tracks() of the tracks and vias to be tested, in increasing order.
+     */
+    const std::vector<int>& References() const { return m_references; }
+
+    /**
+     * @return all the pads of the board, in the BOARD::GetPads() order.
+     */
+    const std::vector<D_PAD*>& Pads() const { return m_pads; }
+
+    /**
+     * @return the largest clearance found on the board.
+     */
+    int GetMaxClearance() const { return m_maxClearance; }
+
+    /**
+     * Collect the tracks and vias stored after Tracks()[aRefIndex] which can violate its
+     * clearance.
+     */
+    void QueryTracks( int aRefIndex, std::vector<TRACK*>& aResult ) const;
+
+    /**
+     * Collect the pads (or pad holes) which can violate the clearance of aRefSeg.
+     */
+    void QueryPads( const TRACK* aRefSeg, std::vector<D_PAD*>& aResult ) const;
+
+    /**
+     * Collect the pads (or pad holes) which can violate the clearance of aRefPad, or of
+     * its hole.  aRefPad itself is not returned.
+     */
+    void QueryPads( const D_PAD* aRefPad, std::vector<D_PAD*>& aResult ) const;
+
+    /**
+     * Collect the pads whose clearance area intersects one of \a aAreas, in the Pads()
+     * order.  These are the pads whose clearance test can be changed by the items of
+     * these areas.
+     */
+    void QueryPads( const std::vector<EDA_RECT>& aAreas, std::vector<D_PAD*>& aResult ) const;
+
+private:
+    typedef RTree<int, int, 2, double> ITEM_TREE;
+
+    void build( BOARD* aBoard, const std::vector<EDA_RECT>* aDirtyAreas );
+
+    EDA_RECT trackQueryArea( const TRACK* aRefSeg ) const;
+    EDA_RECT padQueryArea( const TRACK* aRefSeg ) const;
+    EDA_RECT padQueryArea( const D_PAD* aRefPad ) const;
+
+    void query( const ITEM_TREE* aTrees, LSET aLayers, const EDA_RECT& aArea,
+                std::vector<int>& aResult ) const;
+
+    std::vector<TRACK*> m_tracks;
+    std::vector<int>    m_references;
+    std::vector<D_PAD*> m_pads;
+    int                 m_maxClearance;
+
+    ITEM_TREE           m_trackTrees[MAX_CU_LAYERS];
+    ITEM_TREE           m_padTrees[MAX_CU_LAYERS];
+};
+
+#endif  // DRC_CLEARANCE_INDEX_H
@@ -121,6 +121,8 @@ MARKER_PCB* DRC::fillMarker( const TRACK* aTrack, BOARD_ITEM* aItem, int aErrorC
         }
     }
 
+    fillMe->SetMainItemId( aTrack->Type(), aTrack->GetNetCode() );
+
     return fillMe;
 }
 
@@ -163,6 +165,8 @@ MARKER_PCB* DRC::fillMarker( D_PAD* aPad, BOARD_ITEM* aItem, int aErrorCode, MAR
         fillMe->SetItem( aPad );    // TODO it has to be checked
     }
 
+    fillMe->SetMainItemId( aPad->Type(), aPad->GetNetCode() );
+
     return fillMe;
 }
 
@@ -679,7 +679,7 @@ void PCB_EDIT_FRAME::Process_Special_Functions( wxCommandEvent& event )
     {
         m_canvas->MoveCursorToCrossHair();
         ZONE_FILLER filler( GetBoard() );
-        filler.Fill( { (ZONE_CONTAINER*) GetCurItem() } );
+        filler.Fill( { (ZONE_CONTAINER*) GetCurItem() }, true );
         SetMsgPanel( GetBoard() );
         m_canvas->Refresh();
         break;
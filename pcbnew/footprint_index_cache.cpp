@@ -0,0 +1,379 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <footprint_index_cache.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <set>
+
+#include <wx/dir.h>
+#include <wx/ffile.h>
+#include <wx/filename.h>
+#include <wx/stdpaths.h>
+
+#include <common.h>
+
+
+// The index is only read back on the machine which wrote it, so the values are stored
+// in the native byte order.  Bump the version when the layout changes: a file with
+// another version is discarded.
+static const char     indexMagic[8] = { 'K', 'I', 'F', 'P', 'I', 'D', 'X', 0 };
+static const uint32_t indexVersion = 1;
+
+
+namespace
+{
+
+class INDEX_WRITER
+{
+public:
+    void Put( const void* aData, size_t aSize )
+    {
+        const char* data = static_cast<const char*>( aData );
+        m_buf.insert( m_buf.end(), data, data + aSize );
+    }
+
+    template <typename T>
+    void Put( T aValue )
+    {
+        Put( &aValue, sizeof( T ) );
+    }
+
+    void Put( const wxString& aString )
+    {
+        wxScopedCharBuffer utf8 = aString.ToUTF8();
+
+        Put<uint32_t>( utf8.length() );
+        Put( utf8.data(), utf8.length() );
+    }
+
+    const std::vector<char>& Buffer() const { return m_buf; }
+
+private:
+    std::vector<char> m_buf;
+};
+
+
+/**
+ * Reads the values of an index file.  A read past the end of the file sets the error
+ * flag and returns zeroes, so the callers check Ok() once per library.
+ */
+class INDEX_READER
+{
+public:
+    INDEX_READER( const std::vector<char>& aBuf ) :
+        m_buf( aBuf ),
+        m_pos( 0 ),
+        m_ok( true )
+    {
+    }
+
+    bool Get( void* aData, size_t aSize )
+    {
+        if( !m_ok || m_buf.size() - m_pos < aSize )
+        {
+            m_ok = false;
+            memset( aData, 0, aSize );
+            return false;
+        }
+
+        memcpy( aData, m_buf.data() + m_pos, aSize );
+        m_pos += aSize;
+        return true;
+    }
+
+    template <typename T>
+    T Get()
+    {
+        T value;
+        Get( &value, sizeof( T ) );
+        return value;
+    }
+
+    wxString GetString()
+    {
+        uint32_t len = Get<uint32_t>();
+
+        if( !m_ok || m_buf.size() - m_pos < len )
+        {
+            m_ok = false;
+            return wxEmptyString;
+        }
+
+        wxString str = wxString::FromUTF8( m_buf.data() + m_pos, len );
+        m_pos += len;
+        return str;
+    }
+
+    bool Ok() const { return m_ok; }
+
+private:
+    const std::vector<char>& m_buf;
+    size_t                   m_pos;
+    bool                     m_ok;
+};
+
+
+///> FNV-1a hash step
+void hashBytes( uint64_t& aHash, const void* aData, size_t aSize )
+{
+    const unsigned char* data = static_cast<const unsigned char*>( aData );
+
+    for( size_t i = 0; i < aSize; i++ )
+    {
+        aHash ^= data[i];
+        aHash *= 0x100000001b3ULL;
+    }
+}
+
+
+void hashFile( uint64_t& aHash, const wxFileName& aFile )
+{
+    wxScopedCharBuffer name = aFile.GetFullName().ToUTF8();
+    long long          mtime = aFile.GetModificationTime().GetValue().GetValue();
+    long long          size = aFile.GetSize().GetValue();
+
+    hashBytes( aHash, name.data(), name.length() );
+    hashBytes( aHash, &mtime, sizeof( mtime ) );
+    hashBytes( aHash, &size, sizeof( size ) );
+}
+
+}
+
+
+FOOTPRINT_INDEX_CACHE::FOOTPRINT_INDEX_CACHE( const wxString& aFileName ) :
+    m_fileName( aFileName ),
+    m_modified( false )
+{
+}
+
+
+wxString FOOTPRINT_INDEX_CACHE::DefaultFileName()
+{
+    // 1. OSX: ~/Library/Caches/kicad/
+    // 2. Linux: ${XDG_CACHE_HOME}/kicad ~/.cache/kicad/
+    // 3. MSWin: AppData\Local\kicad
+    wxString cacheDir;
+
+#if defined( _WIN32 )
+    wxStandardPaths::Get().UseAppInfo( wxStandardPaths::AppInfo_None );
+    cacheDir = wxStandardPaths::Get().GetUserLocalDataDir();
+    cacheDir.append( "\\kicad" );
+#elif defined( __APPLE__ )
+    cacheDir = "${HOME}/Library/Caches/kicad";
+#else   // assume Linux
+    cacheDir = ExpandEnvVarSubstitutions( "${XDG_CACHE_HOME}" );
+
+    if( cacheDir.empty() || cacheDir == "${XDG_CACHE_HOME}" )
+        cacheDir = "${HOME}/.cache";
+
+    cacheDir.append( "/kicad" );
+#endif
+
+    wxFileName fn( ExpandEnvVarSubstitutions( cacheDir ), "fp-index-cache" );
+
+    return fn.GetFullPath();
+}
+
+
+long long FOOTPRINT_INDEX_CACHE::LibraryKey( const wxString& aPath )
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+
+    if( wxFileName::DirExists( aPath ) )
+    {
+        wxArrayString files;
+
+        wxDir::GetAllFiles( aPath, &files, wxEmptyString, wxDIR_FILES | wxDIR_HIDDEN );
+        files.Sort();
+
+        for( const wxString& file : files )
+            hashFile( hash, wxFileName( file ) );
+    }
+    else if( wxFileName::FileExists( aPath ) )
+    {
+        hashFile( hash, wxFileName( aPath ) );
+    }
+    else
+    {
+        return 0;
+    }
+
+    // 0 is reserved for the libraries which can't be indexed
+    return hash ? (long long) hash : 1;
+}
+
+
+void FOOTPRINT_INDEX_CACHE::Load()
+{
+    m_libraries.clear();
+    m_modified = false;
+
+    if( !wxFileName::FileExists( m_fileName ) )
+        return;
+
+    wxFFile file( m_fileName, "rb" );
+
+    if( !file.IsOpened() )
+        return;
+
+    // Read the whole index at once: it is parsed from memory.
+    std::vector<char> buf( file.Length() );
+
+    if( buf.empty() || file.Read( buf.data(), buf.size() ) != buf.size() )
+        return;
+
+    INDEX_READER reader( buf );
+    char         magic[sizeof( indexMagic )];
+
+    reader.Get( magic, sizeof( magic ) );
+
+    if( memcmp( magic, indexMagic, sizeof( magic ) ) || reader.Get<uint32_t>() != indexVersion )
+        return;
+
+    uint32_t libCount = reader.Get<uint32_t>();
+
+    for( uint32_t i = 0; i < libCount && reader.Ok(); i++ )
+    {
+        wxString      nickname = reader.GetString();
+        LIBRARY_ENTRY lib;
+
+        lib.m_uri = reader.GetString();
+        lib.m_key = reader.Get<int64_t>();
+
+        uint32_t fpCount = reader.Get<uint32_t>();
+
+        for( uint32_t j = 0; j < fpCount && reader.Ok(); j++ )
+        {
+            FOOTPRINT_ENTRY fp;
+
+            fp.m_name = reader.GetString();
+            fp.m_doc = reader.GetString();
+            fp.m_keywords = reader.GetString();
+            fp.m_padCount = reader.Get<int32_t>();
+            fp.m_uniquePadCount = reader.Get<int32_t>();
+
+            lib.m_footprints.push_back( std::move( fp ) );
+        }
+
+        // A truncated library is dropped, it will be parsed again.
+        if( reader.Ok() )
+            m_libraries[nickname] = std::move( lib );
+    }
+}
+
+
+bool FOOTPRINT_INDEX_CACHE::Save()
+{
+    if( !m_modified )
+        return true;
+
+    INDEX_WRITER writer;
+
+    writer.Put( indexMagic, sizeof( indexMagic ) );
+    writer.Put<uint32_t>( indexVersion );
+    writer.Put<uint32_t>( m_libraries.size() );
+
+    for( const auto& lib : m_libraries )
+    {
+        writer.Put( lib.first );
+        writer.Put( lib.second.m_uri );
+        writer.Put<int64_t>( lib.second.m_key );
+        writer.Put<uint32_t>( lib.second.m_footprints.size() );
+
+        for( const FOOTPRINT_ENTRY& fp : lib.second.m_footprints )
+        {
+            writer.Put( fp.m_name );
+            writer.Put( fp.m_doc );
+            writer.Put( fp.m_keywords );
+            writer.Put<int32_t>( fp.m_padCount );
+            writer.Put<int32_t>( fp.m_uniquePadCount );
+        }
+    }
+
+    wxFileName fn( m_fileName );
+
+    if( !fn.DirExists() && !fn.Mkdir( wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL ) )
+        return false;
+
+    // Write a temporary file and rename it, so that a concurrent reader never sees a
+    // partially written index.
+    wxString tmpName = m_fileName + ".tmp";
+
+    {
+        wxFFile file( tmpName, "wb" );
+        const std::vector<char>& buf = writer.Buffer();
+
+        if( !file.IsOpened() || file.Write( buf.data(), buf.size() ) != buf.size() )
+            return false;
+    }
+
+    if( !wxRenameFile( tmpName, m_fileName, true ) )
+        return false;
+
+    m_modified = false;
+    return true;
+}
+
+
+const FOOTPRINT_INDEX_CACHE::LIBRARY_ENTRY* FOOTPRINT_INDEX_CACHE::Find(
+        const wxString& aNickname, const wxString& aUri, long long aKey ) const
+{
+    if( !aKey )
+        return nullptr;
+
+    auto it = m_libraries.find( aNickname );
+
+    if( it == m_libraries.end() || it->second.m_uri != aUri || it->second.m_key != aKey )
+        return nullptr;
+
+    return &it->second;
+}
+
+
+void FOOTPRINT_INDEX_CACHE::Store( const wxString& aNickname, LIBRARY_ENTRY&& aEntry )
+{
+    m_libraries[aNickname] = std::move( aEntry );
+    m_modified = true;
+}
+
+
+void FOOTPRINT_INDEX_CACHE::Prune( const std::vector<wxString>& aNicknames )
+{
+    std::set<wxString> keep( aNicknames.begin(), aNicknames.end() );
+
+    for( auto it = m_libraries.begin(); it != m_libraries.end(); )
+    {
+        if( keep.count( it->first ) )
+        {
+            ++it;
+        }
+        else
+        {
+            it = m_libraries.erase( it );
+            m_modified = true;
+        }
+    }
+}
@@ -0,0 +1,105 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef FOOTPRINT_INDEX_CACHE_H
+#define FOOTPRINT_INDEX_CACHE_H
+
+#include <map>
+#include <vector>
+
+#include <wx/string.h>
+
+
+/**
+ * Class FOOTPRINT_INDEX_CACHE
+ *
+ * Persistent index of the footprint libraries, stored in the user cache directory.  It
+ * holds the FOOTPRINT_INFO fields of every footprint of a library, so that the libraries
+ * which did not change since they were indexed can be listed without being parsed.
+ *
+ * A library is identified by its nickname and URI, and its contents by a key computed
+ * from the names, sizes and modification times of its files.
+ */
+class FOOTPRINT_INDEX_CACHE
+{
+public:
+    struct FOOTPRINT_ENTRY
+    {
+        wxString m_name;
+        wxString m_doc;
+        wxString m_keywords;
+        int      m_padCount;
+        int      m_uniquePadCount;
+    };
+
+    struct LIBRARY_ENTRY
+    {
+        wxString                     m_uri;
+        long long                    m_key;
+        std::vector<FOOTPRINT_ENTRY> m_footprints;
+    };
+
+    FOOTPRINT_INDEX_CACHE( const wxString& aFileName );
+
+    ///> Returns the path of the index file in the user cache directory
+    static wxString DefaultFileName();
+
+    /**
+     * Function LibraryKey
+     * returns a key of the files of the library at aPath: the file itself, or the files
+     * of the directory.  It changes when any of them is added, removed, resized or
+     * modified.
+     * @return the key, or 0 if aPath is not a local file or directory.
+     */
+    static long long LibraryKey( const wxString& aPath );
+
+    /**
+     * Function Load
+     * reads the index file.  A missing, truncated or outdated file gives an empty index.
+     */
+    void Load();
+
+    /**
+     * Function Save
+     * writes the index file if the index was modified since it was loaded.
+     * @return false if the file could not be written.
+     */
+    bool Save();
+
+    ///> Returns the entry of library aNickname if it has the URI aUri and the key aKey
+    const LIBRARY_ENTRY* Find( const wxString& aNickname, const wxString& aUri,
+                               long long aKey ) const;
+
+    ///> Adds or replaces the entry of library aNickname
+    void Store( const wxString& aNickname, LIBRARY_ENTRY&& aEntry );
+
+    ///> Removes the libraries whose nicknames are not in aNicknames
+    void Prune( const std::vector<wxString>& aNicknames );
+
+private:
+    wxString                          m_fileName;
+    std::map<wxString, LIBRARY_ENTRY> m_libraries;
+    bool                              m_modified;
+};
+
+#endif  // FOOTPRINT_INDEX_CACHE_H
@@ -25,6 +25,7 @@
 #include <class_module.h>
 #include <common.h>
 #include <fctsys.h>
+#include <footprint_index_cache.h>
 #include <footprint_info.h>
 #include <fp_lib_table.h>
 #include <html_messagebox.h>
@@ -37,8 +38,7 @@
 #include <pgm_base.h>
 #include <wildcards_and_files_ext.h>
 #include <widgets/progress_reporter.h>
-
-#include <thread>
+#include <work_stealing_pool.h>
 
 
 void FOOTPRINT_INFO_IMPL::load()
@@ -103,6 +103,9 @@ void FOOTPRINT_LIST_IMPL::loader_job()
     while( m_queue_in.pop( nickname ) && !m_cancelled )
     {
         CatchErrors( [this, &nickname]() {
+            if( loadFromIndex( nickname ) )
+                return;
+
             m_lib_table->PrefetchLib( nickname );
             m_queue_out.push( nickname );
         } );
@@ -115,6 +118,37 @@ void FOOTPRINT_LIST_IMPL::loader_job()
 }
 
 
+bool FOOTPRINT_LIST_IMPL::loadFromIndex( const wxString& aNickname )
+{
+    // The plugin timestamps are only meaningful once a library is cached by its plugin, so
+    // the key is computed from the library files themselves.
+    wxString  uri = m_lib_table->GetFullURI( aNickname, true );
+    long long key = FOOTPRINT_INDEX_CACHE::LibraryKey( uri );
+
+    const FOOTPRINT_INDEX_CACHE::LIBRARY_ENTRY* lib = m_index->Find( aNickname, uri, key );
+
+    if( !lib )
+    {
+        std::lock_guard<std::mutex> lock( m_cached_lock );
+        m_lib_keys[aNickname] = key;
+        return false;
+    }
+
+    FPILIST fpis;
+
+    for( const FOOTPRINT_INDEX_CACHE::FOOTPRINT_ENTRY& fp : lib->m_footprints )
+    {
+        fpis.push_back( std::make_unique<FOOTPRINT_INFO_IMPL>( this, aNickname, fp.m_name,
+                fp.m_doc, fp.m_keywords, fp.m_padCount, fp.m_uniquePadCount ) );
+    }
+
+    std::lock_guard<std::mutex> lock( m_cached_lock );
+
+    std::move( fpis.begin(), fpis.end(), std::back_inserter( m_cached_list ) );
+    return true;
+}
+
+
 bool FOOTPRINT_LIST_IMPL::ReadFootprintFiles( FP_LIB_TABLE* aTable, const wxString* aNickname,
                                               WX_PROGRESS_REPORTER* aProgressReporter )
 {
@@ -183,15 +217,29 @@ void FOOTPRINT_LIST_IMPL::StartWorkers( FP_LIB_TABLE* aTable, wxString const* aN
     m_count_finished.store( 0 );
     m_errors.clear();
     m_list.clear();
-    m_threads.clear();
+    m_loaders.clear();
     m_queue_in.clear();
     m_queue_out.clear();
+    m_lib_keys.clear();
+    m_cached_list.clear();
+
+    if( !m_index )
+    {
+        m_index = std::make_unique<FOOTPRINT_INDEX_CACHE>(
+                FOOTPRINT_INDEX_CACHE::DefaultFileName() );
+        m_index->Load();
+    }
 
     if( aNickname )
         m_queue_in.push( *aNickname );
     else
     {
-        for( auto const& nickname : aTable->GetLogicalLibs() )
+        std::vector<wxString> nicknames = aTable->GetLogicalLibs();
+
+        // Forget the libraries removed from the table
+        m_index->Prune( nicknames );
+
+        for( auto const& nickname : nicknames )
             m_queue_in.push( nickname );
     }
 
@@ -199,95 +247,98 @@ void FOOTPRINT_LIST_IMPL::StartWorkers( FP_LIB_TABLE* aTable, wxString const* aN
 
     for( unsigned i = 0; i < aNThreads; ++i )
     {
-        m_threads.push_back( std::thread( &FOOTPRINT_LIST_IMPL::loader_job, this ) );
+        m_loaders.push_back( GetThreadPool().Submit( [this]() { loader_job(); } ) );
     }
 }
 
 bool FOOTPRINT_LIST_IMPL::JoinWorkers()
 {
-    for( auto& i : m_threads )
-        i.join();
+    for( auto& loader : m_loaders )
+        loader.wait();
 
-    m_threads.clear();
+    m_loaders.clear();
     m_queue_in.clear();
     m_count_finished.store( 0 );
 
     size_t total_count = m_queue_out.size();
 
-    LOCALE_IO toggle_locale;
-
-    // Parse the footprints in parallel. WARNING! This requires changing the locale, which is
-    // GLOBAL. It is only threadsafe to construct the LOCALE_IO before the threads are created,
-    // destroy it after they finish, and block the main (GUI) thread while they work. Any deviation
-    // from this will cause nasal demons.
-    //
-    // TODO: blast LOCALE_IO into the sun
+    // Parse the footprints in parallel.  The s-expression parser reads numbers whatever the
+    // locale, so no global LOCALE_IO is needed here: the plugins still relying on strtod()
+    // switch the locale themselves, and LOCALE_IO serializes the switches between threads.
 
     SYNC_QUEUE<std::unique_ptr<FOOTPRINT_INFO>> queue_parsed;
-    std::vector<std::thread>                    threads;
+    std::vector<WORK_STEALING_POOL::TASK>       tasks;
+    std::mutex                                  index_lock;
 
-    for( size_t ii = 0; ii < std::thread::hardware_concurrency() + 1; ++ii )
+    // One task per library
+    for( size_t ii = 0; ii < total_count; ++ii )
     {
-        threads.push_back( std::thread( [this, &queue_parsed]() {
+        tasks.push_back( [this, &queue_parsed, &index_lock]() {
             wxString nickname;
 
-            while( this->m_queue_out.pop( nickname ) && !m_cancelled )
+            if( !this->m_queue_out.pop( nickname ) || m_cancelled )
+                return;
+
+            wxArrayString fpnames;
+            bool          enumerated = CatchErrors( [this, &fpnames, &nickname]() {
+                m_lib_table->FootprintEnumerate( fpnames, nickname );
+            } );
+
+            FOOTPRINT_INDEX_CACHE::LIBRARY_ENTRY lib;
+            bool                                 complete = enumerated;
+
+            for( unsigned jj = 0; jj < fpnames.size() && !m_cancelled; ++jj )
             {
-                wxArrayString fpnames;
+                wxString fpname = fpnames[jj];
+                FOOTPRINT_INFO_IMPL* fpinfo = new FOOTPRINT_INFO_IMPL( this, nickname, fpname );
 
-                try
-                {
-                    m_lib_table->FootprintEnumerate( fpnames, nickname );
-                }
-                catch( const IO_ERROR& ioe )
+                if( fpinfo->IsLoaded() )
                 {
-                    m_errors.move_push( std::make_unique<IO_ERROR>( ioe ) );
+                    lib.m_footprints.push_back( { fpname, fpinfo->GetDoc(), fpinfo->GetKeywords(),
+                            (int) fpinfo->GetPadCount(), (int) fpinfo->GetUniquePadCount() } );
                 }
-                catch( const std::exception& se )
+                else
                 {
-                    // This is a round about way to do this, but who knows what THROW_IO_ERROR()
-                    // may be tricked out to do someday, keep it in the game.
-                    try
-                    {
-                        THROW_IO_ERROR( se.what() );
-                    }
-                    catch( const IO_ERROR& ioe )
-                    {
-                        m_errors.move_push( std::make_unique<IO_ERROR>( ioe ) );
-                    }
+                    complete = false;
                 }
 
-                for( unsigned jj = 0; jj < fpnames.size() && !m_cancelled; ++jj )
-                {
-                    wxString fpname = fpnames[jj];
-                    FOOTPRINT_INFO* fpinfo = new FOOTPRINT_INFO_IMPL( this, nickname, fpname );
-                    queue_parsed.move_push( std::unique_ptr<FOOTPRINT_INFO>( fpinfo ) );
-                }
+                queue_parsed.move_push( std::unique_ptr<FOOTPRINT_INFO>( fpinfo ) );
+            }
 
-                if( m_progress_reporter )
-                    m_progress_reporter->AdvanceProgress();
+            // Only index the libraries read completely, so that a broken or partially read
+            // library is parsed again the next time.
+            auto key = m_lib_keys.find( nickname );
+
+            if( complete && !m_cancelled && key != m_lib_keys.end() && key->second )
+            {
+                lib.m_uri = m_lib_table->GetFullURI( nickname, true );
+                lib.m_key = key->second;
 
-                m_count_finished.fetch_add( 1 );
+                std::lock_guard<std::mutex> lock( index_lock );
+                m_index->Store( nickname, std::move( lib ) );
             }
-        } ) );
-    }
 
-    while( !m_cancelled && m_count_finished.load() < total_count )
-    {
-        if( m_progress_reporter )
-            m_cancelled = !m_progress_reporter->KeepRefreshing();
-        else
-            wxMilliSleep( 20 );
+            if( m_progress_reporter )
+                m_progress_reporter->AdvanceProgress();
+
+            m_count_finished.fetch_add( 1 );
+        } );
     }
 
-    for( auto& thr : threads )
-        thr.join();
+    if( !GetThreadPool().Run( tasks, m_progress_reporter, true ) )
+        m_cancelled = true;
 
     std::unique_ptr<FOOTPRINT_INFO> fpi;
 
     while( queue_parsed.pop( fpi ) )
         m_list.push_back( std::move( fpi ) );
 
+    std::move( m_cached_list.begin(), m_cached_list.end(), std::back_inserter( m_list ) );
+    m_cached_list.clear();
+
+    if( !m_cancelled )
+        m_index->Save();
+
     std::sort( m_list.begin(), m_list.end(),
             []( std::unique_ptr<FOOTPRINT_INFO> const&     lhs,
                     std::unique_ptr<FOOTPRINT_INFO> const& rhs ) -> bool { return *lhs < *rhs; } );
@@ -314,6 +365,6 @@ FOOTPRINT_LIST_IMPL::FOOTPRINT_LIST_IMPL() :
 
 FOOTPRINT_LIST_IMPL::~FOOTPRINT_LIST_IMPL()
 {
-    for( auto& i : m_threads )
-        i.join();
+    for( auto& loader : m_loaders )
+        loader.wait();
 }
@@ -22,14 +22,17 @@
 
 #include <atomic>
 #include <functional>
+#include <future>
+#include <map>
 #include <memory>
-#include <thread>
+#include <mutex>
 #include <vector>
 
 #include <footprint_info.h>
 #include <sync_queue.h>
 #include <widgets/progress_reporter.h>
 
+class FOOTPRINT_INDEX_CACHE;
 class LOCALE_IO;
 
 class FOOTPRINT_INFO_IMPL : public FOOTPRINT_INFO
@@ -50,6 +53,27 @@ public:
 #endif
     }
 
+    ///> Creates a loaded footprint info from the fields stored in the footprint index
+    FOOTPRINT_INFO_IMPL( FOOTPRINT_LIST* aOwner, const wxString& aNickname,
+            const wxString& aFootprintName, const wxString& aDoc, const wxString& aKeywords,
+            int aPadCount, int aUniquePadCount )
+    {
+        m_owner = aOwner;
+        m_loaded = true;
+        m_nickname = aNickname;
+        m_fpname = aFootprintName;
+        m_num = 0;
+        m_pad_count = aPadCount;
+        m_unique_pad_count = aUniquePadCount;
+        m_doc = aDoc;
+        m_keywords = aKeywords;
+    }
+
+    bool IsLoaded() const
+    {
+        return m_loaded;
+    }
+
 protected:
     virtual void load() override;
 };
@@ -57,14 +81,22 @@ protected:
 
 class FOOTPRINT_LIST_IMPL : public FOOTPRINT_LIST
 {
-    FOOTPRINT_ASYNC_LOADER*  m_loader;
-    std::vector<std::thread> m_threads;
-    SYNC_QUEUE<wxString>     m_queue_in;
-    SYNC_QUEUE<wxString>     m_queue_out;
-    std::atomic_size_t       m_count_finished;
-    long long                m_list_timestamp;
-    WX_PROGRESS_REPORTER*    m_progress_reporter;
-    std::atomic_bool         m_cancelled;
+    FOOTPRINT_ASYNC_LOADER*        m_loader;
+    std::vector<std::future<void>> m_loaders;
+    SYNC_QUEUE<wxString>           m_queue_in;
+    SYNC_QUEUE<wxString>           m_queue_out;
+    std::atomic_size_t             m_count_finished;
+    long long                      m_list_timestamp;
+    WX_PROGRESS_REPORTER*          m_progress_reporter;
+    std::atomic_bool               m_cancelled;
+
+    ///> Persistent index of the libraries, loaded by the first StartWorkers()
+    std::unique_ptr<FOOTPRINT_INDEX_CACHE> m_index;
+    ///> Keys of the libraries to parse, to store them in m_index
+    std::map<wxString, long long>          m_lib_keys;
+    ///> Footprints of the libraries found in m_index
+    FPILIST                                m_cached_list;
+    std::mutex                             m_cached_lock;
 
     /**
      * Call aFunc, pushing any IO_ERRORs and std::exceptions it throws onto m_errors.
@@ -85,6 +117,15 @@ protected:
      */
     void loader_job();
 
+    /**
+     * Function loadFromIndex
+     * adds the footprints of library aNickname to m_cached_list if m_index holds them
+     * and the library did not change since it was indexed.  Otherwise remembers the key
+     * of the library, to index it once it is parsed.
+     * @return true if the library was found in m_index.
+     */
+    bool loadFromIndex( const wxString& aNickname );
+
 public:
     FOOTPRINT_LIST_IMPL();
     virtual ~FOOTPRINT_LIST_IMPL();
@@ -1761,6 +1761,10 @@ void PCB_IO::format( ZONE_CONTAINER* aZone, int aNestLevel ) const
                           FMT_IU( aZone->GetCornerRadius() ).c_str() );
     }
 
+    // Lets the zone filler skip the zones whose inputs did not change after a reload
+    if( aZone->IsFilled() && aZone->GetFillHash() )
+        m_out->Print( 0, " (fill_hash %llX)", (unsigned long long) aZone->GetFillHash() );
+
     m_out->Print( 0, ")\n" );
 
     int newLine = 0;
@@ -1912,7 +1916,7 @@ PCB_IO::~PCB_IO()
 
 BOARD* PCB_IO::Load( const wxString& aFileName, BOARD* aAppendToMe, const PROPERTIES* aProperties )
 {
-    FILE_LINE_READER    reader( aFileName );
+    MMAP_LINE_READER    reader( aFileName );
 
     init( aProperties );
 
@@ -1979,7 +1983,6 @@ void PCB_IO::FootprintEnumerate( wxArrayString&    aFootprintNames,
                                  const wxString&   aLibraryPath,
                                  const PROPERTIES* aProperties )
 {
-    LOCALE_IO     toggle;     // toggles on, then off, the C locale.
     wxDir         dir( aLibraryPath );
 
     init( aProperties );
@@ -2015,8 +2018,6 @@ MODULE* PCB_IO::doLoadFootprint( const wxString& aLibraryPath,
                                  const PROPERTIES* aProperties,
                                  bool checkModified )
 {
-    LOCALE_IO   toggle;     // toggles on, then off, the C locale.
-
     init( aProperties );
 
     try
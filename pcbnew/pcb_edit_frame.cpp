@@ -1094,6 +1094,14 @@ void PCB_EDIT_FRAME::OnModify( )
 }
 
 
+void PCB_EDIT_FRAME::OnBoardItemsChanged( const std::vector<EDA_RECT>& aDirtyAreas,
+                                          const std::vector<BOARD_ITEM*>& aChangedItems )
+{
+    if( Settings().m_onlineDrc )
+        m_drc->TestDirtyAreas( aDirtyAreas, aChangedItems );
+}
+
+
 void PCB_EDIT_FRAME::SVG_Print( wxCommandEvent& event )
 {
     PCB_PLOT_PARAMS  plot_prms = GetPlotSettings();
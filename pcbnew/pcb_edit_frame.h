@@ -616,6 +616,13 @@ public:
      */
     virtual void OnModify() override;
 
+    /**
+     * Function OnBoardItemsChanged
+     * runs the online DRC on the changed areas, if enabled.
+     */
+    virtual void OnBoardItemsChanged( const std::vector<EDA_RECT>& aDirtyAreas,
+                                      const std::vector<BOARD_ITEM*>& aChangedItems ) override;
+
     /**
      * Function SetActiveLayer
      * will change the currently active layer to \a aLayer and also
@@ -59,6 +59,8 @@ public:
     bool    m_legacyUseTwoSegmentTracks = true;
 
     bool    m_editActionChangesTrackWidth = false;
+    bool    m_onlineDrc = false;                    // True to re-run the DRC on the board
+                                                    // areas changed by each commit
     static bool m_dragSelects;                  // True: Drag gesture always draws a selection box,
                                                 // False: Drag will preselect an item and move it
 
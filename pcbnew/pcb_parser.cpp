@@ -27,10 +27,11 @@
  * @brief Pcbnew s-expression file format parser implementation.
  */
 
-#include <errno.h>
+#include <cmath>
 #include <common.h>
 #include <confirm.h>
 #include <macros.h>
+#include <kicad_string.h>
 #include <trigo.h>
 #include <title_block.h>
 
@@ -49,6 +50,10 @@
 #include <pcb_plot_params.h>
 #include <zones.h>
 #include <pcb_parser.h>
+#include <work_stealing_pool.h>
+
+#include <exception>
+#include <memory>
 
 using namespace PCB_KEYS_T;
 
@@ -123,13 +128,13 @@ void PCB_PARSER::pushValueIntoMap( int aIndex, int aValue )
 
 double PCB_PARSER::parseDouble()
 {
-    char* tmp;
-
-    errno = 0;
+    const std::string& text = CurStr();
+    double fval;
 
-    double fval = strtod( CurText(), &tmp );
+    // The C locale number format, whatever the current locale
+    const char* end = ParseDouble( text.c_str(), text.c_str() + text.size(), fval );
 
-    if( errno )
+    if( !std::isfinite( fval ) )
     {
         wxString error;
         error.Printf( _( "Invalid floating point number in\nfile: \"%s\"\nline: %d\noffset: %d" ),
@@ -138,7 +143,7 @@ double PCB_PARSER::parseDouble()
         THROW_IO_ERROR( error );
     }
 
-    if( CurText() == tmp )
+    if( end == text.c_str() )
     {
         wxString error;
         error.Printf( _( "Missing floating point number in\nfile: \"%s\"\nline: %d\noffset: %d" ),
@@ -443,7 +448,9 @@ BOARD_ITEM* PCB_PARSER::Parse()
 {
     T               token;
     BOARD_ITEM*     item;
-    LOCALE_IO       toggle;
+
+    // The numbers are read by parseDouble() whatever the current locale, so unlike the
+    // other plugins this does not need a LOCALE_IO, and can run in worker threads.
 
     // MODULEs can be prefixed with an initial block of single line comments and these
     // are kept for Format() so they round trip in s-expression form.  BOARDs might
@@ -494,10 +501,30 @@ BOARD* PCB_PARSER::parseBOARD()
 }
 
 
+/// Size of the text of the item batches of a board, a trade off between the cost of a
+/// parser and the balance of the work between the threads
+static const size_t ITEM_BATCH_SIZE = 256 * 1024;
+
+
+struct PCB_PARSER::ITEM_BATCH
+{
+    std::string     m_text;             ///< the text of the items, with the line ends of the file
+    unsigned        m_firstLine;        ///< line number of the start of m_text in the file
+    unsigned        m_lastLine;         ///< line number of the end of m_text in the file
+
+    std::vector< std::unique_ptr<BOARD_ITEM> >          m_items;
+    std::vector< std::pair<ZONE_CONTAINER*, wxString> > m_zoneNetFixes;
+    std::exception_ptr                                  m_error;
+};
+
+
 BOARD* PCB_PARSER::parseBOARD_unchecked()
 {
     T token;
 
+    // The items are independent from each other, but not from the other sections
+    std::vector<ITEM_BATCH> batches;
+
     parseHeader();
 
     for( token = NextTok();  token != T_RIGHT;  token = NextTok() )
@@ -507,6 +534,30 @@ BOARD* PCB_PARSER::parseBOARD_unchecked()
 
         token = NextTok();
 
+        switch( token )
+        {
+        case T_gr_arc:
+        case T_gr_circle:
+        case T_gr_curve:
+        case T_gr_line:
+        case T_gr_poly:
+        case T_gr_text:
+        case T_dimension:
+        case T_module:
+        case T_segment:
+        case T_via:
+        case T_zone:
+        case T_target:
+            readBoardItem( batches );
+            continue;
+
+        default:
+            break;
+        }
+
+        // The items read so far must not see the settings which follow them
+        parseItemBatches( batches );
+
         switch( token )
         {
         case T_general:
@@ -537,50 +588,143 @@ BOARD* PCB_PARSER::parseBOARD_unchecked()
             parseNETCLASS();
             break;
 
-        case T_gr_arc:
-        case T_gr_circle:
-        case T_gr_curve:
-        case T_gr_line:
-        case T_gr_poly:
-            m_board->Add( parseDRAWSEGMENT(), ADD_APPEND );
-            break;
+        default:
+            wxString err;
+            err.Printf( _( "Unknown token \"%s\"" ), GetChars( FromUTF8() ) );
+            THROW_PARSE_ERROR( err, CurSource(), CurLine(), CurLineNumber(), CurOffset() );
+        }
+    }
 
-        case T_gr_text:
-            m_board->Add( parseTEXTE_PCB(), ADD_APPEND );
-            break;
+    parseItemBatches( batches );
 
-        case T_dimension:
-            m_board->Add( parseDIMENSION(), ADD_APPEND );
-            break;
+    return m_board;
+}
 
-        case T_module:
-            m_board->Add( parseMODULE(), ADD_APPEND );
-            break;
 
-        case T_segment:
-            m_board->Add( parseTRACK(), ADD_APPEND );
-            break;
+BOARD_ITEM* PCB_PARSER::parseBoardItem( T aToken )
+{
+    switch( aToken )
+    {
+    case T_gr_arc:
+    case T_gr_circle:
+    case T_gr_curve:
+    case T_gr_line:
+    case T_gr_poly:
+        return parseDRAWSEGMENT();
 
-        case T_via:
-            m_board->Add( parseVIA(), ADD_APPEND );
-            break;
+    case T_gr_text:
+        return parseTEXTE_PCB();
 
-        case T_zone:
-            m_board->Add( parseZONE_CONTAINER(), ADD_APPEND );
-            break;
+    case T_dimension:
+        return parseDIMENSION();
 
-        case T_target:
-            m_board->Add( parsePCB_TARGET(), ADD_APPEND );
-            break;
+    case T_module:
+        return parseMODULE();
 
-        default:
-            wxString err;
-            err.Printf( _( "Unknown token \"%s\"" ), GetChars( FromUTF8() ) );
-            THROW_PARSE_ERROR( err, CurSource(), CurLine(), CurLineNumber(), CurOffset() );
-        }
+    case T_segment:
+        return parseTRACK();
+
+    case T_via:
+        return parseVIA();
+
+    case T_zone:
+        return parseZONE_CONTAINER();
+
+    case T_target:
+        return parsePCB_TARGET();
+
+    default:
+        wxString err;
+        err.Printf( _( "Unknown token \"%s\"" ), GetChars( FromUTF8() ) );
+        THROW_PARSE_ERROR( err, CurSource(), CurLine(), CurLineNumber(), CurOffset() );
     }
+}
 
-    return m_board;
+
+void PCB_PARSER::readBoardItem( std::vector<ITEM_BATCH>& aBatches )
+{
+    unsigned line = CurLineNumber();
+
+    if( aBatches.empty() || aBatches.back().m_text.size() >= ITEM_BATCH_SIZE )
+    {
+        aBatches.emplace_back();
+        aBatches.back().m_firstLine = line;
+        aBatches.back().m_lastLine = line;
+    }
+
+    ITEM_BATCH& batch = aBatches.back();
+
+    // Keep the line numbers of the file for the error messages
+    batch.m_text.append( line - batch.m_lastLine, '\n' );
+    batch.m_text += '(';
+    batch.m_text += CurStr();
+    ReadSectionText( batch.m_text );
+
+    batch.m_lastLine = CurLineNumber();
+}
+
+
+void PCB_PARSER::parseItemBatches( std::vector<ITEM_BATCH>& aBatches )
+{
+    if( aBatches.empty() )
+        return;
+
+    const wxString source = CurSource();
+    std::vector<WORK_STEALING_POOL::TASK> tasks;
+
+    for( ITEM_BATCH& batch : aBatches )
+    {
+        tasks.push_back( [this, &batch, &source]()
+        {
+            try
+            {
+                STRING_LINE_READER reader( batch.m_text, source, batch.m_firstLine - 1 );
+                PCB_PARSER         parser( &reader );
+
+                // The settings read so far; the board is only read by the item parsers
+                parser.m_board = m_board;
+                parser.m_layerIndices = m_layerIndices;
+                parser.m_layerMasks = m_layerMasks;
+                parser.m_netCodes = m_netCodes;
+                parser.m_tooRecent = m_tooRecent;
+                parser.m_requiredVersion = m_requiredVersion;
+                parser.m_zoneNetFixes = &batch.m_zoneNetFixes;
+
+                for( T token = parser.NextTok();  token != T_EOF;  token = parser.NextTok() )
+                {
+                    if( token != T_LEFT )
+                        parser.Expecting( T_LEFT );
+
+                    token = parser.NextTok();
+                    batch.m_items.emplace_back( parser.parseBoardItem( token ) );
+                }
+            }
+            catch( ... )
+            {
+                batch.m_error = std::current_exception();
+            }
+        } );
+    }
+
+    GetThreadPool().Run( tasks );
+
+    // Report the first error of the file
+    for( ITEM_BATCH& batch : aBatches )
+    {
+        if( batch.m_error )
+            std::rethrow_exception( batch.m_error );
+    }
+
+    for( ITEM_BATCH& batch : aBatches )
+    {
+        for( auto& fix : batch.m_zoneNetFixes )
+            fixZoneNet( fix.first, fix.second );
+
+        for( auto& item : batch.m_items )
+            m_board->Add( item.release(), ADD_APPEND );
+    }
+
+    aBatches.clear();
 }
 
 
@@ -3012,9 +3156,15 @@ ZONE_CONTAINER* PCB_PARSER::parseZONE_CONTAINER()
                     NeedRIGHT();
                     break;
 
+                case T_fill_hash:
+                    NeedSYMBOLorNUMBER();
+                    zone->SetFillHash( (uint64_t) strtoull( CurText(), NULL, 16 ) );
+                    NeedRIGHT();
+                    break;
+
                 default:
                     Expecting( "mode, arc_segments, thermal_gap, thermal_bridge_width, "
-                               "smoothing, or radius" );
+                               "smoothing, radius, or fill_hash" );
                 }
             }
             break;
@@ -3163,37 +3313,46 @@ ZONE_CONTAINER* PCB_PARSER::parseZONE_CONTAINER()
         // Can happens which old boards, with nonexistent nets ...
         // or after being edited by hand
         // We try to fix the mismatch.
-        NETINFO_ITEM* net = m_board->FindNet( netnameFromfile );
-
-        if( net )   // An existing net has the same net name. use it for the zone
-            zone->SetNetCode( net->GetNet() );
-        else    // Not existing net: add a new net to keep trace of the zone netname
-        {
-            int newnetcode = m_board->GetNetCount();
-            net = new NETINFO_ITEM( m_board, netnameFromfile, newnetcode );
-            m_board->Add( net );
-
-            // Store the new code mapping
-            pushValueIntoMap( newnetcode, net->GetNet() );
-            // and update the zone netcode
-            zone->SetNetCode( net->GetNet() );
-
-            // FIXME: a call to any GUI item is not allowed in io plugins:
-            // Change this code to generate a warning message outside this plugin
-            // Prompt the user
-            wxString msg;
-            msg.Printf( _( "There is a zone that belongs to a not existing net\n"
-                           "\"%s\"\n"
-                           "you should verify and edit it (run DRC test)." ),
-                           GetChars( netnameFromfile ) );
-            DisplayError( NULL, msg );
-        }
+        if( m_zoneNetFixes )
+            m_zoneNetFixes->emplace_back( zone.get(), netnameFromfile );
+        else
+            fixZoneNet( zone.get(), netnameFromfile );
     }
 
     return zone.release();
 }
 
 
+void PCB_PARSER::fixZoneNet( ZONE_CONTAINER* aZone, const wxString& aNetName )
+{
+    NETINFO_ITEM* net = m_board->FindNet( aNetName );
+
+    if( net )   // An existing net has the same net name. use it for the zone
+        aZone->SetNetCode( net->GetNet() );
+    else    // Not existing net: add a new net to keep trace of the zone netname
+    {
+        int newnetcode = m_board->GetNetCount();
+        net = new NETINFO_ITEM( m_board, aNetName, newnetcode );
+        m_board->Add( net );
+
+        // Store the new code mapping
+        pushValueIntoMap( newnetcode, net->GetNet() );
+        // and update the zone netcode
+        aZone->SetNetCode( net->GetNet() );
+
+        // FIXME: a call to any GUI item is not allowed in io plugins:
+        // Change this code to generate a warning message outside this plugin
+        // Prompt the user
+        wxString msg;
+        msg.Printf( _( "There is a zone that belongs to a not existing net\n"
+                       "\"%s\"\n"
+                       "you should verify and edit it (run DRC test)." ),
+                       GetChars( aNetName ) );
+        DisplayError( NULL, msg );
+    }
+}
+
+
 PCB_TARGET* PCB_PARSER::parsePCB_TARGET()
 {
     wxCHECK_MSG( CurTok() == T_target, NULL,
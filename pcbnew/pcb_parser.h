@@ -74,6 +74,14 @@ class PCB_PARSER : public PCB_LEXER
     bool                m_tooRecent;        ///< true if version parses as later than supported
     int                 m_requiredVersion;  ///< set to the KiCad format version this board requires
 
+    ///> Zones whose net name does not match their net code, with the name read from the
+    ///> file.  Only used by the parsers of item batches: the nets are fixed by the board
+    ///> parser, which owns the board.
+    std::vector< std::pair<ZONE_CONTAINER*, wxString> >* m_zoneNetFixes;
+
+    ///> Consecutive top level items of a board, parsed together in a worker thread
+    struct ITEM_BATCH;
+
     ///> Converts net code using the mapping table if available,
     ///> otherwise returns unchanged net code if < 0 or if is is out of range
     inline int getNetCode( int aNetCode )
@@ -139,6 +147,32 @@ class PCB_PARSER : public PCB_LEXER
      */
     BOARD*          parseBOARD_unchecked();
 
+    /**
+     * Function parseBoardItem
+     * parses a top level item of a board, from the token following its T_LEFT.
+     */
+    BOARD_ITEM*     parseBoardItem( PCB_KEYS_T::T aToken );
+
+    /**
+     * Function readBoardItem
+     * reads the text of a top level item of a board into the last of @a aBatches, and
+     * starts a new batch when this one is large enough.
+     */
+    void            readBoardItem( std::vector<ITEM_BATCH>& aBatches );
+
+    /**
+     * Function parseItemBatches
+     * parses the item batches in parallel, then adds their items to the board in file
+     * order, and clears @a aBatches.
+     */
+    void            parseItemBatches( std::vector<ITEM_BATCH>& aBatches );
+
+    /**
+     * Function fixZoneNet
+     * gives a zone the net named @a aNetName, adding this net to the board if needed.
+     */
+    void            fixZoneNet( ZONE_CONTAINER* aZone, const wxString& aNetName );
+
 
     /**
      * Function lookUpLayer
@@ -273,7 +307,8 @@ public:
 
     PCB_PARSER( LINE_READER* aReader = NULL ) :
         PCB_LEXER( aReader ),
-        m_board( 0 )
+        m_board( 0 ),
+        m_zoneNetFixes( nullptr )
     {
         init();
     }
@@ -651,7 +651,7 @@ void PlotLayerOutlines( BOARD* aBoard, PLOTTER* aPlotter,
         outlines.RemoveAllContours();
         aBoard->ConvertBrdLayerToPolygonalContours( layer, outlines );
 
-        outlines.Simplify( SHAPE_POLY_SET::PM_FAST );
+        outlines.UnionMany( {}, SHAPE_POLY_SET::PM_FAST );
 
         // Plot outlines
         std::vector< wxPoint > cornerList;
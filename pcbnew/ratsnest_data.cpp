@@ -28,10 +28,6 @@
  * @brief Class that computes missing connections on a PCB.
  */
 
-#ifdef USE_OPENMP
-#include <omp.h>
-#endif /* USE_OPENMP */
-
 #ifdef PROFILE
 #include <profile.h>
 #endif
@@ -23,7 +23,9 @@
 #define __PNS_INDEX_H
 
 #include <layers_id_colors_and_visibility.h>
+#include <atomic>
 #include <map>
+#include <memory>
 #include <unordered_set>
 
 #include <boost/range/adaptor/map.hpp>
@@ -42,6 +44,9 @@ namespace PNS {
  * Custom spatial index, holding our board items and allowing for very fast searches. Items
  * are assigned to separate R-Tree subindices depending on their type and spanned layers, reducing
  * overlap and improving search time.
+ *
+ * Copies of an index share their subindices until either of them is modified: then only the
+ * written subindex is copied.
  **/
 class INDEX
 {
@@ -53,6 +58,9 @@ public:
     INDEX();
     ~INDEX();
 
+    ///> Number of subindices copied so far because they were shared when written to
+    static std::atomic<int> s_subIndexCopies;
+
     /**
      * Function Add()
      *
@@ -90,6 +98,15 @@ public:
     template<class Visitor>
     int Query( const ITEM* aItem, int aMinDistance, Visitor& aVisitor );
 
+    /**
+     * Function Query()
+     *
+     * Same as above, for a shape spanning the layers aLayers.
+     */
+    template<class Visitor>
+    int Query( const LAYER_RANGE& aLayers, const SHAPE* aShape, int aMinDistance,
+               Visitor& aVisitor );
+
     /**
      * Function Query()
      *
@@ -152,16 +169,16 @@ private:
     template <class Visitor>
     int querySingle( int index, const SHAPE* aShape, int aMinDistance, Visitor& aVisitor );
 
+    ///> Returns the subindex aItem is stored in, made private to this index first
     ITEM_SHAPE_INDEX* getSubindex( const ITEM* aItem );
 
-    ITEM_SHAPE_INDEX* m_subIndices[MaxSubIndices];
+    std::shared_ptr<ITEM_SHAPE_INDEX> m_subIndices[MaxSubIndices];
     std::map<int, NET_ITEMS_LIST> m_netMap;
     ITEM_SET m_allItems;
 };
 
 INDEX::INDEX()
 {
-    memset( m_subIndices, 0, sizeof( m_subIndices ) );
 }
 
 INDEX::ITEM_SHAPE_INDEX* INDEX::getSubindex( const ITEM* aItem )
@@ -205,10 +222,25 @@ INDEX::ITEM_SHAPE_INDEX* INDEX::getSubindex( const ITEM* aItem )
         return nullptr;
     }
 
-    if( !m_subIndices[idx_n] )
-        m_subIndices[idx_n] = new ITEM_SHAPE_INDEX;
+    std::shared_ptr<ITEM_SHAPE_INDEX>& idx = m_subIndices[idx_n];
+
+    if( !idx )
+    {
+        idx = std::make_shared<ITEM_SHAPE_INDEX>();
+    }
+    else if( idx.use_count() > 1 )
+    {
+        // still shared with another copy of the index: copy it before it gets modified
+        std::shared_ptr<ITEM_SHAPE_INDEX> copy = std::make_shared<ITEM_SHAPE_INDEX>();
+
+        for( ITEM_SHAPE_INDEX::Iterator i = idx->Begin(); !i.IsNull(); i++ )
+            copy->Add( *i );
+
+        idx = copy;
+        s_subIndexCopies++;
+    }
 
-    return m_subIndices[idx_n];
+    return idx.get();
 }
 
 void INDEX::Add( ITEM* aItem )
@@ -261,12 +293,19 @@ int INDEX::querySingle( int index, const SHAPE* aShape, int aMinDistance, Visito
 template<class Visitor>
 int INDEX::Query( const ITEM* aItem, int aMinDistance, Visitor& aVisitor )
 {
-    const SHAPE* shape = aItem->Shape();
+    return Query( aItem->Layers(), aItem->Shape(), aMinDistance, aVisitor );
+}
+
+template<class Visitor>
+int INDEX::Query( const LAYER_RANGE& aLayers, const SHAPE* aShape, int aMinDistance,
+                  Visitor& aVisitor )
+{
+    const SHAPE* shape = aShape;
     int total = 0;
 
     total += querySingle( SI_Multilayer, shape, aMinDistance, aVisitor );
 
-    const LAYER_RANGE layers = aItem->Layers();
+    const LAYER_RANGE layers = aLayers;
 
     if( layers.IsMultilayer() )
     {
@@ -305,14 +344,7 @@ int INDEX::Query( const SHAPE* aShape, int aMinDistance, Visitor& aVisitor )
 void INDEX::Clear()
 {
     for( int i = 0; i < MaxSubIndices; ++i )
-    {
-        ITEM_SHAPE_INDEX* idx = m_subIndices[i];
-
-        if( idx )
-            delete idx;
-
-        m_subIndices[i] = NULL;
-    }
+        m_subIndices[i].reset();
 }
 
 INDEX::~INDEX()
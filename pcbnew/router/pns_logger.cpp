@@ -32,11 +32,14 @@
 #include <geometry/shape_circle.h>
 #include <geometry/shape_convex.h>
 
+#include <fstream>
+
 namespace PNS {
 
 LOGGER::LOGGER( )
 {
     m_groupOpened = false;
+    m_eventCount = 0;
 }
 
 
@@ -49,6 +52,7 @@ void LOGGER::Clear()
 {
     m_theLog.str( std::string() );
     m_groupOpened = false;
+    m_eventCount = 0;
 }
 
 
@@ -139,6 +143,62 @@ void LOGGER::Log( const VECTOR2I& aStart, const VECTOR2I& aEnd,
 }
 
 
+void LOGGER::LogEvent( EVENT_TYPE aType, const VECTOR2I& aP, const ITEM* aItem, int aArg,
+                       const std::vector<int>& aParams )
+{
+    EndGroup();
+    m_eventCount++;
+
+    m_theLog << "event " << (int) aType << " " << aP.x << " " << aP.y << " " << aArg << " ";
+
+    if( aItem )
+        m_theLog << aItem->Kind() << " " << aItem->Net() << " " << aItem->Layers().Start();
+    else
+        m_theLog << "0 0 0";
+
+    for( int param : aParams )
+        m_theLog << " " << param;
+
+    m_theLog << std::endl;
+}
+
+
+bool LOGGER::ParseEvents( const std::string& aFilename, std::vector<EVENT_ENTRY>& aEvents )
+{
+    std::ifstream f( aFilename );
+
+    if( !f )
+        return false;
+
+    std::string line;
+
+    while( std::getline( f, line ) )
+    {
+        std::istringstream tokens( line );
+        std::string        keyword;
+        EVENT_ENTRY        evt;
+        int                type;
+
+        if( !( tokens >> keyword ) || keyword != "event" )
+            continue;
+
+        if( tokens >> type >> evt.m_p.x >> evt.m_p.y >> evt.m_arg
+                   >> evt.m_itemKind >> evt.m_itemNet >> evt.m_itemLayer )
+        {
+            int param;
+
+            while( tokens >> param )
+                evt.m_params.push_back( param );
+
+            evt.m_type = (EVENT_TYPE) type;
+            aEvents.push_back( evt );
+        }
+    }
+
+    return true;
+}
+
+
 void LOGGER::dumpShape( const SHAPE* aSh )
 {
     switch( aSh->Type() )
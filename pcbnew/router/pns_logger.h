@@ -39,6 +39,47 @@ class ITEM;
 class LOGGER
 {
 public:
+    ///> Types of the router events, as passed by the tools to ROUTER
+    enum EVENT_TYPE
+    {
+        EVT_START_ROUTE = 0,
+        EVT_START_DRAG,
+        EVT_MOVE,
+        EVT_FIX,
+        EVT_STOP,
+        EVT_SET_MODE,
+        EVT_SWITCH_LAYER,
+        EVT_TOGGLE_VIA,
+        EVT_FLIP_POSTURE,
+        EVT_SETTINGS,
+        EVT_SIZES
+    };
+
+    /**
+     * Struct EVENT_ENTRY
+     *
+     * A router event read back from a log.  The item passed with the event is identified
+     * by its kind, net and first layer, so that it can be found again in a world synced
+     * from the same board.
+     */
+    struct EVENT_ENTRY
+    {
+        EVENT_TYPE  m_type;
+        VECTOR2I    m_p;
+
+        ///> layer, drag mode, router mode, PNS_MODE or track width, depending on the
+        ///> event type
+        int         m_arg;
+
+        ///> kind of the item, 0 if the event has none
+        int         m_itemKind;
+        int         m_itemNet;
+        int         m_itemLayer;
+
+        ///> additional values of the event (the via and diff pair sizes for EVT_SIZES)
+        std::vector<int> m_params;
+    };
+
     LOGGER();
     ~LOGGER();
 
@@ -53,10 +94,28 @@ public:
     void Log( const VECTOR2I& aStart, const VECTOR2I& aEnd, int aKind = 0,
               const std::string& aName = std::string() );
 
+    ///> Logs a router event, in a line of its own outside of the groups
+    void LogEvent( EVENT_TYPE aType, const VECTOR2I& aP, const ITEM* aItem = nullptr,
+                   int aArg = 0, const std::vector<int>& aParams = std::vector<int>() );
+
+    ///> Returns the number of events logged since the last Clear()
+    int EventCount() const
+    {
+        return m_eventCount;
+    }
+
+    /**
+     * Function ParseEvents()
+     * reads the events saved in a log file, skipping all the other lines.
+     * @return false if the file could not be read.
+     */
+    static bool ParseEvents( const std::string& aFilename, std::vector<EVENT_ENTRY>& aEvents );
+
 private:
     void dumpShape( const SHAPE* aSh );
 
     bool m_groupOpened;
+    int m_eventCount;
     std::stringstream m_theLog;
 };
 
@@ -82,6 +82,9 @@ bool MEANDER_PLACER::Start( const VECTOR2I& aP, ITEM* aStartItem )
 
     m_world->Remove( m_originLine );
 
+    m_originLine.Line().CacheSegments();
+    cacheSegments( m_tunedPath );
+
     m_currentWidth = m_originLine.Width();
     m_currentEnd = VECTOR2I( 0, 0 );
 
@@ -89,6 +92,16 @@ bool MEANDER_PLACER::Start( const VECTOR2I& aP, ITEM* aStartItem )
 }
 
 
+void MEANDER_PLACER::cacheSegments( ITEM_SET& aItems )
+{
+    for( ITEM* item : aItems.Items() )
+    {
+        if( LINE* l = dyn_cast<LINE*>( item ) )
+            l->Line().CacheSegments();
+    }
+}
+
+
 int MEANDER_PLACER::origPathLength() const
 {
     int total = 0;
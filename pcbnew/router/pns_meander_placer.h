@@ -96,6 +96,9 @@ protected:
 
     virtual int origPathLength() const;
 
+    ///> Caches the segments of the lines in aItems, which do not change while tuning
+    void cacheSegments( ITEM_SET& aItems );
+
     ///> pointer to world to search colliding items
     NODE* m_world;
 
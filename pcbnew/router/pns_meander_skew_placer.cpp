@@ -87,6 +87,11 @@ bool MEANDER_SKEW_PLACER::Start( const VECTOR2I& aP, ITEM* aStartItem )
 
     m_world->Remove( m_originLine );
 
+    m_originLine.Line().CacheSegments();
+    cacheSegments( m_tunedPath );
+    cacheSegments( m_tunedPathP );
+    cacheSegments( m_tunedPathN );
+
     m_currentWidth = m_originLine.Width();
     m_currentEnd = VECTOR2I( 0, 0 );
 
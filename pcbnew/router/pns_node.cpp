@@ -20,7 +20,10 @@
  */
 
 #include <vector>
+#include <atomic>
 #include <cassert>
+#include <mutex>
+#include <unordered_map>
 
 #include <math/vector2d.h>
 
@@ -28,6 +31,7 @@
 #include <geometry/shape.h>
 #include <geometry/shape_line_chain.h>
 #include <geometry/shape_index.h>
+#include <geometry/shape_rect.h>
 
 #include "pns_item.h"
 #include "pns_line.h"
@@ -45,6 +49,73 @@ namespace PNS {
 static std::unordered_set<NODE*> allocNodes;
 #endif
 
+static std::atomic<int> branchCount( 0 );
+static std::atomic<int> itemCount( 0 );
+static std::atomic<int> jointMapCopies( 0 );
+static std::atomic<int> revisionCount( 0 );
+
+std::atomic<int> INDEX::s_subIndexCopies( 0 );
+
+
+/**
+ * Struct NODE::CANDIDATE_CACHE
+ *
+ * Results of the broad-phase queries of the root index, per grid cell and layer range.
+ * Each cell holds the items whose bounding boxes touch it, for the revision of the root
+ * the cache was filled at.
+ */
+struct NODE::CANDIDATE_CACHE
+{
+    ///> size of the cells
+    static const int CellSize = 4000000;
+
+    ///> queries spanning more cells than this go directly to the index
+    static const int MaxQueryCells = 4;
+
+    ///> the cache is emptied when it holds more cells than this
+    static const int MaxCells = 65536;
+
+    struct CELL_KEY
+    {
+        int m_x;
+        int m_y;
+        int m_layerStart;
+        int m_layerEnd;
+
+        bool operator==( const CELL_KEY& aOther ) const
+        {
+            return m_x == aOther.m_x && m_y == aOther.m_y &&
+                   m_layerStart == aOther.m_layerStart && m_layerEnd == aOther.m_layerEnd;
+        }
+    };
+
+    struct CELL_KEY_HASH
+    {
+        std::size_t operator()( const CELL_KEY& aKey ) const
+        {
+            return ( (std::size_t) aKey.m_x * 73856093 ) ^ ( (std::size_t) aKey.m_y * 19349663 ) ^
+                   ( (std::size_t) aKey.m_layerStart * 83492791 ) ^ aKey.m_layerEnd;
+        }
+    };
+
+    struct CANDIDATE
+    {
+        BOX2I m_bbox;
+        ITEM* m_item;
+    };
+
+    typedef std::vector<CANDIDATE> CELL;
+
+    static int CellIndex( int aCoord )
+    {
+        return aCoord >= 0 ? aCoord / CellSize : -( ( -( aCoord + 1 ) ) / CellSize ) - 1;
+    }
+
+    std::mutex m_lock;
+    int m_revision = -1;
+    std::unordered_map<CELL_KEY, std::shared_ptr<const CELL>, CELL_KEY_HASH> m_cells;
+};
+
 NODE::NODE()
 {
     wxLogTrace( "PNS", "NODE::create %p", this );
@@ -54,6 +125,9 @@ NODE::NODE()
     m_maxClearance = 800000;    // fixme: depends on how thick traces are.
     m_ruleResolver = NULL;
     m_index = new INDEX;
+    m_joints = std::make_shared<JOINT_MAP>();
+    m_revision = ++revisionCount;
+    m_candidateCache.reset( new CANDIDATE_CACHE );
 
 #ifdef DEBUG
     allocNodes.insert( this );
@@ -81,7 +155,7 @@ NODE::~NODE()
     allocNodes.erase( this );
 #endif
 
-    m_joints.clear();
+    m_joints.reset();
 
     for( INDEX::ITEM_SET::iterator i = m_index->begin(); i != m_index->end(); ++i )
     {
@@ -117,27 +191,53 @@ NODE* NODE::Branch()
     child->m_ruleResolver = m_ruleResolver;
     child->m_root = isRoot() ? this : m_root;
 
+    // only the root index is cached
+    child->m_candidateCache.reset();
+
+    branchCount++;
+
     // immmediate offspring of the root branch needs not copy anything.
-    // For the rest, deep-copy joints, overridden item map and pointers
-    // to stored items.
+    // For the rest, share the spatial subindices and the joints until
+    // they are modified, and copy the overridden item map.
     if( !isRoot() )
     {
-        JOINT_MAP::iterator j;
-
-        for( INDEX::ITEM_SET::iterator i = m_index->begin(); i != m_index->end(); ++i )
-            child->m_index->Add( *i );
-
+        *child->m_index = *m_index;
         child->m_joints = m_joints;
         child->m_override = m_override;
     }
 
     wxLogTrace( "PNS", "%d items, %d joints, %d overrides",
-            child->m_index->Size(), (int) child->m_joints.size(), (int) child->m_override.size() );
+            child->m_index->Size(), (int) child->m_joints->size(), (int) child->m_override.size() );
 
     return child;
 }
 
 
+NODE::JOINT_MAP& NODE::writableJoints()
+{
+    if( m_joints.use_count() > 1 )
+    {
+        m_joints = std::make_shared<JOINT_MAP>( *m_joints );
+        jointMapCopies++;
+    }
+
+    return *m_joints;
+}
+
+
+ALLOC_STATS NODE::AllocStats()
+{
+    ALLOC_STATS stats;
+
+    stats.m_branches = branchCount;
+    stats.m_items = itemCount;
+    stats.m_subIndexCopies = INDEX::s_subIndexCopies;
+    stats.m_jointMapCopies = jointMapCopies;
+
+    return stats;
+}
+
+
 void NODE::unlinkParent()
 {
     if( isRoot() )
@@ -458,6 +558,144 @@ NODE::OPT_OBSTACLE NODE::CheckColliding( const ITEM* aItemA, int aKindMask )
 }
 
 
+bool NODE::CheckAnyColliding( const ITEM* aItem, int aKindMask )
+{
+    if( aItem->Kind() == ITEM::LINE_T )
+    {
+        const LINE* line = static_cast<const LINE*>( aItem );
+        const SHAPE_LINE_CHAIN& l = line->CLine();
+
+        for( int i = 0; i < l.SegmentCount(); i++ )
+        {
+            const SEGMENT s( *line, l.CSegment( i ) );
+
+            if( anyColliding( &s, aKindMask ) )
+                return true;
+        }
+
+        return line->EndsWithVia() && anyColliding( &line->Via(), aKindMask );
+    }
+
+    return anyColliding( aItem, aKindMask );
+}
+
+
+bool NODE::anyColliding( const ITEM* aItem, int aKindMask )
+{
+    OBSTACLES obs;
+    DEFAULT_OBSTACLE_VISITOR visitor( obs, aItem, aKindMask, true );
+
+    visitor.SetCountLimit( 1 );
+    visitor.SetWorld( this, NULL );
+
+    if( !isRoot() )
+    {
+        m_index->Query( aItem, m_maxClearance, visitor );
+
+        if( visitor.m_matchCount > 0 )
+            return true;
+
+        visitor.SetWorld( m_root, this );
+    }
+
+    m_root->queryCachedCandidates( aItem, m_maxClearance, visitor );
+
+    return visitor.m_matchCount > 0;
+}
+
+
+void NODE::queryCachedCandidates( const ITEM* aItem, int aMinDistance, OBSTACLE_VISITOR& aVisitor )
+{
+    typedef CANDIDATE_CACHE::CELL CELL;
+
+    BOX2I box = aItem->Shape()->BBox();
+
+    box.Inflate( aMinDistance );
+
+    int x0 = CANDIDATE_CACHE::CellIndex( box.GetX() );
+    int y0 = CANDIDATE_CACHE::CellIndex( box.GetY() );
+    int x1 = CANDIDATE_CACHE::CellIndex( box.GetRight() );
+    int y1 = CANDIDATE_CACHE::CellIndex( box.GetBottom() );
+
+    if( (int64_t) ( x1 - x0 + 1 ) * ( y1 - y0 + 1 ) > CANDIDATE_CACHE::MaxQueryCells )
+    {
+        m_index->Query( aItem, aMinDistance, aVisitor );
+        return;
+    }
+
+    CANDIDATE_CACHE& cache = *m_candidateCache;
+    const LAYER_RANGE layers = aItem->Layers();
+    std::shared_ptr<const CELL> cells[CANDIDATE_CACHE::MaxQueryCells];
+    int n = 0;
+
+    for( int y = y0; y <= y1; y++ )
+    {
+        for( int x = x0; x <= x1; x++, n++ )
+        {
+            CANDIDATE_CACHE::CELL_KEY key = { x, y, layers.Start(), layers.End() };
+
+            {
+                std::lock_guard<std::mutex> lock( cache.m_lock );
+
+                if( cache.m_revision != m_revision ||
+                    (int) cache.m_cells.size() > CANDIDATE_CACHE::MaxCells )
+                {
+                    cache.m_cells.clear();
+                    cache.m_revision = m_revision;
+                }
+
+                auto found = cache.m_cells.find( key );
+
+                if( found != cache.m_cells.end() )
+                    cells[n] = found->second;
+            }
+
+            if( cells[n] )
+                continue;
+
+            std::shared_ptr<CELL> cell = std::make_shared<CELL>();
+            SHAPE_RECT rect( x * CANDIDATE_CACHE::CellSize, y * CANDIDATE_CACHE::CellSize,
+                             CANDIDATE_CACHE::CellSize, CANDIDATE_CACHE::CellSize );
+
+            auto collect = [&cell]( ITEM* aCandidate ) -> bool
+            {
+                cell->push_back( { aCandidate->Shape()->BBox(), aCandidate } );
+                return true;
+            };
+
+            m_index->Query( layers, &rect, 0, collect );
+
+            cells[n] = cell;
+
+            std::lock_guard<std::mutex> lock( cache.m_lock );
+
+            if( cache.m_revision == m_revision )
+                cache.m_cells.emplace( key, cells[n] );
+        }
+    }
+
+    // an item spanning several cells is listed in each of them
+    std::unordered_set<ITEM*> visited;
+
+    box.Inflate( 1 );
+
+    for( int i = 0; i < n; i++ )
+    {
+        for( const CANDIDATE_CACHE::CANDIDATE& candidate : *cells[i] )
+        {
+            if( !candidate.m_bbox.Intersects( box ) )
+                continue;
+
+            if( n > 1 && !visited.insert( candidate.m_item ).second )
+                continue;
+
+            if( !aVisitor( candidate.m_item ) )
+                return;
+        }
+    }
+}
+
+
 bool NODE::CheckColliding( const ITEM* aItemA, const ITEM* aItemB, int aKindMask, int aForceClearance )
 {
     assert( aItemB );
@@ -534,6 +772,8 @@ void NODE::addSolid( SOLID* aSolid )
 {
     linkJoint( aSolid->Pos(), aSolid->Layers(), aSolid->Net(), aSolid );
     m_index->Add( aSolid );
+    m_revision = ++revisionCount;
+    itemCount++;
 }
 
 void NODE::Add( std::unique_ptr< SOLID > aSolid )
@@ -546,6 +786,8 @@ void NODE::addVia( VIA* aVia )
 {
     linkJoint( aVia->Pos(), aVia->Layers(), aVia->Net(), aVia );
     m_index->Add( aVia );
+    m_revision = ++revisionCount;
+    itemCount++;
 }
 
 void NODE::Add( std::unique_ptr< VIA > aVia )
@@ -589,6 +831,8 @@ void NODE::addSegment( SEGMENT* aSeg )
     linkJoint( aSeg->Seg().B, aSeg->Layers(), aSeg->Net(), aSeg );
 
     m_index->Add( aSeg );
+    m_revision = ++revisionCount;
+    itemCount++;
 }
 
 bool NODE::Add( std::unique_ptr< SEGMENT > aSegment, bool aAllowRedundant )
@@ -646,6 +890,8 @@ void NODE::doRemove( ITEM* aItem )
     else if( !aItem->BelongsTo( m_root ) || isRoot() )
         m_index->Remove( aItem );
 
+    m_revision = ++revisionCount;
+
     // the item belongs to this particular branch: un-reference it
     if( aItem->BelongsTo( this ) )
     {
@@ -678,13 +924,15 @@ void NODE::removeViaIndex( VIA* aVia )
     tag.net = net;
     tag.pos = p;
 
+    JOINT_MAP& joints = writableJoints();
+
     bool split;
     do
     {
         split = false;
-        std::pair<JOINT_MAP::iterator, JOINT_MAP::iterator> range = m_joints.equal_range( tag );
+        std::pair<JOINT_MAP::iterator, JOINT_MAP::iterator> range = joints.equal_range( tag );
 
-        if( range.first == m_joints.end() )
+        if( range.first == joints.end() )
             break;
 
         // find and remove all joints containing the via to be removed
@@ -693,7 +941,7 @@ void NODE::removeViaIndex( VIA* aVia )
         {
             if( aVia->LayersOverlap( &f->second ) )
             {
-                m_joints.erase( f );
+                joints.erase( f );
                 split = true;
                 break;
             }
@@ -972,12 +1220,12 @@ JOINT* NODE::FindJoint( const VECTOR2I& aPos, int aLayer, int aNet )
     tag.net = aNet;
     tag.pos = aPos;
 
-    JOINT_MAP::iterator f = m_joints.find( tag ), end = m_joints.end();
+    JOINT_MAP::iterator f = m_joints->find( tag ), end = m_joints->end();
 
     if( f == end && !isRoot() )
     {
-        end = m_root->m_joints.end();
-        f = m_root->m_joints.find( tag );    // m_root->FindJoint(aPos, aLayer, aNet);
+        end = m_root->m_joints->end();
+        f = m_root->m_joints->find( tag );    // m_root->FindJoint(aPos, aLayer, aNet);
     }
 
     if( f == end )
@@ -1009,18 +1257,20 @@ JOINT& NODE::touchJoint( const VECTOR2I& aPos, const LAYER_RANGE& aLayers, int a
     tag.pos = aPos;
     tag.net = aNet;
 
+    JOINT_MAP& joints = writableJoints();
+
     // try to find the joint in this node.
-    JOINT_MAP::iterator f = m_joints.find( tag );
+    JOINT_MAP::iterator f = joints.find( tag );
 
     std::pair<JOINT_MAP::iterator, JOINT_MAP::iterator> range;
 
     // not found and we are not root? find in the root and copy results here.
-    if( f == m_joints.end() && !isRoot() )
+    if( f == joints.end() && !isRoot() )
     {
-        range = m_root->m_joints.equal_range( tag );
+        range = m_root->m_joints->equal_range( tag );
 
         for( f = range.first; f != range.second; ++f )
-            m_joints.insert( *f );
+            joints.insert( *f );
     }
 
     // now insert and combine overlapping joints
@@ -1031,9 +1281,9 @@ JOINT& NODE::touchJoint( const VECTOR2I& aPos, const LAYER_RANGE& aLayers, int a
     do
     {
         merged  = false;
-        range   = m_joints.equal_range( tag );
+        range   = joints.equal_range( tag );
 
-        if( range.first == m_joints.end() )
+        if( range.first == joints.end() )
             break;
 
         for( f = range.first; f != range.second; ++f )
@@ -1041,7 +1291,7 @@ JOINT& NODE::touchJoint( const VECTOR2I& aPos, const LAYER_RANGE& aLayers, int a
             if( aLayers.Overlaps( f->second.Layers() ) )
             {
                 jt.Merge( f->second );
-                m_joints.erase( f );
+                joints.erase( f );
                 merged = true;
                 break;
             }
@@ -1049,7 +1299,7 @@ JOINT& NODE::touchJoint( const VECTOR2I& aPos, const LAYER_RANGE& aLayers, int a
     }
     while( merged );
 
-    return m_joints.insert( TagJointPair( tag, jt ) )->second;
+    return joints.insert( TagJointPair( tag, jt ) )->second;
 }
 
 
@@ -1103,7 +1353,7 @@ void NODE::Dump( bool aLong )
     JOINT_MAP::iterator j;
 
     if( aLong )
-        for( j = m_joints.begin(); j != m_joints.end(); ++j )
+        for( j = m_joints->begin(); j != m_joints->end(); ++j )
         {
             wxLogTrace( "PNS", "joint : %s, links : %d\n",
                     j->second.GetPos().Format().c_str(), j->second.LinkCount() );
@@ -1155,7 +1405,7 @@ void NODE::Dump( bool aLong )
         lines_count++;
     }
 
-    wxLogTrace( "PNS", "Local joints: %d, lines : %d \n", m_joints.size(), lines_count );
+    wxLogTrace( "PNS", "Local joints: %d, lines : %d \n", m_joints->size(), lines_count );
 #endif
 }
 
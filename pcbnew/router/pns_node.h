@@ -24,6 +24,7 @@
 
 #include <vector>
 #include <list>
+#include <memory>
 #include <unordered_set>
 #include <unordered_map>
 
@@ -47,6 +48,38 @@ class INDEX;
 class ROUTER;
 class NODE;
 
+/**
+ * Struct ALLOC_STATS
+ *
+ * Counts of the allocations made by the nodes, to follow the cost of branching.
+ **/
+struct ALLOC_STATS
+{
+    ///> nodes created by NODE::Branch()
+    int m_branches = 0;
+
+    ///> items added to the nodes
+    int m_items = 0;
+
+    ///> spatial subindices copied when first written to by a branch or its parent
+    int m_subIndexCopies = 0;
+
+    ///> joint maps copied when first written to by a branch or its parent
+    int m_jointMapCopies = 0;
+
+    ALLOC_STATS operator-( const ALLOC_STATS& aOther ) const
+    {
+        ALLOC_STATS diff;
+
+        diff.m_branches = m_branches - aOther.m_branches;
+        diff.m_items = m_items - aOther.m_items;
+        diff.m_subIndexCopies = m_subIndexCopies - aOther.m_subIndexCopies;
+        diff.m_jointMapCopies = m_jointMapCopies - aOther.m_jointMapCopies;
+
+        return diff;
+    }
+};
+
 /**
  * Class RULE_RESOLVER
  *
@@ -173,7 +206,13 @@ public:
     ///> Returns the number of joints
     int JointCount() const
     {
-        return m_joints.size();
+        return m_joints->size();
+    }
+
+    ///> Returns a number changed by every item added to or removed from this node
+    int Revision() const
+    {
+        return m_revision;
     }
 
     ///> Returns the number of nodes in the inheritance chain (wrs to the root node)
@@ -257,6 +296,19 @@ public:
                          int            aKindMask = ITEM::ANY_T,
                          int            aForceClearance = -1 );
 
+    /**
+     * Function CheckAnyColliding()
+     *
+     * Checks if the item collides with anything else in the world, like CheckColliding(),
+     * without telling with what. The broad-phase candidates of the root node are cached
+     * per grid cell until the root is modified, which speeds up the many checks made by
+     * the optimizer around the cursor. Can be called from several threads at once.
+     * @param aItem the item to find collisions with
+     * @param aKindMask mask of obstacle types to take into account
+     * @return true if a collision was found.
+     */
+    bool CheckAnyColliding( const ITEM* aItem, int aKindMask = ITEM::ANY_T );
+
     /**
      * Function HitTest()
      *
@@ -419,8 +471,12 @@ public:
         return m_override.find( aItem ) != m_override.end();
     }
 
+    ///> Returns the allocations made by all the nodes so far
+    static ALLOC_STATS AllocStats();
+
 private:
     struct DEFAULT_OBSTACLE_VISITOR;
+    struct CANDIDATE_CACHE;
     typedef std::unordered_multimap<JOINT::HASH_TAG, JOINT, JOINT::JOINT_TAG_HASH> JOINT_MAP;
     typedef JOINT_MAP::value_type TagJointPair;
 
@@ -428,6 +484,10 @@ private:
     NODE( const NODE& aB );
     NODE& operator=( const NODE& aB );
 
+    ///> returns the joint map for modification, copying it first if it is shared
+    ///> with another node
+    JOINT_MAP& writableJoints();
+
     ///> tries to find matching joint and creates a new one if not found
     JOINT& touchJoint( const VECTOR2I&     aPos,
                        const LAYER_RANGE&  aLayers,
@@ -450,6 +510,13 @@ private:
     void removeViaIndex( VIA* aVia );
 
     void doRemove( ITEM* aItem );
+
+    ///> checks a single item (not a line) with CheckAnyColliding()
+    bool anyColliding( const ITEM* aItem, int aKindMask );
+
+    ///> runs aVisitor on the items of the index of this root node closer than aMinDistance
+    ///> to the bounding box of aItem, using the candidate cache
+    void queryCachedCandidates( const ITEM* aItem, int aMinDistance, OBSTACLE_VISITOR& aVisitor );
     void unlinkParent();
     void releaseChildren();
     void releaseGarbage();
@@ -474,8 +541,9 @@ private:
                      bool        aStopAtLockedJoints );
 
     ///> hash table with the joints, linking the items. Joints are hashed by
-    ///> their position, layer set and net.
-    JOINT_MAP m_joints;
+    ///> their position, layer set and net. Shared with the parent node
+    ///> until either of them modifies it.
+    std::shared_ptr<JOINT_MAP> m_joints;
 
     ///> node this node was branched from
     NODE* m_parent;
@@ -502,6 +570,12 @@ private:
     int m_depth;
 
     std::unordered_set<ITEM*> m_garbageItems;
+
+    ///> revision of the node contents, see Revision()
+    int m_revision;
+
+    ///> broad-phase query results of the root index, per grid cell
+    std::unique_ptr<CANDIDATE_CACHE> m_candidateCache;
 };
 
 }
@@ -25,6 +25,8 @@
 
 #include <cmath>
 
+#include <work_stealing_pool.h>
+
 #include "pns_line.h"
 #include "pns_diff_pair.h"
 #include "pns_node.h"
@@ -386,7 +388,7 @@ bool OPTIMIZER::checkColliding( ITEM* aItem, bool aUpdateCache )
 {
     CACHE_VISITOR v( aItem, m_world, m_collisionKindMask );
 
-    return static_cast<bool>( m_world->CheckColliding( aItem ) );
+    return m_world->CheckAnyColliding( aItem );
 
 #if 0
     // something is wrong with the cache, need to investigate.
@@ -896,17 +898,44 @@ int OPTIMIZER::smartPadsSingle( LINE* aLine, ITEM* aPad, bool aEnd, int aEndVert
         }
     }
 
+    // The collision checks only read the world: run them for all the variants at once.
+    // This runs on every mouse move, so a few variants are checked in place.
+    const size_t minParallelVariants = 4;
+
+    std::vector<uint8_t> colliding( variants.size(), 0 );
+    auto checkVariant = [&]( size_t aIndex )
+    {
+        LINE tmp( *aLine, variants[aIndex].second );
+
+        colliding[aIndex] = checkColliding( &tmp );
+    };
+
+    if( variants.size() >= minParallelVariants )
+    {
+        std::vector<WORK_STEALING_POOL::TASK> tasks;
+
+        for( size_t i = 0; i < variants.size(); i++ )
+            tasks.push_back( [&checkVariant, i]() { checkVariant( i ); } );
+
+        GetThreadPool().Run( tasks );
+    }
+    else
+    {
+        for( size_t i = 0; i < variants.size(); i++ )
+            checkVariant( i );
+    }
+
     SHAPE_LINE_CHAIN l_best;
     bool found = false;
     int p_best = -1;
 
-    for( RtVariant& vp : variants )
+    for( size_t i = 0; i < variants.size(); i++ )
     {
-        LINE tmp( *aLine, vp.second );
+        const RtVariant& vp = variants[i];
         int cost = COST_ESTIMATOR::CornerCost( vp.second );
         int len = vp.second.Length();
 
-        if( !checkColliding( &tmp ) )
+        if( !colliding[i] )
         {
             if( cost < min_cost || ( cost == min_cost && len < min_len ) )
             {
@@ -22,6 +22,8 @@
 #include <cstdio>
 #include <vector>
 
+#include <wx/utils.h>
+
 #include <view/view.h>
 #include <view/view_item.h>
 #include <view/view_group.h>
@@ -72,6 +74,13 @@ ROUTER::ROUTER()
     m_snapshotIter = 0;
     m_violation = false;
     m_iface = nullptr;
+
+    // The event log is a debugging aid: record it in debug builds or on request only
+#ifdef DEBUG
+    m_logEvents = true;
+#else
+    m_logEvents = wxGetEnv( "KICAD_PNS_EVENT_LOG", nullptr );
+#endif
 }
 
 
@@ -95,6 +104,8 @@ void ROUTER::SyncWorld()
     m_world = std::unique_ptr<NODE>( new NODE );
     m_iface->SyncWorld( m_world.get() );
 
+    m_eventLog.Clear();
+
 }
 
 void ROUTER::ClearWorld()
@@ -135,6 +146,9 @@ bool ROUTER::StartDragging( const VECTOR2I& aP, ITEM* aStartItem, int aDragMode
     if( !aStartItem || aStartItem->OfKind( ITEM::SOLID_T ) )
         return false;
 
+    logSettings( aP );
+    logEvent( LOGGER::EVT_START_DRAG, aP, aStartItem, aDragMode );
+
     m_dragger.reset( new DRAGGER( this ) );
     m_dragger->SetMode( aDragMode );
     m_dragger->SetWorld( m_world.get() );
@@ -178,6 +192,10 @@ bool ROUTER::StartRouting( const VECTOR2I& aP, ITEM* aStartItem, int aLayer )
 
     m_forceMarkObstaclesMode = false;
 
+    logEvent( LOGGER::EVT_SET_MODE, aP, nullptr, m_mode );
+    logSettings( aP );
+    logEvent( LOGGER::EVT_START_ROUTE, aP, aStartItem, aLayer );
+
     switch( m_mode )
     {
         case PNS_MODE_ROUTE_SINGLE:
@@ -224,6 +242,10 @@ void ROUTER::DisplayItems( const ITEM_SET& aItems )
 
 void ROUTER::Move( const VECTOR2I& aP, ITEM* endItem )
 {
+    const ALLOC_STATS statsBefore = NODE::AllocStats();
+
+    logEvent( LOGGER::EVT_MOVE, aP, endItem );
+
     m_currentEnd = aP;
 
     switch( m_state )
@@ -239,6 +261,12 @@ void ROUTER::Move( const VECTOR2I& aP, ITEM* endItem )
     default:
         break;
     }
+
+    m_moveStats = NODE::AllocStats() - statsBefore;
+
+    wxLogTrace( "PNS", "move: %d branches, %d items, %d subindex copies, %d joint map copies",
+                m_moveStats.m_branches, m_moveStats.m_items, m_moveStats.m_subIndexCopies,
+                m_moveStats.m_jointMapCopies );
 }
 
 
@@ -312,6 +340,7 @@ void ROUTER::UpdateSizes( const SIZES_SETTINGS& aSizes )
     // Change track/via size settings
     if( m_state == ROUTE_TRACK)
     {
+        logSizes( m_currentEnd );
         m_placer->UpdateSizes( m_sizes );
     }
 }
@@ -365,6 +394,8 @@ bool ROUTER::FixRoute( const VECTOR2I& aP, ITEM* aEndItem )
 {
     bool rv = false;
 
+    logEvent( LOGGER::EVT_FIX, aP, aEndItem );
+
     switch( m_state )
     {
     case ROUTE_TRACK:
@@ -403,6 +434,8 @@ void ROUTER::StopRouting()
     if( !RoutingInProgress() )
         return;
 
+    logEvent( LOGGER::EVT_STOP, m_currentEnd );
+
     m_placer.reset();
     m_dragger.reset();
 
@@ -418,6 +451,7 @@ void ROUTER::FlipPosture()
 {
     if( m_state == ROUTE_TRACK )
     {
+        logEvent( LOGGER::EVT_FLIP_POSTURE, m_currentEnd );
         m_placer->FlipPosture();
     }
 }
@@ -428,6 +462,7 @@ void ROUTER::SwitchLayer( int aLayer )
     switch( m_state )
     {
     case ROUTE_TRACK:
+        logEvent( LOGGER::EVT_SWITCH_LAYER, m_currentEnd, nullptr, aLayer );
         m_placer->SetLayer( aLayer );
         break;
     default:
@@ -440,6 +475,8 @@ void ROUTER::ToggleViaPlacement()
 {
     if( m_state == ROUTE_TRACK )
     {
+        logEvent( LOGGER::EVT_TOGGLE_VIA, m_currentEnd );
+
         bool toggle = !m_placer->IsPlacingVia();
         m_placer->ToggleVia( toggle );
     }
@@ -463,6 +500,35 @@ int ROUTER::GetCurrentLayer() const
 }
 
 
+void ROUTER::logEvent( LOGGER::EVENT_TYPE aType, const VECTOR2I& aP, const ITEM* aItem,
+                       int aArg, const std::vector<int>& aParams )
+{
+    // The log is only cleared by SyncWorld(): stop it rather than let it grow without bound
+    const int maxEvents = 200000;
+
+    if( m_logEvents && m_eventLog.EventCount() < maxEvents )
+        m_eventLog.LogEvent( aType, aP, aItem, aArg, aParams );
+}
+
+
+void ROUTER::logSizes( const VECTOR2I& aP )
+{
+    std::vector<int> params = { m_sizes.ViaDiameter(), m_sizes.ViaDrill(),
+                                (int) m_sizes.ViaType(), m_sizes.DiffPairWidth(),
+                                m_sizes.DiffPairGap(), m_sizes.DiffPairViaGap(),
+                                m_sizes.DiffPairViaGapSameAsTraceGap() ? 1 : 0 };
+
+    logEvent( LOGGER::EVT_SIZES, aP, nullptr, m_sizes.TrackWidth(), params );
+}
+
+
+void ROUTER::logSettings( const VECTOR2I& aP )
+{
+    logEvent( LOGGER::EVT_SETTINGS, aP, nullptr, m_settings.Mode() );
+    logSizes( aP );
+}
+
+
 void ROUTER::DumpLog()
 {
     LOGGER* logger = nullptr;
@@ -483,6 +549,8 @@ void ROUTER::DumpLog()
 
     if( logger )
         logger->Save( "/tmp/shove.log" );
+
+    m_eventLog.Save( "/tmp/pns_events.log" );
 }
 
 
@@ -34,6 +34,7 @@
 #include "pns_sizes_settings.h"
 #include "pns_item.h"
 #include "pns_itemset.h"
+#include "pns_logger.h"
 #include "pns_node.h"
 
 namespace KIGFX
@@ -220,6 +221,25 @@ public:
         return m_iface;
     }
 
+    ///> Returns the log of the events passed to the router since the world was synced
+    const LOGGER& EventLog() const
+    {
+        return m_eventLog;
+    }
+
+    ///> Enables the event log, off by default in release builds unless the
+    ///> KICAD_PNS_EVENT_LOG environment variable is set
+    void EnableEventLog( bool aEnable )
+    {
+        m_logEvents = aEnable;
+    }
+
+    ///> Returns the allocations made by the nodes during the last Move()
+    const ALLOC_STATS& LastMoveStats() const
+    {
+        return m_moveStats;
+    }
+
 private:
     void movePlacing( const VECTOR2I& aP, ITEM* aItem );
     void moveDragging( const VECTOR2I& aP, ITEM* aItem );
@@ -247,6 +267,15 @@ private:
     void markViolations( NODE* aNode, ITEM_SET& aCurrent, NODE::ITEM_VECTOR& aRemoved );
     bool isStartingPointRoutable( const VECTOR2I& aWhere, int aLayer );
 
+    void logEvent( LOGGER::EVENT_TYPE aType, const VECTOR2I& aP, const ITEM* aItem = nullptr,
+                   int aArg = 0, const std::vector<int>& aParams = std::vector<int>() );
+
+    ///> Logs the track, via and diff pair sizes the next events are routed with
+    void logSizes( const VECTOR2I& aP );
+
+    ///> Logs the routing mode (PNS_MODE) and the sizes
+    void logSettings( const VECTOR2I& aP );
+
     VECTOR2I m_currentEnd;
     RouterState m_state;
 
@@ -271,6 +300,10 @@ private:
 
     wxString m_toolStatusbarName;
     wxString m_failureReason;
+
+    ALLOC_STATS m_moveStats;
+    LOGGER m_eventLog;
+    bool m_logEvents;
 };
 
 }
@@ -43,8 +43,19 @@
 
 #include <profile.h>
 
+#include <atomic>
+
 namespace PNS {
 
+static std::atomic<int> totalIterations( 0 );
+
+
+int SHOVE::TotalIterations()
+{
+    return totalIterations;
+}
+
+
 void SHOVE::replaceItems( ITEM* aOld, std::unique_ptr< ITEM > aNew )
 {
     OPT_BOX2I changed_area = ChangedArea( aOld, aNew.get() );
@@ -1050,6 +1061,7 @@ SHOVE::SHOVE_STATUS SHOVE::shoveMainLoop()
         st = shoveIteration( m_iter );
 
         m_iter++;
+        totalIterations++;
 
         if( st == SH_INCOMPLETE || timeLimit.Expired() || m_iter >= iterLimit )
         {
@@ -85,6 +85,9 @@ public:
 
     void SetInitialLine( LINE& aInitial );
 
+    ///> Returns the number of shove iterations run by all the SHOVE objects so far
+    static int TotalIterations();
+
 private:
     typedef std::vector<SHAPE_LINE_CHAIN> HULL_SET;
     typedef OPT<LINE> OPT_LINE;
@@ -22,6 +22,7 @@
 #include <core/optional.h>
 
 #include <geometry/shape_line_chain.h>
+#include <work_stealing_pool.h>
 
 #include "pns_walkaround.h"
 #include "pns_optimizer.h"
@@ -52,7 +53,9 @@ NODE::OPT_OBSTACLE WALKAROUND::nearestObstacle( const LINE& aPath )
 
 
 WALKAROUND::WALKAROUND_STATUS WALKAROUND::singleStep( LINE& aPath,
-                                                              bool aWindingDirection )
+                                                              bool aWindingDirection,
+                                                              int aIteration,
+                                                              int& aBlockageCount )
 {
     OPT<OBSTACLE>& current_obs =
         aWindingDirection ? m_currentObstacle[0] : m_currentObstacle[1];
@@ -68,9 +71,9 @@ WALKAROUND::WALKAROUND_STATUS WALKAROUND::singleStep( LINE& aPath,
 
     if( ( current_obs->m_hull ).PointInside( last ) || ( current_obs->m_hull ).PointOnEdge( last ) )
     {
-        m_recursiveBlockageCount++;
+        aBlockageCount++;
 
-        if( m_recursiveBlockageCount < 3 )
+        if( aBlockageCount < 3 )
             aPath.Line().Append( current_obs->m_hull.NearestPoint( last ) );
         else
         {
@@ -85,7 +88,9 @@ WALKAROUND::WALKAROUND_STATUS WALKAROUND::singleStep( LINE& aPath,
                       path_post[1], !aWindingDirection );
 
 #ifdef DEBUG
-    m_logger.NewGroup( aWindingDirection ? "walk-cw" : "walk-ccw", m_iteration );
+    std::lock_guard<std::mutex> lock( m_loggerLock );
+
+    m_logger.NewGroup( aWindingDirection ? "walk-cw" : "walk-ccw", aIteration );
     m_logger.Log( &path_walk[0], 0, "path-walk" );
     m_logger.Log( &path_pre[0], 1, "path-pre" );
     m_logger.Log( &path_post[0], 4, "path-post" );
@@ -141,6 +146,87 @@ WALKAROUND::WALKAROUND_STATUS WALKAROUND::singleStep( LINE& aPath,
 }
 
 
+int WALKAROUND::walk( LINE& aPath, bool aWindingDirection, std::vector<int>& aBlockages,
+                      std::atomic<int>& aFirstDone )
+{
+    int blockageCount = 0;
+
+    for( int i = 0; i < m_iterationLimit && i <= aFirstDone; i++ )
+    {
+        int prevCount = blockageCount;
+        WALKAROUND_STATUS status = singleStep( aPath, aWindingDirection, i, blockageCount );
+
+        if( blockageCount != prevCount )
+            aBlockages.push_back( i );
+
+        if( status == DONE )
+        {
+            int first = aFirstDone;
+
+            while( i < first && !aFirstDone.compare_exchange_weak( first, i ) )
+                ;
+
+            return i;
+        }
+    }
+
+    return m_iterationLimit;
+}
+
+
+bool WALKAROUND::walkConcurrently( LINE& aPathCw, LINE& aPathCcw,
+                                   WALKAROUND_STATUS& aStatusCw, WALKAROUND_STATUS& aStatusCcw )
+{
+    std::atomic<int> firstDone( m_iterationLimit );
+    std::vector<int> blockages_cw, blockages_ccw;
+    int done_cw = m_iterationLimit, done_ccw = m_iterationLimit;
+
+    std::vector<WORK_STEALING_POOL::TASK> tasks;
+
+    tasks.push_back( [&]() { done_cw = walk( aPathCw, true, blockages_cw, firstDone ); } );
+    tasks.push_back( [&]() { done_ccw = walk( aPathCcw, false, blockages_ccw, firstDone ); } );
+
+    GetThreadPool().Run( tasks );
+
+    // The serial walk stops at the first iteration done in either direction
+    int last = std::min( done_cw, done_ccw );
+
+    // Replay the blockages in the order of the serial walk (clockwise step first): the
+    // walks are the same unless the shared count reaches the limit before the count of
+    // the direction alone.
+    int    count = 0;
+    size_t n_cw = 0, n_ccw = 0;
+
+    for( int i = 0; i <= last && i < m_iterationLimit; i++ )
+    {
+        if( n_cw < blockages_cw.size() && blockages_cw[n_cw] == i )
+        {
+            count++;
+            n_cw++;
+
+            if( count >= 3 && n_cw < 3 )
+                return false;
+        }
+
+        if( n_ccw < blockages_ccw.size() && blockages_ccw[n_ccw] == i )
+        {
+            count++;
+            n_ccw++;
+
+            if( count >= 3 && n_ccw < 3 )
+                return false;
+        }
+    }
+
+    m_recursiveBlockageCount = count;
+    m_iteration = last;
+    aStatusCw = ( last < m_iterationLimit && done_cw == last ) ? DONE : IN_PROGRESS;
+    aStatusCcw = ( last < m_iterationLimit && done_ccw == last ) ? DONE : IN_PROGRESS;
+
+    return true;
+}
+
+
 WALKAROUND::WALKAROUND_STATUS WALKAROUND::Route( const LINE& aInitialPath,
         LINE& aWalkPath, bool aOptimize )
 {
@@ -174,14 +260,46 @@ WALKAROUND::WALKAROUND_STATUS WALKAROUND::Route( const LINE& aInitialPath,
         m_forceSingleDirection = false;
     }
 
-    while( m_iteration < m_iterationLimit )
+    // The two directions only read the world: walk them at the same time.  The serial walk
+    // below gives the same result, and is used when the shared blockage count makes the
+    // directions depend on each other, or when both paths must be walked to the end.
+    bool walked = false;
+
+    if( s_cw != STUCK && s_ccw != STUCK && !m_forceLongerPath )
+    {
+        NODE::OPT_OBSTACLE initialObstacle = m_currentObstacle[0];
+        bool               initialRecursive[2] = { m_recursiveCollision[0], m_recursiveCollision[1] };
+
+        walked = walkConcurrently( path_cw, path_ccw, s_cw, s_ccw );
+
+        if( !walked )
+        {
+            path_cw = path_ccw = aInitialPath;
+            m_currentObstacle[0] = m_currentObstacle[1] = initialObstacle;
+            m_recursiveCollision[0] = initialRecursive[0];
+            m_recursiveCollision[1] = initialRecursive[1];
+            m_recursiveBlockageCount = 0;
+        }
+    }
+
+    while( !walked && m_iteration < m_iterationLimit )
     {
         if( s_cw != STUCK )
-            s_cw = singleStep( path_cw, true );
+            s_cw = singleStep( path_cw, true, m_iteration, m_recursiveBlockageCount );
 
         if( s_ccw != STUCK )
-            s_ccw = singleStep( path_ccw, false );
+            s_ccw = singleStep( path_ccw, false, m_iteration, m_recursiveBlockageCount );
 
+        if( ( s_cw == DONE && s_ccw == DONE ) || ( s_cw == STUCK && s_ccw == STUCK ) )
+            break;
+        else if( ( s_cw == DONE || s_ccw == DONE ) && !m_forceLongerPath )
+            break;
+
+        m_iteration++;
+    }
+
+    if( m_iteration < m_iterationLimit )
+    {
         if( ( s_cw == DONE && s_ccw == DONE ) || ( s_cw == STUCK && s_ccw == STUCK ) )
         {
             int len_cw  = path_cw.CLine().Length();
@@ -191,21 +309,15 @@ WALKAROUND::WALKAROUND_STATUS WALKAROUND::Route( const LINE& aInitialPath,
                 aWalkPath = ( len_cw > len_ccw ? path_cw : path_ccw );
             else
                 aWalkPath = ( len_cw < len_ccw ? path_cw : path_ccw );
-
-            break;
         }
-        else if( s_cw == DONE && !m_forceLongerPath )
+        else if( s_cw == DONE )
         {
             aWalkPath = path_cw;
-            break;
         }
-        else if( s_ccw == DONE && !m_forceLongerPath )
+        else
         {
             aWalkPath = path_ccw;
-            break;
         }
-
-        m_iteration++;
     }
 
     if( m_iteration == m_iterationLimit )
@@ -22,6 +22,8 @@
 #ifndef __PNS_WALKAROUND_H
 #define __PNS_WALKAROUND_H
 
+#include <atomic>
+#include <mutex>
 #include <set>
 
 #include "pns_line.h"
@@ -129,7 +131,22 @@ public:
 private:
     void start( const LINE& aInitialPath );
 
-    WALKAROUND_STATUS singleStep( LINE& aPath, bool aWindingDirection );
+    WALKAROUND_STATUS singleStep( LINE& aPath, bool aWindingDirection, int aIteration,
+                                  int& aBlockageCount );
+
+    ///> Walks around the obstacles in one direction, with its own blockage count, until the
+    ///> path is done, the iteration limit is reached or a path done in the other direction
+    ///> ends the search.  Stores the iterations which met a blockage in aBlockages.
+    ///> @return the iteration at which the path was done, or m_iterationLimit.
+    int walk( LINE& aPath, bool aWindingDirection, std::vector<int>& aBlockages,
+              std::atomic<int>& aFirstDone );
+
+    ///> Walks both directions in parallel and checks that sharing the blockage count between
+    ///> them, as the serial walk does, would not have changed the paths.  Sets the state of
+    ///> the serial walk at its last iteration.
+    ///> @return false if the paths differ from the serial walk ones, which must be redone.
+    bool walkConcurrently( LINE& aPathCw, LINE& aPathCcw,
+                           WALKAROUND_STATUS& aStatusCw, WALKAROUND_STATUS& aStatusCcw );
     NODE::OPT_OBSTACLE nearestObstacle( const LINE& aPath );
 
     NODE* m_world;
@@ -146,6 +163,7 @@ private:
     NODE::OPT_OBSTACLE m_currentObstacle[2];
     bool m_recursiveCollision[2];
     LOGGER m_logger;
+    std::mutex m_loggerLock;
     std::set<ITEM*> m_restrictedSet;
 };
 
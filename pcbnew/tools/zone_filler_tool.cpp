@@ -93,9 +93,10 @@ int ZONE_FILLER_TOOL::ZoneFill( const TOOL_EVENT& aEvent )
             new WX_PROGRESS_REPORTER( frame(), _( "Fill Zone" ), 3 )
             );
 
+    // An explicit fill command always refills, whatever the fill hashes say
     ZONE_FILLER filler( board(), &commit );
     filler.SetProgressReporter( progressReporter.get() );
-    filler.Fill( toFill );
+    filler.Fill( toFill, true );
 
     return 0;
 }
@@ -116,9 +117,10 @@ int ZONE_FILLER_TOOL::ZoneFillAll( const TOOL_EVENT& aEvent )
             new WX_PROGRESS_REPORTER( frame(), _( "Fill All Zones" ), 3 )
             );
 
+    // An explicit fill command always refills, whatever the fill hashes say
     ZONE_FILLER filler( board(), &commit );
     filler.SetProgressReporter( progressReporter.get() );
-    filler.Fill( toFill );
+    filler.Fill( toFill, true );
 
     return 0;
 }
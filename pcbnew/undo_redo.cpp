@@ -422,6 +422,10 @@ void PCB_BASE_EDIT_FRAME::PutDataInPreviousState( PICKED_ITEMS_LIST* aList, bool
 
     bool build_item_list = true;    // if true the list of existing items must be rebuilt
 
+    // Areas changed by the undo or redo, reported to the frame (e.g. for the online DRC)
+    std::vector<EDA_RECT>    dirtyAreas;
+    std::vector<BOARD_ITEM*> changedItems;
+
     // Restore changes in reverse order
     for( int ii = aList->GetCount() - 1; ii >= 0 ; ii-- )
     {
@@ -487,6 +491,13 @@ void PCB_BASE_EDIT_FRAME::PutDataInPreviousState( PICKED_ITEMS_LIST* aList, bool
         // It is possible that we are going to replace the selected item, so clear it
         SetCurItem( NULL );
 
+        // Markers are the result of the DRC, not an input, and origins are not on the board
+        bool reportChange = item->Type() != PCB_MARKER_T
+                            && status != UR_DRILLORIGIN && status != UR_GRIDORIGIN;
+
+        if( reportChange )
+            dirtyAreas.push_back( item->GetBoundingBox() );
+
         switch( aList->GetPickedItemStatus( ii ) )
         {
         case UR_CHANGED:    /* Exchange old and new data for each item */
@@ -577,6 +588,12 @@ void PCB_BASE_EDIT_FRAME::PutDataInPreviousState( PICKED_ITEMS_LIST* aList, bool
         }
         break;
         }
+
+        if( reportChange )
+        {
+            dirtyAreas.push_back( item->GetBoundingBox() );
+            changedItems.push_back( item );
+        }
     }
 
     if( not_found )
@@ -588,6 +605,9 @@ void PCB_BASE_EDIT_FRAME::PutDataInPreviousState( PICKED_ITEMS_LIST* aList, bool
     {
         Compile_Ratsnest( NULL, false );
     }
+
+    if( !dirtyAreas.empty() )
+        OnBoardItemsChanged( dirtyAreas, changedItems );
 }
 
 
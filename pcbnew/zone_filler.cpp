@@ -24,8 +24,9 @@
  */
 
 #include <cstdint>
-#include <thread>
+#include <cstring>
 #include <mutex>
+#include <functional>
 
 #include <class_board.h>
 #include <class_zone.h>
@@ -40,6 +41,7 @@
 #include <board_commit.h>
 
 #include <widgets/progress_reporter.h>
+#include <work_stealing_pool.h>
 
 #include <geometry/shape_poly_set.h>
 #include <geometry/shape_file_io.h>
@@ -65,7 +67,7 @@ static double s_thermalRot = 450;    // angle of stubs in thermal reliefs for ro
 static const bool s_DumpZonesWhenFilling = false;
 
 ZONE_FILLER::ZONE_FILLER(  BOARD* aBoard, COMMIT* aCommit ) :
-    m_board( aBoard ), m_commit( aCommit ), m_progressReporter( nullptr ), m_count_done( 0 )
+    m_board( aBoard ), m_commit( aCommit ), m_progressReporter( nullptr ), m_pool( nullptr )
 {
 }
 
@@ -80,10 +82,8 @@ void ZONE_FILLER::SetProgressReporter( PROGRESS_REPORTER* aReporter )
     m_progressReporter = aReporter;
 }
 
-void ZONE_FILLER::Fill( std::vector<ZONE_CONTAINER*> aZones )
+void ZONE_FILLER::Fill( std::vector<ZONE_CONTAINER*> aZones, bool aForce )
 {
-    int parallelThreadCount = std::max( ( int )std::thread::hardware_concurrency(), 2 );
-
     std::vector<CN_ZONE_ISOLATED_ISLAND_LIST> toFill;
     auto connectivity = m_board->GetConnectivity();
 
@@ -93,15 +93,24 @@ void ZONE_FILLER::Fill( std::vector<ZONE_CONTAINER*> aZones )
     // Remove segment zones
     m_board->m_Zone.DeleteAll();
 
+    std::vector<uint64_t> fillHashes;
+
     for( auto zone : aZones )
     {
         // Keepout zones are not filled
         if( zone->GetIsKeepout() )
             continue;
 
+        // Nothing which can change the fill has been modified since the last fill
+        uint64_t fillHash = computeFillHash( zone );
+
+        if( !aForce && zone->IsFilled() && zone->GetFillHash() == fillHash )
+            continue;
+
         CN_ZONE_ISOLATED_ISLAND_LIST l;
         l.m_zone = zone;
         toFill.push_back( l );
+        fillHashes.push_back( fillHash );
     }
 
     for( unsigned i = 0; i < toFill.size(); i++ )
@@ -118,44 +127,51 @@ void ZONE_FILLER::Fill( std::vector<ZONE_CONTAINER*> aZones )
         m_progressReporter->SetMaxProgress( toFill.size() );
     }
 
-    m_next = 0;
-    m_count_done = 0;
-    std::vector<std::thread> fillWorkers;
+    // The zone fills split their work into smaller tasks, so the other workers can help
+    // with the biggest zones instead of waiting for them
+    WORK_STEALING_POOL& pool = GetThreadPool();
+    std::vector<WORK_STEALING_POOL::TASK> tasks;
+    std::vector<char> filled( toFill.size(), 0 );
+
+    m_pool = &pool;
 
-    for( ssize_t ii = 0; ii < parallelThreadCount; ++ii )
+    for( unsigned i = 0; i < toFill.size(); i++ )
     {
-        fillWorkers.push_back( std::thread( [ this, toFill ]()
-        {
-            size_t i = m_next.fetch_add( 1 );
-            while( i < toFill.size() )
-            {
-                SHAPE_POLY_SET rawPolys, finalPolys;
-                ZONE_SEGMENT_FILL segFill;
-                fillSingleZone( toFill[i].m_zone, rawPolys, finalPolys );
+        ZONE_CONTAINER* zone = toFill[i].m_zone;
 
-                toFill[i].m_zone->SetRawPolysList( rawPolys );
-                toFill[i].m_zone->SetFilledPolysList( finalPolys );
-                toFill[i].m_zone->SetIsFilled( true );
+        tasks.push_back( [ this, zone, i, &filled ]()
+        {
+            SHAPE_POLY_SET rawPolys, finalPolys;
+            fillSingleZone( zone, rawPolys, finalPolys );
 
-                if( m_progressReporter )
-                    m_progressReporter->AdvanceProgress();
+            zone->SetRawPolysList( rawPolys );
+            zone->SetFilledPolysList( finalPolys );
+            zone->SetIsFilled( true );
+            filled[i] = 1;
 
-                m_count_done.fetch_add( 1 );
-                i = m_next.fetch_add( 1 );
-            }
-        } ) );
+            if( m_progressReporter )
+                m_progressReporter->AdvanceProgress();
+        } );
     }
 
-    while( m_count_done.load() < toFill.size() )
+    if( !pool.Run( tasks, m_progressReporter, true ) )
     {
-        if( m_progressReporter )
-            m_progressReporter->KeepRefreshing();
-        else
-            wxMilliSleep( 20 );
-    }
+        // Cancelled by the user: the zones which were not refilled keep their previous fill
+        unsigned count = 0;
 
-    for( size_t ii = 0; ii < fillWorkers.size(); ++ii )
-        fillWorkers[ ii ].join();
+        for( unsigned i = 0; i < toFill.size(); i++ )
+        {
+            if( filled[i] )
+            {
+                toFill[count] = toFill[i];
+                fillHashes[count] = fillHashes[i];
+                count++;
+            }
+        }
+
+        toFill.resize( count );
+        fillHashes.resize( count );
+    }
 
     // Now remove insulated copper islands
     if( m_progressReporter )
@@ -181,6 +197,10 @@ void ZONE_FILLER::Fill( std::vector<ZONE_CONTAINER*> aZones )
         zone.m_zone->SetFilledPolysList( poly );
     }
 
+    // The hashes are stored after the commit has saved the previous state of the zones
+    for( unsigned i = 0; i < toFill.size(); i++ )
+        toFill[i].m_zone->SetFillHash( fillHashes[i] );
+
     if( m_progressReporter )
     {
         m_progressReporter->AdvancePhase();
@@ -188,38 +208,22 @@ void ZONE_FILLER::Fill( std::vector<ZONE_CONTAINER*> aZones )
         m_progressReporter->SetMaxProgress( toFill.size() );
     }
 
-    m_next = 0;
-    m_count_done = 0;
-    std::vector<std::thread> triangulationWorkers;
+    tasks.clear();
 
-    for( ssize_t ii = 0; ii < parallelThreadCount; ++ii )
+    for( auto& fillItem : toFill )
     {
-        triangulationWorkers.push_back( std::thread( [ this, toFill ]()
-        {
-            size_t i = m_next.fetch_add( 1 );
-            while( i < toFill.size() )
-            {
-                if( m_progressReporter )
-                    m_progressReporter->AdvanceProgress();
-
-                toFill[i].m_zone->CacheTriangulation();
+        ZONE_CONTAINER* zone = fillItem.m_zone;
 
-                m_count_done.fetch_add( 1 );
-                i = m_next.fetch_add( 1 );
-            }
-        } ) );
-    }
+        tasks.push_back( [ this, zone ]()
+        {
+            zone->CacheTriangulation();
 
-    while( m_count_done.load() < toFill.size() )
-    {
-        if( m_progressReporter )
-            m_progressReporter->KeepRefreshing();
-        else
-            wxMilliSleep( 10 );
+            if( m_progressReporter )
+                m_progressReporter->AdvanceProgress();
+        } );
     }
 
-    for( size_t ii = 0; ii < triangulationWorkers.size(); ++ii )
-        triangulationWorkers[ ii ].join();
+    pool.Run( tasks, m_progressReporter );
 
     // If some zones must be filled by segments, create the filling segments
     // (note, this is a outdated option, but it exists)
@@ -240,26 +244,32 @@ void ZONE_FILLER::Fill( std::vector<ZONE_CONTAINER*> aZones )
             m_progressReporter->SetMaxProgress( zones_to_fill_count );
         }
 
-        // TODO: use thread pool to speedup calculations:
-        for( unsigned i = 0; i < toFill.size(); i++ )
+        tasks.clear();
+
+        for( auto& fillItem : toFill )
         {
-            ZONE_CONTAINER* zone = toFill[i].m_zone;
+            ZONE_CONTAINER* zone = fillItem.m_zone;
 
             if( zone->GetFillMode() != ZFM_SEGMENTS )
                 continue;
 
-            if( m_progressReporter )
+            tasks.push_back( [ this, zone ]()
             {
-                m_progressReporter->AdvanceProgress();
-            }
+                ZONE_SEGMENT_FILL segFill;
 
-            ZONE_SEGMENT_FILL segFill;
+                fillZoneWithSegments( zone, zone->GetFilledPolysList(), segFill );
+                zone->SetFillSegments( segFill );
 
-            fillZoneWithSegments( zone, zone->GetFilledPolysList(), segFill );
-            toFill[i].m_zone->SetFillSegments( segFill );
+                if( m_progressReporter )
+                    m_progressReporter->AdvanceProgress();
+            } );
         }
+
+        pool.Run( tasks, m_progressReporter );
     }
 
+    m_pool = nullptr;
+
     if( m_progressReporter )
     {
         m_progressReporter->AdvancePhase();
@@ -286,6 +296,280 @@ void ZONE_FILLER::Fill( std::vector<ZONE_CONTAINER*> aZones )
 }
 
 
+/**
+ * FNV-1a hash of the values which can change a zone fill.  The values are serialized
+ * explicitly (integers as 64 bit little endian numbers, doubles as their bit pattern,
+ * texts as UTF-8), so the hash saved in the board file does not depend on the platform
+ * or the compiler.
+ */
+class FILL_HASH
+{
+public:
+    FILL_HASH() :
+        m_hash( 0xcbf29ce484222325ULL )
+    {
+    }
+
+    void AddInt( int64_t aValue )
+    {
+        uint64_t value = (uint64_t) aValue;
+
+        for( int i = 0; i < 8; i++ )
+            addByte( (uint8_t) ( value >> ( 8 * i ) ) );
+    }
+
+    void AddDouble( double aValue )
+    {
+        static_assert( sizeof( double ) == sizeof( uint64_t ), "double is not 64 bits" );
+
+        uint64_t bits;
+
+        // -0.0 and 0.0 give the same fill
+        if( aValue == 0.0 )
+            aValue = 0.0;
+
+        memcpy( &bits, &aValue, sizeof( bits ) );
+        AddInt( (int64_t) bits );
+    }
+
+    void AddText( const wxString& aText )
+    {
+        wxScopedCharBuffer utf8 = aText.utf8_str();
+
+        AddInt( utf8.length() );
+
+        for( size_t i = 0; i < utf8.length(); i++ )
+            addByte( (uint8_t) utf8.data()[i] );
+    }
+
+    void AddPoint( const wxPoint& aPoint )
+    {
+        AddInt( aPoint.x );
+        AddInt( aPoint.y );
+    }
+
+    void AddPolySet( const SHAPE_POLY_SET& aPolySet )
+    {
+        AddInt( aPolySet.OutlineCount() );
+
+        for( auto it = aPolySet.CIterateWithHoles(); it; it++ )
+        {
+            AddInt( it->x );
+            AddInt( it->y );
+        }
+    }
+
+    void AddLayers( const BOARD_ITEM* aItem )
+    {
+        AddText( aItem->GetLayerSet().FmtHex() );
+    }
+
+    uint64_t GetHash() const
+    {
+        return m_hash;
+    }
+
+private:
+    void addByte( uint8_t aByte )
+    {
+        m_hash ^= aByte;
+        m_hash *= 0x100000001b3ULL;
+    }
+
+    uint64_t m_hash;
+};
+
+
+static void hashPad( FILL_HASH& aHash, const D_PAD* aPad )
+{
+    aHash.AddLayers( aPad );
+    aHash.AddInt( aPad->GetShape() );
+    aHash.AddInt( aPad->GetDrillShape() );
+    aHash.AddPoint( wxPoint( aPad->GetSize() ) );
+    aHash.AddPoint( aPad->GetOffset() );
+    aHash.AddPoint( wxPoint( aPad->GetDelta() ) );
+    aHash.AddPoint( aPad->GetPosition() );
+    aHash.AddDouble( aPad->GetOrientation() );
+}
+
+
+static void hashDrawSegment( FILL_HASH& aHash, const DRAWSEGMENT* aSegment )
+{
+    aHash.AddInt( aSegment->Type() );
+    aHash.AddLayers( aSegment );
+    aHash.AddInt( aSegment->GetShape() );
+    aHash.AddInt( aSegment->GetWidth() );
+    aHash.AddPoint( aSegment->GetStart() );
+    aHash.AddPoint( aSegment->GetEnd() );
+    aHash.AddPoint( aSegment->GetBezControl1() );
+    aHash.AddPoint( aSegment->GetBezControl2() );
+    aHash.AddDouble( aSegment->GetAngle() );
+}
+
+
+static void hashText( FILL_HASH& aHash, const TEXTE_PCB* aText )
+{
+    aHash.AddInt( aText->Type() );
+    aHash.AddLayers( aText );
+    aHash.AddText( aText->GetText() );
+    aHash.AddInt( aText->IsItalic() );
+    aHash.AddInt( aText->IsBold() );
+    aHash.AddInt( aText->IsMirrored() );
+    aHash.AddInt( aText->GetTextWidth() );
+    aHash.AddInt( aText->GetTextHeight() );
+    aHash.AddInt( aText->GetThickness() );
+    aHash.AddInt( aText->GetHorizJustify() );
+    aHash.AddInt( aText->GetVertJustify() );
+    aHash.AddPoint( aText->GetTextPos() );
+    aHash.AddDouble( aText->GetTextAngle() );
+}
+
+
+static void hashTrack( FILL_HASH& aHash, const TRACK* aTrack )
+{
+    aHash.AddInt( aTrack->Type() );
+    aHash.AddLayers( aTrack );
+    aHash.AddInt( aTrack->GetWidth() );
+    aHash.AddPoint( aTrack->GetStart() );
+    aHash.AddPoint( aTrack->GetEnd() );
+
+    if( aTrack->Type() == PCB_VIA_T )
+    {
+        const VIA* via = static_cast<const VIA*>( aTrack );
+
+        aHash.AddInt( via->GetViaType() );
+        aHash.AddInt( via->GetDrill() );
+    }
+}
+
+
+uint64_t ZONE_FILLER::computeFillHash( const ZONE_CONTAINER* aZone ) const
+{
+    FILL_HASH hash;
+
+    // The zone settings.  Net codes are renumbered when the board is saved, so the nets
+    // are identified by their names.
+    int biggest_clearance = m_board->GetDesignSettings().GetBiggestClearanceValue();
+
+    hash.AddText( aZone->GetLayerSet().FmtHex() );
+    hash.AddText( aZone->GetNetname() );
+    hash.AddInt( aZone->GetPriority() );
+    hash.AddInt( aZone->GetClearance() );
+    hash.AddInt( aZone->GetZoneClearance() );
+    hash.AddInt( aZone->GetMinThickness() );
+    hash.AddInt( aZone->GetFillMode() );
+    hash.AddInt( aZone->GetArcSegmentCount() );
+    hash.AddInt( aZone->GetPadConnection() );
+    hash.AddInt( aZone->GetThermalReliefGap() );
+    hash.AddInt( aZone->GetThermalReliefCopperBridge() );
+    hash.AddInt( aZone->GetCornerSmoothingType() );
+    hash.AddInt( aZone->GetCornerRadius() );
+    hash.AddInt( biggest_clearance );
+    hash.AddPolySet( *aZone->Outline() );
+
+    // Only the items which can be subtracted from the zone are hashed, using the same
+    // (conservative) range test as buildZoneFeatureHoleList()
+    int         outline_half_thickness = aZone->GetMinThickness() / 2;
+    EDA_RECT    zone_boundingbox = aZone->GetBoundingBox();
+
+    zone_boundingbox.Inflate( std::max( biggest_clearance, aZone->GetClearance() )
+                              + aZone->GetZoneClearance() + outline_half_thickness );
+
+    auto inRange = [&]( EDA_RECT aItemBoundingBox, int aMargin ) -> bool
+    {
+        aItemBoundingBox.Inflate( aMargin );
+        return aItemBoundingBox.Intersects( zone_boundingbox );
+    };
+
+    for( auto module : m_board->Modules() )
+    {
+        for( auto pad : module->Pads() )
+        {
+            int thermalGap = aZone->GetThermalReliefGap( pad );
+
+            if( !inRange( pad->GetBoundingBox(),
+                          std::max( pad->GetClearance(), thermalGap ) + outline_half_thickness ) )
+                continue;
+
+            hashPad( hash, pad );
+            hash.AddText( pad->GetNetname() );
+            hash.AddInt( pad->GetClearance() );
+            hash.AddPoint( wxPoint( pad->GetDrillSize() ) );
+            hash.AddInt( pad->GetAttribute() );
+            hash.AddInt( aZone->GetPadConnection( pad ) );
+            hash.AddInt( thermalGap );
+            hash.AddInt( aZone->GetThermalReliefCopperBridge( pad ) );
+            hash.AddDouble( pad->GetRoundRectRadiusRatio() );
+
+            if( pad->GetShape() == PAD_SHAPE_CUSTOM )
+            {
+                hash.AddInt( pad->GetCustomShapeInZoneOpt() );
+                hash.AddPolySet( pad->GetCustomShapeAsPolygon() );
+            }
+        }
+
+        for( auto item : module->GraphicalItems() )
+        {
+            if( item->Type() != PCB_MODULE_EDGE_T )
+                continue;
+
+            if( !item->IsOnLayer( aZone->GetLayer() ) && !item->IsOnLayer( Edge_Cuts ) )
+                continue;
+
+            if( inRange( item->GetBoundingBox(), 0 ) )
+                hashDrawSegment( hash, static_cast<const EDGE_MODULE*>( item ) );
+        }
+    }
+
+    for( auto track : m_board->Tracks() )
+    {
+        if( !track->IsOnLayer( aZone->GetLayer() ) )
+            continue;
+
+        if( !inRange( track->GetBoundingBox(), track->GetClearance() + outline_half_thickness ) )
+            continue;
+
+        hashTrack( hash, track );
+        hash.AddText( track->GetNetname() );
+        hash.AddInt( track->GetClearance() );
+    }
+
+    for( auto item : m_board->Drawings() )
+    {
+        if( item->GetLayer() != aZone->GetLayer() && item->GetLayer() != Edge_Cuts )
+            continue;
+
+        if( !inRange( item->GetBoundingBox(), 0 ) )
+            continue;
+
+        if( item->Type() == PCB_LINE_T )
+            hashDrawSegment( hash, static_cast<const DRAWSEGMENT*>( item ) );
+        else if( item->Type() == PCB_TEXT_T )
+            hashText( hash, static_cast<const TEXTE_PCB*>( item ) );
+    }
+
+    for( int ii = 0; ii < m_board->GetAreaCount(); ii++ )
+    {
+        ZONE_CONTAINER* zone = m_board->GetArea( ii );
+
+        if( zone == aZone || !aZone->CommonLayerExists( zone->GetLayerSet() ) )
+            continue;
+
+        if( !inRange( zone->GetBoundingBox(), zone->GetClearance() + outline_half_thickness ) )
+            continue;
+
+        hash.AddInt( zone->GetPriority() );
+        hash.AddInt( zone->GetIsKeepout() );
+        hash.AddInt( zone->GetDoNotAllowCopperPour() );
+        hash.AddText( zone->GetNetname() );
+        hash.AddInt( zone->GetClearance() );
+        hash.AddPolySet( *zone->Outline() );
+    }
+
+    return hash.GetHash();
+}
+
+
 void ZONE_FILLER::buildZoneFeatureHoleList( const ZONE_CONTAINER* aZone,
         SHAPE_POLY_SET& aFeatures ) const
 {
@@ -691,22 +975,35 @@ void ZONE_FILLER::computeRawFilledAreas( const ZONE_CONTAINER* aZone,
     if( s_DumpZonesWhenFilling )
         dumper->BeginGroup( "clipper-zone" );
 
-    SHAPE_POLY_SET solidAreas = aSmoothedOutline;
+    SHAPE_POLY_SET solidAreas;
+    SHAPE_POLY_SET holes;
+    std::vector<std::function<void()>> tasks;
 
-    solidAreas.Inflate( -outline_half_thickness, segsPerCircle );
-    solidAreas.Simplify( SHAPE_POLY_SET::PM_FAST );
+    // The zone outline and the holes are independent
+    tasks.push_back( [&]()
+    {
+        SHAPE_POLY_SET::BATCH outline( aSmoothedOutline );
 
-    SHAPE_POLY_SET holes;
+        outline.Inflate( -outline_half_thickness, segsPerCircle );
+        outline.Simplify( SHAPE_POLY_SET::PM_FAST );
+        outline.GetResult( solidAreas );
+    } );
 
-    if( s_DumpZonesWhenFilling )
-        dumper->Write( &solidAreas, "solid-areas" );
+    tasks.push_back( [&]()
+    {
+        buildZoneFeatureHoleList( aZone, holes );
+    } );
 
-    buildZoneFeatureHoleList( aZone, holes );
+    runTasks( tasks );
 
     if( s_DumpZonesWhenFilling )
+    {
+        dumper->Write( &solidAreas, "solid-areas" );
         dumper->Write( &holes, "feature-holes" );
+    }
 
-    holes.Simplify( SHAPE_POLY_SET::PM_FAST );
+    // The holes of large zones are merged on all the cores
+    holes.UnionMany( {}, SHAPE_POLY_SET::PM_FAST );
 
     if( s_DumpZonesWhenFilling )
         dumper->Write( &holes, "feature-holes-postsimplify" );
@@ -715,14 +1012,49 @@ void ZONE_FILLER::computeRawFilledAreas( const ZONE_CONTAINER* aZone,
     // be created later).
     // Use SHAPE_POLY_SET::PM_STRICTLY_SIMPLE to generate strictly simple polygons
     // needed by Gerber files and Fracture()
-    solidAreas.BooleanSubtract( holes, SHAPE_POLY_SET::PM_STRICTLY_SIMPLE );
+    // The outlines do not overlap after Simplify(), so each one is handled by its own task.
+    // The holes are converted to the Clipper format only once for all the tasks.
+    SHAPE_POLY_SET::BATCH holesBatch( holes );
+    std::vector<SHAPE_POLY_SET> parts( solidAreas.OutlineCount() );
+    std::vector<SHAPE_POLY_SET> fracturedParts( parts.size() );
+
+    tasks.clear();
+
+    for( unsigned ii = 0; ii < parts.size(); ii++ )
+    {
+        tasks.push_back( [&, ii]()
+        {
+            const SHAPE_POLY_SET::POLYGON& outline = solidAreas.CPolygon( ii );
+
+            parts[ii].AddOutline( outline[0] );
+
+            for( unsigned jj = 1; jj < outline.size(); jj++ )
+                parts[ii].AddHole( outline[jj] );
+
+            SHAPE_POLY_SET::BATCH part( parts[ii] );
+
+            part.BooleanSubtract( holesBatch, SHAPE_POLY_SET::PM_STRICTLY_SIMPLE );
+            part.GetResult( parts[ii] );
+
+            fracturedParts[ii] = parts[ii];
+            fracturedParts[ii].Fracture( SHAPE_POLY_SET::PM_FAST );
+        } );
+    }
+
+    runTasks( tasks );
+
+    SHAPE_POLY_SET areas_fractured;
+    solidAreas.RemoveAllContours();
+
+    for( unsigned ii = 0; ii < parts.size(); ii++ )
+    {
+        solidAreas.Append( parts[ii] );
+        areas_fractured.Append( fracturedParts[ii] );
+    }
 
     if( s_DumpZonesWhenFilling )
         dumper->Write( &solidAreas, "solid-areas-minus-holes" );
 
-    SHAPE_POLY_SET areas_fractured = solidAreas;
-    areas_fractured.Fracture( SHAPE_POLY_SET::PM_FAST );
-
     if( s_DumpZonesWhenFilling )
         dumper->Write( &areas_fractured, "areas_fractured" );
 
@@ -767,6 +1099,20 @@ void ZONE_FILLER::computeRawFilledAreas( const ZONE_CONTAINER* aZone,
         dumper->EndGroup();
 }
 
+void ZONE_FILLER::runTasks( std::vector<std::function<void()>>& aTasks ) const
+{
+    if( m_pool )
+    {
+        m_pool->Run( aTasks );
+    }
+    else
+    {
+        for( auto& task : aTasks )
+            task();
+    }
+}
+
+
 /* Build the filled solid areas data from real outlines (stored in m_Poly)
  * The solid areas can be more than one on copper layers, and do not have holes
  * ( holes are linked by overlapping segments to the main outline)
@@ -26,6 +26,7 @@
 #ifndef __ZONE_FILLER_H
 #define __ZONE_FILLER_H
 
+#include <functional>
 #include <vector>
 #include <class_zone.h>
 
@@ -34,6 +35,7 @@ class BOARD;
 class COMMIT;
 class SHAPE_POLY_SET;
 class SHAPE_LINE_CHAIN;
+class WORK_STEALING_POOL;
 
 class ZONE_FILLER
 {
@@ -42,11 +44,28 @@ public:
     ~ZONE_FILLER();
 
     void    SetProgressReporter( PROGRESS_REPORTER* aReporter );
-    void    Fill( std::vector<ZONE_CONTAINER*> aZones );
+    /**
+     * Function Fill
+     * Fills the zones, skipping the ones whose fill hash shows that nothing which can
+     * change their fill was modified since their last fill.
+     * @param aZones is the list of zones to fill.
+     * @param aForce refills all the zones, whatever their fill hash.
+     */
+    void    Fill( std::vector<ZONE_CONTAINER*> aZones, bool aForce = false );
     void    Unfill( std::vector<ZONE_CONTAINER*> aZones );
 
 private:
 
+    /**
+     * Function computeFillHash
+     * Hashes the zone settings and outline, and all the board items which can change
+     * its fill.  A zone which is filled and whose hash did not change since its last
+     * fill does not need to be refilled.
+     * The hash is saved in the board file, so it is computed with a fixed algorithm
+     * which gives the same result with all platforms and compilers.
+     */
+    uint64_t computeFillHash( const ZONE_CONTAINER* aZone ) const;
+
     void buildZoneFeatureHoleList( const ZONE_CONTAINER* aZone,
             SHAPE_POLY_SET& aFeatures ) const;
 
@@ -67,6 +86,12 @@ private:
             SHAPE_POLY_SET& aRawPolys,
             SHAPE_POLY_SET& aFinalPolys ) const;
 
+    /**
+     * Runs a set of subtasks of a zone fill on the workers, or in the calling thread if
+     * there are no workers.
+     */
+    void runTasks( std::vector<std::function<void()>>& aTasks ) const;
+
     bool fillPolygonWithHorizontalSegments( const SHAPE_LINE_CHAIN& aPolygon,
             ZONE_SEGMENT_FILL& aFillSegmList, int aStep ) const;
 
@@ -120,10 +145,8 @@ private:
     COMMIT* m_commit;
     PROGRESS_REPORTER* m_progressReporter;
 
-    std::atomic_size_t m_next;          // An index into the vector of zones to fill.
-                                        // Used by the variuos parallel thread sets during
-                                        // fill operations.
-    std::atomic_size_t m_count_done;
+    WORK_STEALING_POOL* m_pool;         // The workers of the current Fill() call, which
+                                        // also run the subtasks of each zone fill
 };
 
 #endif
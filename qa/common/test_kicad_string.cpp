@@ -0,0 +1,217 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <kicad_string.h>
+
+#include <clocale>
+#include <cmath>
+#include <cstring>
+#include <string>
+
+
+/**
+ * Switches the global locale to one with a decimal comma, when the system has one, and
+ * restores the C locale at the end of each test.
+ */
+struct COMMA_LOCALE_FIXTURE
+{
+    COMMA_LOCALE_FIXTURE() :
+        m_commaLocale( false )
+    {
+        const char* names[] = { "de_DE.UTF-8", "de_DE.utf8", "de_DE", "fr_FR.UTF-8", "fr_FR",
+                                "German", "French" };
+
+        for( const char* name : names )
+        {
+            if( setlocale( LC_NUMERIC, name ) && localeconv()->decimal_point[0] == ',' )
+            {
+                m_commaLocale = true;
+                break;
+            }
+        }
+
+        if( !m_commaLocale )
+        {
+            setlocale( LC_NUMERIC, "C" );
+            BOOST_TEST_MESSAGE( "No locale with a decimal comma, testing in the C locale" );
+        }
+    }
+
+    ~COMMA_LOCALE_FIXTURE()
+    {
+        setlocale( LC_NUMERIC, "C" );
+    }
+
+    bool m_commaLocale;
+};
+
+
+static std::string formatDouble( const char* aFormat, double aValue )
+{
+    char buf[64];
+    int  len = FormatDouble( buf, sizeof( buf ), aFormat, aValue );
+
+    BOOST_REQUIRE( len >= 0 && len < (int) sizeof( buf ) );
+    BOOST_CHECK_EQUAL( len, (int) strlen( buf ) );
+
+    return std::string( buf, len );
+}
+
+
+BOOST_FIXTURE_TEST_SUITE( KicadString, COMMA_LOCALE_FIXTURE )
+
+/**
+ * Checks that FormatDouble() writes a '.' whatever the global locale.
+ */
+BOOST_AUTO_TEST_CASE( FormatDoubleLocale )
+{
+    BOOST_CHECK_EQUAL( formatDouble( "%f", 1.5 ), "1.500000" );
+    BOOST_CHECK_EQUAL( formatDouble( "%.10f", -0.0001 ), "-0.0001000000" );
+    BOOST_CHECK_EQUAL( formatDouble( "%.10g", 25.4 ), "25.4" );
+    BOOST_CHECK_EQUAL( formatDouble( "%g", 90.0 ), "90" );
+    BOOST_CHECK_EQUAL( formatDouble( "%g", 1.5e-7 ), "1.5e-07" );
+    BOOST_CHECK_EQUAL( formatDouble( "%.16g", 1.0 / 3.0 ), "0.3333333333333333" );
+
+    // The global locale is left as it was
+    if( m_commaLocale )
+    {
+        char buf[16];
+
+        snprintf( buf, sizeof( buf ), "%.1f", 1.5 );
+        BOOST_CHECK_EQUAL( std::string( buf ), "1,5" );
+    }
+}
+
+
+/**
+ * Checks that FormatDouble() returns the length of the whole text when it is truncated,
+ * as snprintf() does, and still terminates the buffer.
+ */
+BOOST_AUTO_TEST_CASE( FormatDoubleTruncated )
+{
+    char buf[5];
+
+    memset( buf, 'x', sizeof( buf ) );
+
+    BOOST_CHECK_EQUAL( FormatDouble( buf, sizeof( buf ), "%.3f", 123.25 ), 7 );
+    BOOST_CHECK( memchr( buf, 0, sizeof( buf ) ) != nullptr );
+}
+
+
+/**
+ * Checks ParseDouble() on the C locale format, whatever the global locale.
+ */
+BOOST_AUTO_TEST_CASE( ParseDoubleLocale )
+{
+    struct CASE
+    {
+        const char* m_text;
+        double      m_value;
+        size_t      m_length;
+    };
+
+    const CASE cases[] = {
+        { "1.5",        1.5,     3 },
+        { "-0.25",      -0.25,   5 },
+        { "+12",        12.0,    3 },
+        { ".5",         0.5,     2 },
+        { "5.",         5.0,     2 },
+        { "1e3",        1000.0,  3 },
+        { "2.5E-2",     0.025,   6 },
+        { "1e",         1.0,     1 },     // an exponent without digits is not read
+        { "1,5",        1.0,     1 },     // the comma is never a decimal point
+        { "3.14)",      3.14,    4 },
+    };
+
+    for( const CASE& c : cases )
+    {
+        double      value = -1.0;
+        const char* end = ParseDouble( c.m_text, c.m_text + strlen( c.m_text ), value );
+
+        BOOST_CHECK_EQUAL( value, c.m_value );
+        BOOST_CHECK_EQUAL( (size_t) ( end - c.m_text ), c.m_length );
+    }
+
+    // Not a number: nothing is read
+    const char* text = "abc";
+    double      value = -1.0;
+
+    BOOST_CHECK( ParseDouble( text, text + 3, value ) == text );
+    BOOST_CHECK_EQUAL( value, 0.0 );
+
+    // The end of the text is honoured even without a terminating nul
+    text = "12345";
+    BOOST_CHECK( ParseDouble( text, text + 2, value ) == text + 2 );
+    BOOST_CHECK_EQUAL( value, 12.0 );
+}
+
+
+/**
+ * Checks that the numbers written by FormatDouble() read back exactly with ParseDouble().
+ */
+BOOST_AUTO_TEST_CASE( RoundTrip )
+{
+    const double values[] = { 0.0, 1.0, -1.0, 0.1, 1.0 / 3.0, 25.4, 1e-7, 123456.789,
+                              -9.87654321e12, 2.5e-300, 1.7976931348623157e308 };
+
+    for( double value : values )
+    {
+        std::string text = formatDouble( "%.17g", value );
+        double      parsed;
+
+        ParseDouble( text.c_str(), text.c_str() + text.size(), parsed );
+        BOOST_CHECK_EQUAL( parsed, value );
+    }
+}
+
+
+/**
+ * Checks ParseDoubleToken(), which reads the numbers of the legacy schematic and symbol
+ * library files: the whitespace around the number is skipped.
+ */
+BOOST_AUTO_TEST_CASE( ParseDoubleTokens )
+{
+    double      value;
+    const char* line = "  1.25   2,5 next";
+    const char* next = ParseDoubleToken( line, value );
+
+    BOOST_CHECK_EQUAL( value, 1.25 );
+    BOOST_CHECK_EQUAL( std::string( next ), "2,5 next" );
+
+    next = ParseDoubleToken( next, value );
+    BOOST_CHECK_EQUAL( value, 2.0 );
+    BOOST_CHECK_EQUAL( std::string( next ), ",5 next" );
+
+    // The last number of a line
+    next = ParseDoubleToken( "\t-0.5\r\n", value );
+    BOOST_CHECK_EQUAL( value, -0.5 );
+    BOOST_CHECK_EQUAL( *next, 0 );
+
+    // A large scale is read as infinity, which the parser rejects
+    ParseDoubleToken( "1e400", value );
+    BOOST_CHECK( !std::isfinite( value ) );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,143 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * Segment batch benchmark: tests random segments against a set of segments one pair at a
+ * time with SEG, then with SEG_BATCH, and checks that both give the same results.
+ *
+ * Usage: seg_batch_bench [segment count] [query count]
+ */
+
+#include <geometry/seg.h>
+#include <geometry/seg_batch.h>
+#include <profile.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+
+static void report( const char* aName, const PROF_COUNTER& aTimer, long long aPairs )
+{
+    double msecs = aTimer.msecs();
+    double mPairsPerSec = msecs > 0.0 ? aPairs / ( msecs * 1000.0 ) : 0.0;
+
+    printf( "%-28s %10.1f ms %10.1f Mpairs/s\n", aName, msecs, mPairsPerSec );
+}
+
+
+int main( int argc, char *argv[] )
+{
+    int segCount = argc > 1 ? std::max( atoi( argv[1] ), 1 ) : 2000;
+    int queryCount = argc > 2 ? std::max( atoi( argv[2] ), 1 ) : 2000;
+
+    std::mt19937                       rng( 1 );
+    std::uniform_int_distribution<int> coord( -1000000, 1000000 );
+    std::uniform_int_distribution<int> length( -50000, 50000 );
+    std::vector<SEG>                   segs;
+    std::vector<SEG>                   queries;
+    SEG_BATCH                          batch;
+
+    for( int i = 0; i < segCount + queryCount; i++ )
+    {
+        VECTOR2I a( coord( rng ), coord( rng ) );
+        SEG      seg( a, a + VECTOR2I( length( rng ), length( rng ) ) );
+
+        if( i < segCount )
+        {
+            segs.push_back( seg );
+            batch.Add( seg );
+        }
+        else
+        {
+            queries.push_back( seg );
+        }
+    }
+
+    const int   clearance = 20000;
+    long long   pairs = (long long) segCount * queryCount;
+    int         hits = 0, batchHits = 0;
+    long long   dist = 0, batchDist = 0;
+
+    PROF_COUNTER pairCollide( "pair collide" );
+
+    for( const SEG& q : queries )
+    {
+        for( const SEG& s : segs )
+        {
+            if( s.Collide( q, clearance ) )
+                hits++;
+        }
+    }
+
+    pairCollide.Stop();
+
+    PROF_COUNTER batchCollide( "batch collide" );
+    std::vector<uint8_t> mask;
+
+    for( const SEG& q : queries )
+    {
+        batch.Collide( q, clearance, &mask );
+        batchHits += std::count( mask.begin(), mask.end(), 1 );
+    }
+
+    batchCollide.Stop();
+
+    PROF_COUNTER pairDistance( "pair distance" );
+
+    for( const SEG& q : queries )
+    {
+        SEG_BATCH::ecoord best = VECTOR2I::ECOORD_MAX;
+
+        for( const SEG& s : segs )
+            best = std::min( best, s.SquaredDistance( q ) );
+
+        dist += best;
+    }
+
+    pairDistance.Stop();
+
+    PROF_COUNTER batchDistance( "batch distance" );
+
+    for( const SEG& q : queries )
+        batchDist += batch.SquaredDistance( q );
+
+    batchDistance.Stop();
+
+    printf( "%d segments, %d queries, %s kernel\n", segCount, queryCount,
+            SEG_BATCH::KernelName() );
+    report( "SEG::Collide", pairCollide, pairs );
+    report( "SEG_BATCH::Collide", batchCollide, pairs );
+    report( "SEG::SquaredDistance", pairDistance, pairs );
+    report( "SEG_BATCH::SquaredDistance", batchDistance, pairs );
+
+    if( hits != batchHits || dist != batchDist )
+    {
+        printf( "results differ: %d/%d collisions, %lld/%lld distances\n", hits, batchHits,
+                dist, batchDist );
+        return -1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,78 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <math/box2.h>
+
+
+BOOST_AUTO_TEST_SUITE( Box2 )
+
+/**
+ * Checks the distance from a box to the points around it, on every side.
+ */
+BOOST_AUTO_TEST_CASE( PointSquaredDistance )
+{
+    BOX2I box( VECTOR2I( 100, 200 ), VECTOR2I( 1000, 500 ) );
+
+    // Inside and on the edges
+    BOOST_CHECK_EQUAL( box.SquaredDistance( VECTOR2I( 500, 400 ) ), 0 );
+    BOOST_CHECK_EQUAL( box.SquaredDistance( VECTOR2I( 100, 200 ) ), 0 );
+    BOOST_CHECK_EQUAL( box.SquaredDistance( VECTOR2I( 1100, 700 ) ), 0 );
+
+    // Left, right, above and below
+    BOOST_CHECK_EQUAL( box.SquaredDistance( VECTOR2I( 90, 400 ) ), 100 );
+    BOOST_CHECK_EQUAL( box.SquaredDistance( VECTOR2I( 1120, 400 ) ), 400 );
+    BOOST_CHECK_EQUAL( box.SquaredDistance( VECTOR2I( 500, 170 ) ), 900 );
+    BOOST_CHECK_EQUAL( box.SquaredDistance( VECTOR2I( 500, 740 ) ), 1600 );
+
+    // Past the corners
+    BOOST_CHECK_EQUAL( box.SquaredDistance( VECTOR2I( 97, 196 ) ), 25 );
+    BOOST_CHECK_EQUAL( box.SquaredDistance( VECTOR2I( 1103, 704 ) ), 25 );
+    BOOST_CHECK_EQUAL( box.SquaredDistance( VECTOR2I( 97, 704 ) ), 25 );
+    BOOST_CHECK_EQUAL( box.SquaredDistance( VECTOR2I( 1103, 196 ) ), 25 );
+
+    BOOST_CHECK_EQUAL( box.Distance( VECTOR2I( 1103, 704 ) ), 5 );
+}
+
+
+/**
+ * Checks that the distance to a point is the distance to a box of zero size at that point.
+ */
+BOOST_AUTO_TEST_CASE( PointMatchesBox )
+{
+    BOX2I box( VECTOR2I( -300, -300 ), VECTOR2I( 600, 400 ) );
+
+    for( int x = -500; x <= 500; x += 50 )
+    {
+        for( int y = -500; y <= 500; y += 50 )
+        {
+            VECTOR2I p( x, y );
+
+            BOOST_CHECK_EQUAL( box.SquaredDistance( p ),
+                               box.SquaredDistance( BOX2I( p, VECTOR2I( 0, 0 ) ) ) );
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
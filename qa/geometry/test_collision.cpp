@@ -26,6 +26,7 @@
 #include <boost/test/test_case_template.hpp>
 #include <geometry/shape_poly_set.h>
 #include <geometry/shape_line_chain.h>
+#include <cmath>
 
 #include <qa/data/fixtures_geometry.h>
 
@@ -147,4 +148,102 @@ BOOST_AUTO_TEST_CASE( CollideVertexWithClearance )
     }
 }
 
+/**
+ * This test checks that the queries answered by the grid indices of a large polygon match
+ * the linear tests, done on fresh copies of the set which have no index yet.
+ */
+BOOST_AUTO_TEST_CASE( IndexedQueries )
+{
+    SHAPE_POLY_SET polySet;
+
+    // A 400 sided polygon, with a ring of square holes
+    polySet.NewOutline();
+
+    for( int i = 0; i < 400; i++ )
+    {
+        double angle = 2.0 * M_PI * i / 400;
+        polySet.Append( int( 100000 * cos( angle ) ), int( 100000 * sin( angle ) ) );
+    }
+
+    for( int i = 0; i < 12; i++ )
+    {
+        double   angle = 2.0 * M_PI * i / 12;
+        VECTOR2I center( int( 60000 * cos( angle ) ), int( 60000 * sin( angle ) ) );
+
+        int hole = polySet.NewHole();
+
+        polySet.Append( center + VECTOR2I( -5000, -5000 ), -1, hole );
+        polySet.Append( center + VECTOR2I( 5000, -5000 ), -1, hole );
+        polySet.Append( center + VECTOR2I( 5000, 5000 ), -1, hole );
+        polySet.Append( center + VECTOR2I( -5000, 5000 ), -1, hole );
+    }
+
+    std::vector<VECTOR2I> points;
+
+    for( int x = -110000; x <= 110000; x += 5000 )
+    {
+        for( int y = -110000; y <= 110000; y += 5000 )
+            points.push_back( VECTOR2I( x, y ) );
+    }
+
+    // Add points far away from the polygon, on all sides
+    for( int i = 0; i < 16; i++ )
+    {
+        double angle = 2.0 * M_PI * i / 16;
+
+        points.push_back( VECTOR2I( int( 3000000 * cos( angle ) ), int( 3000000 * sin( angle ) ) ) );
+        points.push_back( VECTOR2I( int( 250000 * cos( angle ) ), int( 250000 * sin( angle ) ) ) );
+    }
+
+    points.push_back( VECTOR2I( 50000000, 0 ) );
+    points.push_back( VECTOR2I( -40000000, 30000000 ) );
+
+    // Add the vertices and the points next to them
+    for( auto it = polySet.CIterateWithHoles(); it; it++ )
+    {
+        points.push_back( *it );
+        points.push_back( *it + VECTOR2I( 1, 1 ) );
+    }
+
+    for( const VECTOR2I& point : points )
+    {
+        SEG seg( point, point + VECTOR2I( 7000, 3000 ) );
+
+        BOOST_CHECK_EQUAL( polySet.Contains( point ), SHAPE_POLY_SET( polySet ).Contains( point ) );
+        BOOST_CHECK_EQUAL( polySet.PointOnEdge( point ), SHAPE_POLY_SET( polySet ).PointOnEdge( point ) );
+        BOOST_CHECK_EQUAL( polySet.Distance( point ), SHAPE_POLY_SET( polySet ).Distance( point ) );
+        BOOST_CHECK_EQUAL( polySet.Distance( seg ), SHAPE_POLY_SET( polySet ).Distance( seg ) );
+
+        for( int clearance : { 0, 1000, 200000 } )
+        {
+            BOOST_CHECK_EQUAL( polySet.Collide( seg, clearance ),
+                               SHAPE_POLY_SET( polySet ).Collide( seg, clearance ) );
+        }
+    }
+
+    // Long segments passing far from the polygon, or crossing it from far away
+    std::vector<SEG> segs = { SEG( VECTOR2I( -5000000, 4000000 ), VECTOR2I( 5000000, 4000000 ) ),
+                              SEG( VECTOR2I( 3000000, -3000000 ), VECTOR2I( 3000000, 3000000 ) ),
+                              SEG( VECTOR2I( -5000000, 0 ), VECTOR2I( 5000000, 1000 ) ),
+                              SEG( VECTOR2I( -5000000, -5000000 ), VECTOR2I( 5000000, 5000000 ) ),
+                              SEG( VECTOR2I( 150000, -5000000 ), VECTOR2I( 150000, 5000000 ) ) };
+
+    for( const SEG& seg : segs )
+    {
+        BOOST_CHECK_EQUAL( polySet.Distance( seg ), SHAPE_POLY_SET( polySet ).Distance( seg ) );
+        BOOST_CHECK_EQUAL( polySet.Distance( seg.A ), SHAPE_POLY_SET( polySet ).Distance( seg.A ) );
+
+        for( int clearance : { 0, 49000, 51000, 3000000 } )
+        {
+            BOOST_CHECK_EQUAL( polySet.Collide( seg, clearance ),
+                               SHAPE_POLY_SET( polySet ).Collide( seg, clearance ) );
+        }
+    }
+
+    // The index must follow the changes of the set
+    polySet.Move( VECTOR2I( 500000, 0 ) );
+    BOOST_CHECK( !polySet.Contains( VECTOR2I( 0, 0 ) ) );
+    BOOST_CHECK( polySet.Contains( VECTOR2I( 500000, 0 ) ) );
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,203 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <geometry/polygon_triangulation.h>
+#include <geometry/shape_poly_set.h>
+#include <geometry/shape_line_chain.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+
+static SHAPE_LINE_CHAIN makeChain( const std::vector<VECTOR2I>& aPoints )
+{
+    SHAPE_LINE_CHAIN chain;
+
+    for( const VECTOR2I& pt : aPoints )
+        chain.Append( pt );
+
+    chain.SetClosed( true );
+
+    return chain;
+}
+
+
+static SHAPE_LINE_CHAIN makeCircle( const VECTOR2I& aCenter, int aRadius, int aCount )
+{
+    SHAPE_LINE_CHAIN chain;
+
+    for( int i = 0; i < aCount; i++ )
+    {
+        double angle = 2.0 * M_PI * i / aCount;
+
+        chain.Append( aCenter.x + KiROUND( aRadius * cos( angle ) ),
+                      aCenter.y + KiROUND( aRadius * sin( angle ) ) );
+    }
+
+    chain.SetClosed( true );
+
+    return chain;
+}
+
+
+/**
+ * Area of a closed chain by the shoelace formula, computed here rather than with
+ * SHAPE_LINE_CHAIN::Area(), which the triangulation uses itself.
+ */
+static double chainArea( const SHAPE_LINE_CHAIN& aChain )
+{
+    double area = 0.0;
+    int    count = aChain.PointCount();
+
+    for( int i = 0; i < count; i++ )
+    {
+        const VECTOR2I& a = aChain.CPoint( i );
+        const VECTOR2I& b = aChain.CPoint( ( i + 1 ) % count );
+
+        area += (double) a.x * b.y - (double) b.x * a.y;
+    }
+
+    return std::abs( area ) / 2.0;
+}
+
+
+/**
+ * Triangulates aPoly and checks that the triangulation is accepted, with no fallback to
+ * poly2tri, and that the triangles cover the outline minus the holes.
+ */
+static void checkTriangulation( const SHAPE_POLY_SET::POLYGON& aPoly )
+{
+    SHAPE_POLY_SET::TRIANGULATED_POLYGON result;
+    POLYGON_TRIANGULATION                tess( result );
+
+    BOOST_CHECK( tess.TesselatePolygon( aPoly ) );
+
+    double polygonArea = chainArea( aPoly[0] );
+
+    for( size_t i = 1; i < aPoly.size(); i++ )
+        polygonArea -= chainArea( aPoly[i] );
+
+    double trianglesArea = 0.0;
+
+    for( int i = 0; i < result.GetTriangleCount(); i++ )
+    {
+        VECTOR2I a, b, c;
+
+        result.GetTriangle( i, a, b, c );
+
+        VECTOR2<double> ab( b.x - a.x, b.y - a.y );
+        VECTOR2<double> ac( c.x - a.x, c.y - a.y );
+
+        trianglesArea += std::abs( ab.x * ac.y - ab.y * ac.x ) / 2.0;
+    }
+
+    BOOST_CHECK_CLOSE( trianglesArea + 1.0, polygonArea + 1.0, 1e-9 );
+}
+
+
+BOOST_AUTO_TEST_SUITE( PolygonTriangulation )
+
+/**
+ * Checks a convex and a concave outline, in both orientations.
+ */
+BOOST_AUTO_TEST_CASE( SimpleOutlines )
+{
+    std::vector<VECTOR2I> square = { { 0, 0 }, { 1000, 0 }, { 1000, 1000 }, { 0, 1000 } };
+    std::vector<VECTOR2I> comb = { { 0, 0 }, { 5000, 0 }, { 5000, 3000 }, { 4000, 3000 },
+                                   { 4000, 1000 }, { 3000, 1000 }, { 3000, 3000 },
+                                   { 2000, 3000 }, { 2000, 1000 }, { 1000, 1000 },
+                                   { 1000, 3000 }, { 0, 3000 } };
+
+    for( std::vector<VECTOR2I> points : { square, comb } )
+    {
+        checkTriangulation( { makeChain( points ) } );
+
+        std::reverse( points.begin(), points.end() );
+        checkTriangulation( { makeChain( points ) } );
+    }
+
+    // Enough vertices to link them in Z-order
+    checkTriangulation( { makeCircle( { 123, -456 }, 1000000, 500 ) } );
+}
+
+
+/**
+ * Checks outlines with holes, given as separate contours and fractured into a single
+ * outline with bridges.
+ */
+BOOST_AUTO_TEST_CASE( Holes )
+{
+    SHAPE_POLY_SET polySet;
+
+    polySet.AddOutline( makeChain( { { 0, 0 }, { 10000, 0 }, { 10000, 10000 },
+                                     { 0, 10000 } } ) );
+    polySet.AddHole( makeChain( { { 1000, 1000 }, { 1000, 3000 }, { 3000, 3000 },
+                                  { 3000, 1000 } } ) );
+    polySet.AddHole( makeCircle( { 6000, 6000 }, 2000, 100 ) );
+    // A hole touching the outline at one vertex
+    polySet.AddHole( makeChain( { { 10000, 5000 }, { 8500, 4000 }, { 8500, 6000 } } ) );
+
+    checkTriangulation( polySet.CPolygon( 0 ) );
+
+    polySet.Fracture( SHAPE_POLY_SET::PM_STRICTLY_SIMPLE );
+
+    BOOST_REQUIRE_EQUAL( polySet.OutlineCount(), 1 );
+    BOOST_REQUIRE_EQUAL( polySet.HoleCount( 0 ), 0 );
+
+    checkTriangulation( polySet.CPolygon( 0 ) );
+}
+
+
+/**
+ * Checks collinear and duplicated vertices, and outlines with no area at all.
+ */
+BOOST_AUTO_TEST_CASE( Degenerate )
+{
+    // Collinear vertices along every edge
+    checkTriangulation( { makeChain( { { 0, 0 }, { 500, 0 }, { 1000, 0 }, { 1000, 500 },
+                                       { 1000, 1000 }, { 500, 1000 }, { 0, 1000 },
+                                       { 0, 500 } } ) } );
+
+    // Duplicated vertices, including the closing one
+    checkTriangulation( { makeChain( { { 0, 0 }, { 0, 0 }, { 1000, 0 }, { 1000, 1000 },
+                                       { 1000, 1000 }, { 0, 1000 }, { 0, 0 } } ) } );
+
+    // A spike going back on itself
+    checkTriangulation( { makeChain( { { 0, 0 }, { 1000, 0 }, { 1000, 1000 }, { 500, 1000 },
+                                       { 500, 2000 }, { 500, 1000 }, { 0, 1000 } } ) } );
+
+    // No area: all the vertices on a line, or all at the same place
+    checkTriangulation( { makeChain( { { 0, 0 }, { 500, 500 }, { 1000, 1000 } } ) } );
+    checkTriangulation( { makeChain( { { 10, 10 }, { 10, 10 }, { 10, 10 } } ) } );
+
+    // A hole sharing an edge with the outline
+    checkTriangulation( { makeChain( { { 0, 0 }, { 2000, 0 }, { 2000, 2000 },
+                                       { 0, 2000 } } ),
+                          makeChain( { { 0, 500 }, { 0, 1500 }, { 1000, 1500 },
+                                       { 1000, 500 } } ) } );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -25,6 +25,9 @@
 #include <boost/test/unit_test.hpp>
 #include <boost/test/test_case_template.hpp>
 #include <geometry/seg.h>
+#include <geometry/seg_batch.h>
+
+#include <random>
 
 #include <qa/data/fixtures_geometry.h>
 
@@ -61,3 +64,113 @@ BOOST_AUTO_TEST_CASE( SegmentReference )
 }
 
 BOOST_AUTO_TEST_SUITE_END()
+
+
+BOOST_AUTO_TEST_SUITE( SegmentCloserThan )
+
+/**
+ * Checks that a nearly vertical or horizontal segment is not taken for a diagonal one.
+ */
+BOOST_AUTO_TEST_CASE( NearlyVertical )
+{
+    SEG vertical( VECTOR2I( 0, 0 ), VECTOR2I( 1, 1000 ) );
+
+    BOOST_CHECK( !vertical.PointCloserThan( VECTOR2I( 500, 500 ), 10 ) );
+    BOOST_CHECK( vertical.PointCloserThan( VECTOR2I( 5, 500 ), 10 ) );
+    BOOST_CHECK( !vertical.Collide( SEG( VECTOR2I( 500, 500 ), VECTOR2I( 500, 600 ) ), 10 ) );
+
+    SEG horizontal( VECTOR2I( 0, 0 ), VECTOR2I( 1000, -1 ) );
+
+    BOOST_CHECK( !horizontal.PointCloserThan( VECTOR2I( 500, -500 ), 10 ) );
+    BOOST_CHECK( horizontal.PointCloserThan( VECTOR2I( 500, 5 ), 10 ) );
+}
+
+
+/**
+ * Checks the diagonal, vertical and horizontal lines far from the origin, where the line
+ * coefficient does not fit in an int.
+ */
+BOOST_AUTO_TEST_CASE( LargeCoordinates )
+{
+    const int c = 1500000000;
+
+    SEG diagonal( VECTOR2I( c, c ), VECTOR2I( c + 1000, c - 1000 ) );
+
+    BOOST_CHECK( diagonal.PointCloserThan( VECTOR2I( c + 500, c - 500 ), 10 ) );
+    BOOST_CHECK( diagonal.PointCloserThan( VECTOR2I( c + 505, c - 495 ), 10 ) );
+    BOOST_CHECK( !diagonal.PointCloserThan( VECTOR2I( c + 520, c - 480 ), 10 ) );
+
+    SEG vertical( VECTOR2I( -c, c ), VECTOR2I( -c, c - 1000 ) );
+
+    BOOST_CHECK( vertical.PointCloserThan( VECTOR2I( -c + 5, c - 500 ), 10 ) );
+    BOOST_CHECK( !vertical.PointCloserThan( VECTOR2I( -c + 20, c - 500 ), 10 ) );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+
+BOOST_AUTO_TEST_SUITE( SegmentBatch )
+
+/**
+ * Checks that the batched tests give the results of the per-pair ones.
+ */
+BOOST_AUTO_TEST_CASE( BatchMatchesPairs )
+{
+    std::mt19937                       rng( 1 );
+    std::uniform_int_distribution<int> coord( -20000, 20000 );
+    std::uniform_int_distribution<int> length( -3000, 3000 );
+    std::uniform_int_distribution<int> shape( 0, 3 );
+    SEG_BATCH                          batch;
+
+    auto randomSeg = [&]()
+    {
+        VECTOR2I a( coord( rng ), coord( rng ) );
+        VECTOR2I d( length( rng ), length( rng ) );
+
+        // Include axis aligned, nearly vertical and zero length segments
+        switch( shape( rng ) )
+        {
+        case 0: d.x = 0; break;
+        case 1: d.x = 1; break;
+        case 2: d = ( rng() % 8 ) ? d : VECTOR2I( 0, 0 ); break;
+        default: break;
+        }
+
+        return SEG( a, a + d );
+    };
+
+    for( int i = 0; i < 301; i++ )
+        batch.Add( randomSeg() );
+
+    for( int n = 0; n < 500; n++ )
+    {
+        SEG                  query = randomSeg();
+        int                  clearance = n % 5 ? n * 3 : 0;
+        std::vector<uint8_t> mask;
+        bool                 any = false;
+        SEG_BATCH::ecoord    best = VECTOR2I::ECOORD_MAX;
+        SEG_BATCH::ecoord    bestPt = VECTOR2I::ECOORD_MAX;
+
+        bool collide = batch.Collide( query, clearance, &mask );
+
+        for( int i = 0; i < batch.Size(); i++ )
+        {
+            bool hit = batch.Segment( i ).Collide( query, clearance );
+
+            BOOST_CHECK_EQUAL( mask[i], hit ? 1 : 0 );
+            any |= hit;
+            best = std::min( best, batch.Segment( i ).SquaredDistance( query ) );
+            bestPt = std::min( bestPt, batch.Segment( i ).SquaredDistance( query.A ) );
+        }
+
+        int index = -1;
+
+        BOOST_CHECK_EQUAL( collide, any );
+        BOOST_CHECK_EQUAL( batch.Collide( query, clearance ), any );
+        BOOST_CHECK_EQUAL( batch.SquaredDistance( query, &index ), best );
+        BOOST_CHECK_EQUAL( batch.Segment( index ).SquaredDistance( query ), best );
+        BOOST_CHECK_EQUAL( batch.SquaredDistance( query.A ), bestPt );
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
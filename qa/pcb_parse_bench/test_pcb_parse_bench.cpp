@@ -0,0 +1,168 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * Parse throughput benchmark: reads a board with the line readers alone, through the
+ * lexer, and with the complete parser.
+ *
+ * Usage: test_pcb_parse_bench board_file.kicad_pcb [iterations]
+ */
+
+#include <richio.h>
+#include <dsnlexer.h>
+#include <kicad_string.h>
+
+#include <io_mgr.h>
+#include <kicad_plugin.h>
+
+#include <class_board.h>
+#include <profile.h>
+
+#include <memory>
+
+
+static void report( const char* aName, const PROF_COUNTER& aTimer, size_t aBytes, int aIterations )
+{
+    double msecs = aTimer.msecs() / aIterations;
+    double mbPerSec = msecs > 0.0 ? aBytes / ( msecs * 1000.0 ) : 0.0;
+
+    printf( "%-24s %10.1f ms %10.1f MB/s\n", aName, msecs, mbPerSec );
+}
+
+
+static size_t readLines( LINE_READER& aReader )
+{
+    size_t bytes = 0;
+
+    while( aReader.ReadLine() )
+        bytes += aReader.Length();
+
+    return bytes;
+}
+
+
+static int lexTokens( LINE_READER* aReader, double& aSum )
+{
+    DSNLEXER lexer( NULL, 0, aReader );
+    int      count = 0;
+    int      tok;
+
+    while( ( tok = lexer.NextTok() ) != DSN_EOF )
+    {
+        if( tok == DSN_NUMBER )
+        {
+            const std::string& text = lexer.CurStr();
+            double value;
+
+            ParseDouble( text.c_str(), text.c_str() + text.size(), value );
+            aSum += value;
+        }
+
+        count++;
+    }
+
+    return count;
+}
+
+
+int main( int argc, char *argv[] )
+{
+    if( argc < 2 )
+    {
+        printf( "usage: %s board_file.kicad_pcb [iterations]\n", argv[0] );
+        return -1;
+    }
+
+    wxString filename = wxString::FromUTF8( argv[1] );
+    int      iterations = argc > 2 ? std::max( atoi( argv[2] ), 1 ) : 5;
+    size_t   bytes = 0;
+    int      tokens = 0;
+    double   sum = 0.0;
+
+    try
+    {
+        PROF_COUNTER fileRead( "file read" );
+
+        for( int i = 0; i < iterations; i++ )
+        {
+            FILE_LINE_READER reader( filename );
+            bytes = readLines( reader );
+        }
+
+        fileRead.Stop();
+
+        PROF_COUNTER mmapRead( "mmap read" );
+
+        for( int i = 0; i < iterations; i++ )
+        {
+            MMAP_LINE_READER reader( filename );
+            readLines( reader );
+        }
+
+        mmapRead.Stop();
+
+        PROF_COUNTER fileLex( "file lex" );
+
+        for( int i = 0; i < iterations; i++ )
+        {
+            FILE_LINE_READER reader( filename );
+            tokens = lexTokens( &reader, sum );
+        }
+
+        fileLex.Stop();
+
+        PROF_COUNTER mmapLex( "mmap lex" );
+
+        for( int i = 0; i < iterations; i++ )
+        {
+            MMAP_LINE_READER reader( filename );
+            lexTokens( &reader, sum );
+        }
+
+        mmapLex.Stop();
+
+        PROF_COUNTER load( "load" );
+
+        for( int i = 0; i < iterations; i++ )
+        {
+            PLUGIN::RELEASER pi( new PCB_IO );
+            std::unique_ptr<BOARD> brd( pi->Load( filename, NULL, NULL ) );
+        }
+
+        load.Stop();
+
+        printf( "%s: %zu bytes, %d tokens, %d iterations\n", argv[1], bytes, tokens, iterations );
+        report( "FILE_LINE_READER", fileRead, bytes, iterations );
+        report( "MMAP_LINE_READER", mmapRead, bytes, iterations );
+        report( "DSNLEXER (file)", fileLex, bytes, iterations );
+        report( "DSNLEXER (mmap)", mmapLex, bytes, iterations );
+        report( "PCB_IO::Load", load, bytes, iterations );
+    }
+    catch( const IO_ERROR& ioe )
+    {
+        printf( "%s\n", (const char*) ioe.What().mb_str() );
+        return -1;
+    }
+
+    return 0;
+}
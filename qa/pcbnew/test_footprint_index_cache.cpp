@@ -0,0 +1,298 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <footprint_index_cache.h>
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <wx/dir.h>
+#include <wx/ffile.h>
+#include <wx/filename.h>
+
+
+/**
+ * Index files in a temporary directory of their own, removed at the end of each test.
+ */
+struct FP_INDEX_CACHE_FIXTURE
+{
+    FP_INDEX_CACHE_FIXTURE()
+    {
+        wxFileName dir( wxFileName::CreateTempFileName( "qa_fp_index" ) );
+
+        // Replace the file made by CreateTempFileName() by a directory of the same name
+        wxRemoveFile( dir.GetFullPath() );
+        dir.Mkdir();
+
+        m_dir = dir.GetFullPath();
+        m_indexFile = wxFileName( m_dir, "fp-index-cache" ).GetFullPath();
+    }
+
+    ~FP_INDEX_CACHE_FIXTURE()
+    {
+        wxFileName::Rmdir( m_dir, wxPATH_RMDIR_RECURSIVE );
+    }
+
+    static FOOTPRINT_INDEX_CACHE::LIBRARY_ENTRY makeLibrary( const wxString& aUri,
+                                                              long long aKey, int aCount )
+    {
+        FOOTPRINT_INDEX_CACHE::LIBRARY_ENTRY lib;
+
+        lib.m_uri = aUri;
+        lib.m_key = aKey;
+
+        for( int i = 0; i < aCount; i++ )
+        {
+            FOOTPRINT_INDEX_CACHE::FOOTPRINT_ENTRY fp;
+
+            fp.m_name = wxString::Format( "FP_%d", i );
+            // A non ASCII doc string, stored as UTF-8
+            fp.m_doc = wxString::Format( "Footprint %d, ", i ) + wxString::FromUTF8( "\xC2\xB5" );
+            fp.m_keywords = i % 2 ? wxString( "smd" ) : wxString();
+            fp.m_padCount = i + 2;
+            fp.m_uniquePadCount = i + 1;
+            lib.m_footprints.push_back( fp );
+        }
+
+        return lib;
+    }
+
+    ///> Writes an index with the libraries "A" and "B" (after "A" in the file)
+    void writeIndex()
+    {
+        FOOTPRINT_INDEX_CACHE cache( m_indexFile );
+
+        cache.Store( "A", makeLibrary( "/libs/A.pretty", 1234, 3 ) );
+        cache.Store( "B", makeLibrary( "/libs/B.pretty", -5678, 20 ) );
+        BOOST_REQUIRE( cache.Save() );
+    }
+
+    std::vector<char> readFile()
+    {
+        wxFFile           file( m_indexFile, "rb" );
+        std::vector<char> buf( file.Length() );
+
+        BOOST_REQUIRE( file.Read( buf.data(), buf.size() ) == buf.size() );
+        return buf;
+    }
+
+    void writeFile( const std::vector<char>& aBuf )
+    {
+        wxFFile file( m_indexFile, "wb" );
+
+        BOOST_REQUIRE( file.Write( aBuf.data(), aBuf.size() ) == aBuf.size() );
+    }
+
+    wxString m_dir;
+    wxString m_indexFile;
+};
+
+
+static void checkLibrary( const FOOTPRINT_INDEX_CACHE::LIBRARY_ENTRY* aLib,
+                          const FOOTPRINT_INDEX_CACHE::LIBRARY_ENTRY& aExpected )
+{
+    BOOST_REQUIRE( aLib );
+    BOOST_CHECK( aLib->m_uri == aExpected.m_uri );
+    BOOST_CHECK_EQUAL( aLib->m_key, aExpected.m_key );
+    BOOST_REQUIRE_EQUAL( aLib->m_footprints.size(), aExpected.m_footprints.size() );
+
+    for( size_t i = 0; i < aExpected.m_footprints.size(); i++ )
+    {
+        const FOOTPRINT_INDEX_CACHE::FOOTPRINT_ENTRY& fp = aLib->m_footprints[i];
+        const FOOTPRINT_INDEX_CACHE::FOOTPRINT_ENTRY& expected = aExpected.m_footprints[i];
+
+        BOOST_CHECK( fp.m_name == expected.m_name );
+        BOOST_CHECK( fp.m_doc == expected.m_doc );
+        BOOST_CHECK( fp.m_keywords == expected.m_keywords );
+        BOOST_CHECK_EQUAL( fp.m_padCount, expected.m_padCount );
+        BOOST_CHECK_EQUAL( fp.m_uniquePadCount, expected.m_uniquePadCount );
+    }
+}
+
+
+BOOST_FIXTURE_TEST_SUITE( FootprintIndexCache, FP_INDEX_CACHE_FIXTURE )
+
+/**
+ * Checks that the saved libraries are read back unchanged, and only found with the URI
+ * and key they were stored with.
+ */
+BOOST_AUTO_TEST_CASE( RoundTrip )
+{
+    writeIndex();
+
+    FOOTPRINT_INDEX_CACHE cache( m_indexFile );
+
+    cache.Load();
+
+    checkLibrary( cache.Find( "A", "/libs/A.pretty", 1234 ),
+                  makeLibrary( "/libs/A.pretty", 1234, 3 ) );
+    checkLibrary( cache.Find( "B", "/libs/B.pretty", -5678 ),
+                  makeLibrary( "/libs/B.pretty", -5678, 20 ) );
+
+    BOOST_CHECK( !cache.Find( "C", "/libs/A.pretty", 1234 ) );
+    BOOST_CHECK( !cache.Find( "A", "/other/A.pretty", 1234 ) );
+    BOOST_CHECK( !cache.Find( "A", "/libs/A.pretty", 1235 ) );
+    BOOST_CHECK( !cache.Find( "A", "/libs/A.pretty", 0 ) );
+
+    // Pruned libraries are not saved anymore
+    cache.Prune( { "B" } );
+    BOOST_CHECK( cache.Save() );
+
+    FOOTPRINT_INDEX_CACHE pruned( m_indexFile );
+
+    pruned.Load();
+    BOOST_CHECK( !pruned.Find( "A", "/libs/A.pretty", 1234 ) );
+    BOOST_CHECK( pruned.Find( "B", "/libs/B.pretty", -5678 ) );
+}
+
+
+/**
+ * Checks that a truncated index never gives a partial library: the libraries cut by the
+ * end of the file are dropped, the ones before are kept.
+ */
+BOOST_AUTO_TEST_CASE( Truncated )
+{
+    writeIndex();
+
+    std::vector<char> full = readFile();
+    FOOTPRINT_INDEX_CACHE::LIBRARY_ENTRY libA = makeLibrary( "/libs/A.pretty", 1234, 3 );
+
+    for( size_t size = 0; size < full.size(); size++ )
+    {
+        writeFile( std::vector<char>( full.begin(), full.begin() + size ) );
+
+        FOOTPRINT_INDEX_CACHE cache( m_indexFile );
+
+        cache.Load();
+
+        // "B" ends the file
+        BOOST_CHECK( !cache.Find( "B", "/libs/B.pretty", -5678 ) );
+
+        if( const FOOTPRINT_INDEX_CACHE::LIBRARY_ENTRY* lib =
+                cache.Find( "A", "/libs/A.pretty", 1234 ) )
+            checkLibrary( lib, libA );
+    }
+
+    // Losing the last byte only drops the last library
+    writeFile( std::vector<char>( full.begin(), full.end() - 1 ) );
+
+    FOOTPRINT_INDEX_CACHE cache( m_indexFile );
+
+    cache.Load();
+    checkLibrary( cache.Find( "A", "/libs/A.pretty", 1234 ), libA );
+}
+
+
+/**
+ * Checks that an index with another version or a bad header is discarded.
+ */
+BOOST_AUTO_TEST_CASE( WrongVersion )
+{
+    writeIndex();
+
+    std::vector<char> buf = readFile();
+
+    // The version follows the 8 byte magic
+    uint32_t version;
+
+    BOOST_REQUIRE( buf.size() > 12 );
+    memcpy( &version, buf.data() + 8, sizeof( version ) );
+    version++;
+    memcpy( buf.data() + 8, &version, sizeof( version ) );
+    writeFile( buf );
+
+    FOOTPRINT_INDEX_CACHE cache( m_indexFile );
+
+    cache.Load();
+    BOOST_CHECK( !cache.Find( "A", "/libs/A.pretty", 1234 ) );
+    BOOST_CHECK( !cache.Find( "B", "/libs/B.pretty", -5678 ) );
+
+    // Restore the version, break the magic
+    version--;
+    memcpy( buf.data() + 8, &version, sizeof( version ) );
+    buf[0] = 'X';
+    writeFile( buf );
+
+    cache.Load();
+    BOOST_CHECK( !cache.Find( "A", "/libs/A.pretty", 1234 ) );
+}
+
+
+/**
+ * Checks that the key of a library changes with its files, so that an entry stored with
+ * the previous key is not found anymore.
+ */
+BOOST_AUTO_TEST_CASE( LibraryKeyChanges )
+{
+    wxString libDir = wxFileName( m_dir, "lib.pretty" ).GetFullPath();
+    wxString fpFile = wxFileName( libDir, "R_0603.kicad_mod" ).GetFullPath();
+
+    BOOST_REQUIRE( wxFileName::Mkdir( libDir ) );
+
+    {
+        wxFFile file( fpFile, "wb" );
+        file.Write( wxString( "(module R_0603)\n" ) );
+    }
+
+    BOOST_CHECK_EQUAL( FOOTPRINT_INDEX_CACHE::LibraryKey( libDir + "-missing" ), 0 );
+
+    long long key = FOOTPRINT_INDEX_CACHE::LibraryKey( libDir );
+
+    BOOST_REQUIRE( key != 0 );
+    BOOST_CHECK_EQUAL( FOOTPRINT_INDEX_CACHE::LibraryKey( libDir ), key );
+
+    FOOTPRINT_INDEX_CACHE cache( m_indexFile );
+
+    cache.Store( "lib", makeLibrary( libDir, key, 1 ) );
+    BOOST_CHECK( cache.Find( "lib", libDir, key ) );
+
+    // A resized footprint file
+    {
+        wxFFile file( fpFile, "ab" );
+        file.Write( wxString( "(module R_0603 (layer F.Cu))\n" ) );
+    }
+
+    long long resizedKey = FOOTPRINT_INDEX_CACHE::LibraryKey( libDir );
+
+    BOOST_CHECK( resizedKey != key );
+    BOOST_CHECK( !cache.Find( "lib", libDir, resizedKey ) );
+
+    // A new footprint file
+    {
+        wxFFile file( wxFileName( libDir, "C_0603.kicad_mod" ).GetFullPath(), "wb" );
+        file.Write( wxString( "(module C_0603)\n" ) );
+    }
+
+    long long addedKey = FOOTPRINT_INDEX_CACHE::LibraryKey( libDir );
+
+    BOOST_CHECK( addedKey != resizedKey );
+    BOOST_CHECK( !cache.Find( "lib", libDir, addedKey ) );
+
+    // The key of a single file library follows the file
+    BOOST_CHECK( FOOTPRINT_INDEX_CACHE::LibraryKey( fpFile ) != 0 );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,333 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * Router replay benchmark: syncs a router world from a board, replays the events of a
+ * router event log and reports the latency percentiles and the shove iterations of each
+ * event type.
+ *
+ * The event log is written by ROUTER::DumpLog() in /tmp/pns_events.log, and holds the
+ * events passed to the router since the world was last synced from the board: save the
+ * board before routing to record a log that replays on it.  The router only records it in
+ * debug builds, or when the KICAD_PNS_EVENT_LOG environment variable is set.
+ *
+ * The routing mode and the track and via sizes logged with each route or drag are applied
+ * before replaying it.  Logs without them are replayed with the default routing settings
+ * and the sizes of the board design settings.
+ *
+ * Usage: test_pns_replay_bench board_file.kicad_pcb events.log [iterations]
+ */
+
+#include <io_mgr.h>
+#include <kicad_plugin.h>
+
+#include <class_board.h>
+#include <profile.h>
+
+#include <router/pns_kicad_iface.h>
+#include <router/pns_debug_decorator.h>
+#include <router/pns_logger.h>
+#include <router/pns_router.h>
+#include <router/pns_routing_settings.h>
+#include <router/pns_shove.h>
+#include <router/pns_sizes_settings.h>
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <memory>
+
+
+/**
+ * A PNS_KICAD_IFACE without view nor commit: the router changes are neither displayed
+ * nor written back to the board, so every replay starts from the same world.
+ */
+class REPLAY_IFACE : public PNS_KICAD_IFACE
+{
+public:
+    void EraseView() override {}
+    void HideItem( PNS::ITEM* aItem ) override {}
+    void DisplayItem( const PNS::ITEM* aItem, int aColor = 0, int aClearance = 0 ) override {}
+    void AddItem( PNS::ITEM* aItem ) override {}
+    void RemoveItem( PNS::ITEM* aItem ) override {}
+    void Commit() override {}
+    void UpdateNet( int aNetCode ) override {}
+
+    PNS::DEBUG_DECORATOR* GetDebugDecorator() override
+    {
+        return &m_decorator;
+    }
+
+private:
+    PNS::DEBUG_DECORATOR m_decorator;
+};
+
+
+struct EVENT_STATS
+{
+    std::vector<double> m_msecs;
+    long long           m_shoveIterations = 0;
+    long long           m_branches = 0;
+};
+
+
+static const char* eventName( PNS::LOGGER::EVENT_TYPE aType )
+{
+    switch( aType )
+    {
+    case PNS::LOGGER::EVT_START_ROUTE:  return "start-route";
+    case PNS::LOGGER::EVT_START_DRAG:   return "start-drag";
+    case PNS::LOGGER::EVT_MOVE:         return "move";
+    case PNS::LOGGER::EVT_FIX:          return "fix";
+    case PNS::LOGGER::EVT_STOP:         return "stop";
+    case PNS::LOGGER::EVT_SET_MODE:     return "set-mode";
+    case PNS::LOGGER::EVT_SWITCH_LAYER: return "switch-layer";
+    case PNS::LOGGER::EVT_TOGGLE_VIA:   return "toggle-via";
+    case PNS::LOGGER::EVT_FLIP_POSTURE: return "flip-posture";
+    case PNS::LOGGER::EVT_SETTINGS:     return "settings";
+    case PNS::LOGGER::EVT_SIZES:        return "sizes";
+    default:                            return "unknown";
+    }
+}
+
+
+/**
+ * Finds the item of an event in the items under its position, the way the router tool
+ * picks the item under the cursor.
+ */
+static PNS::ITEM* findItem( PNS::ROUTER& aRouter, const PNS::LOGGER::EVENT_ENTRY& aEvent )
+{
+    if( !aEvent.m_itemKind )
+        return nullptr;
+
+    PNS::ITEM_SET candidates = aRouter.QueryHoverItems( aEvent.m_p );
+
+    for( PNS::ITEM* item : candidates.Items() )
+    {
+        if( item->Kind() == aEvent.m_itemKind && item->Net() == aEvent.m_itemNet
+                && item->Layers().Overlaps( aEvent.m_itemLayer ) )
+            return item;
+    }
+
+    return nullptr;
+}
+
+
+/**
+ * Applies the sizes of an EVT_SIZES event to the router.
+ * @return false if the event does not hold all the sizes.
+ */
+static bool applySizes( PNS::ROUTER& aRouter, const PNS::LOGGER::EVENT_ENTRY& aEvent )
+{
+    const std::vector<int>& params = aEvent.m_params;
+
+    if( params.size() < 7 )
+        return false;
+
+    PNS::SIZES_SETTINGS sizes( aRouter.Sizes() );
+
+    sizes.SetTrackWidth( aEvent.m_arg );
+    sizes.SetViaDiameter( params[0] );
+    sizes.SetViaDrill( params[1] );
+    sizes.SetViaType( (VIATYPE_T) params[2] );
+    sizes.SetDiffPairWidth( params[3] );
+    sizes.SetDiffPairGap( params[4] );
+    sizes.SetDiffPairViaGap( params[5] );
+    sizes.SetDiffPairViaGapSameAsTraceGap( params[6] != 0 );
+    aRouter.UpdateSizes( sizes );
+
+    return true;
+}
+
+
+/**
+ * Replays an event.  aHasSizes tells if the sizes were logged before the route started: if
+ * not, they are taken from the board design settings, as the router tool does.
+ */
+static void replayEvent( PNS::ROUTER& aRouter, BOARD* aBoard,
+                         const PNS::LOGGER::EVENT_ENTRY& aEvent, bool& aHasSizes )
+{
+    PNS::ITEM* item = findItem( aRouter, aEvent );
+
+    switch( aEvent.m_type )
+    {
+    case PNS::LOGGER::EVT_START_ROUTE:
+    {
+        if( !aHasSizes )
+        {
+            PNS::SIZES_SETTINGS sizes( aRouter.Sizes() );
+
+            sizes.Init( aBoard, item );
+            aRouter.UpdateSizes( sizes );
+        }
+
+        aRouter.StartRouting( aEvent.m_p, item, aEvent.m_arg );
+        aHasSizes = false;
+        break;
+    }
+
+    case PNS::LOGGER::EVT_SETTINGS:
+        aRouter.Settings().SetMode( (PNS::PNS_MODE) aEvent.m_arg );
+        break;
+
+    case PNS::LOGGER::EVT_SIZES:
+        aHasSizes = applySizes( aRouter, aEvent );
+        break;
+
+    case PNS::LOGGER::EVT_START_DRAG:
+        aRouter.StartDragging( aEvent.m_p, item, aEvent.m_arg );
+        aHasSizes = false;
+        break;
+
+    case PNS::LOGGER::EVT_MOVE:
+        aRouter.Move( aEvent.m_p, item );
+        break;
+
+    case PNS::LOGGER::EVT_FIX:
+        aRouter.FixRoute( aEvent.m_p, item );
+        break;
+
+    case PNS::LOGGER::EVT_STOP:
+        aRouter.StopRouting();
+        break;
+
+    case PNS::LOGGER::EVT_SET_MODE:
+        aRouter.SetMode( (PNS::ROUTER_MODE) aEvent.m_arg );
+        break;
+
+    case PNS::LOGGER::EVT_SWITCH_LAYER:
+        aRouter.SwitchLayer( aEvent.m_arg );
+        break;
+
+    case PNS::LOGGER::EVT_TOGGLE_VIA:
+        aRouter.ToggleViaPlacement();
+        break;
+
+    case PNS::LOGGER::EVT_FLIP_POSTURE:
+        aRouter.FlipPosture();
+        break;
+
+    default:
+        break;
+    }
+}
+
+
+///> Returns the aPercent percentile of the sorted values aValues (nearest rank)
+static double percentile( const std::vector<double>& aValues, double aPercent )
+{
+    int rank = (int) std::ceil( aPercent / 100.0 * aValues.size() );
+
+    return aValues[ std::max( 0, std::min( rank, (int) aValues.size() ) - 1 ) ];
+}
+
+
+int main( int argc, char *argv[] )
+{
+    if( argc < 3 )
+    {
+        printf( "usage: %s board_file.kicad_pcb events.log [iterations]\n", argv[0] );
+        return -1;
+    }
+
+    wxString filename = wxString::FromUTF8( argv[1] );
+    int      iterations = argc > 3 ? std::max( atoi( argv[3] ), 1 ) : 5;
+
+    std::unique_ptr<BOARD> brd;
+
+    try
+    {
+        PLUGIN::RELEASER pi( new PCB_IO );
+        brd.reset( pi->Load( filename, NULL, NULL ) );
+    }
+    catch( const IO_ERROR& ioe )
+    {
+        printf( "%s\n", (const char*) ioe.What().mb_str() );
+        return -1;
+    }
+
+    std::vector<PNS::LOGGER::EVENT_ENTRY> events;
+
+    if( !PNS::LOGGER::ParseEvents( argv[2], events ) )
+    {
+        printf( "can't read the event log '%s'\n", argv[2] );
+        return -1;
+    }
+
+    REPLAY_IFACE iface;
+    PNS::ROUTER  router;
+
+    iface.SetBoard( brd.get() );
+    router.SetInterface( &iface );
+    router.EnableEventLog( false );
+
+    std::map<PNS::LOGGER::EVENT_TYPE, EVENT_STATS> stats;
+    PROF_COUNTER                                   totalTimer( "replay" );
+
+    for( int i = 0; i < iterations; i++ )
+    {
+        bool hasSizes = false;
+
+        router.LoadSettings( PNS::ROUTING_SETTINGS() );
+        router.SyncWorld();
+
+        for( const PNS::LOGGER::EVENT_ENTRY& evt : events )
+        {
+            EVENT_STATS&     evtStats = stats[evt.m_type];
+            int              shoveIterations = PNS::SHOVE::TotalIterations();
+            PNS::ALLOC_STATS allocs = PNS::NODE::AllocStats();
+            PROF_COUNTER     timer;
+
+            replayEvent( router, brd.get(), evt, hasSizes );
+
+            timer.Stop();
+
+            evtStats.m_msecs.push_back( timer.msecs() );
+            evtStats.m_shoveIterations += PNS::SHOVE::TotalIterations() - shoveIterations;
+            evtStats.m_branches += ( PNS::NODE::AllocStats() - allocs ).m_branches;
+        }
+
+        router.StopRouting();
+    }
+
+    totalTimer.Stop();
+
+    printf( "%s: %d events, %d iterations, %.1f ms per replay\n", argv[2], (int) events.size(),
+            iterations, totalTimer.msecs() / iterations );
+    printf( "%-14s %8s %10s %10s %10s %10s %12s %10s\n", "event", "count", "p50 ms", "p90 ms",
+            "p99 ms", "max ms", "shove iter", "branches" );
+
+    for( auto& entry : stats )
+    {
+        std::vector<double>& msecs = entry.second.m_msecs;
+
+        std::sort( msecs.begin(), msecs.end() );
+
+        printf( "%-14s %8d %10.3f %10.3f %10.3f %10.3f %12lld %10lld\n", eventName( entry.first ),
+                (int) msecs.size(), percentile( msecs, 50 ), percentile( msecs, 90 ),
+                percentile( msecs, 99 ), msecs.back(), entry.second.m_shoveIterations,
+                entry.second.m_branches );
+    }
+
+    return 0;
+}
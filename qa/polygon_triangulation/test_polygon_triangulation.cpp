@@ -24,6 +24,9 @@
 
 #include <geometry/shape_poly_set.h>
 #include <geometry/shape_line_chain.h>
+#include <geometry/polygon_triangulation.h>
+
+#include <poly2tri/poly2tri.h>
 
 #include <io_mgr.h>
 #include <kicad_plugin.h>
@@ -32,6 +35,8 @@
 #include <class_zone.h>
 #include <profile.h>
 
+#include <cmath>
+#include <memory>
 #include <unordered_set>
 #include <utility>
 
@@ -217,16 +222,183 @@ BOARD* loadBoard( const std::string& filename )
     return brd;
 }
 
+/**
+ * Triangulates aPoly like the former CacheTriangulation(): poly2tri on the unfractured
+ * polygon.
+ * @return the triangle count, or -1 if poly2tri cannot handle the polygon.
+ */
+int poly2triTriangulate( const SHAPE_POLY_SET::POLYGON& aPoly )
+{
+    SHAPE_POLY_SET tmpSet;
+
+    tmpSet.AddOutline( aPoly[0] );
+
+    for( unsigned i = 1; i < aPoly.size(); i++ )
+        tmpSet.AddHole( aPoly[i] );
+
+    if( !tmpSet.HasHoles() )
+        tmpSet.Unfracture( SHAPE_POLY_SET::PM_FAST );
+
+    if( tmpSet.HasTouchingHoles() )
+        return -1;
+
+    int triangleCount = 0;
+
+    for( int i = 0; i < tmpSet.OutlineCount(); i++ )
+    {
+        std::vector<std::unique_ptr<p2t::Point>> points;
+        std::unique_ptr<p2t::CDT>                cdt;
+
+        for( const SHAPE_LINE_CHAIN& path : tmpSet.Polygon( i ) )
+        {
+            std::vector<p2t::Point*> polyline;
+
+            for( int j = 0; j < path.PointCount(); j++ )
+            {
+                points.emplace_back( new p2t::Point( path.CPoint( j ).x, path.CPoint( j ).y ) );
+                polyline.push_back( points.back().get() );
+            }
+
+            if( !cdt )
+                cdt.reset( new p2t::CDT( polyline ) );
+            else
+                cdt->AddHole( polyline );
+        }
+
+        cdt->Triangulate();
+        triangleCount += cdt->GetTriangles().size();
+    }
+
+    return triangleCount;
+}
+
+
+/**
+ * Builds a fractured ground plane: a board sized copper area with the clearance holes
+ * of aViaCount vias and a few tracks.
+ */
+SHAPE_POLY_SET groundPlane( int aViaCount )
+{
+    const int width = 100000000;
+    const int height = 80000000;
+
+    SHAPE_POLY_SET plane;
+    SHAPE_POLY_SET holes;
+
+    plane.NewOutline();
+    plane.Append( 0, 0 );
+    plane.Append( width, 0 );
+    plane.Append( width, height );
+    plane.Append( 0, height );
+
+    srand( 1 );
+
+    for( int i = 0; i < aViaCount; i++ )
+    {
+        VECTOR2I center( rand() % width, rand() % height );
+        int      radius = 300000 + rand() % 400000;
+
+        holes.NewOutline();
+
+        for( int k = 0; k < 16; k++ )
+        {
+            double angle = k * 2.0 * M_PI / 16;
+            holes.Append( center.x + KiROUND( radius * cos( angle ) ),
+                          center.y + KiROUND( radius * sin( angle ) ) );
+        }
+
+        if( i % 4 == 0 )
+        {
+            VECTOR2I end = center + VECTOR2I( rand() % 10000000, 0 );
+
+            holes.NewOutline();
+            holes.Append( center.x, center.y - radius / 2 );
+            holes.Append( end.x, end.y - radius / 2 );
+            holes.Append( end.x, end.y + radius / 2 );
+            holes.Append( center.x, center.y + radius / 2 );
+        }
+    }
+
+    holes.Simplify( SHAPE_POLY_SET::PM_FAST );
+    plane.BooleanSubtract( holes, SHAPE_POLY_SET::PM_STRICTLY_SIMPLE );
+    plane.Fracture( SHAPE_POLY_SET::PM_FAST );
+
+    return plane;
+}
+
+
+/**
+ * Triangulates the polygons of aPolys with both engines, and prints the timings.
+ */
+void benchmark( const char* aName, const SHAPE_POLY_SET& aPolys )
+{
+    int earClipTriangles = 0;
+    int poly2triTriangles = 0;
+    int fallbacks = 0;
+    int poly2triFailures = 0;
+
+    PROF_COUNTER earClip( "ear clipping" );
+
+    for( int i = 0; i < aPolys.OutlineCount(); i++ )
+    {
+        SHAPE_POLY_SET::TRIANGULATED_POLYGON result;
+        POLYGON_TRIANGULATION                tess( result );
+
+        if( !tess.TesselatePolygon( aPolys.CPolygon( i ) ) )
+            fallbacks++;
+
+        earClipTriangles += result.GetTriangleCount();
+    }
+
+    earClip.Stop();
+
+    PROF_COUNTER poly2tri( "poly2tri" );
+
+    for( int i = 0; i < aPolys.OutlineCount(); i++ )
+    {
+        int count = poly2triTriangulate( aPolys.CPolygon( i ) );
+
+        if( count < 0 )
+            poly2triFailures++;
+        else
+            poly2triTriangles += count;
+    }
+
+    poly2tri.Stop();
+
+    printf( "%-24s %7d vertices  ear clipping %9.2f ms %7d triangles %d fallbacks"
+            "  poly2tri %9.2f ms %7d triangles %d failures\n",
+            aName, aPolys.TotalVertices(),
+            earClip.msecs(), earClipTriangles, fallbacks,
+            poly2tri.msecs(), poly2triTriangles, poly2triFailures );
+}
+
+
 int main( int argc, char *argv[] )
 {
+    for( int viaCount : { 1000, 5000, 20000 } )
+    {
+        char name[64];
+
+        snprintf( name, sizeof( name ), "ground plane, %d vias", viaCount );
+        benchmark( name, groundPlane( viaCount ) );
+    }
+
     auto brd = loadBoard( argc > 1 ? argv[1] : "../../../../tests/dp.kicad_pcb" );
 
     if( !brd )
         return -1;
 
+    for( int z = 0; z < brd->GetAreaCount(); z++ )
+    {
+        auto zone = brd->GetArea( z );
+        char name[64];
 
-    PROF_COUNTER cnt( "allBoard" );
+        snprintf( name, sizeof( name ), "zone %d/%d", z + 1, brd->GetAreaCount() );
+        benchmark( name, zone->GetFilledPolysList() );
+    }
 
+    PROF_COUNTER cnt( "allBoard" );
 
     #pragma omp parallel for schedule(dynamic)
     for( int z = 0; z<brd->GetAreaCount(); z++ )
@@ -235,22 +407,6 @@ int main( int argc, char *argv[] )
         SHAPE_POLY_SET poly = zone->GetFilledPolysList();
 
         poly.CacheTriangulation();
-
-        (void) poly;
-        printf("zone %d/%d\n", ( z+1 ), brd->GetAreaCount() );
-#if 0
-        PROF_COUNTER unfrac("unfrac");
-        poly.Unfracture( SHAPE_POLY_SET::PM_FAST );
-        unfrac.Show();
-
-        PROF_COUNTER triangulate("triangulate");
-
-        for(int i =0; i< poly.OutlineCount(); i++)
-        {
-            poly.triangulatePoly( &poly.Polygon(i) );
-        }
-        triangulate.Show();
-#endif
     }
 
     cnt.Show();
@@ -258,5 +414,4 @@ int main( int argc, char *argv[] )
     delete brd;
 
     return 0;
-
 }
@@ -0,0 +1,188 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * Chooser search benchmark: generates a set of symbol names and search texts like the
+ * ones of the symbol chooser, and times each keystroke of a few searches with a scan of
+ * all the items by EDA_COMBINED_MATCHER, and with the candidates of a TRIGRAM_INDEX.
+ * Both searches must find the same items.
+ *
+ * Usage: test_search_index_bench [item_count] [iterations]
+ */
+
+#include <eda_pattern_match.h>
+#include <trigram_index.h>
+#include <profile.h>
+
+#include <algorithm>
+#include <random>
+
+
+struct ITEM
+{
+    wxString m_name;        // lower case, as CMP_TREE_NODE::MatchName
+    wxString m_text;        // lower case, as CMP_TREE_NODE::SearchText
+};
+
+
+static std::vector<ITEM> makeItems( int aCount )
+{
+    static const char* prefixes[] = { "lm", "tl", "ne", "ad", "max", "stm32f", "atmega", "pic",
+                                      "74hc", "cd40", "irf", "bc", "1n", "usb", "r", "c" };
+    static const char* packages[] = { "sot-23", "soic-8", "tssop-14", "qfn-32", "lqfp-64",
+                                      "dip-8", "to-220", "sod-123", "0603", "0805" };
+    static const char* words[] = { "operational", "amplifier", "regulator", "voltage", "low",
+                                   "dropout", "microcontroller", "flash", "mosfet", "n-channel",
+                                   "diode", "schottky", "transistor", "npn", "connector",
+                                   "resistor", "capacitor", "logic", "buffer", "inverter",
+                                   "comparator", "timer", "driver", "sensor", "temperature" };
+
+    std::mt19937      rng( 42 );
+    std::vector<ITEM> items;
+
+    auto pick = [&rng]( const char** aList, size_t aSize ) { return aList[rng() % aSize]; };
+
+    for( int ii = 0; ii < aCount; ++ii )
+    {
+        ITEM     item;
+        wxString package = pick( packages, sizeof( packages ) / sizeof( packages[0] ) );
+
+        item.m_name.Printf( "%s%d_%s", pick( prefixes, sizeof( prefixes ) / sizeof( prefixes[0] ) ),
+                            (int) ( rng() % 10000 ), package );
+
+        // Keywords, then description, then footprint, as CMP_TREE_NODE_LIB_ID::Update()
+        wxString keywords, desc;
+
+        for( int jj = 0; jj < 3; ++jj )
+            keywords << pick( words, sizeof( words ) / sizeof( words[0] ) ) << " ";
+
+        for( int jj = 0; jj < 8; ++jj )
+            desc << pick( words, sizeof( words ) / sizeof( words[0] ) ) << " ";
+
+        item.m_text = keywords + "        " + desc + "        package_" + package;
+        items.push_back( item );
+    }
+
+    return items;
+}
+
+
+static bool matches( EDA_COMBINED_MATCHER& aMatcher, const ITEM& aItem )
+{
+    int fired, pos;
+
+    return aMatcher.Find( aItem.m_name, fired, pos ) || aMatcher.Find( aItem.m_text, fired, pos );
+}
+
+
+int main( int argc, char *argv[] )
+{
+    int itemCount = argc > 1 ? std::max( atoi( argv[1] ), 1 ) : 100000;
+    int iterations = argc > 2 ? std::max( atoi( argv[2] ), 1 ) : 3;
+
+    std::vector<ITEM> items = makeItems( itemCount );
+
+    PROF_COUNTER  buildTimer;
+    TRIGRAM_INDEX index;
+
+    for( size_t ii = 0; ii < items.size(); ++ii )
+    {
+        index.Add( ii, items[ii].m_name );
+        index.Add( ii, items[ii].m_text );
+    }
+
+    index.Build();
+    buildTimer.Stop();
+
+    printf( "%d items, %d trigrams, index built in %.1f ms\n", itemCount,
+            (int) index.TrigramCount(), buildTimer.msecs() );
+
+    // Each search is typed one character at a time
+    static const char* searches[] = { "lm317", "regulator", "sot-23", "stm32f4", "schottky" };
+
+    printf( "%-12s %10s %10s %12s %12s\n", "term", "matches", "candidates", "scan ms",
+            "index ms" );
+
+    bool ok = true;
+
+    for( const char* search : searches )
+    {
+        wxString full = search;
+
+        for( size_t len = 1; len <= full.length(); ++len )
+        {
+            wxString              term = full.Left( len );
+            EDA_COMBINED_MATCHER  matcher( term );
+            std::vector<unsigned> scanned, found, candidates;
+            PROF_COUNTER          scanTimer;
+
+            for( int it = 0; it < iterations; ++it )
+            {
+                scanned.clear();
+
+                for( size_t ii = 0; ii < items.size(); ++ii )
+                {
+                    if( matches( matcher, items[ii] ) )
+                        scanned.push_back( ii );
+                }
+            }
+
+            scanTimer.Stop();
+
+            PROF_COUNTER indexTimer;
+
+            for( int it = 0; it < iterations; ++it )
+            {
+                found.clear();
+
+                if( !index.Find( term, candidates ) )
+                {
+                    candidates.resize( items.size() );
+
+                    for( size_t ii = 0; ii < items.size(); ++ii )
+                        candidates[ii] = ii;
+                }
+
+                for( unsigned ii : candidates )
+                {
+                    if( matches( matcher, items[ii] ) )
+                        found.push_back( ii );
+                }
+            }
+
+            indexTimer.Stop();
+
+            if( found != scanned )
+            {
+                printf( "mismatch for term '%s'\n", (const char*) term.c_str() );
+                ok = false;
+            }
+
+            printf( "%-12s %10d %10d %12.3f %12.3f\n", (const char*) term.c_str(),
+                    (int) scanned.size(), (int) candidates.size(),
+                    scanTimer.msecs() / iterations, indexTimer.msecs() / iterations );
+        }
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,207 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * Vertex staging benchmark: tessellates a set of polylines shaped like zone outlines into
+ * cached items, once directly and once through VERTEX_STAGING, and compares the vertices
+ * of each item.  The items are stored in a CACHED_CONTAINER_RAM, which does not need an
+ * OpenGL context until it is uploaded, so the benchmark runs headless.
+ *
+ * Usage: test_vertex_staging_bench [item_count]
+ */
+
+#include <gal/opengl/cached_container_ram.h>
+#include <gal/opengl/vertex_manager.h>
+#include <gal/opengl/vertex_item.h>
+#include <gal/opengl/vertex_staging.h>
+#include <profile.h>
+
+#include <cmath>
+#include <cstring>
+#include <random>
+
+using namespace KIGFX;
+
+
+struct POLYLINE
+{
+    std::vector<VECTOR2D> m_points;
+    COLOR4D               m_color;
+    double                m_width;
+};
+
+
+static std::vector<std::vector<POLYLINE>> makeItems( int aCount )
+{
+    std::mt19937 rng( 42 );
+    std::uniform_real_distribution<double> coord( -1e8, 1e8 );
+    std::uniform_real_distribution<double> unit( 0.0, 1.0 );
+    std::vector<std::vector<POLYLINE>> items( aCount );
+
+    for( std::vector<POLYLINE>& item : items )
+    {
+        // An outline and a few holes
+        int polylineCount = 1 + rng() % 4;
+
+        for( int i = 0; i < polylineCount; ++i )
+        {
+            POLYLINE polyline;
+            VECTOR2D center( coord( rng ), coord( rng ) );
+            double   radius = 1e5 + unit( rng ) * 1e7;
+            int      pointCount = 8 + rng() % 2000;
+
+            for( int j = 0; j <= pointCount; ++j )
+            {
+                double angle = 2.0 * M_PI * j / pointCount;
+                double r = radius * ( 0.8 + 0.2 * unit( rng ) );
+
+                polyline.m_points.push_back( center + VECTOR2D( r * cos( angle ),
+                                                                r * sin( angle ) ) );
+
+                // A few repeated points, whose segments have no quad
+                if( j % 97 == 5 )
+                    polyline.m_points.push_back( polyline.m_points.back() );
+            }
+
+            polyline.m_color = COLOR4D( unit( rng ), unit( rng ), unit( rng ), 1.0 );
+            polyline.m_width = 1e5 + unit( rng ) * 1e6;
+            item.push_back( std::move( polyline ) );
+        }
+    }
+
+    return items;
+}
+
+
+/**
+ * Draws a primitive which is never staged, so that the comparison checks that the staged
+ * vertices keep their place among the other vertices of their item.
+ */
+static void drawMarker( VERTEX_MANAGER& aManager, const VECTOR2D& aPoint, double aWidth,
+                        double aDepth )
+{
+    aManager.Color( COLOR4D( 1.0, 1.0, 1.0, 1.0 ) );
+    VERTEX_STAGING::DrawLineQuad( aManager, aPoint, aPoint + VECTOR2D( aWidth, 0.0 ), aWidth,
+                                  aDepth );
+}
+
+
+int main( int argc, char *argv[] )
+{
+    int itemCount = argc > 1 ? std::max( atoi( argv[1] ), 1 ) : 2000;
+    const double depth = -42.0;
+
+    std::vector<std::vector<POLYLINE>> items = makeItems( itemCount );
+    size_t pointCount = 0;
+
+    for( const std::vector<POLYLINE>& item : items )
+    {
+        for( const POLYLINE& polyline : item )
+            pointCount += polyline.m_points.size();
+    }
+
+    // The managers own their containers, and have to outlive their items
+    VERTEX_MANAGER directManager( new CACHED_CONTAINER_RAM );
+    VERTEX_MANAGER stagedManager( new CACHED_CONTAINER_RAM );
+    std::vector<std::shared_ptr<VERTEX_ITEM>> directItems, stagedItems;
+
+    PROF_COUNTER directTimer;
+
+    for( const std::vector<POLYLINE>& item : items )
+    {
+        directItems.push_back( std::make_shared<VERTEX_ITEM>( directManager ) );
+
+        for( const POLYLINE& polyline : item )
+        {
+            const std::vector<VECTOR2D>& pts = polyline.m_points;
+
+            drawMarker( directManager, pts[0], polyline.m_width, depth );
+            directManager.Color( polyline.m_color );
+            VERTEX_STAGING::DrawPolyline( directManager, [&pts]( int aIdx ) { return pts[aIdx]; },
+                                          pts.size(), polyline.m_width, depth );
+        }
+
+        drawMarker( directManager, item.back().m_points.back(), item.back().m_width, depth );
+
+        directManager.FinishItem();
+    }
+
+    directTimer.Stop();
+
+    PROF_COUNTER   stagedTimer;
+    VERTEX_STAGING staging;
+
+    for( const std::vector<POLYLINE>& item : items )
+    {
+        stagedItems.push_back( std::make_shared<VERTEX_ITEM>( stagedManager ) );
+
+        for( const POLYLINE& polyline : item )
+        {
+            std::vector<VECTOR2D> points( polyline.m_points );
+
+            drawMarker( stagedManager, points[0], polyline.m_width, depth );
+            staging.AddPolyline( stagedManager, stagedItems.back(), std::move( points ),
+                                 polyline.m_color, polyline.m_width, depth );
+        }
+
+        drawMarker( stagedManager, item.back().m_points.back(), item.back().m_width, depth );
+
+        stagedManager.FinishItem();
+    }
+
+    // The polylines of the deleted items are dropped
+    for( size_t i = 0; i < stagedItems.size(); i += 10 )
+        stagedItems[i].reset();
+
+    staging.Flush( stagedManager );
+    stagedTimer.Stop();
+
+    bool ok = true;
+
+    for( size_t i = 0; i < items.size(); ++i )
+    {
+        if( !stagedItems[i] )
+            continue;
+
+        const VERTEX_ITEM& direct = *directItems[i];
+        const VERTEX_ITEM& staged = *stagedItems[i];
+
+        if( direct.GetSize() != staged.GetSize()
+                || memcmp( direct.GetVertices(), staged.GetVertices(),
+                           direct.GetSize() * VERTEX_SIZE ) )
+        {
+            printf( "mismatch for item %d: %u vertices, %u staged\n", (int) i,
+                    direct.GetSize(), staged.GetSize() );
+            ok = false;
+        }
+    }
+
+    printf( "%d items, %d points\n", itemCount, (int) pointCount );
+    printf( "direct: %.1f ms, staged: %.1f ms\n", directTimer.msecs(), stagedTimer.msecs() );
+
+    // Free the items before their managers
+    directItems.clear();
+    stagedItems.clear();
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,239 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * Zone fill boolean benchmark: runs the polygon operations of the zone filler on the
+ * zones of a board, with the SHAPE_POLY_SET operations and with SHAPE_POLY_SET::BATCH.
+ *
+ * Usage: test_zone_fill_bench board_file.kicad_pcb [iterations]
+ */
+
+#include <io_mgr.h>
+#include <kicad_plugin.h>
+
+#include <class_board.h>
+#include <class_module.h>
+#include <class_track.h>
+#include <class_zone.h>
+#include <pcbnew.h>
+#include <geometry/shape_poly_set.h>
+#include <geometry/geometry_utils.h>
+#include <profile.h>
+
+#include <memory>
+
+
+struct ZONE_INPUT
+{
+    SHAPE_POLY_SET  m_outline;
+    SHAPE_POLY_SET  m_holes;
+    int             m_halfThickness;
+};
+
+
+/**
+ * Builds the holes of a zone like the zone filler does: the pads and the tracks of the
+ * other nets on the zone layer, with their clearance.
+ */
+static void buildHoles( BOARD* aBoard, ZONE_CONTAINER* aZone, SHAPE_POLY_SET& aHoles )
+{
+    const int segsPerCircle = ARC_APPROX_SEGMENTS_COUNT_HIGHT_DEF;
+    double    correctionFactor = GetCircletoPolyCorrectionFactor( segsPerCircle );
+    EDA_RECT  zoneBox = aZone->GetBoundingBox();
+    int       clearance = aZone->GetClearance();
+    int       halfThickness = aZone->GetMinThickness() / 2;
+
+    zoneBox.Inflate( clearance );
+
+    for( D_PAD* pad : aBoard->GetPads() )
+    {
+        if( !pad->IsOnLayer( aZone->GetLayer() ) || pad->GetNetCode() == aZone->GetNetCode() )
+            continue;
+
+        if( !pad->GetBoundingBox().Intersects( zoneBox ) )
+            continue;
+
+        pad->TransformShapeWithClearanceToPolygon( aHoles,
+                std::max( clearance, pad->GetClearance() ) + halfThickness,
+                segsPerCircle, correctionFactor );
+    }
+
+    for( TRACK* track : aBoard->Tracks() )
+    {
+        if( !track->IsOnLayer( aZone->GetLayer() ) || track->GetNetCode() == aZone->GetNetCode() )
+            continue;
+
+        if( !track->GetBoundingBox().Intersects( zoneBox ) )
+            continue;
+
+        track->TransformShapeWithClearanceToPolygon( aHoles,
+                std::max( clearance, track->GetClearance() ) + halfThickness,
+                segsPerCircle, correctionFactor );
+    }
+}
+
+
+static SHAPE_POLY_SET outlinePolygon( const SHAPE_POLY_SET& aPolySet, int aIndex )
+{
+    const SHAPE_POLY_SET::POLYGON& outline = aPolySet.CPolygon( aIndex );
+    SHAPE_POLY_SET                 part;
+
+    part.AddOutline( outline[0] );
+
+    for( unsigned jj = 1; jj < outline.size(); jj++ )
+        part.AddHole( outline[jj] );
+
+    return part;
+}
+
+
+static SHAPE_POLY_SET polySetFill( const ZONE_INPUT& aInput )
+{
+    SHAPE_POLY_SET solidAreas = aInput.m_outline;
+    SHAPE_POLY_SET holes = aInput.m_holes;
+
+    solidAreas.Inflate( -aInput.m_halfThickness, ARC_APPROX_SEGMENTS_COUNT_HIGHT_DEF );
+    solidAreas.Simplify( SHAPE_POLY_SET::PM_FAST );
+    holes.Simplify( SHAPE_POLY_SET::PM_FAST );
+
+    SHAPE_POLY_SET result;
+
+    for( int ii = 0; ii < solidAreas.OutlineCount(); ii++ )
+    {
+        SHAPE_POLY_SET part = outlinePolygon( solidAreas, ii );
+
+        part.BooleanSubtract( holes, SHAPE_POLY_SET::PM_STRICTLY_SIMPLE );
+        result.Append( part );
+    }
+
+    return result;
+}
+
+
+static SHAPE_POLY_SET batchFill( const ZONE_INPUT& aInput )
+{
+    SHAPE_POLY_SET::BATCH outline( aInput.m_outline );
+    SHAPE_POLY_SET::BATCH holes( aInput.m_holes );
+    SHAPE_POLY_SET        solidAreas;
+
+    outline.Inflate( -aInput.m_halfThickness, ARC_APPROX_SEGMENTS_COUNT_HIGHT_DEF );
+    outline.Simplify( SHAPE_POLY_SET::PM_FAST );
+    outline.GetResult( solidAreas );
+    holes.Simplify( SHAPE_POLY_SET::PM_FAST );
+
+    SHAPE_POLY_SET result;
+
+    for( int ii = 0; ii < solidAreas.OutlineCount(); ii++ )
+    {
+        SHAPE_POLY_SET::BATCH part( outlinePolygon( solidAreas, ii ) );
+        SHAPE_POLY_SET        partResult;
+
+        part.BooleanSubtract( holes, SHAPE_POLY_SET::PM_STRICTLY_SIMPLE );
+        part.GetResult( partResult );
+        result.Append( partResult );
+    }
+
+    return result;
+}
+
+
+int main( int argc, char *argv[] )
+{
+    if( argc < 2 )
+    {
+        printf( "usage: %s board_file.kicad_pcb [iterations]\n", argv[0] );
+        return -1;
+    }
+
+    wxString filename = wxString::FromUTF8( argv[1] );
+    int      iterations = argc > 2 ? std::max( atoi( argv[2] ), 1 ) : 5;
+
+    std::unique_ptr<BOARD> brd;
+
+    try
+    {
+        PLUGIN::RELEASER pi( new PCB_IO );
+        brd.reset( pi->Load( filename, NULL, NULL ) );
+    }
+    catch( const IO_ERROR& ioe )
+    {
+        printf( "%s\n", (const char*) ioe.What().mb_str() );
+        return -1;
+    }
+
+    std::vector<ZONE_INPUT> inputs;
+    int                     holeVertices = 0;
+
+    for( int i = 0; i < brd->GetAreaCount(); i++ )
+    {
+        ZONE_CONTAINER* zone = brd->GetArea( i );
+
+        if( !zone->IsOnCopperLayer() || zone->GetIsKeepout() )
+            continue;
+
+        ZONE_INPUT input;
+
+        input.m_outline = *zone->Outline();
+        input.m_halfThickness = zone->GetMinThickness() / 2;
+        buildHoles( brd.get(), zone, input.m_holes );
+        holeVertices += input.m_holes.TotalVertices();
+
+        inputs.push_back( std::move( input ) );
+    }
+
+    int polySetVertices = 0;
+    int batchVertices = 0;
+
+    PROF_COUNTER polySetTimer( "SHAPE_POLY_SET" );
+
+    for( int i = 0; i < iterations; i++ )
+    {
+        polySetVertices = 0;
+
+        for( const ZONE_INPUT& input : inputs )
+            polySetVertices += polySetFill( input ).TotalVertices();
+    }
+
+    polySetTimer.Stop();
+
+    PROF_COUNTER batchTimer( "BATCH" );
+
+    for( int i = 0; i < iterations; i++ )
+    {
+        batchVertices = 0;
+
+        for( const ZONE_INPUT& input : inputs )
+            batchVertices += batchFill( input ).TotalVertices();
+    }
+
+    batchTimer.Stop();
+
+    printf( "%s: %d zones, %d hole vertices, %d iterations\n", argv[1], (int) inputs.size(),
+            holeVertices, iterations );
+    printf( "%-16s %10.1f ms %10d vertices\n", "SHAPE_POLY_SET",
+            polySetTimer.msecs() / iterations, polySetVertices );
+    printf( "%-16s %10.1f ms %10d vertices\n", "BATCH",
+            batchTimer.msecs() / iterations, batchVertices );
+
+    return 0;
+}